@@ -0,0 +1,1519 @@
+// assm_array.c - Array processing kernels (tutorial 7)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// array_sum_loop is the tutorial's loop: one addq chain, so at best one
+// element per cycle. The vector kernels keep four independent accumulators
+// (8 or 16 elements per iteration) and only add them together at the end.
+// The AVX2 kernel adds scalars up to a 32-byte boundary so every vpaddq
+// reads one aligned block, and finishes with a single masked load of the
+// last 0..3 elements instead of a scalar loop.
+//
+// Above ARRAY_SUM_PREFETCH_MIN elements it also prefetches 1 KiB ahead.
+// That only pays off well beyond the last-level cache (about 10% at 256
+// MiB here, nothing at 8 MiB); in cache the extra loads cost as much, so
+// smaller arrays skip it.
+#define ARRAY_SUM_PREFETCH_MIN (4u << 20)       // elements (32 MiB)
+#define ARRAY_SUM_PREFETCH_BYTES 1024
+
+// Masks for the last count & 3 elements: 24 - 8 * n bytes in, the first n
+// lanes are all ones
+static const long array_tail_masks[7] = {-1, -1, -1, 0, 0, 0, 0};
+
+long array_sum_loop(const long* arr, size_t count) {
+    long sum;
+    
+    __asm__ volatile (
+        "xorq %%rax, %%rax\n\t"     // Clear accumulator (sum = 0)
+        "movq %1, %%rsi\n\t"        // Load array pointer into RSI
+        "movq %2, %%rcx\n\t"        // Load count into RCX
+        "testq %%rcx, %%rcx\n\t"    // Check if count is zero
+        "jz 2f\n\t"                 // If zero, skip to end
+        "1:\n\t"                    // loop_start
+        "addq (%%rsi), %%rax\n\t"   // Add current element to sum
+        "addq $8, %%rsi\n\t"        // Advance pointer by 8 bytes (sizeof(long))
+        "decq %%rcx\n\t"            // Decrement counter
+        "jnz 1b\n\t"                // If not zero, loop back
+        "2:\n\t"                    // loop_end
+        "movq %%rax, %0\n\t"        // Store result
+        : "=m" (sum)
+        : "m" (arr), "m" (count)
+        : "rax", "rcx", "rsi", "memory"
+    );
+    
+    return sum;
+}
+
+long array_sum_sse2(const long* arr, size_t count) {
+    long sum;
+
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"             // Scalar sum of the head and tail
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rcx\n\t"
+        "pxor %%xmm0, %%xmm0\n\t"           // Four independent accumulators
+        "pxor %%xmm1, %%xmm1\n\t"
+        "pxor %%xmm2, %%xmm2\n\t"
+        "pxor %%xmm3, %%xmm3\n\t"
+        "testq $8, %%rsi\n\t"               // Head: one element to 16-byte alignment
+        "jz 1f\n\t"
+        "testq %%rcx, %%rcx\n\t"
+        "jz 4f\n\t"
+        "addq (%%rsi), %%rax\n\t"
+        "addq $8, %%rsi\n\t"
+        "decq %%rcx\n\t"
+        "1:\n\t"
+        "cmpq $8, %%rcx\n\t"
+        "jb 3f\n\t"
+        "2:\n\t"                            // loop_8: aligned, 64 bytes
+        "paddq (%%rsi), %%xmm0\n\t"
+        "paddq 16(%%rsi), %%xmm1\n\t"
+        "paddq 32(%%rsi), %%xmm2\n\t"
+        "paddq 48(%%rsi), %%xmm3\n\t"
+        "addq $64, %%rsi\n\t"
+        "subq $8, %%rcx\n\t"
+        "cmpq $8, %%rcx\n\t"
+        "jae 2b\n\t"
+        "3:\n\t"                            // tail: 0..7 elements
+        "testq %%rcx, %%rcx\n\t"
+        "jz 4f\n\t"
+        "addq (%%rsi), %%rax\n\t"
+        "addq $8, %%rsi\n\t"
+        "decq %%rcx\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"                            // reduce
+        "paddq %%xmm1, %%xmm0\n\t"
+        "paddq %%xmm3, %%xmm2\n\t"
+        "paddq %%xmm2, %%xmm0\n\t"
+        "pshufd $0x4e, %%xmm0, %%xmm1\n\t"  // Swap the two halves
+        "paddq %%xmm1, %%xmm0\n\t"
+        "movq %%xmm0, %%rdx\n\t"
+        "addq %%rdx, %%rax\n\t"
+        : "=&a" (sum)
+        : "r" (arr), "r" (count)
+        : "rcx", "rdx", "rsi", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+
+    return sum;
+}
+
+long array_sum_avx2(const long* arr, size_t count) {
+    long sum;
+
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"             // Scalar sum of the head
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rcx\n\t"
+        "vpxor %%ymm0, %%ymm0, %%ymm0\n\t"  // Four independent accumulators
+        "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"
+        "vpxor %%ymm2, %%ymm2, %%ymm2\n\t"
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"
+        "1:\n\t"                            // head: scalar to 32-byte alignment
+        "testq $31, %%rsi\n\t"
+        "jz 2f\n\t"
+        "testq %%rcx, %%rcx\n\t"
+        "jz 9f\n\t"
+        "addq (%%rsi), %%rax\n\t"
+        "addq $8, %%rsi\n\t"
+        "decq %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "cmpq %4, %%rcx\n\t"                // Far beyond the LLC: prefetch
+        "jb 4f\n\t"
+        "3:\n\t"                            // loop_16_prefetch
+        "prefetcht0 %c5(%%rsi)\n\t"         // Both lines of the block 1 KiB ahead
+        "prefetcht0 %c5+64(%%rsi)\n\t"
+        "vpaddq (%%rsi), %%ymm0, %%ymm0\n\t"
+        "vpaddq 32(%%rsi), %%ymm1, %%ymm1\n\t"
+        "vpaddq 64(%%rsi), %%ymm2, %%ymm2\n\t"
+        "vpaddq 96(%%rsi), %%ymm3, %%ymm3\n\t"
+        "subq $-128, %%rsi\n\t"             // (imm8, unlike +128)
+        "subq $16, %%rcx\n\t"
+        "cmpq $16, %%rcx\n\t"
+        "jae 3b\n\t"
+        "4:\n\t"
+        "cmpq $16, %%rcx\n\t"
+        "jb 6f\n\t"
+        "5:\n\t"                            // loop_16: aligned, 128 bytes
+        "vpaddq (%%rsi), %%ymm0, %%ymm0\n\t"
+        "vpaddq 32(%%rsi), %%ymm1, %%ymm1\n\t"
+        "vpaddq 64(%%rsi), %%ymm2, %%ymm2\n\t"
+        "vpaddq 96(%%rsi), %%ymm3, %%ymm3\n\t"
+        "subq $-128, %%rsi\n\t"             // (imm8, unlike +128)
+        "subq $16, %%rcx\n\t"
+        "cmpq $16, %%rcx\n\t"
+        "jae 5b\n\t"
+        "6:\n\t"
+        "cmpq $4, %%rcx\n\t"
+        "jb 8f\n\t"
+        "7:\n\t"                            // loop_4
+        "vpaddq (%%rsi), %%ymm0, %%ymm0\n\t"
+        "addq $32, %%rsi\n\t"
+        "subq $4, %%rcx\n\t"
+        "cmpq $4, %%rcx\n\t"
+        "jae 7b\n\t"
+        "8:\n\t"                            // tail: 0..3 elements, one masked load
+        "negq %%rcx\n\t"
+        "vmovdqu 24(%3,%%rcx,8), %%ymm4\n\t" // First count lanes all ones
+        "vpmaskmovq (%%rsi), %%ymm4, %%ymm4\n\t" // Masked lanes never fault
+        "vpaddq %%ymm4, %%ymm1, %%ymm1\n\t"
+        "9:\n\t"                            // reduce
+        "vpaddq %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpaddq %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpaddq %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vextracti128 $1, %%ymm0, %%xmm1\n\t"
+        "vpaddq %%xmm1, %%xmm0, %%xmm0\n\t"
+        "vpshufd $0x4e, %%xmm0, %%xmm1\n\t"
+        "vpaddq %%xmm1, %%xmm0, %%xmm0\n\t"
+        "vmovq %%xmm0, %%rdx\n\t"
+        "addq %%rdx, %%rax\n\t"
+        "vzeroupper\n\t"
+        : "=&a" (sum)
+        : "r" (arr), "r" (count), "r" (array_tail_masks),
+          "i" (ARRAY_SUM_PREFETCH_MIN), "i" (ARRAY_SUM_PREFETCH_BYTES)
+        : "rcx", "rdx", "rsi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "memory"
+    );
+
+    return sum;
+}
+
+long array_sum_asm(const long* arr, size_t count) {
+    return ASSM_DISPATCH(array_sum)(arr, count);
+}
+
+// The checked sum is exact: every element is widened to 128 bits, so
+// overflow is only decided once, on the total, and a sum that goes out of
+// range and comes back is still reported as fitting. The sse2 tier does
+// this with addq/adcq on the sign-extended element. The AVX2 kernel keeps
+// a low and a high word per lane: the low word is stored biased by the
+// sign bit, so its unsigned carry becomes a signed vpcmpgtq against the
+// (equally biased) element, and the high word adds the carry and the
+// element's sign extension.
+__int128 array_sum_wide_sse2(const long* arr, size_t count) {
+    uint64_t words[2];
+
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"             // Low 64 bits
+        "xorl %%edi, %%edi\n\t"             // High 64 bits
+        "movq %0, %%rsi\n\t"
+        "movq %1, %%rcx\n\t"
+        "testq %%rcx, %%rcx\n\t"
+        "jz 2f\n\t"
+        "1:\n\t"
+        "movq (%%rsi), %%rdx\n\t"
+        "movq %%rdx, %%r8\n\t"
+        "sarq $63, %%r8\n\t"                // Sign extension: high word of the element
+        "addq %%rdx, %%rax\n\t"
+        "adcq %%r8, %%rdi\n\t"
+        "addq $8, %%rsi\n\t"
+        "decq %%rcx\n\t"
+        "jnz 1b\n\t"
+        "2:\n\t"
+        "movq %%rax, (%2)\n\t"
+        "movq %%rdi, 8(%2)\n\t"
+        :
+        : "r" (arr), "r" (count), "r" (words)
+        : "rax", "rcx", "rdx", "rsi", "rdi", "r8", "memory"
+    );
+
+    return (__int128)((unsigned __int128)words[1] << 64 | words[0]);
+}
+
+__int128 array_sum_wide_avx2(const long* arr, size_t count) {
+    uint64_t lanes[16];         // low words, high words; two accumulator pairs
+    __int128 sum = 0;
+
+    __asm__ volatile (
+        "movq %0, %%rsi\n\t"
+        "movq %1, %%rcx\n\t"
+        "vpcmpeqq %%ymm15, %%ymm15, %%ymm15\n\t"
+        "vpsllq $63, %%ymm15, %%ymm15\n\t"  // Sign bit in every lane
+        "vpxor %%ymm14, %%ymm14, %%ymm14\n\t"
+        "vmovdqa %%ymm15, %%ymm0\n\t"       // Low words, biased by the sign bit
+        "vmovdqa %%ymm15, %%ymm2\n\t"       // so unsigned carries are signed compares
+        "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"  // High words
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"
+        "cmpq $8, %%rcx\n\t"
+        "jb 2f\n\t"
+        "1:\n\t"                            // loop_8: two accumulator pairs
+        "vmovdqu (%%rsi), %%ymm4\n\t"
+        "vmovdqu 32(%%rsi), %%ymm5\n\t"
+        "vpxor %%ymm15, %%ymm4, %%ymm6\n\t" // Biased element
+        "vpaddq %%ymm4, %%ymm0, %%ymm0\n\t" // Biased low word + element
+        "vpcmpgtq %%ymm0, %%ymm6, %%ymm6\n\t" // Carry: wrapped below the element
+        "vpcmpgtq %%ymm4, %%ymm14, %%ymm7\n\t" // Negative element: high word -1
+        "vpaddq %%ymm7, %%ymm1, %%ymm1\n\t"
+        "vpsubq %%ymm6, %%ymm1, %%ymm1\n\t"
+        "vpxor %%ymm15, %%ymm5, %%ymm8\n\t" // Biased element
+        "vpaddq %%ymm5, %%ymm2, %%ymm2\n\t" // Biased low word + element
+        "vpcmpgtq %%ymm2, %%ymm8, %%ymm8\n\t" // Carry: wrapped below the element
+        "vpcmpgtq %%ymm5, %%ymm14, %%ymm9\n\t" // Negative element: high word -1
+        "vpaddq %%ymm9, %%ymm3, %%ymm3\n\t"
+        "vpsubq %%ymm8, %%ymm3, %%ymm3\n\t"
+        "addq $64, %%rsi\n\t"
+        "subq $8, %%rcx\n\t"
+        "cmpq $8, %%rcx\n\t"
+        "jae 1b\n\t"
+        "2:\n\t"                            // tail: 0..7 elements, masked
+        "cmpq $4, %%rcx\n\t"
+        "jb 3f\n\t"
+        "vmovdqu (%%rsi), %%ymm4\n\t"
+        "vpxor %%ymm15, %%ymm4, %%ymm6\n\t" // Biased element
+        "vpaddq %%ymm4, %%ymm0, %%ymm0\n\t" // Biased low word + element
+        "vpcmpgtq %%ymm0, %%ymm6, %%ymm6\n\t" // Carry: wrapped below the element
+        "vpcmpgtq %%ymm4, %%ymm14, %%ymm7\n\t" // Negative element: high word -1
+        "vpaddq %%ymm7, %%ymm1, %%ymm1\n\t"
+        "vpsubq %%ymm6, %%ymm1, %%ymm1\n\t"
+        "addq $32, %%rsi\n\t"
+        "subq $4, %%rcx\n\t"
+        "3:\n\t"
+        "negq %%rcx\n\t"
+        "vmovdqu 24(%3,%%rcx,8), %%ymm5\n\t" // Zero lanes add nothing
+        "vpmaskmovq (%%rsi), %%ymm5, %%ymm5\n\t"
+        "vpxor %%ymm15, %%ymm5, %%ymm8\n\t" // Biased element
+        "vpaddq %%ymm5, %%ymm2, %%ymm2\n\t" // Biased low word + element
+        "vpcmpgtq %%ymm2, %%ymm8, %%ymm8\n\t" // Carry: wrapped below the element
+        "vpcmpgtq %%ymm5, %%ymm14, %%ymm9\n\t" // Negative element: high word -1
+        "vpaddq %%ymm9, %%ymm3, %%ymm3\n\t"
+        "vpsubq %%ymm8, %%ymm3, %%ymm3\n\t"
+        "vpxor %%ymm15, %%ymm0, %%ymm0\n\t" // Unbias
+        "vpxor %%ymm15, %%ymm2, %%ymm2\n\t"
+        "vmovdqu %%ymm0, (%2)\n\t"          // Lanes out; the caller adds them
+        "vmovdqu %%ymm1, 32(%2)\n\t"
+        "vmovdqu %%ymm2, 64(%2)\n\t"
+        "vmovdqu %%ymm3, 96(%2)\n\t"
+        "vzeroupper\n\t"
+        :
+        : "r" (arr), "r" (count), "r" (lanes), "r" (array_tail_masks)
+        : "rcx", "rsi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+          "xmm8", "xmm9", "xmm14", "xmm15", "memory"
+    );
+
+    for (int pair = 0; pair < 2; ++pair) {
+        for (int lane = 0; lane < 4; ++lane) {
+            const uint64_t* words = lanes + 8 * pair;
+            sum += (__int128)((unsigned __int128)words[4 + lane] << 64 | words[lane]);
+        }
+    }
+    return sum;
+}
+
+int array_sum_checked_asm(const long* arr, size_t count, long* sum) {
+    __int128 total = ASSM_DISPATCH(array_sum_wide)(arr, count);
+
+    if (total > LONG_MAX) {
+        *sum = LONG_MAX;
+        return 0;
+    }
+    if (total < LONG_MIN) {
+        *sum = LONG_MIN;
+        return 0;
+    }
+    *sum = (long)total;
+    return 1;
+}
+
+// Linear search: array_search_loop is the tutorial's one compare per
+// iteration. The vector kernels compare 8 (sse2) or 16 (avx2) elements per
+// iteration and OR the results into one test; only the block holding the
+// match is taken apart into a mask. SSE2 has no 64-bit compare, so an
+// element matches when both of its 32-bit halves do. The AVX2 tail
+// re-reads the last four elements, overlapping ones already checked.
+size_t array_search_loop(const long* arr, size_t count, long target) {
+    size_t index;
+
+    __asm__ volatile (
+        "movq %1, %%rsi\n\t"                // Load array pointer
+        "movq %2, %%rcx\n\t"                // Load count
+        "movq %3, %%rdx\n\t"                // Load target value
+        "xorl %%eax, %%eax\n\t"             // Clear index counter
+        "testq %%rcx, %%rcx\n\t"            // Check if count is zero
+        "jz 3f\n\t"                         // If zero, not found
+        "1:\n\t"                            // loop_start
+        "cmpq (%%rsi), %%rdx\n\t"           // Compare target with current element
+        "je 2f\n\t"                         // If equal, found it
+        "addq $8, %%rsi\n\t"                // Advance pointer
+        "incq %%rax\n\t"                    // Increment index
+        "decq %%rcx\n\t"                    // Decrement counter
+        "jnz 1b\n\t"                        // If not zero, continue loop
+        "3:\n\t"                            // not_found
+        "movq $-1, %%rax\n\t"               // SIZE_MAX
+        "2:\n\t"                            // found
+        : "=&a" (index)
+        : "r" (arr), "r" (count), "r" (target)
+        : "rcx", "rdx", "rsi", "memory"
+    );
+
+    return index;
+}
+
+size_t array_search_sse2(const long* arr, size_t count, long target) {
+    size_t index;
+
+    __asm__ volatile (
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rcx\n\t"
+        "xorl %%eax, %%eax\n\t"             // Index of the next block
+        "movq %3, %%xmm5\n\t"
+        "punpcklqdq %%xmm5, %%xmm5\n\t"     // Target in both lanes
+        "1:\n\t"                            // loop_8
+        "leaq 8(%%rax), %%rdx\n\t"
+        "cmpq %%rcx, %%rdx\n\t"
+        "ja 3f\n\t"
+        "movdqu (%%rsi,%%rax,8), %%xmm0\n\t"
+        "pcmpeqd %%xmm5, %%xmm0\n\t"        // Equal 32-bit halves
+        "pshufd $0xb1, %%xmm0, %%xmm6\n\t"  // Swap the halves of each element
+        "pand %%xmm6, %%xmm0\n\t"           // Both halves equal: all ones
+        "movdqu 16(%%rsi,%%rax,8), %%xmm1\n\t"
+        "pcmpeqd %%xmm5, %%xmm1\n\t"        // Equal 32-bit halves
+        "pshufd $0xb1, %%xmm1, %%xmm6\n\t"  // Swap the halves of each element
+        "pand %%xmm6, %%xmm1\n\t"           // Both halves equal: all ones
+        "movdqu 32(%%rsi,%%rax,8), %%xmm2\n\t"
+        "pcmpeqd %%xmm5, %%xmm2\n\t"        // Equal 32-bit halves
+        "pshufd $0xb1, %%xmm2, %%xmm6\n\t"  // Swap the halves of each element
+        "pand %%xmm6, %%xmm2\n\t"           // Both halves equal: all ones
+        "movdqu 48(%%rsi,%%rax,8), %%xmm3\n\t"
+        "pcmpeqd %%xmm5, %%xmm3\n\t"        // Equal 32-bit halves
+        "pshufd $0xb1, %%xmm3, %%xmm6\n\t"  // Swap the halves of each element
+        "pand %%xmm6, %%xmm3\n\t"           // Both halves equal: all ones
+        "movdqa %%xmm0, %%xmm4\n\t"
+        "por %%xmm1, %%xmm4\n\t"
+        "por %%xmm2, %%xmm4\n\t"
+        "por %%xmm3, %%xmm4\n\t"
+        "pmovmskb %%xmm4, %%edx\n\t"        // Any match in the 8 elements?
+        "testl %%edx, %%edx\n\t"
+        "jnz 2f\n\t"
+        "addq $8, %%rax\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // which one: one mask bit per element
+        "movmskpd %%xmm0, %%edx\n\t"
+        "movmskpd %%xmm1, %%r8d\n\t"
+        "shll $2, %%r8d\n\t"
+        "orl %%r8d, %%edx\n\t"
+        "movmskpd %%xmm2, %%r8d\n\t"
+        "shll $4, %%r8d\n\t"
+        "orl %%r8d, %%edx\n\t"
+        "movmskpd %%xmm3, %%r8d\n\t"
+        "shll $6, %%r8d\n\t"
+        "orl %%r8d, %%edx\n\t"
+        "jmp 4f\n\t"
+        "3:\n\t"                            // loop_2
+        "leaq 2(%%rax), %%rdx\n\t"
+        "cmpq %%rcx, %%rdx\n\t"
+        "ja 5f\n\t"
+        "movdqu (%%rsi,%%rax,8), %%xmm0\n\t"
+        "pcmpeqd %%xmm5, %%xmm0\n\t"        // Equal 32-bit halves
+        "pshufd $0xb1, %%xmm0, %%xmm6\n\t"  // Swap the halves of each element
+        "pand %%xmm6, %%xmm0\n\t"           // Both halves equal: all ones
+        "movmskpd %%xmm0, %%edx\n\t"
+        "testl %%edx, %%edx\n\t"
+        "jnz 4f\n\t"
+        "addq $2, %%rax\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        "bsfl %%edx, %%edx\n\t"
+        "addq %%rdx, %%rax\n\t"
+        "jmp 9f\n\t"
+        "5:\n\t"                            // at most one element left
+        "cmpq %%rcx, %%rax\n\t"
+        "jae 8f\n\t"
+        "movq %3, %%rdx\n\t"
+        "cmpq (%%rsi,%%rax,8), %%rdx\n\t"
+        "je 9f\n\t"
+        "8:\n\t"
+        "movq $-1, %%rax\n\t"               // Not found: SIZE_MAX
+        "9:\n\t"
+        : "=&a" (index)
+        : "r" (arr), "r" (count), "r" (target)
+        : "rcx", "rdx", "rsi", "r8", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "memory"
+    );
+
+    return index;
+}
+
+size_t array_search_avx2(const long* arr, size_t count, long target) {
+    size_t index;
+
+    __asm__ volatile (
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rcx\n\t"
+        "xorl %%eax, %%eax\n\t"             // Index of the next block
+        "vmovq %3, %%xmm5\n\t"
+        "vpbroadcastq %%xmm5, %%ymm5\n\t"   // Target in every lane
+        "1:\n\t"                            // loop_16
+        "leaq 16(%%rax), %%rdx\n\t"
+        "cmpq %%rcx, %%rdx\n\t"
+        "ja 3f\n\t"
+        "vpcmpeqq (%%rsi,%%rax,8), %%ymm5, %%ymm0\n\t"
+        "vpcmpeqq 32(%%rsi,%%rax,8), %%ymm5, %%ymm1\n\t"
+        "vpcmpeqq 64(%%rsi,%%rax,8), %%ymm5, %%ymm2\n\t"
+        "vpcmpeqq 96(%%rsi,%%rax,8), %%ymm5, %%ymm3\n\t"
+        "vpor %%ymm1, %%ymm0, %%ymm4\n\t"
+        "vpor %%ymm3, %%ymm2, %%ymm6\n\t"
+        "vpor %%ymm6, %%ymm4, %%ymm4\n\t"
+        "vptest %%ymm4, %%ymm4\n\t"         // Any match in the 16 elements?
+        "jnz 2f\n\t"
+        "addq $16, %%rax\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // which one: one mask bit per element
+        "vmovmskpd %%ymm0, %%edx\n\t"
+        "vmovmskpd %%ymm1, %%r8d\n\t"
+        "shll $4, %%r8d\n\t"
+        "orl %%r8d, %%edx\n\t"
+        "vmovmskpd %%ymm2, %%r8d\n\t"
+        "shll $8, %%r8d\n\t"
+        "orl %%r8d, %%edx\n\t"
+        "vmovmskpd %%ymm3, %%r8d\n\t"
+        "shll $12, %%r8d\n\t"
+        "orl %%r8d, %%edx\n\t"
+        "jmp 4f\n\t"
+        "3:\n\t"                            // loop_4
+        "leaq 4(%%rax), %%rdx\n\t"
+        "cmpq %%rcx, %%rdx\n\t"
+        "ja 5f\n\t"
+        "vpcmpeqq (%%rsi,%%rax,8), %%ymm5, %%ymm0\n\t"
+        "vmovmskpd %%ymm0, %%edx\n\t"
+        "testl %%edx, %%edx\n\t"
+        "jnz 4f\n\t"
+        "addq $4, %%rax\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        "bsfl %%edx, %%edx\n\t"
+        "addq %%rdx, %%rax\n\t"
+        "jmp 9f\n\t"
+        "5:\n\t"                            // tail: 0..3 elements
+        "cmpq %%rcx, %%rax\n\t"
+        "je 8f\n\t"
+        "cmpq $4, %%rcx\n\t"
+        "jb 6f\n\t"
+        "leaq -4(%%rcx), %%rax\n\t"         // Last 4, overlapping checked ones
+        "jmp 3b\n\t"
+        "6:\n\t"                            // fewer than 4 in all
+        "vmovq %%xmm5, %%rdx\n\t"
+        "7:\n\t"
+        "cmpq (%%rsi,%%rax,8), %%rdx\n\t"
+        "je 9f\n\t"
+        "incq %%rax\n\t"
+        "cmpq %%rcx, %%rax\n\t"
+        "jb 7b\n\t"
+        "8:\n\t"
+        "movq $-1, %%rax\n\t"               // Not found: SIZE_MAX
+        "9:\n\t"
+        "vzeroupper\n\t"
+        : "=&a" (index)
+        : "r" (arr), "r" (count), "r" (target)
+        : "rcx", "rdx", "rsi", "r8", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "memory"
+    );
+
+    return index;
+}
+
+size_t array_search_asm(const long* arr, size_t count, long target) {
+    return ASSM_DISPATCH(array_search)(arr, count, target);
+}
+
+// Sorted search. The lower bound halves the range with a cmov instead of a
+// branch, so the loop runs the same log2(count) steps for every key and
+// never mispredicts; what is left is the chain of dependent loads.
+//
+// The Eytzinger layout stores the implicit binary search tree in BFS order
+// (children of node k at 2k and 2k + 1), so the top levels share a few
+// cache lines and the 16 descendants of node k four levels down sit in two
+// adjacent lines at tree + 16k, which each step prefetches while the next
+// three comparisons run. The batch search walks a group of keys level by
+// level, so ARRAY_BATCH_GROUP independent loads are in flight at once.
+// That already keeps the memory system busy: prefetching there as well
+// made it about twice as slow, so it only loads what it compares.
+#define ARRAY_BATCH_GROUP 16
+
+size_t array_lower_bound_asm(const long* sorted, size_t count, long key) {
+    size_t index;
+
+    __asm__ volatile (
+        "movq %1, %%rsi\n\t"                // Base of the remaining range
+        "movq %2, %%rcx\n\t"                // Its length
+        "movq %3, %%rdx\n\t"
+        "xorl %%eax, %%eax\n\t"
+        "testq %%rcx, %%rcx\n\t"
+        "jz 9f\n\t"
+        "1:\n\t"                            // halve: the same steps for every key
+        "cmpq $1, %%rcx\n\t"
+        "jbe 2f\n\t"
+        "movq %%rcx, %%r8\n\t"
+        "shrq $1, %%r8\n\t"                 // half
+        "leaq (%%rsi,%%r8,8), %%r9\n\t"
+        "cmpq %%rdx, (%%r9)\n\t"
+        "cmovlq %%r9, %%rsi\n\t"            // base[half] < key: keep the upper part
+        "subq %%r8, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // one candidate left
+        "cmpq %%rdx, (%%rsi)\n\t"
+        "setl %%al\n\t"                     // +1 when it is still below the key
+        "subq %1, %%rsi\n\t"
+        "shrq $3, %%rsi\n\t"
+        "addq %%rsi, %%rax\n\t"
+        "9:\n\t"
+        : "=&a" (index)
+        : "r" (sorted), "r" (count), "r" (key)
+        : "rcx", "rdx", "rsi", "r8", "r9", "memory"
+    );
+
+    return index;
+}
+
+// tree[k] for k = first, 2 first, 2 first + 1, ... gets the next elements
+// of sorted in order; returns the next unused element
+static const long* eytzinger_fill(long* tree, size_t count, size_t k, const long* sorted) {
+    if (k <= count) {
+        sorted = eytzinger_fill(tree, count, 2 * k, sorted);
+        tree[k] = *sorted++;
+        sorted = eytzinger_fill(tree, count, 2 * k + 1, sorted);
+    }
+    return sorted;
+}
+
+void array_eytzinger_build(const long* sorted, size_t count, long* tree) {
+    tree[0] = LONG_MIN;             // unused; keeps the slot initialized
+    eytzinger_fill(tree, count, 1, sorted);
+}
+
+size_t array_eytzinger_search(const long* tree, size_t count, long key) {
+    size_t slot;
+
+    __asm__ volatile (
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rcx\n\t"
+        "movq %3, %%rdx\n\t"
+        "movl $1, %%eax\n\t"                // k = root
+        "1:\n\t"                            // descend while k is a node
+        "cmpq %%rcx, %%rax\n\t"
+        "ja 2f\n\t"
+        "movq %%rax, %%r8\n\t"
+        "shlq $7, %%r8\n\t"                 // 16 k longs: 4 levels down
+        "prefetcht0 (%%rsi,%%r8)\n\t"
+        "prefetcht0 64(%%rsi,%%r8)\n\t"
+        "xorl %%r9d, %%r9d\n\t"
+        "cmpq %%rdx, (%%rsi,%%rax,8)\n\t"
+        "setl %%r9b\n\t"                    // tree[k] < key: go right
+        "leaq (%%r9,%%rax,2), %%rax\n\t"    // k = 2 k + right
+        "jmp 1b\n\t"
+        "2:\n\t"                            // undo the right turns after the last left
+        "movq %%rax, %%r8\n\t"
+        "notq %%r8\n\t"
+        "bsfq %%r8, %%rcx\n\t"
+        "incq %%rcx\n\t"
+        "shrq %%cl, %%rax\n\t"              // 0 when every turn was right
+        : "=&a" (slot)
+        : "r" (tree), "r" (count), "r" (key)
+        : "rcx", "rdx", "rsi", "r8", "r9", "memory"
+    );
+
+    return slot;
+}
+
+void array_eytzinger_search_batch(const long* tree, size_t count, const long* keys, size_t n,
+                                  size_t* slots) {
+    // Levels every path goes through; at most one more is partial
+    int levels = count ? 63 - __builtin_clzl(count + 1) : 0;
+
+    for (size_t first = 0; first < n; first += ARRAY_BATCH_GROUP) {
+        size_t group = n - first < ARRAY_BATCH_GROUP ? n - first : ARRAY_BATCH_GROUP;
+        const long* key = keys + first;
+        size_t k[ARRAY_BATCH_GROUP];
+
+        for (size_t j = 0; j < group; ++j) k[j] = 1;
+        for (int level = 0; level < levels; ++level) {
+            for (size_t j = 0; j < group; ++j) k[j] = 2 * k[j] + (tree[k[j]] < key[j]);
+        }
+        for (size_t j = 0; j < group; ++j) {
+            size_t next = 2 * k[j] + (k[j] <= count && tree[k[j]] < key[j]);
+            k[j] = k[j] <= count ? next : k[j];
+            slots[first + j] = k[j] >> (__builtin_ctzl(~k[j]) + 1);
+        }
+    }
+}
+
+// Min/max with indices, one pass. The AVX2 kernel keeps two sets of
+// running minima and maxima per lane, each with the index it was found
+// at, and folds every block in with a greater-than compare and byte
+// blends of the value and of the index vector; strict compares keep the
+// first occurrence in each lane. The lanes are merged in C, ties going to
+// the lower index, and the last few elements done by the scalar loop.
+// There is no packed 64-bit min/max before AVX-512 (vpmaxsq), so every
+// type uses compare and blend.
+//
+// The same template is instantiated for int32, int64, float and double;
+// indices are kept in lanes as wide as the element, so 32-bit types run in
+// chunks of ARRAY_MINMAX_CHUNK elements. Float compares are ordered
+// (_CMP_GT_OQ): NaNs never win, and leading NaNs are skipped so the first
+// value compared against is a number.
+#define ARRAY_MINMAX_CHUNK ((size_t)1 << 30)
+
+// Broadcast from memory, and dst = a > b with all-ones elements
+#define MINMAX_BCAST_32 "vpbroadcastd"
+#define MINMAX_BCAST_64 "vpbroadcastq"
+#define MINMAX_IADD_32 "vpaddd"
+#define MINMAX_IADD_64 "vpaddq"
+#define MINMAX_GT_i32(a, b, dst) "vpcmpgtd " b ", " a ", " dst
+#define MINMAX_GT_i64(a, b, dst) "vpcmpgtq " b ", " a ", " dst
+#define MINMAX_GT_f32(a, b, dst) "vcmpps $0x1e, " b ", " a ", " dst
+#define MINMAX_GT_f64(a, b, dst) "vcmppd $0x1e, " b ", " a ", " dst
+#define MINMAX_NAN_i32(x) 0
+#define MINMAX_NAN_i64(x) 0
+#define MINMAX_NAN_f32(x) ((x) != (x))
+#define MINMAX_NAN_f64(x) ((x) != (x))
+
+// Index of the first lane of each set, then the step per iteration
+static const uint32_t minmax_index_32[17] __attribute__((aligned(32))) = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+};
+static const uint64_t minmax_index_64[9] __attribute__((aligned(32))) = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8,
+};
+
+#define ARRAY_MINMAX_DEFINE(type, T, IDX, BITS)                                                 \
+struct minmax_lanes_##type {                                                                    \
+    struct {                                                                                    \
+        T min[32 / sizeof(T)];                                                                  \
+        T max[32 / sizeof(T)];                                                                  \
+        IDX argmin[32 / sizeof(T)];                                                             \
+        IDX argmax[32 / sizeof(T)];                                                             \
+    } set[2];                                                                                   \
+};                                                                                              \
+                                                                                                \
+/* pairs of 32-byte blocks; indices relative to arr */                                          \
+static void minmax_blocks_##type(const T* arr, size_t pairs, struct minmax_lanes_##type* out) { \
+    __asm__ volatile (                                                                          \
+        MINMAX_BCAST_##BITS " (%0), %%ymm0\n\t"     /* Set A: minima, from arr[0] */            \
+        "vmovdqa %%ymm0, %%ymm1\n\t"                /* maxima */                                \
+        "vpxor %%ymm2, %%ymm2, %%ymm2\n\t"          /* their indices */                         \
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"                                                      \
+        "vmovdqa (%2), %%ymm4\n\t"                  /* index of each lane */                    \
+        "vmovdqa %%ymm0, %%ymm5\n\t"                /* Set B: the odd blocks */                 \
+        "vmovdqa %%ymm0, %%ymm6\n\t"                                                            \
+        "vpxor %%ymm7, %%ymm7, %%ymm7\n\t"                                                      \
+        "vpxor %%ymm8, %%ymm8, %%ymm8\n\t"                                                      \
+        "vmovdqu 32(%2), %%ymm9\n\t"                                                            \
+        MINMAX_BCAST_##BITS " 64(%2), %%ymm10\n\t"  /* Index step: two blocks */                \
+        "movq %0, %%rsi\n\t"                                                                    \
+        "movq %1, %%rcx\n\t"                                                                    \
+        "1:\n\t"                                                                                \
+        "vmovdqu (%%rsi), %%ymm11\n\t"                                                          \
+        "vmovdqu 32(%%rsi), %%ymm13\n\t"                                                        \
+        MINMAX_GT_##type("%%ymm11", "%%ymm1", "%%ymm12") "\n\t"     /* x > max */               \
+        "vpblendvb %%ymm12, %%ymm11, %%ymm1, %%ymm1\n\t"                                        \
+        "vpblendvb %%ymm12, %%ymm4, %%ymm3, %%ymm3\n\t"                                         \
+        MINMAX_GT_##type("%%ymm0", "%%ymm11", "%%ymm12") "\n\t"     /* min > x */               \
+        "vpblendvb %%ymm12, %%ymm11, %%ymm0, %%ymm0\n\t"                                        \
+        "vpblendvb %%ymm12, %%ymm4, %%ymm2, %%ymm2\n\t"                                         \
+        MINMAX_GT_##type("%%ymm13", "%%ymm6", "%%ymm14") "\n\t"                                 \
+        "vpblendvb %%ymm14, %%ymm13, %%ymm6, %%ymm6\n\t"                                        \
+        "vpblendvb %%ymm14, %%ymm9, %%ymm8, %%ymm8\n\t"                                         \
+        MINMAX_GT_##type("%%ymm5", "%%ymm13", "%%ymm14") "\n\t"                                 \
+        "vpblendvb %%ymm14, %%ymm13, %%ymm5, %%ymm5\n\t"                                        \
+        "vpblendvb %%ymm14, %%ymm9, %%ymm7, %%ymm7\n\t"                                         \
+        MINMAX_IADD_##BITS " %%ymm10, %%ymm4, %%ymm4\n\t"                                       \
+        MINMAX_IADD_##BITS " %%ymm10, %%ymm9, %%ymm9\n\t"                                       \
+        "addq $64, %%rsi\n\t"                                                                   \
+        "decq %%rcx\n\t"                                                                        \
+        "jnz 1b\n\t"                                                                            \
+        "vmovdqu %%ymm0, (%3)\n\t"                  /* Lanes out; merged in C */                \
+        "vmovdqu %%ymm1, 32(%3)\n\t"                                                            \
+        "vmovdqu %%ymm2, 64(%3)\n\t"                                                            \
+        "vmovdqu %%ymm3, 96(%3)\n\t"                                                            \
+        "vmovdqu %%ymm5, 128(%3)\n\t"                                                           \
+        "vmovdqu %%ymm6, 160(%3)\n\t"                                                           \
+        "vmovdqu %%ymm7, 192(%3)\n\t"                                                           \
+        "vmovdqu %%ymm8, 224(%3)\n\t"                                                           \
+        "vzeroupper\n\t"                                                                        \
+        :                                                                                       \
+        : "r" (arr), "r" (pairs), "r" (minmax_index_##BITS), "r" (out)                          \
+        : "rcx", "rsi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",         \
+          "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "memory"                 \
+    );                                                                                          \
+}                                                                                               \
+                                                                                                \
+static void minmax_merge_##type(struct assm_minmax_##type* r, T min, size_t argmin,             \
+                                T max, size_t argmax) {                                         \
+    if (min < r->min || (min == r->min && argmin < r->argmin)) {                                \
+        r->min = min;                                                                           \
+        r->argmin = argmin;                                                                     \
+    }                                                                                           \
+    if (max > r->max || (max == r->max && argmax < r->argmax)) {                                \
+        r->max = max;                                                                           \
+        r->argmax = argmax;                                                                     \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+static void minmax_with_##type(const T* arr, size_t count, struct assm_minmax_##type* r,        \
+                               int vector) {                                                    \
+    size_t pos = 0;                                                                             \
+                                                                                                \
+    while (pos < count && MINMAX_NAN_##type(arr[pos])) ++pos;                                   \
+    if (pos == count) {                                                                         \
+        r->min = r->max = 0;                                                                    \
+        r->argmin = r->argmax = SIZE_MAX;                                                       \
+        return;                                                                                 \
+    }                                                                                           \
+    r->min = r->max = arr[pos];                                                                 \
+    r->argmin = r->argmax = pos;                                                                \
+    while (vector && count - pos >= 64 / sizeof(T)) {                                           \
+        size_t elements = (count - pos) & ~(64 / sizeof(T) - 1);                                \
+        struct minmax_lanes_##type lanes;                                                       \
+        if (elements > ARRAY_MINMAX_CHUNK) elements = ARRAY_MINMAX_CHUNK;                       \
+        minmax_blocks_##type(arr + pos, elements / (64 / sizeof(T)), &lanes);                   \
+        for (int s = 0; s < 2; ++s) {                                                           \
+            for (size_t l = 0; l < 32 / sizeof(T); ++l) {                                       \
+                minmax_merge_##type(r, lanes.set[s].min[l], pos + lanes.set[s].argmin[l],       \
+                                    lanes.set[s].max[l], pos + lanes.set[s].argmax[l]);         \
+            }                                                                                   \
+        }                                                                                       \
+        pos += elements;                                                                        \
+    }                                                                                           \
+    for (; pos < count; ++pos) {                                                                \
+        if (arr[pos] < r->min) {                                                                \
+            r->min = arr[pos];                                                                  \
+            r->argmin = pos;                                                                    \
+        }                                                                                       \
+        if (arr[pos] > r->max) {                                                                \
+            r->max = arr[pos];                                                                  \
+            r->argmax = pos;                                                                    \
+        }                                                                                       \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+void array_minmax_##type##_scalar(const T* arr, size_t count, struct assm_minmax_##type* r) {   \
+    minmax_with_##type(arr, count, r, 0);                                                       \
+}                                                                                               \
+                                                                                                \
+void array_minmax_##type##_avx2(const T* arr, size_t count, struct assm_minmax_##type* r) {     \
+    minmax_with_##type(arr, count, r, 1);                                                       \
+}                                                                                               \
+                                                                                                \
+struct assm_minmax_##type array_minmax_##type##_asm(const T* arr, size_t count) {               \
+    struct assm_minmax_##type r;                                                                \
+    ASSM_DISPATCH(minmax_##type)(arr, count, &r);                                               \
+    return r;                                                                                   \
+}
+
+ARRAY_MINMAX_DEFINE(i32, int32_t, uint32_t, 32)
+ARRAY_MINMAX_DEFINE(i64, int64_t, uint64_t, 64)
+ARRAY_MINMAX_DEFINE(f32, float, uint32_t, 32)
+ARRAY_MINMAX_DEFINE(f64, double, uint64_t, 64)
+
+long array_max_asm(const long* arr, size_t count) {
+    return count ? array_minmax_i64_asm(arr, count).max : LONG_MIN;
+}
+
+// Typed kernels for the element types array_sum/search/minmax do not take
+// (the C++ front end in assm_array.hpp picks them by type). Each comes from
+// a macro template filled in with that type's instructions:
+//   - Sums widen as they load, so only the accumulators are 64 bits wide:
+//     bytes are biased to unsigned and summed eight at a time by vpsadbw,
+//     int16 pairs by vpmaddwd against ones, int32 by vpmovsxdq, and floats
+//     are converted with vcvtps2pd and summed in double. Four accumulators
+//     take 128 bytes per iteration; the lanes are added up in C in a fixed
+//     order, so a float sum does not depend on anything but the input.
+//   - Searches compare four vectors per iteration, like array_search_avx2,
+//     and turn the byte mask of the matching vector into an index.
+//   - Min/max of int8, int16 and uint64 find the values first (vpminsb/w,
+//     or signed compare and blend of sign-flipped uint64) and then the
+//     first occurrence of each with the typed search.
+// uint64 sums and searches are the long kernels on the same bits.
+#define TYPED_SUM_BLOCK 128                 // bytes per iteration
+
+static const uint64_t typed_consts[3] __attribute__((aligned(8))) = {
+    0x8080808080808080ull,                  // int8 bias to unsigned
+    0x0001000100010001ull,                  // int16 ones for vpmaddwd
+    0x8000000000000000ull,                  // uint64 sign flip
+};
+
+// 32 bytes at offset off(%0) into the 64-bit lanes of accumulators a, b
+#define TYPED_SUM_INIT_i8  "vpbroadcastq (%2), %%ymm15\n\t" "vpxor %%ymm14, %%ymm14, %%ymm14\n\t"
+#define TYPED_SUM_INIT_i16 "vpbroadcastq 8(%2), %%ymm15\n\t"
+#define TYPED_SUM_INIT_i32 ""
+#define TYPED_SUM_INIT_f32 ""
+#define TYPED_SUM_INIT_f64 ""
+#define TYPED_SUM_STEP_i8(off, a, b)                                                            \
+        "vpxor " off "(%0), %%ymm15, %%ymm4\n\t"                                                \
+        "vpsadbw %%ymm14, %%ymm4, %%ymm4\n\t"                                                   \
+        "vpaddq %%ymm4, " a ", " a "\n\t"
+#define TYPED_SUM_STEP_i16(off, a, b)                                                           \
+        "vpmaddwd " off "(%0), %%ymm15, %%ymm4\n\t"                                             \
+        "vextracti128 $1, %%ymm4, %%xmm5\n\t"                                                   \
+        "vpmovsxdq %%xmm4, %%ymm4\n\t"                                                          \
+        "vpmovsxdq %%xmm5, %%ymm5\n\t"                                                          \
+        "vpaddq %%ymm4, " a ", " a "\n\t"                                                       \
+        "vpaddq %%ymm5, " b ", " b "\n\t"
+#define TYPED_SUM_STEP_i32(off, a, b)                                                           \
+        "vpmovsxdq " off "(%0), %%ymm4\n\t"                                                     \
+        "vpmovsxdq 16+" off "(%0), %%ymm5\n\t"                                                  \
+        "vpaddq %%ymm4, " a ", " a "\n\t"                                                       \
+        "vpaddq %%ymm5, " b ", " b "\n\t"
+#define TYPED_SUM_STEP_f32(off, a, b)                                                           \
+        "vcvtps2pd " off "(%0), %%ymm4\n\t"                                                     \
+        "vcvtps2pd 16+" off "(%0), %%ymm5\n\t"                                                  \
+        "vaddpd %%ymm4, " a ", " a "\n\t"                                                       \
+        "vaddpd %%ymm5, " b ", " b "\n\t"
+#define TYPED_SUM_STEP_f64(off, a, b)                                                           \
+        "vaddpd " off "(%0), " a ", " a "\n\t"
+// Undoes the int8 bias of 128 per element
+#define TYPED_SUM_FIX_i8(sum, n) ((sum) - 128 * (uint64_t)(n))
+#define TYPED_SUM_FIX_i16(sum, n) (sum)
+#define TYPED_SUM_FIX_i32(sum, n) (sum)
+#define TYPED_SUM_FIX_f32(sum, n) (sum)
+#define TYPED_SUM_FIX_f64(sum, n) (sum)
+
+#define ARRAY_SUM_DEFINE(type, T, R, ACC)                                                       \
+R array_sum_##type##_scalar(const T* arr, size_t count) {                                       \
+    ACC sum = 0;                                                                                \
+    for (size_t i = 0; i < count; i++) sum += (ACC)arr[i];                                      \
+    return (R)sum;                                                                              \
+}                                                                                               \
+                                                                                                \
+static void sum_blocks_##type(const T* arr, size_t blocks, ACC lanes[16]) {                     \
+    __asm__ volatile (                                                                          \
+        TYPED_SUM_INIT_##type                                                                   \
+        "vpxor %%ymm0, %%ymm0, %%ymm0\n\t"                                                      \
+        "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"                                                      \
+        "vpxor %%ymm2, %%ymm2, %%ymm2\n\t"                                                      \
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"                                                      \
+        "testq %1, %1\n\t"                                                                      \
+        "jz 2f\n\t"                                                                             \
+        "1:\n\t"                                                                                \
+        TYPED_SUM_STEP_##type("0", "%%ymm0", "%%ymm1")                                          \
+        TYPED_SUM_STEP_##type("32", "%%ymm2", "%%ymm3")                                         \
+        TYPED_SUM_STEP_##type("64", "%%ymm1", "%%ymm0")                                         \
+        TYPED_SUM_STEP_##type("96", "%%ymm3", "%%ymm2")                                         \
+        "addq $128, %0\n\t"                                                                     \
+        "decq %1\n\t"                                                                           \
+        "jnz 1b\n\t"                                                                            \
+        "2:\n\t"                                                                                \
+        "vmovdqu %%ymm0, (%3)\n\t"                                                              \
+        "vmovdqu %%ymm1, 32(%3)\n\t"                                                            \
+        "vmovdqu %%ymm2, 64(%3)\n\t"                                                            \
+        "vmovdqu %%ymm3, 96(%3)\n\t"                                                            \
+        "vzeroupper\n\t"                                                                        \
+        : "+r" (arr), "+r" (blocks)                                                             \
+        : "r" (typed_consts), "r" (lanes)                                                       \
+        : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm14", "xmm15", "memory", "cc"      \
+    );                                                                                          \
+}                                                                                               \
+                                                                                                \
+R array_sum_##type##_avx2(const T* arr, size_t count) {                                         \
+    size_t blocks = count / (TYPED_SUM_BLOCK / sizeof(T));                                      \
+    size_t done = blocks * (TYPED_SUM_BLOCK / sizeof(T));                                       \
+    ACC lanes[16];                                                                              \
+    ACC sum = 0;                                                                                \
+    sum_blocks_##type(arr, blocks, lanes);                                                      \
+    for (int l = 0; l < 16; l++) sum += lanes[l];                                               \
+    sum = TYPED_SUM_FIX_##type(sum, done);                                                      \
+    for (size_t i = done; i < count; i++) sum += (ACC)arr[i];                                   \
+    return (R)sum;                                                                              \
+}                                                                                               \
+                                                                                                \
+R array_sum_##type##_asm(const T* arr, size_t count) {                                          \
+    return ASSM_DISPATCH(sum_##type)(arr, count);                                               \
+}
+
+// Integer lanes add as uint64 so that wrapping is defined
+ARRAY_SUM_DEFINE(i8, int8_t, int64_t, uint64_t)
+ARRAY_SUM_DEFINE(i16, int16_t, int64_t, uint64_t)
+ARRAY_SUM_DEFINE(i32, int32_t, int64_t, uint64_t)
+ARRAY_SUM_DEFINE(f32, float, double, double)
+ARRAY_SUM_DEFINE(f64, double, double, double)
+
+uint64_t array_sum_u64_asm(const uint64_t* arr, size_t count) {
+    return (uint64_t)ASSM_DISPATCH(array_sum)((const long*)arr, count);
+}
+
+#define TYPED_BCAST_i8 "vpbroadcastb"
+#define TYPED_BCAST_i16 "vpbroadcastw"
+#define TYPED_BCAST_i32 "vpbroadcastd"
+#define TYPED_BCAST_f32 "vbroadcastss"
+#define TYPED_BCAST_f64 "vbroadcastsd"
+#define TYPED_CMPEQ_i8 "vpcmpeqb"
+#define TYPED_CMPEQ_i16 "vpcmpeqw"
+#define TYPED_CMPEQ_i32 "vpcmpeqd"
+#define TYPED_CMPEQ_f32 "vcmpeqps"
+#define TYPED_CMPEQ_f64 "vcmpeqpd"
+
+#define ARRAY_SEARCH_DEFINE(type, T)                                                            \
+size_t array_search_##type##_scalar(const T* arr, size_t count, T target) {                     \
+    for (size_t i = 0; i < count; i++) {                                                        \
+        if (arr[i] == target) return i;                                                         \
+    }                                                                                           \
+    return SIZE_MAX;                                                                            \
+}                                                                                               \
+                                                                                                \
+/* Byte offset of the first match in arr[0..bytes), bytes a multiple of 32 */                   \
+static size_t search_bytes_##type(const T* arr, size_t bytes, const T* target) {                \
+    size_t offset;                                                                              \
+    __asm__ volatile (                                                                          \
+        TYPED_BCAST_##type " (%3), %%ymm5\n\t"                                                  \
+        "xorl %%eax, %%eax\n\t"                                                                 \
+        "1:\n\t"                                    /* loop: 128 bytes */                       \
+        "leaq 128(%%rax), %%rdx\n\t"                                                            \
+        "cmpq %2, %%rdx\n\t"                                                                    \
+        "ja 3f\n\t"                                                                             \
+        TYPED_CMPEQ_##type " (%1,%%rax), %%ymm5, %%ymm0\n\t"                                    \
+        TYPED_CMPEQ_##type " 32(%1,%%rax), %%ymm5, %%ymm1\n\t"                                  \
+        TYPED_CMPEQ_##type " 64(%1,%%rax), %%ymm5, %%ymm2\n\t"                                  \
+        TYPED_CMPEQ_##type " 96(%1,%%rax), %%ymm5, %%ymm3\n\t"                                  \
+        "vpor %%ymm1, %%ymm0, %%ymm4\n\t"                                                       \
+        "vpor %%ymm3, %%ymm2, %%ymm6\n\t"                                                       \
+        "vpor %%ymm6, %%ymm4, %%ymm4\n\t"                                                       \
+        "vptest %%ymm4, %%ymm4\n\t"                 /* Any match in the 128 bytes? */           \
+        "jnz 2f\n\t"                                                                            \
+        "movq %%rdx, %%rax\n\t"                                                                 \
+        "jmp 1b\n\t"                                                                            \
+        "2:\n\t"                                    /* which half, then which byte */           \
+        "vpmovmskb %%ymm0, %%edx\n\t"                                                           \
+        "vpmovmskb %%ymm1, %%ecx\n\t"                                                           \
+        "shlq $32, %%rcx\n\t"                                                                   \
+        "orq %%rcx, %%rdx\n\t"                                                                  \
+        "jnz 4f\n\t"                                                                            \
+        "addq $64, %%rax\n\t"                                                                   \
+        "vpmovmskb %%ymm2, %%edx\n\t"                                                           \
+        "vpmovmskb %%ymm3, %%ecx\n\t"                                                           \
+        "shlq $32, %%rcx\n\t"                                                                   \
+        "orq %%rcx, %%rdx\n\t"                                                                  \
+        "jmp 4f\n\t"                                                                            \
+        "3:\n\t"                                    /* loop: 32 bytes */                        \
+        "leaq 32(%%rax), %%rdx\n\t"                                                             \
+        "cmpq %2, %%rdx\n\t"                                                                    \
+        "ja 5f\n\t"                                                                             \
+        TYPED_CMPEQ_##type " (%1,%%rax), %%ymm5, %%ymm0\n\t"                                    \
+        "vpmovmskb %%ymm0, %%edx\n\t"                                                           \
+        "testl %%edx, %%edx\n\t"                                                                \
+        "jnz 4f\n\t"                                                                            \
+        "addq $32, %%rax\n\t"                                                                   \
+        "jmp 3b\n\t"                                                                            \
+        "4:\n\t"                                                                                \
+        "bsfq %%rdx, %%rdx\n\t"                     /* First byte of the matching lane */       \
+        "addq %%rdx, %%rax\n\t"                                                                 \
+        "jmp 6f\n\t"                                                                            \
+        "5:\n\t"                                                                                \
+        "movq $-1, %%rax\n\t"                       /* Not found: SIZE_MAX */                   \
+        "6:\n\t"                                                                                \
+        "vzeroupper\n\t"                                                                        \
+        : "=&a" (offset)                                                                        \
+        : "r" (arr), "r" (bytes), "r" (target)                                                  \
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory", "cc"  \
+    );                                                                                          \
+    return offset;                                                                              \
+}                                                                                               \
+                                                                                                \
+size_t array_search_##type##_avx2(const T* arr, size_t count, T target) {                       \
+    size_t done = count & ~(32 / sizeof(T) - 1);                                                \
+    size_t offset = search_bytes_##type(arr, done * sizeof(T), &target);                        \
+    if (offset != SIZE_MAX) return offset / sizeof(T);                                          \
+    for (size_t i = done; i < count; i++) {                                                     \
+        if (arr[i] == target) return i;                                                         \
+    }                                                                                           \
+    return SIZE_MAX;                                                                            \
+}                                                                                               \
+                                                                                                \
+size_t array_search_##type##_asm(const T* arr, size_t count, T target) {                        \
+    return ASSM_DISPATCH(search_##type)(arr, count, target);                                    \
+}
+
+ARRAY_SEARCH_DEFINE(i8, int8_t)
+ARRAY_SEARCH_DEFINE(i16, int16_t)
+ARRAY_SEARCH_DEFINE(i32, int32_t)
+ARRAY_SEARCH_DEFINE(f32, float)
+ARRAY_SEARCH_DEFINE(f64, double)
+
+size_t array_search_u64_asm(const uint64_t* arr, size_t count, uint64_t target) {
+    return ASSM_DISPATCH(array_search)((const long*)arr, count, (long)target);
+}
+
+// Loads 32 bytes into x, and folds x into a running minimum or maximum.
+// uint64 elements are loaded sign-flipped so that signed compares order
+// them; the lanes are flipped back in C.
+#define TYPED_MM_INIT_i8 ""
+#define TYPED_MM_INIT_i16 ""
+#define TYPED_MM_INIT_u64 "vpbroadcastq 16(%2), %%ymm15\n\t"
+#define TYPED_MM_LOAD_i8(off, x) "vmovdqu " off "(%0), " x "\n\t"
+#define TYPED_MM_LOAD_i16(off, x) "vmovdqu " off "(%0), " x "\n\t"
+#define TYPED_MM_LOAD_u64(off, x) "vpxor " off "(%0), %%ymm15, " x "\n\t"
+#define TYPED_MM_MIN_i8(x, acc) "vpminsb " x ", " acc ", " acc "\n\t"
+#define TYPED_MM_MAX_i8(x, acc) "vpmaxsb " x ", " acc ", " acc "\n\t"
+#define TYPED_MM_MIN_i16(x, acc) "vpminsw " x ", " acc ", " acc "\n\t"
+#define TYPED_MM_MAX_i16(x, acc) "vpmaxsw " x ", " acc ", " acc "\n\t"
+#define TYPED_MM_MIN_u64(x, acc)                                                                \
+        "vpcmpgtq " x ", " acc ", %%ymm6\n\t"                                                   \
+        "vblendvpd %%ymm6, " x ", " acc ", " acc "\n\t"
+#define TYPED_MM_MAX_u64(x, acc)                                                                \
+        "vpcmpgtq " acc ", " x ", %%ymm6\n\t"                                                   \
+        "vblendvpd %%ymm6, " x ", " acc ", " acc "\n\t"
+#define TYPED_MM_UNFLIP_i8(x) (x)
+#define TYPED_MM_UNFLIP_i16(x) (x)
+#define TYPED_MM_UNFLIP_u64(x) ((x) ^ (1ull << 63))
+#define TYPED_MM_SEARCH_i8(arr, n, v) array_search_i8_asm(arr, n, v)
+#define TYPED_MM_SEARCH_i16(arr, n, v) array_search_i16_asm(arr, n, v)
+#define TYPED_MM_SEARCH_u64(arr, n, v) array_search_u64_asm(arr, n, v)
+
+#define ARRAY_MINMAX_VALUES_DEFINE(type, T)                                                     \
+void array_minmax_##type##_scalar(const T* arr, size_t count, struct assm_minmax_##type* r) {   \
+    if (count == 0) {                                                                           \
+        r->min = r->max = 0;                                                                    \
+        r->argmin = r->argmax = SIZE_MAX;                                                       \
+        return;                                                                                 \
+    }                                                                                           \
+    r->min = r->max = arr[0];                                                                   \
+    r->argmin = r->argmax = 0;                                                                  \
+    for (size_t i = 1; i < count; i++) {                                                        \
+        if (arr[i] < r->min) {                                                                  \
+            r->min = arr[i];                                                                    \
+            r->argmin = i;                                                                      \
+        }                                                                                       \
+        if (arr[i] > r->max) {                                                                  \
+            r->max = arr[i];                                                                    \
+            r->argmax = i;                                                                      \
+        }                                                                                       \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+/* Minima and maxima of each lane over blocks of 64 bytes (at least one) */                     \
+static void minmax_values_##type(const T* arr, size_t blocks, T (*lanes)[32 / sizeof(T)]) {     \
+    __asm__ volatile (                                                                          \
+        TYPED_MM_INIT_##type                                                                    \
+        TYPED_MM_LOAD_##type("0", "%%ymm0")         /* First block: minima */                   \
+        TYPED_MM_LOAD_##type("32", "%%ymm1")                                                    \
+        "vmovdqa %%ymm0, %%ymm2\n\t"                /* and maxima */                            \
+        "vmovdqa %%ymm1, %%ymm3\n\t"                                                            \
+        "jmp 2f\n\t"                                                                            \
+        "1:\n\t"                                                                                \
+        TYPED_MM_LOAD_##type("0", "%%ymm4")                                                     \
+        TYPED_MM_LOAD_##type("32", "%%ymm5")                                                    \
+        TYPED_MM_MIN_##type("%%ymm4", "%%ymm0")                                                 \
+        TYPED_MM_MIN_##type("%%ymm5", "%%ymm1")                                                 \
+        TYPED_MM_MAX_##type("%%ymm4", "%%ymm2")                                                 \
+        TYPED_MM_MAX_##type("%%ymm5", "%%ymm3")                                                 \
+        "2:\n\t"                                                                                \
+        "addq $64, %0\n\t"                                                                      \
+        "decq %1\n\t"                                                                           \
+        "jnz 1b\n\t"                                                                            \
+        TYPED_MM_MIN_##type("%%ymm1", "%%ymm0")                                                 \
+        TYPED_MM_MAX_##type("%%ymm3", "%%ymm2")                                                 \
+        "vmovdqu %%ymm0, (%3)\n\t"                                                              \
+        "vmovdqu %%ymm2, 32(%3)\n\t"                                                            \
+        "vzeroupper\n\t"                                                                        \
+        : "+r" (arr), "+r" (blocks)                                                             \
+        : "r" (typed_consts), "r" (lanes)                                                       \
+        : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm15", "memory", "cc"       \
+    );                                                                                          \
+}                                                                                               \
+                                                                                                \
+void array_minmax_##type##_avx2(const T* arr, size_t count, struct assm_minmax_##type* r) {     \
+    size_t blocks = count / (64 / sizeof(T));                                                   \
+    if (blocks == 0) {                                                                          \
+        array_minmax_##type##_scalar(arr, count, r);                                            \
+        return;                                                                                 \
+    }                                                                                           \
+    T lanes[2][32 / sizeof(T)];                                                                 \
+    T min, max;                                                                                 \
+    minmax_values_##type(arr, blocks, lanes);                                                   \
+    min = max = TYPED_MM_UNFLIP_##type(lanes[0][0]);                                            \
+    for (size_t l = 0; l < 32 / sizeof(T); l++) {                                               \
+        T lo = TYPED_MM_UNFLIP_##type(lanes[0][l]);                                             \
+        T hi = TYPED_MM_UNFLIP_##type(lanes[1][l]);                                             \
+        if (lo < min) min = lo;                                                                 \
+        if (hi > max) max = hi;                                                                 \
+    }                                                                                           \
+    for (size_t i = blocks * (64 / sizeof(T)); i < count; i++) {                                \
+        if (arr[i] < min) min = arr[i];                                                         \
+        if (arr[i] > max) max = arr[i];                                                         \
+    }                                                                                           \
+    r->min = min;                                                                               \
+    r->max = max;                                                                               \
+    r->argmin = TYPED_MM_SEARCH_##type(arr, count, min);                                        \
+    r->argmax = TYPED_MM_SEARCH_##type(arr, count, max);                                        \
+}                                                                                               \
+                                                                                                \
+struct assm_minmax_##type array_minmax_##type##_asm(const T* arr, size_t count) {               \
+    struct assm_minmax_##type r;                                                                \
+    ASSM_DISPATCH(minmax_##type)(arr, count, &r);                                               \
+    return r;                                                                                   \
+}
+
+ARRAY_MINMAX_VALUES_DEFINE(i8, int8_t)
+ARRAY_MINMAX_VALUES_DEFINE(i16, int16_t)
+ARRAY_MINMAX_VALUES_DEFINE(u64, uint64_t)
+
+// Histograms. counts[x]++ is a load, an add and a store to one address, so
+// when the next element has the same value its load waits for that store
+// to forward, and a run of equal values goes at store-forwarding latency
+// instead of one element per cycle. The kernels spread consecutive
+// elements over four sub-histograms of uint32 counts, so neighbours land
+// in different tables, then add the tables together four counts per paddd,
+// widen the sums and add them into the caller's uint64 counts. Four tables
+// are used while they fit in HIST_TABLES_L1 bytes; past that (16-bit
+// values) the extra cache misses cost more than they save, and elements
+// alternate between two tables instead.
+// Tables are a cache line apart beyond their size, so the same count in two
+// tables never shares the low 12 address bits (4K aliasing would bring the
+// false dependency back), and each has a last slot that collects the
+// elements outside the buckets. They count at most HIST_CHUNK elements
+// between merges, which keeps every sum within 32 bits. The loops need no
+// vector unit and the merge only SSE2, so there is no dispatch slot.
+#define HIST_TABLES_L1 (32u << 10)
+#define HIST_CHUNK ((size_t)1 << 31)        // elements between merges
+#define HIST_STACK_BYTES HIST_TABLES_L1      // four tables never need malloc
+
+enum { HIST_U8, HIST_U16, HIST_SHIFT };
+
+struct hist_spec {
+    int kind;
+    long base;                      // HIST_SHIFT: bucket of x is
+    unsigned shift;                 // (x - base) >> shift
+    size_t buckets;
+};
+
+// 8 bytes per iteration, byte i into table i % 4
+static void hist_u8_tables(const uint8_t* data, size_t groups, uint32_t* t0, uint32_t* t1,
+                           uint32_t* t2, uint32_t* t3) {
+    if (groups == 0) return;
+    __asm__ volatile (
+        "1:\n\t"
+        "movq (%0), %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl (%2,%%rdx,4)\n\t"
+        "movzbl %%ah, %%edx\n\t"
+        "incl (%3,%%rdx,4)\n\t"
+        "shrq $16, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl (%4,%%rdx,4)\n\t"
+        "movzbl %%ah, %%edx\n\t"
+        "incl (%5,%%rdx,4)\n\t"
+        "shrq $16, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl (%2,%%rdx,4)\n\t"
+        "movzbl %%ah, %%edx\n\t"
+        "incl (%3,%%rdx,4)\n\t"
+        "shrq $16, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl (%4,%%rdx,4)\n\t"
+        "movzbl %%ah, %%edx\n\t"
+        "incl (%5,%%rdx,4)\n\t"
+        "addq $8, %0\n\t"
+        "decq %1\n\t"
+        "jnz 1b\n\t"
+        : "+r" (data), "+r" (groups)
+        : "r" (t0), "r" (t1), "r" (t2), "r" (t3)
+        : "rax", "rdx", "memory", "cc"
+    );
+}
+
+// 4 elements per iteration, one into each table
+static void hist_u16_tables(const uint16_t* data, size_t groups, uint32_t* t0, uint32_t* t1,
+                            uint32_t* t2, uint32_t* t3) {
+    if (groups == 0) return;
+    __asm__ volatile (
+        "1:\n\t"
+        "movq (%0), %%rax\n\t"
+        "movzwl %%ax, %%edx\n\t"
+        "incl (%2,%%rdx,4)\n\t"
+        "shrq $16, %%rax\n\t"
+        "movzwl %%ax, %%edx\n\t"
+        "incl (%3,%%rdx,4)\n\t"
+        "shrq $16, %%rax\n\t"
+        "movzwl %%ax, %%edx\n\t"
+        "incl (%4,%%rdx,4)\n\t"
+        "shrq $16, %%rax\n\t"
+        "incl (%5,%%rax,4)\n\t"
+        "addq $8, %0\n\t"
+        "decq %1\n\t"
+        "jnz 1b\n\t"
+        : "+r" (data), "+r" (groups)
+        : "r" (t0), "r" (t1), "r" (t2), "r" (t3)
+        : "rax", "rdx", "memory", "cc"
+    );
+}
+
+// 4 elements per iteration. A bucket past the last, or an element below
+// base (whose unsigned distance can wrap back into range once shifted),
+// goes to the overflow slot with a cmov.
+static void hist_shift_tables(const long* data, size_t groups, uint32_t* t0, uint32_t* t1,
+                              uint32_t* t2, uint32_t* t3, long base, unsigned shift,
+                              size_t buckets) {
+    if (groups == 0) return;
+    __asm__ volatile (
+        "1:\n\t"
+        "movq (%0), %%rax\n\t"
+        "movq 8(%0), %%rdx\n\t"
+        "subq %6, %%rax\n\t"                // Distance from base, unsigned
+        "subq %6, %%rdx\n\t"
+        "shrq %%cl, %%rax\n\t"              // Bucket
+        "shrq %%cl, %%rdx\n\t"
+        "cmpq %7, %%rax\n\t"
+        "cmovaq %7, %%rax\n\t"              // Past the last: overflow slot
+        "cmpq %7, %%rdx\n\t"
+        "cmovaq %7, %%rdx\n\t"
+        "cmpq %6, (%0)\n\t"
+        "cmovlq %7, %%rax\n\t"              // Below base (signed): overflow slot
+        "cmpq %6, 8(%0)\n\t"
+        "cmovlq %7, %%rdx\n\t"
+        "incl (%2,%%rax,4)\n\t"
+        "incl (%3,%%rdx,4)\n\t"
+        "movq 16(%0), %%rax\n\t"
+        "movq 24(%0), %%rdx\n\t"
+        "subq %6, %%rax\n\t"
+        "subq %6, %%rdx\n\t"
+        "shrq %%cl, %%rax\n\t"
+        "shrq %%cl, %%rdx\n\t"
+        "cmpq %7, %%rax\n\t"
+        "cmovaq %7, %%rax\n\t"
+        "cmpq %7, %%rdx\n\t"
+        "cmovaq %7, %%rdx\n\t"
+        "cmpq %6, 16(%0)\n\t"
+        "cmovlq %7, %%rax\n\t"
+        "cmpq %6, 24(%0)\n\t"
+        "cmovlq %7, %%rdx\n\t"
+        "incl (%4,%%rax,4)\n\t"
+        "incl (%5,%%rdx,4)\n\t"
+        "addq $32, %0\n\t"
+        "decq %1\n\t"
+        "jnz 1b\n\t"
+        : "+r" (data), "+r" (groups)
+        : "r" (t0), "r" (t1), "r" (t2), "r" (t3), "r" (base), "r" (buckets), "c" (shift)
+        : "rax", "rdx", "memory", "cc"
+    );
+}
+
+// counts[0..4 * groups) += the sum of the tables (four, or two), which are
+// cleared
+static void hist_merge_tables(uint64_t* counts, uint32_t* tables, size_t stride, size_t groups,
+                              int four) {
+    if (groups == 0) return;
+    __asm__ volatile (
+        "pxor %%xmm7, %%xmm7\n\t"
+        "leaq (%1,%3,4), %%rax\n\t"         // Tables 1, 2 and 3
+        "leaq (%%rax,%3,4), %%rdx\n\t"
+        "leaq (%%rdx,%3,4), %%r8\n\t"
+        "1:\n\t"
+        "movdqa (%1), %%xmm0\n\t"
+        "paddd (%%rax), %%xmm0\n\t"         // Four counts of each table
+        "movdqa %%xmm7, (%1)\n\t"
+        "movdqa %%xmm7, (%%rax)\n\t"
+        "testl %4, %4\n\t"
+        "jz 2f\n\t"
+        "paddd (%%rdx), %%xmm0\n\t"
+        "paddd (%%r8), %%xmm0\n\t"
+        "movdqa %%xmm7, (%%rdx)\n\t"
+        "movdqa %%xmm7, (%%r8)\n\t"
+        "2:\n\t"
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "punpckldq %%xmm7, %%xmm0\n\t"      // Widen to 64 bits
+        "punpckhdq %%xmm7, %%xmm1\n\t"
+        "movdqu (%0), %%xmm2\n\t"
+        "movdqu 16(%0), %%xmm3\n\t"
+        "paddq %%xmm2, %%xmm0\n\t"
+        "paddq %%xmm3, %%xmm1\n\t"
+        "movdqu %%xmm0, (%0)\n\t"
+        "movdqu %%xmm1, 16(%0)\n\t"
+        "addq $16, %1\n\t"
+        "addq $16, %%rax\n\t"
+        "addq $16, %%rdx\n\t"
+        "addq $16, %%r8\n\t"
+        "addq $32, %0\n\t"
+        "decq %2\n\t"
+        "jnz 1b\n\t"
+        : "+r" (counts), "+r" (tables), "+r" (groups)
+        : "r" (stride), "r" (four)
+        : "rax", "rdx", "r8", "xmm0", "xmm1", "xmm2", "xmm3", "xmm7", "memory", "cc"
+    );
+}
+
+// Bucket of one element, or spec->buckets if it has none
+static size_t hist_bucket(const void* data, size_t i, const struct hist_spec* spec) {
+    if (spec->kind == HIST_U8) return ((const uint8_t*)data)[i];
+    if (spec->kind == HIST_U16) return ((const uint16_t*)data)[i];
+    long x = ((const long*)data)[i];
+    if (x < spec->base) return spec->buckets;
+    size_t bucket = ((unsigned long)x - (unsigned long)spec->base) >> spec->shift;
+    return bucket < spec->buckets ? bucket : spec->buckets;
+}
+
+static size_t hist_size(const struct hist_spec* spec) {
+    return spec->kind == HIST_U8 ? 1 : spec->kind == HIST_U16 ? 2 : sizeof(long);
+}
+
+// Counts data[0..count) into the tables: whole groups in the kernels, the
+// rest into table 0
+static void hist_count_tables(const void* data, size_t count, const struct hist_spec* spec,
+                              uint32_t* tables, size_t stride, int four) {
+    uint32_t* t1 = tables + stride;
+    uint32_t* t2 = four ? t1 + stride : tables;
+    uint32_t* t3 = four ? t2 + stride : t1;
+    size_t done;
+    if (spec->kind == HIST_U8) {
+        hist_u8_tables(data, count / 8, tables, t1, t2, t3);
+        done = count & ~(size_t)7;
+    } else if (spec->kind == HIST_U16) {
+        hist_u16_tables(data, count / 4, tables, t1, t2, t3);
+        done = count & ~(size_t)3;
+    } else {
+        hist_shift_tables(data, count / 4, tables, t1, t2, t3, spec->base, spec->shift, spec->buckets);
+        done = count & ~(size_t)3;
+    }
+    for (size_t i = done; i < count; i++) tables[hist_bucket(data, i, spec)]++;
+}
+
+static void hist_direct(const void* data, size_t count, const struct hist_spec* spec, uint64_t* counts) {
+    if (spec->kind == HIST_U8) {
+        for (size_t i = 0; i < count; i++) counts[((const uint8_t*)data)[i]]++;
+    } else if (spec->kind == HIST_U16) {
+        for (size_t i = 0; i < count; i++) counts[((const uint16_t*)data)[i]]++;
+    } else {
+        const long* arr = data;
+        for (size_t i = 0; i < count; i++) {
+            if (arr[i] < spec->base) continue;
+            size_t bucket = ((unsigned long)arr[i] - (unsigned long)spec->base) >> spec->shift;
+            if (bucket < spec->buckets) counts[bucket]++;
+        }
+    }
+}
+
+// Adds the histogram of data[0..count) to counts
+static void histogram(const void* data, size_t count, const struct hist_spec* spec, uint64_t* counts) {
+    size_t buckets = spec->buckets;
+    if (buckets == 0) return;
+
+    // With fewer elements than buckets, clearing and merging the tables
+    // costs more than the dependencies they remove
+    size_t stride = (buckets + 1 + 15) / 16 * 16 + 16;
+    int four = 4 * stride * sizeof(uint32_t) <= HIST_TABLES_L1;
+    size_t bytes = (four ? 4 : 2) * stride * sizeof(uint32_t);
+    uint32_t stack[HIST_STACK_BYTES / sizeof(uint32_t)] __attribute__((aligned(64)));
+    uint32_t* tables = NULL;
+    if (count >= buckets) tables = bytes <= sizeof(stack) ? stack : malloc(bytes);
+    if (!tables) {
+        hist_direct(data, count, spec, counts);
+        return;
+    }
+
+    memset(tables, 0, bytes);
+    size_t size = hist_size(spec);
+    size_t vector = buckets & ~(size_t)3;
+    for (size_t done = 0; done < count; done += HIST_CHUNK) {
+        size_t n = count - done < HIST_CHUNK ? count - done : HIST_CHUNK;
+        hist_count_tables((const char*)data + done * size, n, spec, tables, stride, four);
+        hist_merge_tables(counts, tables, stride, vector / 4, four);
+        for (size_t t = 0; t < (four ? 4u : 2u); t++) {
+            uint32_t* table = tables + t * stride;
+            for (size_t b = vector; b < buckets; b++) counts[b] += table[b];
+            memset(table + vector, 0, (stride - vector) * sizeof(uint32_t));
+        }
+    }
+    if (tables != stack) free(tables);
+}
+
+// Multithreaded histograms give each pool thread a contiguous chunk and its
+// own counts; thread 0 adds straight into the caller's, the others into
+// zeroed copies that are added in afterwards. Below HIST_PARALLEL_MIN
+// bytes the serial kernel finishes before the workers would wake.
+#define HIST_PARALLEL_MIN (1u << 20)
+#define HIST_CHUNK_MIN (256u << 10)
+
+struct hist_job {
+    const char* data;
+    size_t count;
+    size_t per;                     // elements per chunk but the last
+    const struct hist_spec* spec;
+    uint64_t* counts;               // thread 0
+    uint64_t* partial;              // threads 1.., buckets each
+};
+
+static void hist_worker(void* ctx, unsigned index, unsigned count) {
+    struct hist_job* job = ctx;
+    size_t first = index * job->per;
+    size_t n = index + 1 == count ? job->count - first : job->per;
+    uint64_t* counts = index ? job->partial + (index - 1) * job->spec->buckets : job->counts;
+    histogram(job->data + first * hist_size(job->spec), n, job->spec, counts);
+}
+
+static void histogram_parallel(const void* data, size_t count, const struct hist_spec* spec,
+                               uint64_t* counts, unsigned threads) {
+    size_t bytes = count * hist_size(spec);
+    if (bytes >= HIST_PARALLEL_MIN) {
+        threads = parallel_threads(threads);
+        if (threads > bytes / HIST_CHUNK_MIN) threads = (unsigned)(bytes / HIST_CHUNK_MIN);
+    } else {
+        threads = 1;
+    }
+    uint64_t* partial = threads > 1 ? calloc((threads - 1) * spec->buckets, sizeof(uint64_t)) : NULL;
+    if (!partial) {
+        histogram(data, count, spec, counts);
+        return;
+    }
+
+    struct hist_job job = {data, count, count / threads, spec, counts, partial};
+    parallel_run(hist_worker, &job, threads);
+    for (unsigned t = 1; t < threads; t++) {
+        const uint64_t* part = partial + (t - 1) * spec->buckets;
+        for (size_t b = 0; b < spec->buckets; b++) counts[b] += part[b];
+    }
+    free(partial);
+}
+
+void array_histogram_u8_asm(const uint8_t* data, size_t count, uint64_t counts[256]) {
+    struct hist_spec spec = {HIST_U8, 0, 0, 256};
+    histogram(data, count, &spec, counts);
+}
+
+void array_histogram_u16_asm(const uint16_t* data, size_t count, uint64_t counts[65536]) {
+    struct hist_spec spec = {HIST_U16, 0, 0, 65536};
+    histogram(data, count, &spec, counts);
+}
+
+void array_histogram_shift_asm(const long* arr, size_t count, long base, unsigned shift,
+                               uint64_t* counts, size_t buckets) {
+    struct hist_spec spec = {HIST_SHIFT, base, shift, buckets};
+    histogram(arr, count, &spec, counts);
+}
+
+void array_histogram_u8_parallel(const uint8_t* data, size_t count, uint64_t counts[256],
+                                 unsigned threads) {
+    struct hist_spec spec = {HIST_U8, 0, 0, 256};
+    histogram_parallel(data, count, &spec, counts, threads);
+}
+
+void array_histogram_u16_parallel(const uint16_t* data, size_t count, uint64_t counts[65536],
+                                  unsigned threads) {
+    struct hist_spec spec = {HIST_U16, 0, 0, 65536};
+    histogram_parallel(data, count, &spec, counts, threads);
+}
+
+void array_histogram_shift_parallel(const long* arr, size_t count, long base, unsigned shift,
+                                    uint64_t* counts, size_t buckets, unsigned threads) {
+    struct hist_spec spec = {HIST_SHIFT, base, shift, buckets};
+    histogram_parallel(arr, count, &spec, counts, threads);
+}
+
+long matrix_get_asm(const long* matrix, size_t rows, size_t cols, size_t row, size_t col) {
+    long value;
+    (void)rows;                     // Only needed by callers for bounds checks
+    
+    __asm__ volatile (
+        "movq %1, %%rsi\n\t"        // Load matrix base pointer
+        "movq %3, %%rax\n\t"        // Load row index
+        "mulq %2\n\t"               // Multiply row * cols (result in RAX)
+        "addq %4, %%rax\n\t"        // Add col index
+        "leaq (%%rsi,%%rax,8), %%rsi\n\t"  // Calculate final address: base + index * 8
+        "movq (%%rsi), %%rax\n\t"   // Load value from calculated address
+        "movq %%rax, %0\n\t"        // Store result
+        : "=m" (value)
+        : "m" (matrix), "m" (cols), "m" (row), "m" (col)
+        : "rax", "rdx", "rsi", "memory"  // mulq uses rdx:rax
+    );
+    
+    return value;
+}
@@ -0,0 +1,134 @@
+// assm_array.hpp - Typed C++ front end for the array kernels (assm_array.c)
+//
+// assm::sum, assm::search and assm::minmax pick the array_*_asm kernel for
+// the element type, the way tutorial 11's max_value<T> is instantiated per
+// type, and also take any contiguous container (C++17):
+//
+//   std::vector<int16_t> v = ...;
+//   int64_t total = assm::sum(v);             // widened, so it cannot wrap
+//   auto [lo, hi, at_lo, at_hi] = assm::minmax(v);
+//
+// Supported element types are int8_t, int16_t, int32_t, int64_t, uint64_t,
+// float and double; anything else fails to compile.
+#ifndef ASSM_ARRAY_HPP
+#define ASSM_ARRAY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "assm_kernels.h"
+
+namespace assm {
+
+// sum_type is what sums accumulate in (see array_sum_i8_asm and friends),
+// minmax_type the struct array_minmax_*_asm returns
+template<typename T>
+struct array_traits {
+    static_assert(sizeof(T) == 0, "assm: no array kernels for this element type");
+};
+
+template<>
+struct array_traits<int8_t> {
+    using sum_type = int64_t;
+    using minmax_type = assm_minmax_i8;
+    static sum_type sum(const int8_t* a, size_t n) { return array_sum_i8_asm(a, n); }
+    static size_t search(const int8_t* a, size_t n, int8_t v) { return array_search_i8_asm(a, n, v); }
+    static minmax_type minmax(const int8_t* a, size_t n) { return array_minmax_i8_asm(a, n); }
+};
+
+template<>
+struct array_traits<int16_t> {
+    using sum_type = int64_t;
+    using minmax_type = assm_minmax_i16;
+    static sum_type sum(const int16_t* a, size_t n) { return array_sum_i16_asm(a, n); }
+    static size_t search(const int16_t* a, size_t n, int16_t v) { return array_search_i16_asm(a, n, v); }
+    static minmax_type minmax(const int16_t* a, size_t n) { return array_minmax_i16_asm(a, n); }
+};
+
+template<>
+struct array_traits<int32_t> {
+    using sum_type = int64_t;
+    using minmax_type = assm_minmax_i32;
+    static sum_type sum(const int32_t* a, size_t n) { return array_sum_i32_asm(a, n); }
+    static size_t search(const int32_t* a, size_t n, int32_t v) { return array_search_i32_asm(a, n, v); }
+    static minmax_type minmax(const int32_t* a, size_t n) { return array_minmax_i32_asm(a, n); }
+};
+
+// The original tutorial 7 kernels; the sum wraps like any int64 sum
+template<>
+struct array_traits<int64_t> {
+    using sum_type = int64_t;
+    using minmax_type = assm_minmax_i64;
+    static sum_type sum(const int64_t* a, size_t n) {
+        return array_sum_asm(reinterpret_cast<const long*>(a), n);
+    }
+    static size_t search(const int64_t* a, size_t n, int64_t v) {
+        return array_search_asm(reinterpret_cast<const long*>(a), n, static_cast<long>(v));
+    }
+    static minmax_type minmax(const int64_t* a, size_t n) { return array_minmax_i64_asm(a, n); }
+};
+
+template<>
+struct array_traits<uint64_t> {
+    using sum_type = uint64_t;
+    using minmax_type = assm_minmax_u64;
+    static sum_type sum(const uint64_t* a, size_t n) { return array_sum_u64_asm(a, n); }
+    static size_t search(const uint64_t* a, size_t n, uint64_t v) { return array_search_u64_asm(a, n, v); }
+    static minmax_type minmax(const uint64_t* a, size_t n) { return array_minmax_u64_asm(a, n); }
+};
+
+template<>
+struct array_traits<float> {
+    using sum_type = double;
+    using minmax_type = assm_minmax_f32;
+    static sum_type sum(const float* a, size_t n) { return array_sum_f32_asm(a, n); }
+    static size_t search(const float* a, size_t n, float v) { return array_search_f32_asm(a, n, v); }
+    static minmax_type minmax(const float* a, size_t n) { return array_minmax_f32_asm(a, n); }
+};
+
+template<>
+struct array_traits<double> {
+    using sum_type = double;
+    using minmax_type = assm_minmax_f64;
+    static sum_type sum(const double* a, size_t n) { return array_sum_f64_asm(a, n); }
+    static size_t search(const double* a, size_t n, double v) { return array_search_f64_asm(a, n, v); }
+    static minmax_type minmax(const double* a, size_t n) { return array_minmax_f64_asm(a, n); }
+};
+
+template<typename T>
+typename array_traits<T>::sum_type sum(const T* arr, size_t count) {
+    return array_traits<T>::sum(arr, count);
+}
+
+// Index of the first element equal to target, or SIZE_MAX. target is taken
+// as a T, so search(bytes, n, 300) looks for int8_t(300).
+template<typename T>
+size_t search(const T* arr, size_t count, typename std::common_type<T>::type target) {
+    return array_traits<T>::search(arr, count, target);
+}
+
+template<typename T>
+typename array_traits<T>::minmax_type minmax(const T* arr, size_t count) {
+    return array_traits<T>::minmax(arr, count);
+}
+
+template<typename C>
+auto sum(const C& c) -> decltype(sum(std::data(c), std::size(c))) {
+    return sum(std::data(c), std::size(c));
+}
+
+template<typename C, typename V>
+auto search(const C& c, const V& target) -> decltype(search(std::data(c), std::size(c), target)) {
+    return search(std::data(c), std::size(c), target);
+}
+
+template<typename C>
+auto minmax(const C& c) -> decltype(minmax(std::data(c), std::size(c))) {
+    return minmax(std::data(c), std::size(c));
+}
+
+} // namespace assm
+
+#endif // ASSM_ARRAY_HPP
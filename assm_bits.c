@@ -0,0 +1,323 @@
+// assm_bits.c - Bit manipulation kernels (tutorial 8)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+#include <string.h>
+
+// Clears the lowest set bit per iteration: cost grows with the bit count
+int popcount_loop(uint64_t value) {
+    int count;
+    
+    __asm__ volatile (
+        "movq %1, %%rax\n\t"        // Load value into RAX
+        "xorq %%rbx, %%rbx\n\t"     // Clear counter
+        "testq %%rax, %%rax\n\t"    // Test if value is zero
+        "jz 2f\n\t"                 // If zero, skip loop
+        "1:\n\t"                    // loop_start
+        "movq %%rax, %%rcx\n\t"     // Copy value
+        "decq %%rcx\n\t"            // Subtract 1
+        "andq %%rcx, %%rax\n\t"     // Clear lowest set bit: value &= (value - 1)
+        "incq %%rbx\n\t"            // Increment counter
+        "testq %%rax, %%rax\n\t"    // Test if any bits left
+        "jnz 1b\n\t"                // If not zero, continue loop
+        "2:\n\t"                    // end
+        "movl %%ebx, %0\n\t"        // Store result
+        : "=m" (count)
+        : "m" (value)
+        : "rax", "rbx", "rcx"
+    );
+    
+    return count;
+}
+
+int popcount_popcnt(uint64_t value) {
+    int count;
+    
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"     // Break popcnt's false dependency on its destination
+        "popcntq %1, %%rax\n\t"     // Count set bits in one instruction
+        "movl %%eax, %0\n\t"        // Store result
+        : "=m" (count)
+        : "m" (value)
+        : "rax"
+    );
+    
+    return count;
+}
+
+int popcount_asm(uint64_t value) {
+    return ASSM_DISPATCH(popcount)(value);
+}
+
+// Bulk popcount of n bytes. popcount_buffer_swar is the portable fallback:
+// the usual 64-bit SWAR sum of bit counts (pairs, nibbles, then a multiply
+// to add the bytes). popcount_buffer_popcnt runs four popcnt chains over 32
+// bytes per iteration, one popcnt per cycle on most cores. The AVX2 kernel
+// is Harley-Seal: a tree of carry-save adders (CSA: sum a ^ b ^ c and carry
+// majority(a, b, c), five logic ops) folds sixteen 32-byte vectors into
+// running ones, twos, fours and eights vectors plus one "sixteens" vector
+// per 512 bytes, and only that vector is counted, with vpshufb looking up
+// the bit count of each nibble and vpsadbw adding the bytes into 64-bit
+// lanes. The four running vectors are counted once at the end and weighted
+// by 1, 2, 4 and 8.
+static uint64_t popcount_word_swar(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (x * 0x0101010101010101ull) >> 56;
+}
+
+// The last n % 8 bytes as one zero-padded word
+static uint64_t popcount_tail_word(const unsigned char* p, size_t n) {
+    uint64_t word = 0;
+    memcpy(&word, p, n & 7);
+    return word;
+}
+
+uint64_t popcount_buffer_swar(const void* data, size_t n) {
+    const unsigned char* p = data;
+    uint64_t total = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        memcpy(&word, p + i, 8);
+        total += popcount_word_swar(word);
+    }
+    return total + popcount_word_swar(popcount_tail_word(p + i, n));
+}
+
+uint64_t popcount_buffer_popcnt(const void* data, size_t n) {
+    const unsigned char* p = data;
+    size_t blocks = n / 32;
+    uint64_t total = 0;
+    if (blocks) {
+        __asm__ volatile (
+            "xorl %%r8d, %%r8d\n\t"                 // Four independent sums
+            "xorl %%r9d, %%r9d\n\t"
+            "xorl %%r10d, %%r10d\n\t"
+            "xorl %%r11d, %%r11d\n\t"
+            "1:\n\t"
+            "xorl %%eax, %%eax\n\t"                 // Zeroing breaks popcnt's false
+            "popcntq (%1), %%rax\n\t"               // dependency on its destination
+            "addq %%rax, %%r8\n\t"
+            "xorl %%ecx, %%ecx\n\t"
+            "popcntq 8(%1), %%rcx\n\t"
+            "addq %%rcx, %%r9\n\t"
+            "xorl %%edx, %%edx\n\t"
+            "popcntq 16(%1), %%rdx\n\t"
+            "addq %%rdx, %%r10\n\t"
+            "xorl %%eax, %%eax\n\t"
+            "popcntq 24(%1), %%rax\n\t"
+            "addq %%rax, %%r11\n\t"
+            "addq $32, %1\n\t"
+            "decq %2\n\t"
+            "jnz 1b\n\t"
+            "addq %%r9, %%r8\n\t"
+            "addq %%r11, %%r10\n\t"
+            "leaq (%%r8,%%r10), %0\n\t"
+            : "=r" (total), "+r" (p), "+r" (blocks)
+            :
+            : "rax", "rcx", "rdx", "r8", "r9", "r10", "r11", "memory", "cc"
+        );
+    }
+    for (n %= 32; n >= 8; n -= 8, p += 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        total += (uint64_t)popcount_popcnt(word);
+    }
+    return total + (uint64_t)popcount_popcnt(popcount_tail_word(p, n));
+}
+
+// Bit count of each nibble, for both 128-bit lanes of vpshufb
+static const uint8_t popcount_nibbles[32] __attribute__((aligned(32))) = {
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+};
+static const uint64_t popcount_low_nibble = 0x0f0f0f0f0f0f0f0full;
+
+// ymm0-3 hold ones, twos, fours and eights, ymm4 the sixteens count in
+// four 64-bit lanes. CSA_MEM(h, o1, o2): ones, h = ones + the two vectors
+// at o1(%0) and o2(%0); CSA(h, a, b, c): a, h = a + b + c, with ymm13 and
+// ymm14 as scratch and h allowed to be b.
+#define POPCOUNT_CSA_MEM(h, o1, o2)                                                             \
+        "vmovdqu " o1 "(%0), %%ymm14\n\t"                                                       \
+        "vmovdqu " o2 "(%0), %%ymm15\n\t"                                                       \
+        "vpxor %%ymm14, %%ymm0, %%ymm13\n\t"        /* u = a ^ b */                             \
+        "vpand %%ymm14, %%ymm0, " h "\n\t"          /* a & b */                                 \
+        "vpand %%ymm15, %%ymm13, %%ymm14\n\t"       /* u & c */                                 \
+        "vpor %%ymm14, " h ", " h "\n\t"            /* carry */                                 \
+        "vpxor %%ymm15, %%ymm13, %%ymm0\n\t"        /* sum = u ^ c */
+#define POPCOUNT_CSA(h, a, b, c)                                                                \
+        "vpxor " b ", " a ", %%ymm13\n\t"                                                       \
+        "vpand " b ", " a ", " h "\n\t"                                                         \
+        "vpand " c ", %%ymm13, %%ymm14\n\t"                                                     \
+        "vpor %%ymm14, " h ", " h "\n\t"                                                        \
+        "vpxor " c ", %%ymm13, " a "\n\t"
+
+// 512-byte blocks; stores ones, twos, fours, eights and the sixteens count
+static void popcount_blocks_avx2(const void* data, size_t blocks, uint64_t out[5][4]) {
+    __asm__ volatile (
+        "vmovdqa (%2), %%ymm5\n\t"                  // Nibble counts
+        "vpbroadcastq (%3), %%ymm6\n\t"             // 0x0f mask
+        "vpxor %%ymm7, %%ymm7, %%ymm7\n\t"
+        "vpxor %%ymm0, %%ymm0, %%ymm0\n\t"
+        "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"
+        "vpxor %%ymm2, %%ymm2, %%ymm2\n\t"
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"
+        "vpxor %%ymm4, %%ymm4, %%ymm4\n\t"
+        "1:\n\t"
+        POPCOUNT_CSA_MEM("%%ymm8", "0", "32")
+        POPCOUNT_CSA_MEM("%%ymm9", "64", "96")
+        POPCOUNT_CSA("%%ymm10", "%%ymm1", "%%ymm8", "%%ymm9")
+        POPCOUNT_CSA_MEM("%%ymm8", "128", "160")
+        POPCOUNT_CSA_MEM("%%ymm9", "192", "224")
+        POPCOUNT_CSA("%%ymm11", "%%ymm1", "%%ymm8", "%%ymm9")
+        POPCOUNT_CSA("%%ymm12", "%%ymm2", "%%ymm10", "%%ymm11")
+        POPCOUNT_CSA_MEM("%%ymm8", "256", "288")
+        POPCOUNT_CSA_MEM("%%ymm9", "320", "352")
+        POPCOUNT_CSA("%%ymm10", "%%ymm1", "%%ymm8", "%%ymm9")
+        POPCOUNT_CSA_MEM("%%ymm8", "384", "416")
+        POPCOUNT_CSA_MEM("%%ymm9", "448", "480")
+        POPCOUNT_CSA("%%ymm11", "%%ymm1", "%%ymm8", "%%ymm9")
+        POPCOUNT_CSA("%%ymm8", "%%ymm2", "%%ymm10", "%%ymm11")
+        POPCOUNT_CSA("%%ymm9", "%%ymm3", "%%ymm12", "%%ymm8")
+        "vpand %%ymm6, %%ymm9, %%ymm10\n\t"         // Count the sixteens: low nibbles
+        "vpsrlw $4, %%ymm9, %%ymm11\n\t"            // and high nibbles
+        "vpand %%ymm6, %%ymm11, %%ymm11\n\t"
+        "vpshufb %%ymm10, %%ymm5, %%ymm10\n\t"
+        "vpshufb %%ymm11, %%ymm5, %%ymm11\n\t"
+        "vpaddb %%ymm11, %%ymm10, %%ymm10\n\t"
+        "vpsadbw %%ymm7, %%ymm10, %%ymm10\n\t"      // Bytes into 64-bit lanes
+        "vpaddq %%ymm10, %%ymm4, %%ymm4\n\t"
+        "addq $512, %0\n\t"
+        "decq %1\n\t"
+        "jnz 1b\n\t"
+        "vmovdqu %%ymm0, (%4)\n\t"
+        "vmovdqu %%ymm1, 32(%4)\n\t"
+        "vmovdqu %%ymm2, 64(%4)\n\t"
+        "vmovdqu %%ymm3, 96(%4)\n\t"
+        "vmovdqu %%ymm4, 128(%4)\n\t"
+        "vzeroupper\n\t"
+        : "+r" (data), "+r" (blocks)
+        : "r" (popcount_nibbles), "r" (&popcount_low_nibble), "r" (out)
+        : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9",
+          "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory", "cc"
+    );
+}
+
+uint64_t popcount_buffer_avx2(const void* data, size_t n) {
+    size_t blocks = n / 512;
+    uint64_t total = 0;
+    if (blocks) {
+        uint64_t out[5][4];
+        popcount_blocks_avx2(data, blocks, out);
+        for (int l = 0; l < 4; l++) {
+            total += 16 * out[4][l];
+            for (int v = 0; v < 4; v++) total += (uint64_t)popcount_popcnt(out[v][l]) << v;
+        }
+    }
+    return total + popcount_buffer_popcnt((const unsigned char*)data + blocks * 512, n % 512);
+}
+
+uint64_t popcount_buffer_asm(const void* data, size_t n) {
+    return ASSM_DISPATCH(popcount_buffer)(data, n);
+}
+
+uint64_t extract_bits_asm(uint64_t value, int start_bit, int num_bits) {
+    uint64_t result;
+    
+    __asm__ volatile (
+        "movq %1, %%rax\n\t"        // Load value
+        "movl %2, %%ecx\n\t"        // Load start_bit into CL
+        "shrq %%cl, %%rax\n\t"      // Shift right by start_bit positions
+        "movl %3, %%ecx\n\t"        // Load num_bits
+        "movq $1, %%rdx\n\t"        // Start with 1
+        "shlq %%cl, %%rdx\n\t"      // Shift left to create 2^num_bits
+        "decq %%rdx\n\t"            // Subtract 1 to create mask
+        "andq %%rdx, %%rax\n\t"     // Apply mask
+        "movq %%rax, %0\n\t"        // Store result
+        : "=m" (result)
+        : "m" (value), "m" (start_bit), "m" (num_bits)
+        : "rax", "rcx", "rdx"
+    );
+    
+    return result;
+}
+
+uint64_t set_bit_asm(uint64_t value, int bit_position) {
+    uint64_t result;
+    
+    __asm__ volatile (
+        "movq %1, %%rax\n\t"        // Load value
+        "movl %2, %%ecx\n\t"        // Load bit_position
+        "movq $1, %%rdx\n\t"        // Load 1
+        "shlq %%cl, %%rdx\n\t"      // Shift 1 left by bit_position
+        "orq %%rdx, %%rax\n\t"      // OR with the mask to set bit
+        "movq %%rax, %0\n\t"        // Store result
+        : "=m" (result)
+        : "m" (value), "m" (bit_position)
+        : "rax", "rcx", "rdx"
+    );
+    
+    return result;
+}
+
+uint64_t clear_bit_asm(uint64_t value, int bit_position) {
+    uint64_t result;
+    
+    __asm__ volatile (
+        "movq %1, %%rax\n\t"        // Load value
+        "movl %2, %%ecx\n\t"        // Load bit_position
+        "movq $1, %%rdx\n\t"        // Load 1
+        "shlq %%cl, %%rdx\n\t"      // Shift 1 left by bit_position
+        "notq %%rdx\n\t"            // Invert all bits in mask
+        "andq %%rdx, %%rax\n\t"     // AND with inverted mask to clear bit
+        "movq %%rax, %0\n\t"        // Store result
+        : "=m" (result)
+        : "m" (value), "m" (bit_position)
+        : "rax", "rcx", "rdx"
+    );
+    
+    return result;
+}
+
+uint64_t rotate_left_asm(uint64_t value, int positions) {
+    uint64_t result;
+    
+    __asm__ volatile (
+        "movq %1, %%rax\n\t"        // Load value
+        "movl %2, %%ecx\n\t"        // Load positions
+        "rolq %%cl, %%rax\n\t"      // Rotate left by CL positions
+        "movq %%rax, %0\n\t"        // Store result
+        : "=m" (result)
+        : "m" (value), "m" (positions)
+        : "rax", "rcx"
+    );
+    
+    return result;
+}
+
+int is_power_of_2_asm(uint64_t value) {
+    int result;
+    
+    __asm__ volatile (
+        "movq %1, %%rax\n\t"        // Load value
+        "testq %%rax, %%rax\n\t"    // Test if value is zero
+        "jz 2f\n\t"                 // If zero, not a power of 2
+        "movq %%rax, %%rdx\n\t"     // Copy value
+        "decq %%rdx\n\t"            // Subtract 1
+        "andq %%rdx, %%rax\n\t"     // value & (value - 1)
+        "setz %%al\n\t"             // Set AL to 1 if result is zero
+        "movzbl %%al, %%eax\n\t"    // Zero-extend AL to EAX
+        "jmp 3f\n\t"                // Jump to end
+        "2:\n\t"                    // zero_case
+        "xorl %%eax, %%eax\n\t"     // Return 0 for zero input
+        "3:\n\t"                    // end
+        "movl %%eax, %0\n\t"        // Store result
+        : "=m" (result)
+        : "m" (value)
+        : "rax", "rdx"
+    );
+    
+    return result;
+}
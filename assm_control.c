@@ -0,0 +1,72 @@
+// assm_control.c - Control flow and call kernels (tutorials 3, 4, 10)
+#include "assm_kernels.h"
+
+long factorial_asm(long n) {
+    long result;
+    
+    __asm__ volatile (
+        "movq $1, %%rax\n\t"        // result = 1
+        "movq %1, %%rbx\n\t"        // counter = n
+        "1:\n\t"                    // loop_start label
+        "cmpq $1, %%rbx\n\t"        // compare counter with 1
+        "jle 2f\n\t"                // if counter <= 1, jump to end
+        "mulq %%rbx\n\t"            // result *= counter
+        "decq %%rbx\n\t"            // counter--
+        "jmp 1b\n\t"                // jump back to loop_start
+        "2:\n\t"                    // loop_end label
+        "movq %%rax, %0\n\t"        // store result
+        : "=m" (result)
+        : "m" (n)
+        : "rax", "rbx", "rdx"       // mulq uses rdx:rax
+    );
+    
+    return result;
+}
+
+// Standalone functions. The recursive call goes through a local label so
+// the shared library needs no PLT entry for it.
+__asm__(
+    ".pushsection .text\n"
+    ".globl fibonacci_asm\n"
+    ".type fibonacci_asm, @function\n"
+    "fibonacci_asm:\n"
+    ".Lfib_entry:\n\t"
+    "pushq %rbp\n\t"              // Save old base pointer
+    "movq %rsp, %rbp\n\t"         // Set up new base pointer
+    "pushq %rbx\n\t"              // Save callee-saved register
+    "pushq %r12\n\t"              // Save another callee-saved register
+    "cmpq $1, %rdi\n\t"           // Compare n with 1
+    "jle .Lfib_base\n\t"          // If n <= 1, goto base case
+    "movq %rdi, %rbx\n\t"         // Save n in RBX
+    "decq %rdi\n\t"               // n-1
+    "call .Lfib_entry\n\t"        // Call fib(n-1)
+    "movq %rax, %r12\n\t"         // Save fib(n-1) result in callee-saved R12
+    "movq %rbx, %rdi\n\t"         // Restore n
+    "subq $2, %rdi\n\t"           // n-2
+    "call .Lfib_entry\n\t"        // Call fib(n-2)
+    "addq %r12, %rax\n\t"         // fib(n-1) + fib(n-2)
+    "jmp .Lfib_done\n"
+    ".Lfib_base:\n\t"
+    "movq %rdi, %rax\n"           // Return n (0 or 1)
+    ".Lfib_done:\n\t"
+    "popq %r12\n\t"               // Restore R12
+    "popq %rbx\n\t"               // Restore RBX
+    "popq %rbp\n\t"               // Restore base pointer
+    "ret\n"
+    ".size fibonacci_asm, .-fibonacci_asm\n"
+
+    // (a * b) + c
+    ".globl multiply_add_asm\n"
+    ".type multiply_add_asm, @function\n"
+    "multiply_add_asm:\n\t"
+    "pushq %rbp\n\t"              // Save base pointer
+    "movq %rsp, %rbp\n\t"         // Set up frame
+    "movq %rdx, %rcx\n\t"         // Save c (RDX) before mulq overwrites it
+    "movq %rdi, %rax\n\t"         // Load a into RAX
+    "mulq %rsi\n\t"               // Multiply RAX by b (RSI), high half in RDX
+    "addq %rcx, %rax\n\t"         // Add c to result
+    "popq %rbp\n\t"               // Restore base pointer
+    "ret\n"
+    ".size multiply_add_asm, .-multiply_add_asm\n"
+    ".popsection\n"
+);
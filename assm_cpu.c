@@ -0,0 +1,180 @@
+// assm_cpu.c - CPUID feature probing and dispatch tier selection
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+static void cpuid_asm(uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+    uint32_t a, b, c, d;
+
+    __asm__ volatile (
+        "cpuid\n\t"                 // EAX = leaf, ECX = subleaf -> EAX, EBX, ECX, EDX
+        : "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+        : "a" (leaf), "c" (subleaf)
+    );
+
+    regs[0] = a;
+    regs[1] = b;
+    regs[2] = c;
+    regs[3] = d;
+}
+
+// Reads XCR0 to see which register states the OS saves on context switch
+static uint64_t xgetbv_asm(void) {
+    uint32_t lo, hi;
+
+    __asm__ volatile (
+        "xorl %%ecx, %%ecx\n\t"     // XCR0
+        "xgetbv\n\t"                // EDX:EAX = XCR0
+        : "=a" (lo), "=d" (hi)
+        :
+        : "ecx"
+    );
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static unsigned probe_features(void) {
+    uint32_t regs[4];
+    unsigned features = 0;
+
+    cpuid_asm(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+
+    cpuid_asm(1, 0, regs);
+    if (regs[3] & (1u << 26)) features |= ASSM_CPU_SSE2;
+    if (regs[2] & (1u << 0))  features |= ASSM_CPU_SSE3;
+    if (regs[2] & (1u << 9))  features |= ASSM_CPU_SSSE3;
+    if (regs[2] & (1u << 12)) features |= ASSM_CPU_FMA;
+    if (regs[2] & (1u << 19)) features |= ASSM_CPU_SSE41;
+    if (regs[2] & (1u << 20)) features |= ASSM_CPU_SSE42;
+    if (regs[2] & (1u << 23)) features |= ASSM_CPU_POPCNT;
+
+    // AVX needs both the instruction set and OS support for YMM state
+    int os_avx = 0;
+    if ((regs[2] & (1u << 27)) && (regs[2] & (1u << 28))) {
+        os_avx = (xgetbv_asm() & 0x6) == 0x6;
+    }
+    if (os_avx) features |= ASSM_CPU_AVX;
+    else features &= ~ASSM_CPU_FMA;
+
+    if (max_leaf >= 7) {
+        cpuid_asm(7, 0, regs);
+        if (regs[1] & (1u << 3))  features |= ASSM_CPU_BMI1;
+        if (regs[1] & (1u << 8))  features |= ASSM_CPU_BMI2;
+        if (regs[1] & (1u << 9))  features |= ASSM_CPU_ERMS;
+        if (regs[3] & (1u << 4))  features |= ASSM_CPU_FSRM;
+        if (os_avx && (regs[1] & (1u << 5))) features |= ASSM_CPU_AVX2;
+    }
+
+    return features;
+}
+
+// Highest tier whose required features are all present
+static int tier_for_features(unsigned features) {
+    const unsigned sse42 = ASSM_CPU_SSE2 | ASSM_CPU_SSSE3 | ASSM_CPU_SSE41 |
+                           ASSM_CPU_SSE42 | ASSM_CPU_POPCNT;
+    const unsigned avx2 = sse42 | ASSM_CPU_AVX | ASSM_CPU_AVX2 | ASSM_CPU_FMA |
+                          ASSM_CPU_BMI1 | ASSM_CPU_BMI2;
+
+    if ((features & avx2) == avx2) return ASSM_TIER_AVX2;
+    if ((features & sse42) == sse42) return ASSM_TIER_SSE42;
+    return ASSM_TIER_SSE2;
+}
+
+// Largest data or unified cache from the deterministic cache parameters:
+// CPUID leaf 4 on Intel, 0x8000001D on AMD (same register layout)
+static size_t probe_llc_size(void) {
+    uint32_t regs[4];
+    uint32_t leaf = 0;
+
+    cpuid_asm(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+    if (regs[1] == 0x756E6547 && max_leaf >= 4) {           // "Genu"ineIntel
+        leaf = 4;
+    } else if (regs[1] == 0x68747541) {                     // "Auth"enticAMD
+        cpuid_asm(0x80000000, 0, regs);
+        if (regs[0] >= 0x8000001D) leaf = 0x8000001D;
+    }
+    if (!leaf) return 0;
+
+    size_t largest = 0;
+    for (uint32_t index = 0; index < 16; index++) {
+        cpuid_asm(leaf, index, regs);
+        uint32_t type = regs[0] & 0x1F;                     // 0 = no more caches
+        if (type == 0) break;
+        if (type == 2) continue;                            // Instruction cache
+        size_t ways = (regs[1] >> 22) + 1;
+        size_t partitions = ((regs[1] >> 12) & 0x3FF) + 1;
+        size_t line = (regs[1] & 0xFFF) + 1;
+        size_t sets = (size_t)regs[2] + 1;
+        size_t size = ways * partitions * line * sets;
+        if (size > largest) largest = size;
+    }
+    return largest;
+}
+
+static const char* const tier_names[] = { "sse2", "sse42", "avx2" };
+
+const char* assm_tier_name(int tier) {
+    if (tier < ASSM_TIER_SSE2 || tier > ASSM_TIER_AVX2) return "unknown";
+    return tier_names[tier];
+}
+
+static int parse_tier(const char* name) {
+    for (int tier = ASSM_TIER_SSE2; tier <= ASSM_TIER_AVX2; tier++) {
+        if (strcmp(name, tier_names[tier]) == 0) return tier;
+    }
+    if (name[0] >= '0' && name[0] <= '2' && name[1] == '\0') return name[0] - '0';
+    return -1;
+}
+
+static unsigned cached_features;
+static int detected_tier = -1;
+static size_t llc_size = SIZE_MAX;      // SIZE_MAX until probed
+
+unsigned assm_cpu_features(void) {
+    if (__atomic_load_n(&detected_tier, __ATOMIC_ACQUIRE) < 0) {
+        unsigned features = probe_features();
+        __atomic_store_n(&cached_features, features, __ATOMIC_RELAXED);
+        __atomic_store_n(&detected_tier, tier_for_features(features), __ATOMIC_RELEASE);
+    }
+    return __atomic_load_n(&cached_features, __ATOMIC_RELAXED);
+}
+
+size_t assm_cpu_llc_size(void) {
+    size_t size = __atomic_load_n(&llc_size, __ATOMIC_RELAXED);
+    if (size == SIZE_MAX) {
+        size = probe_llc_size();
+        __atomic_store_n(&llc_size, size, __ATOMIC_RELAXED);
+    }
+    return size;
+}
+
+int assm_cpu_detected_tier(void) {
+    assm_cpu_features();
+    return __atomic_load_n(&detected_tier, __ATOMIC_ACQUIRE);
+}
+
+// ASSM_CPU_TIER can only lower the tier: forcing a tier the CPU cannot
+// execute would turn a reproducible bug into SIGILL
+int assm_cpu_default_tier(void) {
+    int tier = assm_cpu_detected_tier();
+    const char* forced = getenv(ASSM_CPU_TIER_ENV);
+
+    if (forced && forced[0]) {
+        int requested = parse_tier(forced);
+        if (requested < 0) {
+            fprintf(stderr, "assmkernels: ignoring unknown %s=%s (use sse2, sse42 or avx2)\n",
+                    ASSM_CPU_TIER_ENV, forced);
+        } else if (requested > tier) {
+            fprintf(stderr, "assmkernels: %s=%s not supported by this CPU, using %s\n",
+                    ASSM_CPU_TIER_ENV, forced, assm_tier_name(tier));
+        } else {
+            tier = requested;
+        }
+    }
+
+    return tier;
+}
@@ -0,0 +1,446 @@
+// assm_dispatch.c - Runtime selection of kernel implementations
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+static int current_tier = -1;
+
+static void resolve_all(int tier);
+
+// Resolver stubs: the first call through any slot resolves every slot
+static void resolve_default(void) {
+    resolve_all(assm_cpu_default_tier());
+}
+
+static size_t strlen_resolve(const char* str) {
+    resolve_default();
+    return ASSM_DISPATCH(strlen)(str);
+}
+
+static size_t strnlen_resolve(const char* str, size_t maxlen) {
+    resolve_default();
+    return ASSM_DISPATCH(strnlen)(str, maxlen);
+}
+
+static size_t strcpy_bounded_resolve(char* dest, const char* src, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(strcpy_bounded)(dest, src, n);
+}
+
+static void* memcpy_resolve(void* dest, const void* src, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(memcpy)(dest, src, n);
+}
+
+static void* memmove_resolve(void* dest, const void* src, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(memmove)(dest, src, n);
+}
+
+static size_t memchr_resolve(const void* ptr, int c, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(memchr)(ptr, c, n);
+}
+
+static size_t memchr2_resolve(const void* ptr, int c1, int c2, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(memchr2)(ptr, c1, c2, n);
+}
+
+static size_t memchr3_resolve(const void* ptr, int c1, int c2, int c3, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(memchr3)(ptr, c1, c2, c3, n);
+}
+
+static size_t memrchr_resolve(const void* ptr, int c, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(memrchr)(ptr, c, n);
+}
+
+static size_t strchr_resolve(const char* str, int c) {
+    resolve_default();
+    return ASSM_DISPATCH(strchr)(str, c);
+}
+
+static size_t memmem_scan_resolve(const void* hay, size_t pos, size_t limit, int first,
+                                  int last, size_t gap, uint32_t* mask) {
+    resolve_default();
+    return ASSM_DISPATCH(memmem_scan)(hay, pos, limit, first, last, gap, mask);
+}
+
+static size_t teddy_scan_resolve(const uint8_t* masks, const void* text, size_t pos,
+                                 size_t limit, uint32_t* mask, uint8_t* buckets) {
+    resolve_default();
+    return ASSM_DISPATCH(teddy_scan)(masks, text, pos, limit, mask, buckets);
+}
+
+static int memcmp_resolve(const void* ptr1, const void* ptr2, size_t num) {
+    resolve_default();
+    return ASSM_DISPATCH(memcmp)(ptr1, ptr2, num);
+}
+
+static size_t memcmp_mismatch_resolve(const void* ptr1, const void* ptr2, size_t num) {
+    resolve_default();
+    return ASSM_DISPATCH(memcmp_mismatch)(ptr1, ptr2, num);
+}
+
+static uint32_t crc32c_resolve(uint32_t crc, const void* data, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(crc32c)(crc, data, n);
+}
+
+static size_t utf8_scan_resolve(const void* data, size_t pos, size_t n, size_t* count) {
+    resolve_default();
+    return ASSM_DISPATCH(utf8_scan)(data, pos, n, count);
+}
+
+static long array_sum_resolve(const long* arr, size_t count) {
+    resolve_default();
+    return ASSM_DISPATCH(array_sum)(arr, count);
+}
+
+static __int128 array_sum_wide_resolve(const long* arr, size_t count) {
+    resolve_default();
+    return ASSM_DISPATCH(array_sum_wide)(arr, count);
+}
+
+static size_t array_search_resolve(const long* arr, size_t count, long target) {
+    resolve_default();
+    return ASSM_DISPATCH(array_search)(arr, count, target);
+}
+
+static void minmax_i32_resolve(const int32_t* arr, size_t count, struct assm_minmax_i32* result) {
+    resolve_default();
+    ASSM_DISPATCH(minmax_i32)(arr, count, result);
+}
+
+static void minmax_i64_resolve(const int64_t* arr, size_t count, struct assm_minmax_i64* result) {
+    resolve_default();
+    ASSM_DISPATCH(minmax_i64)(arr, count, result);
+}
+
+static void minmax_f32_resolve(const float* arr, size_t count, struct assm_minmax_f32* result) {
+    resolve_default();
+    ASSM_DISPATCH(minmax_f32)(arr, count, result);
+}
+
+static void minmax_f64_resolve(const double* arr, size_t count, struct assm_minmax_f64* result) {
+    resolve_default();
+    ASSM_DISPATCH(minmax_f64)(arr, count, result);
+}
+
+static int64_t sum_i8_resolve(const int8_t* arr, size_t count) {
+    resolve_default();
+    return ASSM_DISPATCH(sum_i8)(arr, count);
+}
+
+static int64_t sum_i16_resolve(const int16_t* arr, size_t count) {
+    resolve_default();
+    return ASSM_DISPATCH(sum_i16)(arr, count);
+}
+
+static int64_t sum_i32_resolve(const int32_t* arr, size_t count) {
+    resolve_default();
+    return ASSM_DISPATCH(sum_i32)(arr, count);
+}
+
+static double sum_f32_resolve(const float* arr, size_t count) {
+    resolve_default();
+    return ASSM_DISPATCH(sum_f32)(arr, count);
+}
+
+static double sum_f64_resolve(const double* arr, size_t count) {
+    resolve_default();
+    return ASSM_DISPATCH(sum_f64)(arr, count);
+}
+
+static size_t search_i8_resolve(const int8_t* arr, size_t count, int8_t target) {
+    resolve_default();
+    return ASSM_DISPATCH(search_i8)(arr, count, target);
+}
+
+static size_t search_i16_resolve(const int16_t* arr, size_t count, int16_t target) {
+    resolve_default();
+    return ASSM_DISPATCH(search_i16)(arr, count, target);
+}
+
+static size_t search_i32_resolve(const int32_t* arr, size_t count, int32_t target) {
+    resolve_default();
+    return ASSM_DISPATCH(search_i32)(arr, count, target);
+}
+
+static size_t search_f32_resolve(const float* arr, size_t count, float target) {
+    resolve_default();
+    return ASSM_DISPATCH(search_f32)(arr, count, target);
+}
+
+static size_t search_f64_resolve(const double* arr, size_t count, double target) {
+    resolve_default();
+    return ASSM_DISPATCH(search_f64)(arr, count, target);
+}
+
+static void minmax_i8_resolve(const int8_t* arr, size_t count, struct assm_minmax_i8* result) {
+    resolve_default();
+    ASSM_DISPATCH(minmax_i8)(arr, count, result);
+}
+
+static void minmax_i16_resolve(const int16_t* arr, size_t count, struct assm_minmax_i16* result) {
+    resolve_default();
+    ASSM_DISPATCH(minmax_i16)(arr, count, result);
+}
+
+static void minmax_u64_resolve(const uint64_t* arr, size_t count, struct assm_minmax_u64* result) {
+    resolve_default();
+    ASSM_DISPATCH(minmax_u64)(arr, count, result);
+}
+
+static void transpose32_tile_resolve(const void* src, size_t src_stride, void* dst, size_t dst_stride) {
+    resolve_default();
+    ASSM_DISPATCH(transpose32_tile)(src, src_stride, dst, dst_stride);
+}
+
+static void gemm_f32_kernel_resolve(size_t kc, const void* a, const void* b, void* c, size_t c_stride) {
+    resolve_default();
+    ASSM_DISPATCH(gemm_f32_kernel)(kc, a, b, c, c_stride);
+}
+
+static void gemm_i32_kernel_resolve(size_t kc, const void* a, const void* b, void* c, size_t c_stride) {
+    resolve_default();
+    ASSM_DISPATCH(gemm_i32_kernel)(kc, a, b, c, c_stride);
+}
+
+static void matrix_add_row_f32_resolve(float* sums, const float* row, size_t n) {
+    resolve_default();
+    ASSM_DISPATCH(matrix_add_row_f32)(sums, row, n);
+}
+
+static void matrix_add_row_i32_resolve(int64_t* sums, const int32_t* row, size_t n) {
+    resolve_default();
+    ASSM_DISPATCH(matrix_add_row_i32)(sums, row, n);
+}
+
+static float matrix_row_sum_f32_resolve(const float* row, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(matrix_row_sum_f32)(row, n);
+}
+
+static int64_t matrix_row_sum_i32_resolve(const int32_t* row, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(matrix_row_sum_i32)(row, n);
+}
+
+static size_t morton_index_resolve(size_t row, size_t col) {
+    resolve_default();
+    return ASSM_DISPATCH(morton_index)(row, col);
+}
+
+static void matrix_gather_resolve(const long* matrix, size_t cols, const size_t* rows,
+                                  const size_t* col_idx, size_t n, long* out, size_t distance) {
+    resolve_default();
+    ASSM_DISPATCH(matrix_gather)(matrix, cols, rows, col_idx, n, out, distance);
+}
+
+static int64_t scan_i64_resolve(int64_t* dst, const int64_t* src, size_t n, int64_t carry,
+                                int64_t mask) {
+    resolve_default();
+    return ASSM_DISPATCH(scan_i64)(dst, src, n, carry, mask);
+}
+
+static int32_t scan_i32_resolve(int32_t* dst, const int32_t* src, size_t n, int32_t carry,
+                                int64_t mask) {
+    resolve_default();
+    return ASSM_DISPATCH(scan_i32)(dst, src, n, carry, mask);
+}
+
+static void sort_blocks_i64_resolve(int64_t* keys, size_t blocks) {
+    resolve_default();
+    ASSM_DISPATCH(sort_blocks_i64)(keys, blocks);
+}
+
+static void sort_blocks_i32_resolve(int32_t* keys, size_t blocks) {
+    resolve_default();
+    ASSM_DISPATCH(sort_blocks_i32)(keys, blocks);
+}
+
+static void sort_merge_i64_resolve(const int64_t* a, const int64_t* a_end, const int64_t* b,
+                                  const int64_t* b_end, int64_t* out) {
+    resolve_default();
+    ASSM_DISPATCH(sort_merge_i64)(a, a_end, b, b_end, out);
+}
+
+static void sort_merge_i32_resolve(const int32_t* a, const int32_t* a_end, const int32_t* b,
+                                  const int32_t* b_end, int32_t* out) {
+    resolve_default();
+    ASSM_DISPATCH(sort_merge_i32)(a, a_end, b, b_end, out);
+}
+
+static size_t filter_eq_resolve(const int64_t* arr, size_t n, int64_t value, int64_t* out, int indices) {
+    resolve_default();
+    return ASSM_DISPATCH(filter_eq)(arr, n, value, out, indices);
+}
+
+static size_t filter_range_resolve(const int64_t* arr, size_t n, int64_t lo, int64_t hi, int64_t* out,
+                                   int indices) {
+    resolve_default();
+    return ASSM_DISPATCH(filter_range)(arr, n, lo, hi, out, indices);
+}
+
+static size_t filter_bits_resolve(const int64_t* arr, const uint64_t* bits, size_t n, int64_t* out,
+                                  int indices) {
+    resolve_default();
+    return ASSM_DISPATCH(filter_bits)(arr, bits, n, out, indices);
+}
+
+static int popcount_resolve(uint64_t value) {
+    resolve_default();
+    return ASSM_DISPATCH(popcount)(value);
+}
+
+static uint64_t popcount_buffer_resolve(const void* data, size_t n) {
+    resolve_default();
+    return ASSM_DISPATCH(popcount_buffer)(data, n);
+}
+
+static float dot_product_resolve(const float* a, const float* b, int count) {
+    resolve_default();
+    return ASSM_DISPATCH(dot_product)(a, b, count);
+}
+
+struct assm_dispatch_table assm_dispatch = {
+    .strlen = strlen_resolve,
+    .strnlen = strnlen_resolve,
+    .strcpy_bounded = strcpy_bounded_resolve,
+    .memcpy = memcpy_resolve,
+    .memmove = memmove_resolve,
+    .memcmp = memcmp_resolve,
+    .memcmp_mismatch = memcmp_mismatch_resolve,
+    .memchr = memchr_resolve,
+    .memchr2 = memchr2_resolve,
+    .memchr3 = memchr3_resolve,
+    .memrchr = memrchr_resolve,
+    .strchr = strchr_resolve,
+    .memmem_scan = memmem_scan_resolve,
+    .teddy_scan = teddy_scan_resolve,
+    .crc32c = crc32c_resolve,
+    .utf8_scan = utf8_scan_resolve,
+    .array_sum = array_sum_resolve,
+    .array_sum_wide = array_sum_wide_resolve,
+    .array_search = array_search_resolve,
+    .minmax_i32 = minmax_i32_resolve,
+    .minmax_i64 = minmax_i64_resolve,
+    .minmax_f32 = minmax_f32_resolve,
+    .minmax_f64 = minmax_f64_resolve,
+    .sum_i8 = sum_i8_resolve,
+    .sum_i16 = sum_i16_resolve,
+    .sum_i32 = sum_i32_resolve,
+    .sum_f32 = sum_f32_resolve,
+    .sum_f64 = sum_f64_resolve,
+    .search_i8 = search_i8_resolve,
+    .search_i16 = search_i16_resolve,
+    .search_i32 = search_i32_resolve,
+    .search_f32 = search_f32_resolve,
+    .search_f64 = search_f64_resolve,
+    .minmax_i8 = minmax_i8_resolve,
+    .minmax_i16 = minmax_i16_resolve,
+    .minmax_u64 = minmax_u64_resolve,
+    .transpose32_tile = transpose32_tile_resolve,
+    .gemm_f32_kernel = gemm_f32_kernel_resolve,
+    .gemm_i32_kernel = gemm_i32_kernel_resolve,
+    .matrix_add_row_f32 = matrix_add_row_f32_resolve,
+    .matrix_add_row_i32 = matrix_add_row_i32_resolve,
+    .matrix_row_sum_f32 = matrix_row_sum_f32_resolve,
+    .matrix_row_sum_i32 = matrix_row_sum_i32_resolve,
+    .morton_index = morton_index_resolve,
+    .matrix_gather = matrix_gather_resolve,
+    .scan_i64 = scan_i64_resolve,
+    .scan_i32 = scan_i32_resolve,
+    .sort_blocks_i64 = sort_blocks_i64_resolve,
+    .sort_blocks_i32 = sort_blocks_i32_resolve,
+    .sort_merge_i64 = sort_merge_i64_resolve,
+    .sort_merge_i32 = sort_merge_i32_resolve,
+    .filter_eq = filter_eq_resolve,
+    .filter_range = filter_range_resolve,
+    .filter_bits = filter_bits_resolve,
+    .popcount = popcount_resolve,
+    .popcount_buffer = popcount_buffer_resolve,
+    .dot_product = dot_product_resolve,
+};
+
+#define ASSM_SELECT(slot, impl) __atomic_store_n(&assm_dispatch.slot, impl, __ATOMIC_RELAXED)
+
+static void resolve_all(int tier) {
+    ASSM_SELECT(strlen, tier >= ASSM_TIER_AVX2 ? strlen_avx2 : strlen_sse2);
+    ASSM_SELECT(strnlen, tier >= ASSM_TIER_AVX2 ? strnlen_avx2 : strnlen_sse2);
+    ASSM_SELECT(strcpy_bounded, tier >= ASSM_TIER_AVX2 ? strcpy_bounded_avx2 : strcpy_bounded_sse2);
+    ASSM_SELECT(memcpy, tier >= ASSM_TIER_AVX2 ? memcpy_avx2 : memcpy_sse2);
+    ASSM_SELECT(memmove, tier >= ASSM_TIER_AVX2 ? memmove_avx2 : memmove_sse2);
+    ASSM_SELECT(memcmp, tier >= ASSM_TIER_AVX2 ? memcmp_avx2 : memcmp_sse2);
+    ASSM_SELECT(memcmp_mismatch, tier >= ASSM_TIER_AVX2 ? memcmp_mismatch_avx2 : memcmp_mismatch_sse2);
+    ASSM_SELECT(memchr, tier >= ASSM_TIER_AVX2 ? memchr_index_avx2 : memchr_index_sse2);
+    ASSM_SELECT(memchr2, tier >= ASSM_TIER_AVX2 ? memchr2_index_avx2 : memchr2_index_sse2);
+    ASSM_SELECT(memchr3, tier >= ASSM_TIER_AVX2 ? memchr3_index_avx2 : memchr3_index_sse2);
+    ASSM_SELECT(memrchr, tier >= ASSM_TIER_AVX2 ? memrchr_index_avx2 : memrchr_index_sse2);
+    ASSM_SELECT(strchr, tier >= ASSM_TIER_AVX2 ? strchr_index_avx2 : strchr_index_sse2);
+    ASSM_SELECT(memmem_scan, tier >= ASSM_TIER_AVX2 ? memmem_scan_avx2 : memmem_scan_sse2);
+    ASSM_SELECT(teddy_scan, tier >= ASSM_TIER_AVX2 ? teddy_scan_avx2 : teddy_scan_ssse3);
+    ASSM_SELECT(crc32c, tier >= ASSM_TIER_SSE42 ? crc32c_sse42 : crc32c_sw);
+    ASSM_SELECT(utf8_scan, tier >= ASSM_TIER_AVX2 ? utf8_scan_avx2 :
+                           tier >= ASSM_TIER_SSE42 ? utf8_scan_sse42 : utf8_scan_sse2);
+    ASSM_SELECT(array_sum, tier >= ASSM_TIER_AVX2 ? array_sum_avx2 : array_sum_sse2);
+    ASSM_SELECT(array_sum_wide, tier >= ASSM_TIER_AVX2 ? array_sum_wide_avx2 : array_sum_wide_sse2);
+    ASSM_SELECT(array_search, tier >= ASSM_TIER_AVX2 ? array_search_avx2 : array_search_sse2);
+    ASSM_SELECT(minmax_i32, tier >= ASSM_TIER_AVX2 ? array_minmax_i32_avx2 : array_minmax_i32_scalar);
+    ASSM_SELECT(minmax_i64, tier >= ASSM_TIER_AVX2 ? array_minmax_i64_avx2 : array_minmax_i64_scalar);
+    ASSM_SELECT(minmax_f32, tier >= ASSM_TIER_AVX2 ? array_minmax_f32_avx2 : array_minmax_f32_scalar);
+    ASSM_SELECT(minmax_f64, tier >= ASSM_TIER_AVX2 ? array_minmax_f64_avx2 : array_minmax_f64_scalar);
+    ASSM_SELECT(sum_i8, tier >= ASSM_TIER_AVX2 ? array_sum_i8_avx2 : array_sum_i8_scalar);
+    ASSM_SELECT(sum_i16, tier >= ASSM_TIER_AVX2 ? array_sum_i16_avx2 : array_sum_i16_scalar);
+    ASSM_SELECT(sum_i32, tier >= ASSM_TIER_AVX2 ? array_sum_i32_avx2 : array_sum_i32_scalar);
+    ASSM_SELECT(sum_f32, tier >= ASSM_TIER_AVX2 ? array_sum_f32_avx2 : array_sum_f32_scalar);
+    ASSM_SELECT(sum_f64, tier >= ASSM_TIER_AVX2 ? array_sum_f64_avx2 : array_sum_f64_scalar);
+    ASSM_SELECT(search_i8, tier >= ASSM_TIER_AVX2 ? array_search_i8_avx2 : array_search_i8_scalar);
+    ASSM_SELECT(search_i16, tier >= ASSM_TIER_AVX2 ? array_search_i16_avx2 : array_search_i16_scalar);
+    ASSM_SELECT(search_i32, tier >= ASSM_TIER_AVX2 ? array_search_i32_avx2 : array_search_i32_scalar);
+    ASSM_SELECT(search_f32, tier >= ASSM_TIER_AVX2 ? array_search_f32_avx2 : array_search_f32_scalar);
+    ASSM_SELECT(search_f64, tier >= ASSM_TIER_AVX2 ? array_search_f64_avx2 : array_search_f64_scalar);
+    ASSM_SELECT(minmax_i8, tier >= ASSM_TIER_AVX2 ? array_minmax_i8_avx2 : array_minmax_i8_scalar);
+    ASSM_SELECT(minmax_i16, tier >= ASSM_TIER_AVX2 ? array_minmax_i16_avx2 : array_minmax_i16_scalar);
+    ASSM_SELECT(minmax_u64, tier >= ASSM_TIER_AVX2 ? array_minmax_u64_avx2 : array_minmax_u64_scalar);
+    ASSM_SELECT(transpose32_tile, tier >= ASSM_TIER_AVX2 ? transpose32_tile_avx2 : transpose32_tile_sse2);
+    ASSM_SELECT(gemm_f32_kernel, tier >= ASSM_TIER_AVX2 ? gemm_f32_kernel_avx2 : gemm_f32_kernel_sse2);
+    ASSM_SELECT(gemm_i32_kernel, tier >= ASSM_TIER_AVX2 ? gemm_i32_kernel_avx2 :
+                                 tier >= ASSM_TIER_SSE42 ? gemm_i32_kernel_sse41 : gemm_i32_kernel_scalar);
+    ASSM_SELECT(matrix_add_row_f32, tier >= ASSM_TIER_AVX2 ? matrix_add_row_f32_avx2 : matrix_add_row_f32_sse2);
+    ASSM_SELECT(matrix_add_row_i32, tier >= ASSM_TIER_AVX2 ? matrix_add_row_i32_avx2 : matrix_add_row_i32_sse2);
+    ASSM_SELECT(matrix_row_sum_f32, tier >= ASSM_TIER_AVX2 ? matrix_row_sum_f32_avx2 : matrix_row_sum_f32_sse2);
+    ASSM_SELECT(matrix_row_sum_i32, tier >= ASSM_TIER_AVX2 ? matrix_row_sum_i32_avx2 : matrix_row_sum_i32_sse2);
+    ASSM_SELECT(morton_index, tier >= ASSM_TIER_AVX2 ? matrix_morton_index_bmi2 : matrix_morton_index_shift);
+    ASSM_SELECT(matrix_gather, tier >= ASSM_TIER_AVX2 ? matrix_gather_avx2 : matrix_gather_scalar);
+    ASSM_SELECT(scan_i64, tier >= ASSM_TIER_AVX2 ? scan_i64_avx2 : scan_i64_sse2);
+    ASSM_SELECT(scan_i32, tier >= ASSM_TIER_AVX2 ? scan_i32_avx2 : scan_i32_sse2);
+    ASSM_SELECT(sort_blocks_i64, tier >= ASSM_TIER_AVX2 ? sort_blocks_i64_avx2 : sort_blocks_i64_scalar);
+    ASSM_SELECT(sort_blocks_i32, tier >= ASSM_TIER_AVX2 ? sort_blocks_i32_avx2 : sort_blocks_i32_scalar);
+    ASSM_SELECT(sort_merge_i64, tier >= ASSM_TIER_AVX2 ? sort_merge_i64_avx2 : sort_merge_i64_scalar);
+    ASSM_SELECT(sort_merge_i32, tier >= ASSM_TIER_AVX2 ? sort_merge_i32_avx2 : sort_merge_i32_scalar);
+    ASSM_SELECT(filter_eq, tier >= ASSM_TIER_AVX2 ? filter_eq_avx2 : filter_eq_scalar);
+    ASSM_SELECT(filter_range, tier >= ASSM_TIER_AVX2 ? filter_range_avx2 : filter_range_scalar);
+    ASSM_SELECT(filter_bits, tier >= ASSM_TIER_AVX2 ? filter_bits_avx2 : filter_bits_scalar);
+    ASSM_SELECT(popcount, tier >= ASSM_TIER_SSE42 ? popcount_popcnt : popcount_loop);
+    ASSM_SELECT(popcount_buffer, tier >= ASSM_TIER_AVX2 ? popcount_buffer_avx2 :
+                                 tier >= ASSM_TIER_SSE42 ? popcount_buffer_popcnt : popcount_buffer_swar);
+    ASSM_SELECT(dot_product, tier >= ASSM_TIER_AVX2 ? dot_product_avx2 : dot_product_sse2);
+
+    __atomic_store_n(&current_tier, tier, __ATOMIC_RELEASE);
+}
+
+int assm_cpu_tier(void) {
+    if (__atomic_load_n(&current_tier, __ATOMIC_ACQUIRE) < 0) resolve_default();
+    return __atomic_load_n(&current_tier, __ATOMIC_ACQUIRE);
+}
+
+int assm_cpu_set_tier(int tier) {
+    int detected = assm_cpu_detected_tier();
+    if (tier > detected) tier = detected;
+    if (tier < ASSM_TIER_SSE2) tier = ASSM_TIER_SSE2;
+    resolve_all(tier);
+    return tier;
+}
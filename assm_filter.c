@@ -0,0 +1,221 @@
+// assm_filter.c - Stream compaction: keep the elements that pass a predicate
+#include <stdint.h>
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// A branch per element mispredicts whenever the predicate is neither
+// mostly true nor mostly false. The scalar kernels always store the
+// element and advance the output by the 0/1 outcome instead; the AVX2
+// kernels do the same four elements at a time: the predicate becomes a
+// 4-bit mask, the mask selects a vpermd pattern from filter_lut that moves
+// the kept lanes to the front, the whole vector is stored and the output
+// advances by popcnt(mask). The stores overlap, so out[kept..count) may be
+// overwritten, but nothing past out + count is. Index output permutes a
+// vector of element indices instead of the elements.
+
+// Dword permutation for each 4-bit mask: the kept qwords, in order
+static const uint32_t filter_lut[16][8] __attribute__((aligned(32))) = {
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 0, 0, 0, 0, 0, 0 },
+    { 2, 3, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 2, 3, 0, 0, 0, 0 },
+    { 4, 5, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 4, 5, 0, 0, 0, 0 },
+    { 2, 3, 4, 5, 0, 0, 0, 0 },
+    { 0, 1, 2, 3, 4, 5, 0, 0 },
+    { 6, 7, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 6, 7, 0, 0, 0, 0 },
+    { 2, 3, 6, 7, 0, 0, 0, 0 },
+    { 0, 1, 2, 3, 6, 7, 0, 0 },
+    { 4, 5, 6, 7, 0, 0, 0, 0 },
+    { 0, 1, 4, 5, 6, 7, 0, 0 },
+    { 2, 3, 4, 5, 6, 7, 0, 0 },
+    { 0, 1, 2, 3, 4, 5, 6, 7 },
+};
+
+// Indices of the first two vectors, then the step per iteration
+static const int64_t filter_iota[12] __attribute__((aligned(32))) = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 8, 8, 8,
+};
+
+// Scalar kernels from element first on; out is where element first would go
+static size_t filter_eq_from(const int64_t* arr, size_t first, size_t n, int64_t value, int64_t* out,
+                             int indices) {
+    size_t kept = 0;
+    for (size_t i = first; i < n; i++) {
+        out[kept] = indices ? (int64_t)i : arr[i];
+        kept += arr[i] == value;
+    }
+    return kept;
+}
+
+// lo <= x <= hi as one unsigned compare: x - lo <= hi - lo
+static size_t filter_range_from(const int64_t* arr, size_t first, size_t n, int64_t lo, int64_t hi,
+                                int64_t* out, int indices) {
+    uint64_t width = (uint64_t)hi - (uint64_t)lo;
+    size_t kept = 0;
+    for (size_t i = first; i < n; i++) {
+        out[kept] = indices ? (int64_t)i : arr[i];
+        kept += (uint64_t)arr[i] - (uint64_t)lo <= width;
+    }
+    return kept;
+}
+
+static size_t filter_bits_from(const int64_t* arr, const uint64_t* bits, size_t first, size_t n,
+                               int64_t* out, int indices) {
+    size_t kept = 0;
+    for (size_t i = first; i < n; i++) {
+        out[kept] = indices ? (int64_t)i : arr[i];
+        kept += (bits[i >> 6] >> (i & 63)) & 1;
+    }
+    return kept;
+}
+
+size_t filter_eq_scalar(const int64_t* arr, size_t n, int64_t value, int64_t* out, int indices) {
+    return filter_eq_from(arr, 0, n, value, out, indices);
+}
+
+size_t filter_range_scalar(const int64_t* arr, size_t n, int64_t lo, int64_t hi, int64_t* out,
+                           int indices) {
+    return filter_range_from(arr, 0, n, lo, hi, out, indices);
+}
+
+size_t filter_bits_scalar(const int64_t* arr, const uint64_t* bits, size_t n, int64_t* out,
+                          int indices) {
+    return filter_bits_from(arr, bits, 0, n, out, indices);
+}
+
+// Loads of the two vectors of an iteration, and the masks for them in eax
+// and edx. The compare predicates take their constants from ymm14/ymm15;
+// the bitmap one reads a byte of bits per iteration.
+#define FILTER_LOAD                                                                             \
+        "vmovdqu (%0,%%rcx,8), %%ymm0\n\t"                                                      \
+        "vmovdqu 32(%0,%%rcx,8), %%ymm1\n\t"
+#define FILTER_MASK_EQ                                                                          \
+        "vpcmpeqq %%ymm14, %%ymm0, %%ymm2\n\t"                                                  \
+        "vpcmpeqq %%ymm14, %%ymm1, %%ymm3\n\t"                                                  \
+        "vmovmskpd %%ymm2, %%eax\n\t"                                                           \
+        "vmovmskpd %%ymm3, %%edx\n\t"
+#define FILTER_MASK_RANGE                                                                       \
+        "vpsubq %%ymm14, %%ymm0, %%ymm2\n\t"        /* x - lo, sign-flipped */                  \
+        "vpsubq %%ymm14, %%ymm1, %%ymm3\n\t"                                                    \
+        "vpcmpgtq %%ymm15, %%ymm2, %%ymm2\n\t"      /* above hi - lo: outside */                \
+        "vpcmpgtq %%ymm15, %%ymm3, %%ymm3\n\t"                                                  \
+        "vmovmskpd %%ymm2, %%eax\n\t"                                                           \
+        "vmovmskpd %%ymm3, %%edx\n\t"                                                           \
+        "xorl $15, %%eax\n\t"                                                                   \
+        "xorl $15, %%edx\n\t"
+#define FILTER_MASK_BITS                                                                        \
+        "movzbl (%2), %%eax\n\t"                                                                \
+        "incq %2\n\t"                                                                           \
+        "movl %%eax, %%edx\n\t"                                                                 \
+        "andl $15, %%eax\n\t"                                                                   \
+        "shrl $4, %%edx\n\t"
+#define FILTER_STEP_INDEX                                                                       \
+        "vpaddq %%ymm11, %%ymm12, %%ymm12\n\t"                                                  \
+        "vpaddq %%ymm11, %%ymm13, %%ymm13\n\t"
+
+// Filters arr[0..n8), n8 a multiple of 8, and returns the end of the
+// output. SRC0/SRC1 hold what is stored: the elements or their indices.
+#define FILTER_AVX2_DEFINE(name, LOAD, MASK, SRC0, SRC1, STEP)                                  \
+static int64_t* filter_##name##_avx2_loop(const int64_t* arr, size_t n8, const int64_t k[2],     \
+                                          const uint8_t* bits, int64_t* out) {                  \
+    __asm__ volatile (                                                                          \
+        "vpbroadcastq (%4), %%ymm14\n\t"                                                        \
+        "vpbroadcastq 8(%4), %%ymm15\n\t"                                                       \
+        "vmovdqa (%5), %%ymm12\n\t"                 /* Indices of the first vectors */          \
+        "vmovdqa 32(%5), %%ymm13\n\t"                                                           \
+        "vmovdqu 64(%5), %%ymm11\n\t"                                                           \
+        "xorl %%ecx, %%ecx\n\t"                                                                 \
+        "jmp 2f\n\t"                                                                            \
+        "1:\n\t"                                                                                \
+        LOAD                                                                                    \
+        MASK                                                                                    \
+        "popcntl %%eax, %%r8d\n\t"                  /* Elements kept */                         \
+        "popcntl %%edx, %%r9d\n\t"                                                              \
+        "shll $5, %%eax\n\t"                        /* Row of filter_lut */                     \
+        "shll $5, %%edx\n\t"                                                                    \
+        "vmovdqa (%6,%%rax), %%ymm4\n\t"                                                        \
+        "vmovdqa (%6,%%rdx), %%ymm5\n\t"                                                        \
+        "vpermd " SRC0 ", %%ymm4, %%ymm4\n\t"       /* Kept lanes to the front */               \
+        "vpermd " SRC1 ", %%ymm5, %%ymm5\n\t"                                                   \
+        "vmovdqu %%ymm4, (%1)\n\t"                                                              \
+        "leaq (%1,%%r8,8), %1\n\t"                                                              \
+        "vmovdqu %%ymm5, (%1)\n\t"                                                              \
+        "leaq (%1,%%r9,8), %1\n\t"                                                              \
+        STEP                                                                                    \
+        "addq $8, %%rcx\n\t"                                                                    \
+        "2:\n\t"                                                                                \
+        "cmpq %3, %%rcx\n\t"                                                                    \
+        "jb 1b\n\t"                                                                             \
+        "vzeroupper\n\t"                                                                        \
+        : "+r" (arr), "+r" (out), "+r" (bits)                                                   \
+        : "r" (n8), "r" (k), "r" (filter_iota), "r" (filter_lut)                                \
+        : "rax", "rcx", "rdx", "r8", "r9", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",      \
+          "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory", "cc"                           \
+    );                                                                                          \
+    return out;                                                                                 \
+}
+
+FILTER_AVX2_DEFINE(eq_values, FILTER_LOAD, FILTER_MASK_EQ, "%%ymm0", "%%ymm1", "")
+FILTER_AVX2_DEFINE(eq_indices, FILTER_LOAD, FILTER_MASK_EQ, "%%ymm12", "%%ymm13", FILTER_STEP_INDEX)
+FILTER_AVX2_DEFINE(range_values, FILTER_LOAD, FILTER_MASK_RANGE, "%%ymm0", "%%ymm1", "")
+FILTER_AVX2_DEFINE(range_indices, FILTER_LOAD, FILTER_MASK_RANGE, "%%ymm12", "%%ymm13",
+                   FILTER_STEP_INDEX)
+FILTER_AVX2_DEFINE(bits_values, FILTER_LOAD, FILTER_MASK_BITS, "%%ymm0", "%%ymm1", "")
+FILTER_AVX2_DEFINE(bits_indices, "", FILTER_MASK_BITS, "%%ymm12", "%%ymm13", FILTER_STEP_INDEX)
+
+// The vector loop takes whole groups of 8; the scalar kernel the rest
+size_t filter_eq_avx2(const int64_t* arr, size_t n, int64_t value, int64_t* out, int indices) {
+    const int64_t k[2] = { value, 0 };
+    size_t n8 = n & ~(size_t)7;
+    int64_t* end = (indices ? filter_eq_indices_avx2_loop : filter_eq_values_avx2_loop)(
+        arr, n8, k, NULL, out);
+    return (size_t)(end - out) + filter_eq_from(arr, n8, n, value, end, indices);
+}
+
+// Signed compares only: with both sides sign-flipped, x - lo > hi - lo
+// signed is the unsigned compare of the scalar kernel
+size_t filter_range_avx2(const int64_t* arr, size_t n, int64_t lo, int64_t hi, int64_t* out,
+                         int indices) {
+    const int64_t k[2] = { (int64_t)((uint64_t)lo ^ (1ull << 63)),
+                           (int64_t)(((uint64_t)hi - (uint64_t)lo) ^ (1ull << 63)) };
+    size_t n8 = n & ~(size_t)7;
+    int64_t* end = (indices ? filter_range_indices_avx2_loop : filter_range_values_avx2_loop)(
+        arr, n8, k, NULL, out);
+    return (size_t)(end - out) + filter_range_from(arr, n8, n, lo, hi, end, indices);
+}
+
+size_t filter_bits_avx2(const int64_t* arr, const uint64_t* bits, size_t n, int64_t* out, int indices) {
+    const int64_t k[2] = { 0, 0 };
+    size_t n8 = n & ~(size_t)7;
+    int64_t* end = (indices ? filter_bits_indices_avx2_loop : filter_bits_values_avx2_loop)(
+        arr, n8, k, (const uint8_t*)bits, out);
+    return (size_t)(end - out) + filter_bits_from(arr, bits, n8, n, end, indices);
+}
+
+size_t array_filter_eq_asm(const long* arr, size_t count, long value, long* out) {
+    return ASSM_DISPATCH(filter_eq)((const int64_t*)arr, count, value, (int64_t*)out, 0);
+}
+
+size_t array_filter_eq_index_asm(const long* arr, size_t count, long value, size_t* out) {
+    return ASSM_DISPATCH(filter_eq)((const int64_t*)arr, count, value, (int64_t*)out, 1);
+}
+
+size_t array_filter_range_asm(const long* arr, size_t count, long lo, long hi, long* out) {
+    if (lo > hi) return 0;
+    return ASSM_DISPATCH(filter_range)((const int64_t*)arr, count, lo, hi, (int64_t*)out, 0);
+}
+
+size_t array_filter_range_index_asm(const long* arr, size_t count, long lo, long hi, size_t* out) {
+    if (lo > hi) return 0;
+    return ASSM_DISPATCH(filter_range)((const int64_t*)arr, count, lo, hi, (int64_t*)out, 1);
+}
+
+size_t array_filter_bits_asm(const long* arr, const uint64_t* bits, size_t count, long* out) {
+    return ASSM_DISPATCH(filter_bits)((const int64_t*)arr, bits, count, (int64_t*)out, 0);
+}
+
+size_t array_filter_bits_index_asm(const uint64_t* bits, size_t count, size_t* out) {
+    return ASSM_DISPATCH(filter_bits)(NULL, bits, count, (int64_t*)out, 1);
+}
@@ -0,0 +1,410 @@
+// assm_hash.c - CRC32C and a 64-bit multiply/rotate hash for hash table keys
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// CRC32C uses the reflected Castagnoli polynomial, the one SSE4.2's crc32
+// instruction implements. The kernels work on the raw CRC register; the
+// public entry points add the customary pre- and post-inversion.
+//
+// crc32 has a 3-cycle latency and a 1-cycle throughput, so one dependency
+// chain leaves two thirds of the unit idle. crc32c_sse42 splits each block
+// into three equal streams, runs them as independent chains and folds them
+// together with
+//     crc(A B, init) = shift_|B|(crc(A, init)) ^ crc(B, 0)
+// where shift_n appends n zero bytes. shift_n is linear in the register, so
+// for the two block sizes used it is four table lookups; the tables are
+// built on first use from x^(8n) mod P. The sse2 tier uses slicing-by-8:
+// eight independent table lookups per 8-byte word.
+#define CRC32C_POLY 0x82F63B78u
+
+// Bytes per stream. Long blocks make the two folds per block negligible;
+// short ones let inputs from 3 * 256 bytes use all three streams.
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
+struct crc32c_tables {
+    uint32_t slice[8][256];         // slicing-by-8: slice[k][b] = b followed by k zero bytes
+    uint32_t long_shift[4][256];    // shift_CRC32C_LONG, one table per register byte
+    uint32_t short_shift[4][256];   // shift_CRC32C_SHORT
+};
+
+static struct crc32c_tables tables;
+static int tables_ready;
+
+// a * b mod P with polynomials stored reflected (bit 31 is x^0)
+static uint32_t crc32c_multiply(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+
+    for (uint32_t m = 1u << 31; m; m >>= 1) {
+        if (a & m) product ^= b;
+        b = (b >> 1) ^ (CRC32C_POLY & (0u - (b & 1)));
+    }
+    return product;
+}
+
+// x^(8 n) mod P: multiplying a register by it appends n zero bytes
+static uint32_t crc32c_zeros_operator(size_t n) {
+    uint32_t result = 1u << 31, power = 1u << 30;   // x^0, x^1
+
+    for (size_t e = 8 * n; e; e >>= 1) {
+        if (e & 1) result = crc32c_multiply(result, power);
+        power = crc32c_multiply(power, power);
+    }
+    return result;
+}
+
+// table[k][b] = shift of the register b << 8k; built from the 32 single-bit
+// registers since shifting is linear
+static void build_shift_table(uint32_t table[4][256], size_t n) {
+    uint32_t op = crc32c_zeros_operator(n);
+
+    for (int k = 0; k < 4; ++k) {
+        table[k][0] = 0;
+        for (uint32_t b = 1; b < 256; ++b) {
+            uint32_t bit = (uint32_t)__builtin_ctz(b);
+            table[k][b] = table[k][b & (b - 1)] ^ crc32c_multiply(op, 1u << (8 * k + bit));
+        }
+    }
+}
+
+// Built on first use; threads racing here write identical values
+static const struct crc32c_tables* crc32c_tables(void) {
+    if (!__atomic_load_n(&tables_ready, __ATOMIC_ACQUIRE)) {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int i = 0; i < 8; ++i) crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+            tables.slice[0][b] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (uint32_t b = 0; b < 256; ++b) {
+                uint32_t prev = tables.slice[k - 1][b];
+                tables.slice[k][b] = (prev >> 8) ^ tables.slice[0][prev & 0xff];
+            }
+        }
+        build_shift_table(tables.long_shift, CRC32C_LONG);
+        build_shift_table(tables.short_shift, CRC32C_SHORT);
+        __atomic_store_n(&tables_ready, 1, __ATOMIC_RELEASE);
+    }
+    return &tables;
+}
+
+static uint32_t crc32c_shift(const uint32_t table[4][256], uint32_t crc) {
+    return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+           table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+uint32_t crc32c_sw(uint32_t crc, const void* data, size_t n) {
+    uint32_t result;
+
+    __asm__ volatile (
+        "movl %1, %%eax\n\t"                // CRC register
+        "movq %2, %%rsi\n\t"                // Data
+        "movq %3, %%r8\n\t"                 // Length
+        "movq %4, %%rdi\n\t"                // Tables: T0 at 0, T1 at 1024, ... T7 at 7168
+        "cmpq $8, %%r8\n\t"
+        "jb 2f\n\t"
+        "1:\n\t"                            // word_loop: eight independent lookups per 8 bytes
+        "movq (%%rsi), %%rdx\n\t"
+        "xorq %%rax, %%rdx\n\t"             // Fold the CRC into the low 4 bytes
+        "movzbl %%dl, %%ecx\n\t"
+        "movl 7168(%%rdi,%%rcx,4), %%eax\n\t" // Byte 0 is 7 bytes from the end
+        "movzbl %%dh, %%ecx\n\t"
+        "xorl 6144(%%rdi,%%rcx,4), %%eax\n\t"
+        "shrq $16, %%rdx\n\t"
+        "movzbl %%dl, %%ecx\n\t"
+        "xorl 5120(%%rdi,%%rcx,4), %%eax\n\t"
+        "movzbl %%dh, %%ecx\n\t"
+        "xorl 4096(%%rdi,%%rcx,4), %%eax\n\t"
+        "shrq $16, %%rdx\n\t"
+        "movzbl %%dl, %%ecx\n\t"
+        "xorl 3072(%%rdi,%%rcx,4), %%eax\n\t"
+        "movzbl %%dh, %%ecx\n\t"
+        "xorl 2048(%%rdi,%%rcx,4), %%eax\n\t"
+        "shrq $16, %%rdx\n\t"
+        "movzbl %%dl, %%ecx\n\t"
+        "xorl 1024(%%rdi,%%rcx,4), %%eax\n\t"
+        "movzbl %%dh, %%ecx\n\t"
+        "xorl (%%rdi,%%rcx,4), %%eax\n\t"
+        "addq $8, %%rsi\n\t"
+        "subq $8, %%r8\n\t"
+        "cmpq $8, %%r8\n\t"
+        "jae 1b\n\t"
+        "2:\n\t"                            // byte_tail: T0[(crc ^ byte) & 0xff] ^ (crc >> 8)
+        "testq %%r8, %%r8\n\t"
+        "jz 9f\n\t"
+        "3:\n\t"
+        "movzbl (%%rsi), %%ecx\n\t"
+        "xorb %%al, %%cl\n\t"
+        "shrl $8, %%eax\n\t"
+        "xorl (%%rdi,%%rcx,4), %%eax\n\t"
+        "addq $1, %%rsi\n\t"
+        "subq $1, %%r8\n\t"
+        "jnz 3b\n\t"
+        "9:\n\t"
+        : "=&a" (result)
+        : "r" (crc), "r" (data), "r" (n), "r" (&crc32c_tables()->slice[0][0])
+        : "rcx", "rdx", "rsi", "rdi", "r8", "memory"
+    );
+
+    return result;
+}
+
+uint32_t crc32c_serial_sse42(uint32_t crc, const void* data, size_t n) {
+    uint32_t result;
+
+    __asm__ volatile (
+        "movl %1, %%eax\n\t"                // CRC register
+        "movq %2, %%rsi\n\t"                // Data
+        "movq %3, %%rcx\n\t"                // Length
+        "cmpq $8, %%rcx\n\t"
+        "jb 2f\n\t"
+        "1:\n\t"                            // word_loop: one crc32q per 8 bytes
+        "crc32q (%%rsi), %%rax\n\t"         // 3-cycle latency, one chain
+        "addq $8, %%rsi\n\t"
+        "subq $8, %%rcx\n\t"
+        "cmpq $8, %%rcx\n\t"
+        "jae 1b\n\t"
+        "2:\n\t"                            // byte_tail
+        "testq %%rcx, %%rcx\n\t"
+        "jz 9f\n\t"
+        "3:\n\t"
+        "crc32b (%%rsi), %%eax\n\t"
+        "addq $1, %%rsi\n\t"
+        "subq $1, %%rcx\n\t"
+        "jnz 3b\n\t"
+        "9:\n\t"
+        : "=&a" (result)
+        : "r" (crc), "r" (data), "r" (n)
+        : "rcx", "rsi", "memory"
+    );
+
+    return result;
+}
+
+// Three streams of block bytes each, starting at data, data + block and
+// data + 2 * block; stream 0 continues crc, the others start from zero
+static void crc32c_three_streams(uint32_t crc, const void* data, size_t block, uint32_t out[3]) {
+    __asm__ volatile (
+        "movl %0, %%eax\n\t"                // Stream 0 continues the CRC
+        "xorl %%edx, %%edx\n\t"             // Streams 1 and 2 start from zero
+        "xorl %%ecx, %%ecx\n\t"
+        "movq %1, %%rsi\n\t"                // Stream 0 data
+        "movq %2, %%rdi\n\t"                // Block length (a multiple of 8)
+        "leaq (%%rsi,%%rdi), %%r8\n\t"      // End of stream 0
+        "leaq (%%rdi,%%rdi), %%r9\n\t"      // Offset of stream 2
+        "1:\n\t"                            // stripe_loop: three independent chains
+        "crc32q (%%rsi), %%rax\n\t"
+        "crc32q (%%rsi,%%rdi), %%rdx\n\t"
+        "crc32q (%%rsi,%%r9), %%rcx\n\t"
+        "addq $8, %%rsi\n\t"
+        "cmpq %%r8, %%rsi\n\t"
+        "jb 1b\n\t"
+        "movl %%eax, (%3)\n\t"              // Stream CRCs for the caller to combine
+        "movl %%edx, 4(%3)\n\t"
+        "movl %%ecx, 8(%3)\n\t"
+        :
+        : "r" (crc), "r" (data), "r" (block), "r" (out)
+        : "rax", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "memory"
+    );
+}
+
+uint32_t crc32c_sse42(uint32_t crc, const void* data, size_t n) {
+    const unsigned char* p = data;
+    uint32_t streams[3];
+
+    if (n >= 3 * CRC32C_SHORT) {
+        const struct crc32c_tables* t = crc32c_tables();
+        for (; n >= 3 * CRC32C_LONG; p += 3 * CRC32C_LONG, n -= 3 * CRC32C_LONG) {
+            crc32c_three_streams(crc, p, CRC32C_LONG, streams);
+            crc = crc32c_shift(t->long_shift, streams[0]) ^ streams[1];
+            crc = crc32c_shift(t->long_shift, crc) ^ streams[2];
+        }
+        for (; n >= 3 * CRC32C_SHORT; p += 3 * CRC32C_SHORT, n -= 3 * CRC32C_SHORT) {
+            crc32c_three_streams(crc, p, CRC32C_SHORT, streams);
+            crc = crc32c_shift(t->short_shift, streams[0]) ^ streams[1];
+            crc = crc32c_shift(t->short_shift, crc) ^ streams[2];
+        }
+    }
+    return crc32c_serial_sse42(crc, p, n);
+}
+
+uint32_t assm_crc32c_update(uint32_t crc, const void* data, size_t n) {
+    return ~ASSM_DISPATCH(crc32c)(~crc, data, n);
+}
+
+uint32_t assm_crc32c(const void* data, size_t n) {
+    return assm_crc32c_update(0, data, n);
+}
+
+// The 64-bit hash is XXH64: four accumulators each take one 8-byte word of
+// every 32-byte stripe as acc = rotl(acc + word * P2, 31) * P1, so the four
+// multiply chains overlap. The accumulators are then merged and the tail
+// (under 32 bytes) mixed in 8, 4 and 1 bytes at a time, and a final
+// xorshift-multiply avalanche spreads every input bit over the output.
+#define HASH64_P1 0x9E3779B185EBCA87ull
+#define HASH64_P2 0xC2B2AE3D27D4EB4Full
+#define HASH64_P3 0x165667B19E3779F9ull
+#define HASH64_P4 0x85EBCA77C2B2AE63ull
+#define HASH64_P5 0x27D4EB2F165667C5ull
+
+// rotate_left_asm without the call and the memory round trip; constant
+// counts become an immediate
+static inline uint64_t rotl64(uint64_t value, int positions) {
+    __asm__ ("rolq %b1, %0" : "+r" (value) : "cJ" (positions));
+    return value;
+}
+
+static inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    __builtin_memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char* p) {
+    uint32_t v;
+    __builtin_memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t hash64_round(uint64_t acc, uint64_t word) {
+    return rotl64(acc + word * HASH64_P2, 31) * HASH64_P1;
+}
+
+static void hash64_stripes(uint64_t acc[4], const void* data, size_t stripes) {
+    __asm__ volatile (
+        "movq %0, %%rax\n\t"                // Accumulators
+        "movq (%%rax), %%r8\n\t"
+        "movq 8(%%rax), %%r9\n\t"
+        "movq 16(%%rax), %%r10\n\t"
+        "movq 24(%%rax), %%r11\n\t"
+        "movq %1, %%rsi\n\t"                // Data
+        "movq %2, %%rax\n\t"                // End of the last stripe
+        "shlq $5, %%rax\n\t"
+        "addq %%rsi, %%rax\n\t"
+        "movabsq $0x9E3779B185EBCA87, %%rdx\n\t" // P1
+        "movabsq $0xC2B2AE3D27D4EB4F, %%rdi\n\t" // P2
+        "1:\n\t"                            // stripe_loop: acc = rotl(acc + word * P2, 31) * P1
+        "movq (%%rsi), %%rcx\n\t"
+        "imulq %%rdi, %%rcx\n\t"            // input * P2
+        "addq %%rcx, %%r8\n\t"
+        "rolq $31, %%r8\n\t"
+        "imulq %%rdx, %%r8\n\t"             // * P1
+        "movq 8(%%rsi), %%rcx\n\t"
+        "imulq %%rdi, %%rcx\n\t"            // input * P2
+        "addq %%rcx, %%r9\n\t"
+        "rolq $31, %%r9\n\t"
+        "imulq %%rdx, %%r9\n\t"             // * P1
+        "movq 16(%%rsi), %%rcx\n\t"
+        "imulq %%rdi, %%rcx\n\t"            // input * P2
+        "addq %%rcx, %%r10\n\t"
+        "rolq $31, %%r10\n\t"
+        "imulq %%rdx, %%r10\n\t"            // * P1
+        "movq 24(%%rsi), %%rcx\n\t"
+        "imulq %%rdi, %%rcx\n\t"            // input * P2
+        "addq %%rcx, %%r11\n\t"
+        "rolq $31, %%r11\n\t"
+        "imulq %%rdx, %%r11\n\t"            // * P1
+        "addq $32, %%rsi\n\t"
+        "cmpq %%rax, %%rsi\n\t"
+        "jb 1b\n\t"
+        "movq %0, %%rax\n\t"
+        "movq %%r8, (%%rax)\n\t"
+        "movq %%r9, 8(%%rax)\n\t"
+        "movq %%r10, 16(%%rax)\n\t"
+        "movq %%r11, 24(%%rax)\n\t"
+        :
+        : "r" (acc), "r" (data), "r" (stripes)
+        : "rax", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r10", "r11", "memory"
+    );
+}
+
+static void hash64_start(uint64_t acc[4], uint64_t seed) {
+    acc[0] = seed + HASH64_P1 + HASH64_P2;
+    acc[1] = seed + HASH64_P2;
+    acc[2] = seed;
+    acc[3] = seed - HASH64_P1;
+}
+
+static uint64_t hash64_merge(const uint64_t acc[4]) {
+    uint64_t h = rotl64(acc[0], 1) + rotl64(acc[1], 7) + rotl64(acc[2], 12) + rotl64(acc[3], 18);
+
+    for (int i = 0; i < 4; ++i) {
+        h ^= hash64_round(0, acc[i]);
+        h = h * HASH64_P1 + HASH64_P4;
+    }
+    return h;
+}
+
+// Mixes in the last n < 32 bytes and avalanches
+static uint64_t hash64_finish(uint64_t h, const unsigned char* p, size_t n) {
+    for (; n >= 8; p += 8, n -= 8) {
+        h ^= hash64_round(0, read64(p));
+        h = rotl64(h, 27) * HASH64_P1 + HASH64_P4;
+    }
+    if (n >= 4) {
+        h ^= read32(p) * HASH64_P1;
+        h = rotl64(h, 23) * HASH64_P2 + HASH64_P3;
+        p += 4;
+        n -= 4;
+    }
+    for (; n; ++p, --n) {
+        h ^= *p * HASH64_P5;
+        h = rotl64(h, 11) * HASH64_P1;
+    }
+    h ^= h >> 33;
+    h *= HASH64_P2;
+    h ^= h >> 29;
+    h *= HASH64_P3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t assm_hash64(const void* data, size_t n, uint64_t seed) {
+    const unsigned char* p = data;
+    uint64_t h;
+
+    if (n >= 32) {
+        uint64_t acc[4];
+        hash64_start(acc, seed);
+        hash64_stripes(acc, p, n / 32);
+        h = hash64_merge(acc);
+    } else {
+        h = seed + HASH64_P5;
+    }
+    return hash64_finish(h + n, p + (n & ~(size_t)31), n & 31);
+}
+
+void assm_hash64_init(struct assm_hash64_state* state, uint64_t seed) {
+    hash64_start(state->acc, seed);
+    state->seed = seed;
+    state->total = 0;
+    state->buffered = 0;
+}
+
+void assm_hash64_update(struct assm_hash64_state* state, const void* data, size_t n) {
+    const unsigned char* p = data;
+
+    state->total += n;
+    if (state->buffered) {
+        size_t take = 32 - state->buffered < n ? 32 - state->buffered : n;
+        memcpy_asm(state->buffer + state->buffered, p, take);
+        state->buffered += take;
+        p += take;
+        n -= take;
+        if (state->buffered < 32) return;
+        hash64_stripes(state->acc, state->buffer, 1);
+        state->buffered = 0;
+    }
+    if (n >= 32) {
+        hash64_stripes(state->acc, p, n / 32);
+        p += n & ~(size_t)31;
+        n &= 31;
+    }
+    memcpy_asm(state->buffer, p, n);
+    state->buffered = n;
+}
+
+uint64_t assm_hash64_final(const struct assm_hash64_state* state) {
+    uint64_t h = state->total >= 32 ? hash64_merge(state->acc) : state->seed + HASH64_P5;
+    return hash64_finish(h + state->total, state->buffer, state->buffered);
+}
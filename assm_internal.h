@@ -0,0 +1,334 @@
+// assm_internal.h - Dispatch table and tier-specific kernel implementations
+//
+// Not part of the public interface: callers use the dispatched entry points
+// in assm_kernels.h. The benchmark suite includes this header to compare the
+// individual implementations against each other.
+#ifndef ASSM_INTERNAL_H
+#define ASSM_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct assm_minmax_i32;
+struct assm_minmax_i64;
+struct assm_minmax_f32;
+struct assm_minmax_f64;
+struct assm_minmax_i8;
+struct assm_minmax_i16;
+struct assm_minmax_u64;
+struct assm_matrix_f32;
+struct assm_matrix_i32;
+
+// One slot per dispatched kernel. Every slot starts at a resolver stub that
+// fills the whole table on first use and then forwards the call.
+struct assm_dispatch_table {
+    size_t (*strlen)(const char* str);
+    size_t (*strnlen)(const char* str, size_t maxlen);
+    size_t (*strcpy_bounded)(char* dest, const char* src, size_t n);
+    void*  (*memcpy)(void* dest, const void* src, size_t n);
+    void*  (*memmove)(void* dest, const void* src, size_t n);
+    int    (*memcmp)(const void* ptr1, const void* ptr2, size_t num);
+    size_t (*memcmp_mismatch)(const void* ptr1, const void* ptr2, size_t num);
+    size_t (*memchr)(const void* ptr, int c, size_t n);
+    size_t (*memchr2)(const void* ptr, int c1, int c2, size_t n);
+    size_t (*memchr3)(const void* ptr, int c1, int c2, int c3, size_t n);
+    size_t (*memrchr)(const void* ptr, int c, size_t n);
+    size_t (*strchr)(const char* str, int c);
+    size_t (*memmem_scan)(const void* hay, size_t pos, size_t limit, int first, int last,
+                          size_t gap, uint32_t* mask);
+    size_t (*teddy_scan)(const uint8_t* masks, const void* text, size_t pos, size_t limit,
+                         uint32_t* mask, uint8_t* buckets);
+    uint32_t (*crc32c)(uint32_t crc, const void* data, size_t n);
+    size_t (*utf8_scan)(const void* data, size_t pos, size_t n, size_t* count);
+    long  (*array_sum)(const long* arr, size_t count);
+    __int128 (*array_sum_wide)(const long* arr, size_t count);
+    size_t (*array_search)(const long* arr, size_t count, long target);
+    void  (*minmax_i32)(const int32_t* arr, size_t count, struct assm_minmax_i32* result);
+    void  (*minmax_i64)(const int64_t* arr, size_t count, struct assm_minmax_i64* result);
+    void  (*minmax_f32)(const float* arr, size_t count, struct assm_minmax_f32* result);
+    void  (*minmax_f64)(const double* arr, size_t count, struct assm_minmax_f64* result);
+    int64_t (*sum_i8)(const int8_t* arr, size_t count);
+    int64_t (*sum_i16)(const int16_t* arr, size_t count);
+    int64_t (*sum_i32)(const int32_t* arr, size_t count);
+    double (*sum_f32)(const float* arr, size_t count);
+    double (*sum_f64)(const double* arr, size_t count);
+    size_t (*search_i8)(const int8_t* arr, size_t count, int8_t target);
+    size_t (*search_i16)(const int16_t* arr, size_t count, int16_t target);
+    size_t (*search_i32)(const int32_t* arr, size_t count, int32_t target);
+    size_t (*search_f32)(const float* arr, size_t count, float target);
+    size_t (*search_f64)(const double* arr, size_t count, double target);
+    void  (*minmax_i8)(const int8_t* arr, size_t count, struct assm_minmax_i8* result);
+    void  (*minmax_i16)(const int16_t* arr, size_t count, struct assm_minmax_i16* result);
+    void  (*minmax_u64)(const uint64_t* arr, size_t count, struct assm_minmax_u64* result);
+    void  (*transpose32_tile)(const void* src, size_t src_stride, void* dst, size_t dst_stride);
+    void  (*gemm_f32_kernel)(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+    void  (*gemm_i32_kernel)(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+    void  (*matrix_add_row_f32)(float* sums, const float* row, size_t n);
+    void  (*matrix_add_row_i32)(int64_t* sums, const int32_t* row, size_t n);
+    float (*matrix_row_sum_f32)(const float* row, size_t n);
+    int64_t (*matrix_row_sum_i32)(const int32_t* row, size_t n);
+    size_t (*morton_index)(size_t row, size_t col);
+    void  (*matrix_gather)(const long* matrix, size_t cols, const size_t* rows,
+                           const size_t* col_idx, size_t n, long* out, size_t distance);
+    int64_t (*scan_i64)(int64_t* dst, const int64_t* src, size_t n, int64_t carry, int64_t mask);
+    int32_t (*scan_i32)(int32_t* dst, const int32_t* src, size_t n, int32_t carry, int64_t mask);
+    void  (*sort_blocks_i64)(int64_t* keys, size_t blocks);
+    void  (*sort_blocks_i32)(int32_t* keys, size_t blocks);
+    void  (*sort_merge_i64)(const int64_t* a, const int64_t* a_end, const int64_t* b,
+                            const int64_t* b_end, int64_t* out);
+    void  (*sort_merge_i32)(const int32_t* a, const int32_t* a_end, const int32_t* b,
+                            const int32_t* b_end, int32_t* out);
+    size_t (*filter_eq)(const int64_t* arr, size_t n, int64_t value, int64_t* out, int indices);
+    size_t (*filter_range)(const int64_t* arr, size_t n, int64_t lo, int64_t hi, int64_t* out,
+                           int indices);
+    size_t (*filter_bits)(const int64_t* arr, const uint64_t* bits, size_t n, int64_t* out,
+                          int indices);
+    int   (*popcount)(uint64_t value);
+    uint64_t (*popcount_buffer)(const void* data, size_t n);
+    float (*dot_product)(const float* a, const float* b, int count);
+};
+
+extern struct assm_dispatch_table assm_dispatch;
+
+// Loads a slot; resolution may race with another thread's first call, but
+// both store the same pointer
+#define ASSM_DISPATCH(slot) __atomic_load_n(&assm_dispatch.slot, __ATOMIC_RELAXED)
+
+// Detected tier lowered by ASSM_CPU_TIER (assm_cpu.c)
+int assm_cpu_default_tier(void);
+
+// Strings (assm_string.c)
+size_t strlen_scasb(const char* str);           // repne scasb reference
+size_t strlen_sse2(const char* str);
+size_t strlen_avx2(const char* str);
+size_t strnlen_sse2(const char* str, size_t maxlen);
+size_t strnlen_avx2(const char* str, size_t maxlen);
+void strcpy_lodsb(char* dest, const char* src);                     // lodsb/stosb reference
+// Copies min(strlen(src), n) bytes and a terminator; returns the count copied
+size_t strcpy_bounded_sse2(char* dest, const char* src, size_t n);
+size_t strcpy_bounded_avx2(char* dest, const char* src, size_t n);
+int memcmp_cmpsb(const void* ptr1, const void* ptr2, size_t num);   // repe cmpsb reference
+int memcmp_sse2(const void* ptr1, const void* ptr2, size_t num);
+int memcmp_avx2(const void* ptr1, const void* ptr2, size_t num);
+size_t memcmp_mismatch_sse2(const void* ptr1, const void* ptr2, size_t num);
+size_t memcmp_mismatch_avx2(const void* ptr1, const void* ptr2, size_t num);
+// Index of the first (memrchr: last) byte equal to a needle, or n if none
+size_t memchr_index_sse2(const void* ptr, int c, size_t n);
+size_t memchr_index_avx2(const void* ptr, int c, size_t n);
+size_t memchr2_index_sse2(const void* ptr, int c1, int c2, size_t n);
+size_t memchr2_index_avx2(const void* ptr, int c1, int c2, size_t n);
+size_t memchr3_index_sse2(const void* ptr, int c1, int c2, int c3, size_t n);
+size_t memchr3_index_avx2(const void* ptr, int c1, int c2, int c3, size_t n);
+size_t memrchr_index_sse2(const void* ptr, int c, size_t n);
+size_t memrchr_index_avx2(const void* ptr, int c, size_t n);
+// Index of the first byte equal to (char)c or to the terminator
+size_t strchr_index_sse2(const char* str, int c);
+size_t strchr_index_avx2(const char* str, int c);
+
+// Substring search (assm_search.c): first block at or after pos holding a
+// position p < limit with hay[p] == first and hay[p + gap] == last
+size_t memmem_scan_sse2(const void* hay, size_t pos, size_t limit, int first, int last,
+                        size_t gap, uint32_t* mask);
+size_t memmem_scan_avx2(const void* hay, size_t pos, size_t limit, int first, int last,
+                        size_t gap, uint32_t* mask);
+
+// Multi-pattern matching (assm_search.c). The Teddy block scan needs pshufb,
+// so the sse2 tier matches with the automaton alone.
+size_t teddy_scan_ssse3(const uint8_t* masks, const void* text, size_t pos, size_t limit,
+                        uint32_t* mask, uint8_t* buckets);
+size_t teddy_scan_avx2(const uint8_t* masks, const void* text, size_t pos, size_t limit,
+                       uint32_t* mask, uint8_t* buckets);
+// allow_teddy = 0 builds an automaton-only matcher
+struct assm_matcher* assm_matcher_create_with(const char* const* patterns, const size_t* lengths,
+                                              size_t count, int allow_teddy);
+
+// UTF-8 (assm_utf8.c): from pos, the offset of the first full block
+// (16 or 32 bytes) the kernel cannot accept, or of the unscanned tail; the
+// code points in the accepted blocks go to *count. The sse2 kernel accepts
+// only ASCII blocks.
+typedef size_t (*utf8_scan_fn)(const void* data, size_t pos, size_t n, size_t* count);
+size_t utf8_scan_sse2(const void* data, size_t pos, size_t n, size_t* count);
+size_t utf8_scan_sse42(const void* data, size_t pos, size_t n, size_t* count);
+size_t utf8_scan_avx2(const void* data, size_t pos, size_t n, size_t* count);
+// assm_utf8_validate_count with a given kernel; count may be NULL
+size_t utf8_validate_with(utf8_scan_fn scan, const void* data, size_t n, size_t* count);
+
+// Hashing (assm_hash.c): CRC32C on the raw register, no pre/post inversion
+uint32_t crc32c_sw(uint32_t crc, const void* data, size_t n);           // slicing-by-8 tables
+uint32_t crc32c_serial_sse42(uint32_t crc, const void* data, size_t n); // one crc32 chain
+uint32_t crc32c_sse42(uint32_t crc, const void* data, size_t n);        // three interleaved chains
+
+// Memory copy (assm_memcpy.c). memcpy_{sse2,avx2} pick a size class; the
+// others use one strategy for every size above the small classes.
+void* memcpy_sse2(void* dest, const void* src, size_t n);
+void* memcpy_avx2(void* dest, const void* src, size_t n);
+void* memmove_sse2(void* dest, const void* src, size_t n);
+void* memmove_avx2(void* dest, const void* src, size_t n);
+void* memcpy_loop_sse2(void* dest, const void* src, size_t n);     // vector loop only
+void* memcpy_loop_avx2(void* dest, const void* src, size_t n);
+void* memcpy_stream_sse2(void* dest, const void* src, size_t n);   // non-temporal stores
+void* memcpy_stream_avx2(void* dest, const void* src, size_t n);
+void* memcpy_erms(void* dest, const void* src, size_t n);          // rep movsb only
+
+// Arrays (assm_array.c)
+long array_sum_loop(const long* arr, size_t count);         // one addq chain reference
+long array_sum_sse2(const long* arr, size_t count);
+long array_sum_avx2(const long* arr, size_t count);
+// Exact 128-bit sums behind array_sum_checked_asm
+__int128 array_sum_wide_sse2(const long* arr, size_t count);    // addq/adcq
+__int128 array_sum_wide_avx2(const long* arr, size_t count);
+size_t array_search_loop(const long* arr, size_t count, long target);   // one cmpq per element
+size_t array_search_sse2(const long* arr, size_t count, long target);
+size_t array_search_avx2(const long* arr, size_t count, long target);
+// array_minmax_*_asm: a cmp/branch loop, and the blend kernel
+void array_minmax_i32_scalar(const int32_t* arr, size_t count, struct assm_minmax_i32* result);
+void array_minmax_i32_avx2(const int32_t* arr, size_t count, struct assm_minmax_i32* result);
+void array_minmax_i64_scalar(const int64_t* arr, size_t count, struct assm_minmax_i64* result);
+void array_minmax_i64_avx2(const int64_t* arr, size_t count, struct assm_minmax_i64* result);
+void array_minmax_f32_scalar(const float* arr, size_t count, struct assm_minmax_f32* result);
+void array_minmax_f32_avx2(const float* arr, size_t count, struct assm_minmax_f32* result);
+void array_minmax_f64_scalar(const double* arr, size_t count, struct assm_minmax_f64* result);
+void array_minmax_f64_avx2(const double* arr, size_t count, struct assm_minmax_f64* result);
+// Typed sums, searches and min/max (assm_array.hpp): a C loop, and the
+// kernel generated for the type
+int64_t array_sum_i8_scalar(const int8_t* arr, size_t count);
+int64_t array_sum_i8_avx2(const int8_t* arr, size_t count);
+int64_t array_sum_i16_scalar(const int16_t* arr, size_t count);
+int64_t array_sum_i16_avx2(const int16_t* arr, size_t count);
+int64_t array_sum_i32_scalar(const int32_t* arr, size_t count);
+int64_t array_sum_i32_avx2(const int32_t* arr, size_t count);
+double array_sum_f32_scalar(const float* arr, size_t count);
+double array_sum_f32_avx2(const float* arr, size_t count);
+double array_sum_f64_scalar(const double* arr, size_t count);
+double array_sum_f64_avx2(const double* arr, size_t count);
+size_t array_search_i8_scalar(const int8_t* arr, size_t count, int8_t target);
+size_t array_search_i8_avx2(const int8_t* arr, size_t count, int8_t target);
+size_t array_search_i16_scalar(const int16_t* arr, size_t count, int16_t target);
+size_t array_search_i16_avx2(const int16_t* arr, size_t count, int16_t target);
+size_t array_search_i32_scalar(const int32_t* arr, size_t count, int32_t target);
+size_t array_search_i32_avx2(const int32_t* arr, size_t count, int32_t target);
+size_t array_search_f32_scalar(const float* arr, size_t count, float target);
+size_t array_search_f32_avx2(const float* arr, size_t count, float target);
+size_t array_search_f64_scalar(const double* arr, size_t count, double target);
+size_t array_search_f64_avx2(const double* arr, size_t count, double target);
+void array_minmax_i8_scalar(const int8_t* arr, size_t count, struct assm_minmax_i8* result);
+void array_minmax_i8_avx2(const int8_t* arr, size_t count, struct assm_minmax_i8* result);
+void array_minmax_i16_scalar(const int16_t* arr, size_t count, struct assm_minmax_i16* result);
+void array_minmax_i16_avx2(const int16_t* arr, size_t count, struct assm_minmax_i16* result);
+void array_minmax_u64_scalar(const uint64_t* arr, size_t count, struct assm_minmax_u64* result);
+void array_minmax_u64_avx2(const uint64_t* arr, size_t count, struct assm_minmax_u64* result);
+
+// Matrices (assm_matrix.c). Strides are in elements. A tile kernel
+// transposes one 8x8 block of 32-bit elements.
+typedef void (*transpose_tile_fn)(const void* src, size_t src_stride, void* dst, size_t dst_stride);
+void transpose32_tile_sse2(const void* src, size_t src_stride, void* dst, size_t dst_stride);
+void transpose32_tile_avx2(const void* src, size_t src_stride, void* dst, size_t dst_stride);
+void matrix_transpose32_with(transpose_tile_fn tile, void* dst, size_t dst_stride, const void* src,
+                             size_t src_stride, size_t rows, size_t cols);
+// GEMM micro-kernels: the 6x16 tile at c += a 6-row panel of A times a
+// 16-column panel of B, both packed kc steps deep
+typedef void (*gemm_kernel_fn)(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+void gemm_f32_kernel_sse2(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+void gemm_f32_kernel_avx2(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+void gemm_i32_kernel_scalar(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+void gemm_i32_kernel_sse41(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+void gemm_i32_kernel_avx2(size_t kc, const void* a, const void* b, void* c, size_t c_stride);
+// assm_matrix_multiply_* with a given micro-kernel
+int matrix_multiply_f32_with(gemm_kernel_fn kernel, struct assm_matrix_f32 c,
+                             struct assm_matrix_f32 a, struct assm_matrix_f32 b);
+int matrix_multiply_i32_with(gemm_kernel_fn kernel, struct assm_matrix_i32 c,
+                             struct assm_matrix_i32 a, struct assm_matrix_i32 b);
+// sums[0..n) += row[0..n), and the sum of one row
+void matrix_add_row_f32_sse2(float* sums, const float* row, size_t n);
+void matrix_add_row_f32_avx2(float* sums, const float* row, size_t n);
+void matrix_add_row_i32_sse2(int64_t* sums, const int32_t* row, size_t n);
+void matrix_add_row_i32_avx2(int64_t* sums, const int32_t* row, size_t n);
+float matrix_row_sum_f32_sse2(const float* row, size_t n);
+float matrix_row_sum_f32_avx2(const float* row, size_t n);
+int64_t matrix_row_sum_i32_sse2(const int32_t* row, size_t n);
+int64_t matrix_row_sum_i32_avx2(const int32_t* row, size_t n);
+// Z-order index: two pdep, or spreading each coordinate with shifts and masks
+size_t matrix_morton_index_bmi2(size_t row, size_t col);
+size_t matrix_morton_index_shift(size_t row, size_t col);
+// matrix_get_batch_asm: imul and a load per lookup, or vpgatherqq
+void matrix_gather_scalar(const long* matrix, size_t cols, const size_t* rows, const size_t* col_idx,
+                          size_t n, long* out, size_t distance);
+void matrix_gather_avx2(const long* matrix, size_t cols, const size_t* rows, const size_t* col_idx,
+                        size_t n, long* out, size_t distance);
+
+// Prefix sums (assm_scan.c): dst[0..n) = scan of src[0..n) starting from
+// carry; returns carry plus the sum of src. mask is 0 for an inclusive
+// scan and -1 for an exclusive one.
+int64_t scan_i64_sse2(int64_t* dst, const int64_t* src, size_t n, int64_t carry, int64_t mask);
+int64_t scan_i64_avx2(int64_t* dst, const int64_t* src, size_t n, int64_t carry, int64_t mask);
+int32_t scan_i32_sse2(int32_t* dst, const int32_t* src, size_t n, int32_t carry, int64_t mask);
+int32_t scan_i32_avx2(int32_t* dst, const int32_t* src, size_t n, int32_t carry, int64_t mask);
+
+// Sorting (assm_sort.c). sort_blocks_* sorts each block of SORT_BLOCK_*
+// keys in place; sort_merge_* merges two sorted runs of whole blocks into
+// out, reading one key past the end of each run. sort_small_* sorts up to
+// SORT_SMALL_MAX_* keys with them, sort_radix any count with the LSD radix
+// sort (keys int64 if wide, else int32; payload may be NULL).
+#define SORT_BLOCK_I64 16
+#define SORT_BLOCK_I32 64
+#define SORT_SMALL_MAX_I64 1024
+#define SORT_SMALL_MAX_I32 2048
+void sort_blocks_i64_scalar(int64_t* keys, size_t blocks);
+void sort_blocks_i64_avx2(int64_t* keys, size_t blocks);
+void sort_blocks_i32_scalar(int32_t* keys, size_t blocks);
+void sort_blocks_i32_avx2(int32_t* keys, size_t blocks);
+void sort_merge_i64_scalar(const int64_t* a, const int64_t* a_end, const int64_t* b,
+                           const int64_t* b_end, int64_t* out);
+void sort_merge_i64_avx2(const int64_t* a, const int64_t* a_end, const int64_t* b,
+                         const int64_t* b_end, int64_t* out);
+void sort_merge_i32_scalar(const int32_t* a, const int32_t* a_end, const int32_t* b,
+                           const int32_t* b_end, int32_t* out);
+void sort_merge_i32_avx2(const int32_t* a, const int32_t* a_end, const int32_t* b,
+                         const int32_t* b_end, int32_t* out);
+void sort_small_i64(int64_t* keys, size_t n);
+void sort_small_i32(int32_t* keys, size_t n);
+int sort_radix(void* keys, void* payload, size_t n, int wide);
+
+// Filters (assm_filter.c): store arr[i], or i if indices, for every i < n
+// that passes, in order, and return how many. out[kept..n) may be
+// overwritten. filter_range needs lo <= hi; filter_bits with indices does
+// not read arr.
+size_t filter_eq_scalar(const int64_t* arr, size_t n, int64_t value, int64_t* out, int indices);
+size_t filter_eq_avx2(const int64_t* arr, size_t n, int64_t value, int64_t* out, int indices);
+size_t filter_range_scalar(const int64_t* arr, size_t n, int64_t lo, int64_t hi, int64_t* out,
+                           int indices);
+size_t filter_range_avx2(const int64_t* arr, size_t n, int64_t lo, int64_t hi, int64_t* out,
+                         int indices);
+size_t filter_bits_scalar(const int64_t* arr, const uint64_t* bits, size_t n, int64_t* out,
+                          int indices);
+size_t filter_bits_avx2(const int64_t* arr, const uint64_t* bits, size_t n, int64_t* out, int indices);
+
+// Thread pool (assm_parallel.c). parallel_run calls fn(ctx, i, count) for
+// every i in [0, count), i == 0 on the calling thread and the rest on pool
+// workers, and returns when all have finished; called from inside a job it
+// runs them inline. parallel_threads is the count to split a job into:
+// requested (0 for all) capped at the pool size, or 1 inside a job.
+typedef void (*parallel_fn)(void* ctx, unsigned index, unsigned count);
+unsigned parallel_threads(unsigned requested);
+void parallel_run(parallel_fn fn, void* ctx, unsigned count);
+
+// Bit manipulation (assm_bits.c)
+int popcount_loop(uint64_t value);              // sse2: clear lowest bit per iteration
+int popcount_popcnt(uint64_t value);            // sse42: popcnt instruction
+uint64_t popcount_buffer_swar(const void* data, size_t n);     // sse2: SWAR bit sums
+uint64_t popcount_buffer_popcnt(const void* data, size_t n);   // sse42: four popcnt chains
+uint64_t popcount_buffer_avx2(const void* data, size_t n);     // avx2: Harley-Seal + vpshufb
+
+// SSE floating point (assm_sse.c)
+float dot_product_sse2(const float* a, const float* b, int count);
+float dot_product_avx2(const float* a, const float* b, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASSM_INTERNAL_H
@@ -0,0 +1,552 @@
+// assm_kernels.h - Public interface for the assembly kernel library
+//
+// Every *_asm / *_sse kernel from the tutorials lives in libassmkernels
+// (static: libassmkernels.a, shared: libassmkernels.so). The tutorial
+// programs are thin demos linked against this library.
+//
+//   gcc -O2 -pthread -o app app.c -L. -lassmkernels
+#ifndef ASSM_KERNELS_H
+#define ASSM_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---------------------------------------------------------------------------
+// CPU features and kernel dispatch - assm_cpu.c, assm_dispatch.c
+//
+// Kernels with several implementations resolve on first use to the best
+// one for the highest tier this CPU supports. Set ASSM_CPU_TIER=sse2,
+// sse42 or avx2 in the environment to force a lower tier.
+// ---------------------------------------------------------------------------
+
+#define ASSM_CPU_TIER_ENV "ASSM_CPU_TIER"
+
+// Dispatch tiers, ordered: each one implies everything below it
+enum {
+    ASSM_TIER_SSE2 = 0,     // x86-64 baseline
+    ASSM_TIER_SSE42 = 1,    // + SSSE3, SSE4.1, SSE4.2, POPCNT
+    ASSM_TIER_AVX2 = 2      // + AVX, AVX2, FMA, BMI1, BMI2
+};
+
+// Feature bits returned by assm_cpu_features()
+enum {
+    ASSM_CPU_SSE2   = 1u << 0,
+    ASSM_CPU_SSE3   = 1u << 1,
+    ASSM_CPU_SSSE3  = 1u << 2,
+    ASSM_CPU_SSE41  = 1u << 3,
+    ASSM_CPU_SSE42  = 1u << 4,
+    ASSM_CPU_POPCNT = 1u << 5,
+    ASSM_CPU_AVX    = 1u << 6,      // includes OS support for YMM state
+    ASSM_CPU_AVX2   = 1u << 7,
+    ASSM_CPU_FMA    = 1u << 8,
+    ASSM_CPU_BMI1   = 1u << 9,
+    ASSM_CPU_BMI2   = 1u << 10,
+    ASSM_CPU_ERMS   = 1u << 11,     // enhanced rep movsb/stosb
+    ASSM_CPU_FSRM   = 1u << 12      // fast short rep movsb
+};
+
+unsigned assm_cpu_features(void);
+
+// Highest tier the CPU supports, ignoring ASSM_CPU_TIER
+int assm_cpu_detected_tier(void);
+
+// Tier the dispatch table currently resolves to
+int assm_cpu_tier(void);
+
+// Re-resolve every dispatched kernel for tier (clamped to the detected
+// tier); returns the tier actually used. Not safe while other threads are
+// calling kernels.
+int assm_cpu_set_tier(int tier);
+
+// "sse2", "sse42" or "avx2"
+const char* assm_tier_name(int tier);
+
+// Size in bytes of the largest (last-level) data cache, or 0 if CPUID does
+// not report it
+size_t assm_cpu_llc_size(void);
+
+// ---------------------------------------------------------------------------
+// Control flow and calls (tutorials 3, 4, 10) - assm_control.c
+// ---------------------------------------------------------------------------
+
+// n! using a mulq loop
+long factorial_asm(long n);
+
+// Recursive Fibonacci, standalone System V function
+long fibonacci_asm(long n);
+
+// (a * b) + c, standalone System V function
+long multiply_add_asm(long a, long b, long c);
+
+// ---------------------------------------------------------------------------
+// Strings and memory (tutorial 6) - assm_string.c
+// ---------------------------------------------------------------------------
+
+// Length of a NUL-terminated string (SSE2/AVX2, page-safe aligned scan)
+size_t strlen_asm(const char* str);
+
+// Like strlen_asm but never counts past maxlen: returns maxlen when there is
+// no terminator in the first maxlen bytes
+size_t strnlen_asm(const char* str, size_t maxlen);
+
+// Copy src (including the terminator) into dest
+void strcpy_asm(char* dest, const char* src);
+
+// Like strcpy_asm but returns a pointer to the terminator written in dest
+char* stpcpy_asm(char* dest, const char* src);
+
+// BSD strlcpy: copies at most size - 1 bytes and always terminates dest when
+// size > 0. Returns strlen(src); a result >= size means dest was truncated.
+size_t strlcpy_asm(char* dest, const char* src, size_t size);
+
+// Linux strscpy: copies at most size - 1 bytes, always terminating dest when
+// size > 0, and reads no more than size bytes of src. Returns the length
+// copied, or -1 if src did not fit (dest then holds the truncated prefix).
+ptrdiff_t strscpy_asm(char* dest, const char* src, size_t size);
+
+// Compare num bytes as unsigned chars; returns ptr1[i] - ptr2[i] for the
+// first differing byte i (so the sign orders the buffers), or 0 if equal
+int memcmp_asm(const void* ptr1, const void* ptr2, size_t num);
+
+// Index of the first byte where the buffers differ, or num if they are equal
+size_t memcmp_mismatch_asm(const void* ptr1, const void* ptr2, size_t num);
+
+// First byte of ptr[0..n) equal to (unsigned char)c, or NULL
+void* memchr_asm(const void* ptr, int c, size_t n);
+
+// Last byte of ptr[0..n) equal to (unsigned char)c, or NULL
+void* memrchr_asm(const void* ptr, int c, size_t n);
+
+// First byte equal to any of the needles, or NULL
+void* memchr2_asm(const void* ptr, int c1, int c2, size_t n);
+void* memchr3_asm(const void* ptr, int c1, int c2, int c3, size_t n);
+
+// First occurrence of (char)c in str, or NULL; c == 0 finds the terminator
+char* strchr_asm(const char* str, int c);
+
+// ---------------------------------------------------------------------------
+// Memory copy (tutorial 11 copy_array) - assm_memcpy.c
+// ---------------------------------------------------------------------------
+
+// Copy n bytes between non-overlapping buffers; returns dest
+void* memcpy_asm(void* dest, const void* src, size_t n);
+
+// Like memcpy_asm but the buffers may overlap
+void* memmove_asm(void* dest, const void* src, size_t n);
+
+// Size-class thresholds in bytes. Copies below rep_movsb_min use vector
+// loads and stores; from rep_movsb_min they use rep movsb, and from
+// nontemporal_min (disjoint buffers only) non-temporal stores that bypass
+// the cache. SIZE_MAX disables a class. Defaults: 4 KiB when the CPU has
+// ERMS, and 3/4 of the last-level cache.
+struct assm_memcpy_tuning {
+    size_t rep_movsb_min;
+    size_t nontemporal_min;
+};
+
+void assm_memcpy_get_tuning(struct assm_memcpy_tuning* tuning);
+
+// Not safe while other threads are copying
+void assm_memcpy_set_tuning(const struct assm_memcpy_tuning* tuning);
+
+// ---------------------------------------------------------------------------
+// Substring and multi-pattern search - assm_search.c
+// ---------------------------------------------------------------------------
+
+// First occurrence of needle[0..len) in haystack[0..n), or NULL; an empty
+// needle matches at haystack. Linear in the worst case.
+void* memmem_asm(const void* haystack, size_t n, const void* needle, size_t len);
+
+// First occurrence of needle in haystack, or NULL
+char* strstr_asm(const char* haystack, const char* needle);
+
+// Precompiled needle for repeated searches: the Two-Way factorization and
+// skip table are built once by assm_needle_init. The needle bytes are not
+// copied and must outlive the struct. Fields are private to assm_search.c.
+struct assm_needle {
+    const unsigned char* bytes;
+    size_t len;
+    size_t split;           // critical factorization point
+    size_t period;
+    int periodic;
+    int prepared;
+    size_t shift[256];      // bad-character skip on the window's last byte
+};
+
+void assm_needle_init(struct assm_needle* needle, const void* bytes, size_t len);
+
+// Same result as memmem_asm(haystack, n, needle->bytes, needle->len)
+void* assm_needle_find(const struct assm_needle* needle, const void* haystack, size_t n);
+
+// Multi-pattern matcher: every occurrence of every pattern, overlapping ones
+// included. Fewer than 64 patterns use a SIMD (Teddy) prefilter, more an
+// Aho-Corasick automaton; both report the same set of matches, the
+// automaton in order of end offset and the prefilter by start offset.
+struct assm_matcher;
+
+struct assm_match {
+    size_t pattern;         // index into the patterns passed to create
+    size_t start;           // offset of the match in the text
+};
+
+// Called once per match; return non-zero to stop the scan
+typedef int (*assm_match_fn)(void* context, size_t pattern, size_t start);
+
+// Compiles count patterns (copied, so they need not outlive the matcher).
+// lengths may be NULL for NUL-terminated patterns. Returns NULL if a
+// pattern is empty or memory runs out.
+struct assm_matcher* assm_matcher_create(const char* const* patterns, const size_t* lengths,
+                                         size_t count);
+void assm_matcher_free(struct assm_matcher* matcher);
+
+// Reports each match to fn; returns the number reported
+size_t assm_matcher_scan(const struct assm_matcher* matcher, const void* text, size_t n,
+                         assm_match_fn fn, void* context);
+
+// Stores up to max matches in out; returns the total number of matches,
+// which may exceed max
+size_t assm_matcher_find_all(const struct assm_matcher* matcher, const void* text, size_t n,
+                             struct assm_match* out, size_t max);
+
+// ---------------------------------------------------------------------------
+// UTF-8 validation - assm_utf8.c
+// ---------------------------------------------------------------------------
+
+// Length of the longest valid UTF-8 prefix of data[0..n): n when all of it
+// is valid, otherwise the offset of the first invalid or truncated
+// sequence. Valid per RFC 3629 (no overlong forms, surrogates or code
+// points past U+10FFFF). All-ASCII input costs one vector test per block.
+size_t assm_utf8_validate(const void* data, size_t n);
+
+// Same, and stores the number of code points in that prefix in *count, so
+// callers sizing a decode buffer need no second pass
+size_t assm_utf8_validate_count(const void* data, size_t n, size_t* count);
+
+// ---------------------------------------------------------------------------
+// Hashing - assm_hash.c
+// ---------------------------------------------------------------------------
+
+// CRC32C (Castagnoli): the checksum of iSCSI, ext4 and SSE4.2's crc32
+// instruction; assm_crc32c("123456789", 9) == 0xE3069283. To checksum a
+// stream, start from 0 and pass each result back in:
+// assm_crc32c_update(assm_crc32c(a, n), b, m) is the CRC of a then b.
+uint32_t assm_crc32c(const void* data, size_t n);
+uint32_t assm_crc32c_update(uint32_t crc, const void* data, size_t n);
+
+// 64-bit non-cryptographic hash for hash table keys; the output matches
+// xxHash's XXH64 for the same seed. Not for untrusted keys an attacker can
+// choose to collide.
+uint64_t assm_hash64(const void* data, size_t n, uint64_t seed);
+
+// Incremental assm_hash64: init, update any number of times with pieces of
+// any size, then final (which leaves the state usable for more updates).
+// Fields are private to assm_hash.c.
+struct assm_hash64_state {
+    uint64_t acc[4];
+    uint64_t seed;
+    uint64_t total;             // bytes hashed so far
+    unsigned char buffer[32];   // partial stripe
+    size_t buffered;
+};
+
+void assm_hash64_init(struct assm_hash64_state* state, uint64_t seed);
+void assm_hash64_update(struct assm_hash64_state* state, const void* data, size_t n);
+// Same result as assm_hash64 over everything passed to update
+uint64_t assm_hash64_final(const struct assm_hash64_state* state);
+
+// ---------------------------------------------------------------------------
+// Arrays (tutorial 7) - assm_array.c
+// ---------------------------------------------------------------------------
+
+// Sum of count elements (wraps on overflow)
+long array_sum_asm(const long* arr, size_t count);
+
+// Sum of count elements without wrapping: returns 1 and stores the sum if
+// it fits in a long, otherwise returns 0 and stores LONG_MAX or LONG_MIN
+// (the sign of the true sum). Intermediate sums may leave the range.
+int array_sum_checked_asm(const long* arr, size_t count, long* sum);
+
+// Index of the first element equal to target, or SIZE_MAX
+size_t array_search_asm(const long* arr, size_t count, long target);
+
+// Index of the first element of an ascending array that is >= key, or
+// count if there is none (std::lower_bound)
+size_t array_lower_bound_asm(const long* sorted, size_t count, long key);
+
+// Eytzinger layout: the ascending array's search tree in BFS order, in
+// tree[1..count] (tree needs count + 1 elements; 64-byte alignment keeps
+// each node's descendants in as few cache lines as possible). Searches
+// return the slot k of the first element >= key, so tree[k] is that
+// element, or 0 if there is none.
+void array_eytzinger_build(const long* sorted, size_t count, long* tree);
+size_t array_eytzinger_search(const long* tree, size_t count, long key);
+
+// Searches n keys at once, interleaving their loads; slots[i] is the
+// result for keys[i]
+void array_eytzinger_search_batch(const long* tree, size_t count, const long* keys, size_t n,
+                                  size_t* slots);
+
+// Smallest and largest element and the index of the first occurrence of
+// each, in one pass. With nothing to compare (count is 0, or every float
+// is NaN) min and max are 0 and both indices SIZE_MAX; NaNs are skipped.
+struct assm_minmax_i32 { int32_t min, max; size_t argmin, argmax; };
+struct assm_minmax_i64 { int64_t min, max; size_t argmin, argmax; };
+struct assm_minmax_f32 { float min, max; size_t argmin, argmax; };
+struct assm_minmax_f64 { double min, max; size_t argmin, argmax; };
+struct assm_minmax_i32 array_minmax_i32_asm(const int32_t* arr, size_t count);
+struct assm_minmax_i64 array_minmax_i64_asm(const int64_t* arr, size_t count);
+struct assm_minmax_f32 array_minmax_f32_asm(const float* arr, size_t count);
+struct assm_minmax_f64 array_minmax_f64_asm(const double* arr, size_t count);
+
+// Largest element (array_minmax_i64_asm), or LONG_MIN if count is 0
+long array_max_asm(const long* arr, size_t count);
+
+// Typed variants for the other element types (assm_array.hpp picks one by
+// type). Sums accumulate in a type that cannot overflow before 2^32
+// elements: integer sums are exact in int64 (uint64 wraps), and float
+// sums are added in double.
+int64_t array_sum_i8_asm(const int8_t* arr, size_t count);
+int64_t array_sum_i16_asm(const int16_t* arr, size_t count);
+int64_t array_sum_i32_asm(const int32_t* arr, size_t count);
+uint64_t array_sum_u64_asm(const uint64_t* arr, size_t count);
+double array_sum_f32_asm(const float* arr, size_t count);
+double array_sum_f64_asm(const double* arr, size_t count);
+
+// Index of the first element equal to target (==, so NaN is never found
+// and -0.0 finds 0.0), or SIZE_MAX
+size_t array_search_i8_asm(const int8_t* arr, size_t count, int8_t target);
+size_t array_search_i16_asm(const int16_t* arr, size_t count, int16_t target);
+size_t array_search_i32_asm(const int32_t* arr, size_t count, int32_t target);
+size_t array_search_u64_asm(const uint64_t* arr, size_t count, uint64_t target);
+size_t array_search_f32_asm(const float* arr, size_t count, float target);
+size_t array_search_f64_asm(const double* arr, size_t count, double target);
+
+// As array_minmax_i32_asm, for the remaining integer types
+struct assm_minmax_i8 { int8_t min, max; size_t argmin, argmax; };
+struct assm_minmax_i16 { int16_t min, max; size_t argmin, argmax; };
+struct assm_minmax_u64 { uint64_t min, max; size_t argmin, argmax; };
+struct assm_minmax_i8 array_minmax_i8_asm(const int8_t* arr, size_t count);
+struct assm_minmax_i16 array_minmax_i16_asm(const int16_t* arr, size_t count);
+struct assm_minmax_u64 array_minmax_u64_asm(const uint64_t* arr, size_t count);
+
+// Histograms: counts[x] += the number of elements equal to x, so one
+// histogram can be built over several calls (zero counts first)
+void array_histogram_u8_asm(const uint8_t* data, size_t count, uint64_t counts[256]);
+void array_histogram_u16_asm(const uint16_t* data, size_t count, uint64_t counts[65536]);
+
+// Element x falls in bucket (x - base) >> shift (shift below 64); elements
+// below base or past the last of the buckets are not counted
+void array_histogram_shift_asm(const long* arr, size_t count, long base, unsigned shift,
+                               uint64_t* counts, size_t buckets);
+
+// Same counts using up to threads threads of the assm_parallel pool (0: all
+// of them), each with its own table, for arrays past about 1 MiB
+void array_histogram_u8_parallel(const uint8_t* data, size_t count, uint64_t counts[256],
+                                 unsigned threads);
+void array_histogram_u16_parallel(const uint16_t* data, size_t count, uint64_t counts[65536],
+                                  unsigned threads);
+void array_histogram_shift_parallel(const long* arr, size_t count, long base, unsigned shift,
+                                    uint64_t* counts, size_t buckets, unsigned threads);
+
+// matrix[row][col] of a dense row-major rows x cols matrix
+long matrix_get_asm(const long* matrix, size_t rows, size_t cols, size_t row, size_t col);
+
+// ---------------------------------------------------------------------------
+// Filters - assm_filter.c
+// ---------------------------------------------------------------------------
+
+// Stream compaction: store the elements of arr that pass the predicate to
+// out, in order, and return how many were kept. out needs room for count
+// elements; out[kept..count) may be overwritten. The _index forms store
+// the positions of the kept elements instead, for a later gather.
+size_t array_filter_eq_asm(const long* arr, size_t count, long value, long* out);
+size_t array_filter_eq_index_asm(const long* arr, size_t count, long value, size_t* out);
+
+// lo <= element <= hi; nothing passes if lo > hi
+size_t array_filter_range_asm(const long* arr, size_t count, long lo, long hi, long* out);
+size_t array_filter_range_index_asm(const long* arr, size_t count, long lo, long hi, size_t* out);
+
+// Selection bitmap: element i passes if bit i % 64 of bits[i / 64] is set.
+// The index form turns the bitmap into the list of its set bits.
+size_t array_filter_bits_asm(const long* arr, const uint64_t* bits, size_t count, long* out);
+size_t array_filter_bits_index_asm(const uint64_t* bits, size_t count, size_t* out);
+
+// ---------------------------------------------------------------------------
+// Prefix sums - assm_scan.c
+// ---------------------------------------------------------------------------
+
+// dst[i] = src[0] + ... + src[i] (ASSM_SCAN_INCLUSIVE) or src[0] + ... +
+// src[i - 1], with dst[0] = 0 (ASSM_SCAN_EXCLUSIVE). Sums wrap; dst may be
+// src for an in-place scan, but must not otherwise overlap it.
+enum { ASSM_SCAN_INCLUSIVE, ASSM_SCAN_EXCLUSIVE };
+void array_scan_i32_asm(int32_t* dst, const int32_t* src, size_t count, int mode);
+void array_scan_i64_asm(int64_t* dst, const int64_t* src, size_t count, int mode);
+
+// Same result using up to threads threads of the assm_parallel pool (0:
+// all of them) for arrays past about 1 MiB; smaller ones are scanned on
+// the calling thread
+void array_scan_i32_parallel(int32_t* dst, const int32_t* src, size_t count, int mode,
+                             unsigned threads);
+void array_scan_i64_parallel(int64_t* dst, const int64_t* src, size_t count, int mode,
+                             unsigned threads);
+
+// ---------------------------------------------------------------------------
+// Sorting - assm_sort.c
+// ---------------------------------------------------------------------------
+
+// Sort keys ascending, as signed integers. Large arrays take an LSD radix
+// sort that needs a scratch copy of the keys (and of the payload); if it
+// cannot be allocated the functions return 0 and leave the arrays as they
+// were, otherwise 1. Small arrays are sorted on the stack.
+int array_sort_i64(int64_t* keys, size_t count);
+int array_sort_i32(int32_t* keys, size_t count);
+
+// payload[i] moves with keys[i]. The sort is stable: equal keys keep the
+// order of their payloads.
+int array_sort_i64_payload(int64_t* keys, uint64_t* payload, size_t count);
+int array_sort_i32_payload(int32_t* keys, uint32_t* payload, size_t count);
+
+// ---------------------------------------------------------------------------
+// Parallel reductions - assm_parallel.c
+// ---------------------------------------------------------------------------
+
+// The *_parallel kernels share a pool of threads started on first use, one
+// per online CPU or ASSM_THREADS of them. Each splits its array into blocks
+// of 1 MiB or more and gives every thread a contiguous run of blocks;
+// threads limits how many take part (0: the whole pool). Results depend on
+// the array alone, never on the thread count: block sizes follow the
+// length and block results are combined in order, so even the float dot
+// product is reproducible. Arrays under 2 MiB stay on the calling thread.
+#define ASSM_THREADS_ENV "ASSM_THREADS"
+
+// Threads in the pool, the caller included; starts the pool
+unsigned assm_parallel_threads(void);
+
+// Same results as array_sum_asm, array_max_asm and popcount_asm summed
+// over every word. The dot product adds the blocks' dot_product_sse results
+// in double, so past 2 MiB it can differ from one dot_product_sse call in
+// the last bits.
+long array_sum_parallel(const long* arr, size_t count, unsigned threads);
+long array_max_parallel(const long* arr, size_t count, unsigned threads);
+uint64_t popcount_parallel(const uint64_t* words, size_t count, unsigned threads);
+float dot_product_parallel(const float* a, const float* b, size_t count, unsigned threads);
+
+// ---------------------------------------------------------------------------
+// Matrices - assm_matrix.c
+// ---------------------------------------------------------------------------
+
+// Row-major view of 32-bit elements: element (i, j) is data[i * stride + j]
+// with stride >= cols. Views are plain values; they never own the data.
+struct assm_matrix_f32 { float* data; size_t rows, cols, stride; };
+struct assm_matrix_i32 { int32_t* data; size_t rows, cols, stride; };
+
+struct assm_matrix_f32 assm_matrix_f32_view(float* data, size_t rows, size_t cols, size_t stride);
+struct assm_matrix_i32 assm_matrix_i32_view(int32_t* data, size_t rows, size_t cols, size_t stride);
+
+// The rows x cols block of m starting at (row, col), sharing m's data
+struct assm_matrix_f32 assm_matrix_f32_block(struct assm_matrix_f32 m, size_t row, size_t col,
+                                             size_t rows, size_t cols);
+struct assm_matrix_i32 assm_matrix_i32_block(struct assm_matrix_i32 m, size_t row, size_t col,
+                                             size_t rows, size_t cols);
+
+// dst = transpose(src); dst must be src.cols x src.rows and must not
+// overlap src
+void assm_matrix_transpose_f32(struct assm_matrix_f32 dst, struct assm_matrix_f32 src);
+void assm_matrix_transpose_i32(struct assm_matrix_i32 dst, struct assm_matrix_i32 src);
+
+// c = a * b (the integer product wraps). Returns 1, or 0 with c untouched
+// if the shapes disagree or the packing buffers cannot be allocated. c must
+// not overlap a or b.
+int assm_matrix_multiply_f32(struct assm_matrix_f32 c, struct assm_matrix_f32 a,
+                             struct assm_matrix_f32 b);
+int assm_matrix_multiply_i32(struct assm_matrix_i32 c, struct assm_matrix_i32 a,
+                             struct assm_matrix_i32 b);
+
+// sums[i] = sum of row i (m.rows entries) or sums[j] = sum of column j
+// (m.cols entries); integer sums are exact
+void assm_matrix_row_sums_f32(struct assm_matrix_f32 m, float* sums);
+void assm_matrix_row_sums_i32(struct assm_matrix_i32 m, int64_t* sums);
+void assm_matrix_col_sums_f32(struct assm_matrix_f32 m, float* sums);
+void assm_matrix_col_sums_i32(struct assm_matrix_i32 m, int64_t* sums);
+
+// Storage layouts for long matrices, each with an O(1) accessor like
+// matrix_get_asm and conversions to and from dense row-major rows x cols.
+// The *_size functions give the elements a layout needs; padding elements
+// are left untouched.
+//
+// Z-order (Morton): element (row, col) at the interleave of the bits of col
+// (even positions) and row (odd positions); row and col must be below 2^32.
+// Pads up to power-of-two squares, so it suits roughly square grids.
+size_t matrix_morton_index(size_t row, size_t col);
+size_t matrix_morton_size(size_t rows, size_t cols);
+long matrix_get_morton_asm(const long* matrix, size_t row, size_t col);
+void matrix_to_morton(long* dst, const long* src, size_t rows, size_t cols);
+void matrix_from_morton(long* dst, const long* src, size_t rows, size_t cols);
+
+// Tiled: ASSM_MATRIX_TILE x ASSM_MATRIX_TILE row-major squares (one cache
+// line per tile row) stored tile row by tile row
+#define ASSM_MATRIX_TILE 8
+size_t matrix_tiled_size(size_t rows, size_t cols);
+long matrix_get_tiled_asm(const long* matrix, size_t cols, size_t row, size_t col);
+void matrix_to_tiled(long* dst, const long* src, size_t rows, size_t cols);
+void matrix_from_tiled(long* dst, const long* src, size_t rows, size_t cols);
+
+// out[i] = matrix_get_asm(matrix, ..., cols, rows[i], col_idx[i]) for i in
+// [0, n): random lookups batched so their cache misses overlap. Each lookup
+// prefetches the element prefetch_distance lookups ahead (0 disables). That
+// costs 10-20% while the matrix fits in cache; past the last-level cache
+// ASSM_MATRIX_PREFETCH_DISTANCE keeps the misses of the gather kernel
+// overlapped.
+#define ASSM_MATRIX_PREFETCH_DISTANCE 16
+void matrix_get_batch_asm(const long* matrix, size_t cols, const size_t* rows, const size_t* col_idx,
+                          size_t n, long* out, size_t prefetch_distance);
+
+// ---------------------------------------------------------------------------
+// Bit manipulation (tutorial 8) - assm_bits.c
+// ---------------------------------------------------------------------------
+
+// Number of set bits
+int popcount_asm(uint64_t value);
+
+// Number of set bits in n bytes (any alignment)
+uint64_t popcount_buffer_asm(const void* data, size_t n);
+
+// num_bits bits of value starting at start_bit
+uint64_t extract_bits_asm(uint64_t value, int start_bit, int num_bits);
+
+uint64_t set_bit_asm(uint64_t value, int bit_position);
+uint64_t clear_bit_asm(uint64_t value, int bit_position);
+uint64_t rotate_left_asm(uint64_t value, int positions);
+
+// 1 if value is a non-zero power of two, 0 otherwise
+int is_power_of_2_asm(uint64_t value);
+
+// ---------------------------------------------------------------------------
+// SSE floating point (tutorial 9) - assm_sse.c
+// ---------------------------------------------------------------------------
+
+float add_floats_sse(float a, float b);
+
+// -1, 0 or 1 (unordered inputs compare as equal)
+int compare_floats_sse(float a, float b);
+
+float sqrt_sse(float value);
+
+// result[0..3] = a[0..3] + b[0..3]
+void add_vectors_sse(const float* a, const float* b, float* result);
+
+// Sum of a[i] * b[i] for i in [0, count)
+float dot_product_sse(const float* a, const float* b, int count);
+
+// rsqrtss approximation of 1/sqrt(value), ~12 bits of precision
+float fast_inv_sqrt_sse(float value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASSM_KERNELS_H
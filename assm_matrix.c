@@ -0,0 +1,1417 @@
+// assm_matrix.c - Strided matrix views: transpose, multiply and reductions;
+// Z-order and tiled storage layouts (tutorial 7 matrix_get_asm, grown up)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Every operation works on 32-bit elements of a row-major view, element
+// (i, j) at data[i * stride + j], so a block of a larger matrix is just a
+// view with the parent's stride.
+//
+// Transpose walks the source in MATRIX_TRANSPOSE_BLOCK square blocks so
+// both the rows read and the rows written stay in L1 while a block is done,
+// and moves each 8x8 tile through registers: eight row loads, a shuffle
+// network, eight column stores. The naive loop touches a new destination
+// cache line on every element once a column outgrows the cache.
+//
+// Multiply follows the usual GotoBLAS structure. B is packed GEMM_KC rows by
+// GEMM_NC columns at a time into 16-column panels, A GEMM_MC rows by GEMM_KC
+// columns into 6-row panels, both contiguous in the order the micro-kernel
+// reads them. The micro-kernel keeps a 6x16 tile of C in twelve registers
+// for the whole GEMM_KC steps: two loads of B and six broadcasts of A feed
+// twelve multiply-adds per step. The packed B panel (16 KiB) stays in L1,
+// the packed A block in L2 and the packed B block in the last-level cache.
+// Tiles cut short by the edge of C go through a scratch tile.
+//
+// Column sums add whole rows into the sums array, MATRIX_SUM_STRIP columns
+// at a time so the sums stay in L1 however wide the matrix is.
+#define MATRIX_TRANSPOSE_BLOCK 64
+#define MATRIX_SUM_STRIP 2048
+
+#define GEMM_MR 6
+#define GEMM_NR 16
+#define GEMM_KC 256
+#define GEMM_MC 96                  // multiple of GEMM_MR
+#define GEMM_NC 1024                // multiple of GEMM_NR
+
+struct assm_matrix_f32 assm_matrix_f32_view(float* data, size_t rows, size_t cols, size_t stride) {
+    struct assm_matrix_f32 m = {data, rows, cols, stride};
+    return m;
+}
+
+struct assm_matrix_i32 assm_matrix_i32_view(int32_t* data, size_t rows, size_t cols, size_t stride) {
+    struct assm_matrix_i32 m = {data, rows, cols, stride};
+    return m;
+}
+
+struct assm_matrix_f32 assm_matrix_f32_block(struct assm_matrix_f32 m, size_t row, size_t col,
+                                             size_t rows, size_t cols) {
+    return assm_matrix_f32_view(m.data + row * m.stride + col, rows, cols, m.stride);
+}
+
+struct assm_matrix_i32 assm_matrix_i32_block(struct assm_matrix_i32 m, size_t row, size_t col,
+                                             size_t rows, size_t cols) {
+    return assm_matrix_i32_view(m.data + row * m.stride + col, rows, cols, m.stride);
+}
+
+// Strides in bytes
+static inline void transpose32_block4_sse2(const void* src, size_t src_stride, void* dst,
+                                           size_t dst_stride) {
+    __asm__ volatile (
+        "leaq (%1,%1,2), %%r9\n\t"
+        "leaq (%3,%3,2), %%r10\n\t"
+        "movups (%0), %%xmm0\n\t"
+        "movups (%0,%1), %%xmm1\n\t"
+        "movups (%0,%1,2), %%xmm2\n\t"
+        "movups (%0,%%r9), %%xmm3\n\t"
+        "movaps %%xmm0, %%xmm4\n\t"
+        "unpcklps %%xmm1, %%xmm4\n\t"       // 00 10 01 11
+        "unpckhps %%xmm1, %%xmm0\n\t"       // 02 12 03 13
+        "movaps %%xmm2, %%xmm5\n\t"
+        "unpcklps %%xmm3, %%xmm5\n\t"       // 20 30 21 31
+        "unpckhps %%xmm3, %%xmm2\n\t"       // 22 32 23 33
+        "movaps %%xmm4, %%xmm1\n\t"
+        "movlhps %%xmm5, %%xmm1\n\t"        // Column 0
+        "movhlps %%xmm4, %%xmm5\n\t"        // Column 1
+        "movaps %%xmm0, %%xmm3\n\t"
+        "movlhps %%xmm2, %%xmm3\n\t"        // Column 2
+        "movhlps %%xmm0, %%xmm2\n\t"        // Column 3
+        "movups %%xmm1, (%2)\n\t"
+        "movups %%xmm5, (%2,%3)\n\t"
+        "movups %%xmm3, (%2,%3,2)\n\t"
+        "movups %%xmm2, (%2,%%r10)\n\t"
+        :
+        : "r" (src), "r" (src_stride), "r" (dst), "r" (dst_stride)
+        : "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "memory"
+    );
+}
+
+void transpose32_tile_sse2(const void* src, size_t src_stride, void* dst, size_t dst_stride) {
+    const uint32_t* s = src;
+    uint32_t* d = dst;
+
+    for (size_t bi = 0; bi < 8; bi += 4) {
+        for (size_t bj = 0; bj < 8; bj += 4) {
+            transpose32_block4_sse2(s + bi * src_stride + bj, src_stride * 4,
+                                    d + bj * dst_stride + bi, dst_stride * 4);
+        }
+    }
+}
+
+void transpose32_tile_avx2(const void* src, size_t src_stride, void* dst, size_t dst_stride) {
+    __asm__ volatile (
+        "leaq (%1,%1,2), %%r9\n\t"          // 3 rows of src
+        "leaq (%0,%1,4), %%r8\n\t"          // src row 4
+        "leaq (%3,%3,2), %%r10\n\t"         // 3 rows of dst
+        "leaq (%2,%3,4), %%r11\n\t"         // dst row 4
+        "vmovups (%0), %%ymm0\n\t"          // Rows 0..7
+        "vmovups (%0,%1), %%ymm1\n\t"
+        "vmovups (%0,%1,2), %%ymm2\n\t"
+        "vmovups (%0,%%r9), %%ymm3\n\t"
+        "vmovups (%%r8), %%ymm4\n\t"
+        "vmovups (%%r8,%1), %%ymm5\n\t"
+        "vmovups (%%r8,%1,2), %%ymm6\n\t"
+        "vmovups (%%r8,%%r9), %%ymm7\n\t"
+        "vunpcklps %%ymm1, %%ymm0, %%ymm8\n\t" // Interleave row pairs
+        "vunpckhps %%ymm1, %%ymm0, %%ymm9\n\t"
+        "vunpcklps %%ymm3, %%ymm2, %%ymm10\n\t"
+        "vunpckhps %%ymm3, %%ymm2, %%ymm11\n\t"
+        "vunpcklps %%ymm5, %%ymm4, %%ymm12\n\t"
+        "vunpckhps %%ymm5, %%ymm4, %%ymm13\n\t"
+        "vunpcklps %%ymm7, %%ymm6, %%ymm14\n\t"
+        "vunpckhps %%ymm7, %%ymm6, %%ymm15\n\t"
+        "vshufps $0x44, %%ymm10, %%ymm8, %%ymm0\n\t" // Columns of 4 rows, both lanes
+        "vshufps $0xee, %%ymm10, %%ymm8, %%ymm1\n\t"
+        "vshufps $0x44, %%ymm11, %%ymm9, %%ymm2\n\t"
+        "vshufps $0xee, %%ymm11, %%ymm9, %%ymm3\n\t"
+        "vshufps $0x44, %%ymm14, %%ymm12, %%ymm4\n\t"
+        "vshufps $0xee, %%ymm14, %%ymm12, %%ymm5\n\t"
+        "vshufps $0x44, %%ymm15, %%ymm13, %%ymm6\n\t"
+        "vshufps $0xee, %%ymm15, %%ymm13, %%ymm7\n\t"
+        "vperm2f128 $0x20, %%ymm4, %%ymm0, %%ymm8\n\t" // Join the lanes: columns 0..3
+        "vperm2f128 $0x31, %%ymm4, %%ymm0, %%ymm12\n\t" // ... and 4..7
+        "vperm2f128 $0x20, %%ymm5, %%ymm1, %%ymm9\n\t"
+        "vperm2f128 $0x31, %%ymm5, %%ymm1, %%ymm13\n\t"
+        "vperm2f128 $0x20, %%ymm6, %%ymm2, %%ymm10\n\t"
+        "vperm2f128 $0x31, %%ymm6, %%ymm2, %%ymm14\n\t"
+        "vperm2f128 $0x20, %%ymm7, %%ymm3, %%ymm11\n\t"
+        "vperm2f128 $0x31, %%ymm7, %%ymm3, %%ymm15\n\t"
+        "vmovups %%ymm8, (%2)\n\t"
+        "vmovups %%ymm9, (%2,%3)\n\t"
+        "vmovups %%ymm10, (%2,%3,2)\n\t"
+        "vmovups %%ymm11, (%2,%%r10)\n\t"
+        "vmovups %%ymm12, (%%r11)\n\t"
+        "vmovups %%ymm13, (%%r11,%3)\n\t"
+        "vmovups %%ymm14, (%%r11,%3,2)\n\t"
+        "vmovups %%ymm15, (%%r11,%%r10)\n\t"
+        "vzeroupper\n\t"
+        :
+        : "r" (src), "r" (src_stride * 4), "r" (dst), "r" (dst_stride * 4)
+        : "r8", "r9", "r10", "r11", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory"
+    );
+}
+
+void matrix_transpose32_with(transpose_tile_fn tile, void* dst, size_t dst_stride, const void* src,
+                             size_t src_stride, size_t rows, size_t cols) {
+    const uint32_t* s = src;
+    uint32_t* d = dst;
+
+    for (size_t i0 = 0; i0 < rows; i0 += MATRIX_TRANSPOSE_BLOCK) {
+        size_t i1 = rows - i0 < MATRIX_TRANSPOSE_BLOCK ? rows : i0 + MATRIX_TRANSPOSE_BLOCK;
+        size_t i8 = i0 + ((i1 - i0) & ~(size_t)7);
+
+        for (size_t j0 = 0; j0 < cols; j0 += MATRIX_TRANSPOSE_BLOCK) {
+            size_t j1 = cols - j0 < MATRIX_TRANSPOSE_BLOCK ? cols : j0 + MATRIX_TRANSPOSE_BLOCK;
+            size_t j8 = j0 + ((j1 - j0) & ~(size_t)7);
+
+            for (size_t i = i0; i < i8; i += 8) {
+                for (size_t j = j0; j < j8; j += 8) {
+                    tile(s + i * src_stride + j, src_stride, d + j * dst_stride + i, dst_stride);
+                }
+                for (size_t r = i; r < i + 8; ++r) {
+                    for (size_t j = j8; j < j1; ++j) d[j * dst_stride + r] = s[r * src_stride + j];
+                }
+            }
+            for (size_t i = i8; i < i1; ++i) {
+                for (size_t j = j0; j < j1; ++j) d[j * dst_stride + i] = s[i * src_stride + j];
+            }
+        }
+    }
+}
+
+void assm_matrix_transpose_f32(struct assm_matrix_f32 dst, struct assm_matrix_f32 src) {
+    matrix_transpose32_with(ASSM_DISPATCH(transpose32_tile), dst.data, dst.stride, src.data,
+                            src.stride, src.rows, src.cols);
+}
+
+void assm_matrix_transpose_i32(struct assm_matrix_i32 dst, struct assm_matrix_i32 src) {
+    matrix_transpose32_with(ASSM_DISPATCH(transpose32_tile), dst.data, dst.stride, src.data,
+                            src.stride, src.rows, src.cols);
+}
+
+void gemm_f32_kernel_avx2(size_t kc, const void* a, const void* b, void* c, size_t c_stride) {
+    __asm__ volatile (
+        "movq %0, %%rcx\n\t"
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rdi\n\t"
+        "vpxor %%ymm0, %%ymm0, %%ymm0\n\t"  // Accumulators: row i in ymm 2i, 2i+1
+        "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"
+        "vpxor %%ymm2, %%ymm2, %%ymm2\n\t"
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"
+        "vpxor %%ymm4, %%ymm4, %%ymm4\n\t"
+        "vpxor %%ymm5, %%ymm5, %%ymm5\n\t"
+        "vpxor %%ymm6, %%ymm6, %%ymm6\n\t"
+        "vpxor %%ymm7, %%ymm7, %%ymm7\n\t"
+        "vpxor %%ymm8, %%ymm8, %%ymm8\n\t"
+        "vpxor %%ymm9, %%ymm9, %%ymm9\n\t"
+        "vpxor %%ymm10, %%ymm10, %%ymm10\n\t"
+        "vpxor %%ymm11, %%ymm11, %%ymm11\n\t"
+        "1:\n\t"                            // one k: a column of A times a row of B
+        "vmovaps (%%rdi), %%ymm12\n\t"
+        "vmovaps 32(%%rdi), %%ymm13\n\t"
+        "vbroadcastss 0(%%rsi), %%ymm14\n\t" // A[i][k] in every lane
+        "vfmadd231ps %%ymm12, %%ymm14, %%ymm0\n\t"
+        "vfmadd231ps %%ymm13, %%ymm14, %%ymm1\n\t"
+        "vbroadcastss 4(%%rsi), %%ymm14\n\t"
+        "vfmadd231ps %%ymm12, %%ymm14, %%ymm2\n\t"
+        "vfmadd231ps %%ymm13, %%ymm14, %%ymm3\n\t"
+        "vbroadcastss 8(%%rsi), %%ymm14\n\t"
+        "vfmadd231ps %%ymm12, %%ymm14, %%ymm4\n\t"
+        "vfmadd231ps %%ymm13, %%ymm14, %%ymm5\n\t"
+        "vbroadcastss 12(%%rsi), %%ymm14\n\t"
+        "vfmadd231ps %%ymm12, %%ymm14, %%ymm6\n\t"
+        "vfmadd231ps %%ymm13, %%ymm14, %%ymm7\n\t"
+        "vbroadcastss 16(%%rsi), %%ymm14\n\t"
+        "vfmadd231ps %%ymm12, %%ymm14, %%ymm8\n\t"
+        "vfmadd231ps %%ymm13, %%ymm14, %%ymm9\n\t"
+        "vbroadcastss 20(%%rsi), %%ymm14\n\t"
+        "vfmadd231ps %%ymm12, %%ymm14, %%ymm10\n\t"
+        "vfmadd231ps %%ymm13, %%ymm14, %%ymm11\n\t"
+        "addq $24, %%rsi\n\t"
+        "addq $64, %%rdi\n\t"
+        "decq %%rcx\n\t"
+        "jnz 1b\n\t"
+        "movq %3, %%rdx\n\t"
+        "vaddps (%%rdx), %%ymm0, %%ymm0\n\t" // Add the tile to C, row by row
+        "vaddps 32(%%rdx), %%ymm1, %%ymm1\n\t"
+        "vmovups %%ymm0, (%%rdx)\n\t"
+        "vmovups %%ymm1, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vaddps (%%rdx), %%ymm2, %%ymm2\n\t"
+        "vaddps 32(%%rdx), %%ymm3, %%ymm3\n\t"
+        "vmovups %%ymm2, (%%rdx)\n\t"
+        "vmovups %%ymm3, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vaddps (%%rdx), %%ymm4, %%ymm4\n\t"
+        "vaddps 32(%%rdx), %%ymm5, %%ymm5\n\t"
+        "vmovups %%ymm4, (%%rdx)\n\t"
+        "vmovups %%ymm5, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vaddps (%%rdx), %%ymm6, %%ymm6\n\t"
+        "vaddps 32(%%rdx), %%ymm7, %%ymm7\n\t"
+        "vmovups %%ymm6, (%%rdx)\n\t"
+        "vmovups %%ymm7, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vaddps (%%rdx), %%ymm8, %%ymm8\n\t"
+        "vaddps 32(%%rdx), %%ymm9, %%ymm9\n\t"
+        "vmovups %%ymm8, (%%rdx)\n\t"
+        "vmovups %%ymm9, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vaddps (%%rdx), %%ymm10, %%ymm10\n\t"
+        "vaddps 32(%%rdx), %%ymm11, %%ymm11\n\t"
+        "vmovups %%ymm10, (%%rdx)\n\t"
+        "vmovups %%ymm11, 32(%%rdx)\n\t"
+        "vzeroupper\n\t"
+        :
+        : "r" (kc), "r" (a), "r" (b), "r" (c), "r" (c_stride * 4)
+        : "rcx", "rdx", "rsi", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory"
+    );
+}
+
+void gemm_i32_kernel_avx2(size_t kc, const void* a, const void* b, void* c, size_t c_stride) {
+    __asm__ volatile (
+        "movq %0, %%rcx\n\t"
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rdi\n\t"
+        "vpxor %%ymm0, %%ymm0, %%ymm0\n\t"  // Accumulators: row i in ymm 2i, 2i+1
+        "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"
+        "vpxor %%ymm2, %%ymm2, %%ymm2\n\t"
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"
+        "vpxor %%ymm4, %%ymm4, %%ymm4\n\t"
+        "vpxor %%ymm5, %%ymm5, %%ymm5\n\t"
+        "vpxor %%ymm6, %%ymm6, %%ymm6\n\t"
+        "vpxor %%ymm7, %%ymm7, %%ymm7\n\t"
+        "vpxor %%ymm8, %%ymm8, %%ymm8\n\t"
+        "vpxor %%ymm9, %%ymm9, %%ymm9\n\t"
+        "vpxor %%ymm10, %%ymm10, %%ymm10\n\t"
+        "vpxor %%ymm11, %%ymm11, %%ymm11\n\t"
+        "1:\n\t"                            // one k: a column of A times a row of B
+        "vmovaps (%%rdi), %%ymm12\n\t"
+        "vmovaps 32(%%rdi), %%ymm13\n\t"
+        "vpbroadcastd 0(%%rsi), %%ymm14\n\t" // A[i][k] in every lane
+        "vpmulld %%ymm12, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm0, %%ymm0\n\t"
+        "vpmulld %%ymm13, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm1, %%ymm1\n\t"
+        "vpbroadcastd 4(%%rsi), %%ymm14\n\t"
+        "vpmulld %%ymm12, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm2, %%ymm2\n\t"
+        "vpmulld %%ymm13, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm3, %%ymm3\n\t"
+        "vpbroadcastd 8(%%rsi), %%ymm14\n\t"
+        "vpmulld %%ymm12, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm4, %%ymm4\n\t"
+        "vpmulld %%ymm13, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm5, %%ymm5\n\t"
+        "vpbroadcastd 12(%%rsi), %%ymm14\n\t"
+        "vpmulld %%ymm12, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm6, %%ymm6\n\t"
+        "vpmulld %%ymm13, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm7, %%ymm7\n\t"
+        "vpbroadcastd 16(%%rsi), %%ymm14\n\t"
+        "vpmulld %%ymm12, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm8, %%ymm8\n\t"
+        "vpmulld %%ymm13, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm9, %%ymm9\n\t"
+        "vpbroadcastd 20(%%rsi), %%ymm14\n\t"
+        "vpmulld %%ymm12, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm10, %%ymm10\n\t"
+        "vpmulld %%ymm13, %%ymm14, %%ymm15\n\t"
+        "vpaddd %%ymm15, %%ymm11, %%ymm11\n\t"
+        "addq $24, %%rsi\n\t"
+        "addq $64, %%rdi\n\t"
+        "decq %%rcx\n\t"
+        "jnz 1b\n\t"
+        "movq %3, %%rdx\n\t"
+        "vpaddd (%%rdx), %%ymm0, %%ymm0\n\t" // Add the tile to C, row by row
+        "vpaddd 32(%%rdx), %%ymm1, %%ymm1\n\t"
+        "vmovups %%ymm0, (%%rdx)\n\t"
+        "vmovups %%ymm1, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vpaddd (%%rdx), %%ymm2, %%ymm2\n\t"
+        "vpaddd 32(%%rdx), %%ymm3, %%ymm3\n\t"
+        "vmovups %%ymm2, (%%rdx)\n\t"
+        "vmovups %%ymm3, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vpaddd (%%rdx), %%ymm4, %%ymm4\n\t"
+        "vpaddd 32(%%rdx), %%ymm5, %%ymm5\n\t"
+        "vmovups %%ymm4, (%%rdx)\n\t"
+        "vmovups %%ymm5, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vpaddd (%%rdx), %%ymm6, %%ymm6\n\t"
+        "vpaddd 32(%%rdx), %%ymm7, %%ymm7\n\t"
+        "vmovups %%ymm6, (%%rdx)\n\t"
+        "vmovups %%ymm7, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vpaddd (%%rdx), %%ymm8, %%ymm8\n\t"
+        "vpaddd 32(%%rdx), %%ymm9, %%ymm9\n\t"
+        "vmovups %%ymm8, (%%rdx)\n\t"
+        "vmovups %%ymm9, 32(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "vpaddd (%%rdx), %%ymm10, %%ymm10\n\t"
+        "vpaddd 32(%%rdx), %%ymm11, %%ymm11\n\t"
+        "vmovups %%ymm10, (%%rdx)\n\t"
+        "vmovups %%ymm11, 32(%%rdx)\n\t"
+        "vzeroupper\n\t"
+        :
+        : "r" (kc), "r" (a), "r" (b), "r" (c), "r" (c_stride * 4)
+        : "rcx", "rdx", "rsi", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory"
+    );
+}
+
+// With 16 xmm registers a 6x16 tile does not fit: the sse kernels make two
+// passes over the packed panels, 6x8 each
+static inline void gemm_f32_half_sse2(size_t kc, const void* a, const void* b, void* c,
+                                      size_t c_stride) {
+    __asm__ volatile (
+        "movq %0, %%rcx\n\t"
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rdi\n\t"
+        "pxor %%xmm0, %%xmm0\n\t"           // Accumulators: row i in xmm 2i, 2i+1
+        "pxor %%xmm1, %%xmm1\n\t"
+        "pxor %%xmm2, %%xmm2\n\t"
+        "pxor %%xmm3, %%xmm3\n\t"
+        "pxor %%xmm4, %%xmm4\n\t"
+        "pxor %%xmm5, %%xmm5\n\t"
+        "pxor %%xmm6, %%xmm6\n\t"
+        "pxor %%xmm7, %%xmm7\n\t"
+        "pxor %%xmm8, %%xmm8\n\t"
+        "pxor %%xmm9, %%xmm9\n\t"
+        "pxor %%xmm10, %%xmm10\n\t"
+        "pxor %%xmm11, %%xmm11\n\t"
+        "1:\n\t"
+        "movaps (%%rdi), %%xmm12\n\t"
+        "movaps 16(%%rdi), %%xmm13\n\t"
+        "movd 0(%%rsi), %%xmm14\n\t"        // A[i][k]
+        "pshufd $0, %%xmm14, %%xmm14\n\t"   // ... in every lane
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "mulps %%xmm12, %%xmm15\n\t"
+        "addps %%xmm15, %%xmm0\n\t"
+        "mulps %%xmm13, %%xmm14\n\t"
+        "addps %%xmm14, %%xmm1\n\t"
+        "movd 4(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "mulps %%xmm12, %%xmm15\n\t"
+        "addps %%xmm15, %%xmm2\n\t"
+        "mulps %%xmm13, %%xmm14\n\t"
+        "addps %%xmm14, %%xmm3\n\t"
+        "movd 8(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "mulps %%xmm12, %%xmm15\n\t"
+        "addps %%xmm15, %%xmm4\n\t"
+        "mulps %%xmm13, %%xmm14\n\t"
+        "addps %%xmm14, %%xmm5\n\t"
+        "movd 12(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "mulps %%xmm12, %%xmm15\n\t"
+        "addps %%xmm15, %%xmm6\n\t"
+        "mulps %%xmm13, %%xmm14\n\t"
+        "addps %%xmm14, %%xmm7\n\t"
+        "movd 16(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "mulps %%xmm12, %%xmm15\n\t"
+        "addps %%xmm15, %%xmm8\n\t"
+        "mulps %%xmm13, %%xmm14\n\t"
+        "addps %%xmm14, %%xmm9\n\t"
+        "movd 20(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "mulps %%xmm12, %%xmm15\n\t"
+        "addps %%xmm15, %%xmm10\n\t"
+        "mulps %%xmm13, %%xmm14\n\t"
+        "addps %%xmm14, %%xmm11\n\t"
+        "addq $24, %%rsi\n\t"
+        "addq $64, %%rdi\n\t"
+        "decq %%rcx\n\t"
+        "jnz 1b\n\t"
+        "movq %3, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"       // Add to C, row by row
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "addps %%xmm12, %%xmm0\n\t"
+        "addps %%xmm13, %%xmm1\n\t"
+        "movups %%xmm0, (%%rdx)\n\t"
+        "movups %%xmm1, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "addps %%xmm12, %%xmm2\n\t"
+        "addps %%xmm13, %%xmm3\n\t"
+        "movups %%xmm2, (%%rdx)\n\t"
+        "movups %%xmm3, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "addps %%xmm12, %%xmm4\n\t"
+        "addps %%xmm13, %%xmm5\n\t"
+        "movups %%xmm4, (%%rdx)\n\t"
+        "movups %%xmm5, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "addps %%xmm12, %%xmm6\n\t"
+        "addps %%xmm13, %%xmm7\n\t"
+        "movups %%xmm6, (%%rdx)\n\t"
+        "movups %%xmm7, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "addps %%xmm12, %%xmm8\n\t"
+        "addps %%xmm13, %%xmm9\n\t"
+        "movups %%xmm8, (%%rdx)\n\t"
+        "movups %%xmm9, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "addps %%xmm12, %%xmm10\n\t"
+        "addps %%xmm13, %%xmm11\n\t"
+        "movups %%xmm10, (%%rdx)\n\t"
+        "movups %%xmm11, 16(%%rdx)\n\t"
+        :
+        : "r" (kc), "r" (a), "r" (b), "r" (c), "r" (c_stride)
+        : "rcx", "rdx", "rsi", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory"
+    );
+}
+
+static inline void gemm_i32_half_sse41(size_t kc, const void* a, const void* b, void* c,
+                                       size_t c_stride) {
+    __asm__ volatile (
+        "movq %0, %%rcx\n\t"
+        "movq %1, %%rsi\n\t"
+        "movq %2, %%rdi\n\t"
+        "pxor %%xmm0, %%xmm0\n\t"           // Accumulators: row i in xmm 2i, 2i+1
+        "pxor %%xmm1, %%xmm1\n\t"
+        "pxor %%xmm2, %%xmm2\n\t"
+        "pxor %%xmm3, %%xmm3\n\t"
+        "pxor %%xmm4, %%xmm4\n\t"
+        "pxor %%xmm5, %%xmm5\n\t"
+        "pxor %%xmm6, %%xmm6\n\t"
+        "pxor %%xmm7, %%xmm7\n\t"
+        "pxor %%xmm8, %%xmm8\n\t"
+        "pxor %%xmm9, %%xmm9\n\t"
+        "pxor %%xmm10, %%xmm10\n\t"
+        "pxor %%xmm11, %%xmm11\n\t"
+        "1:\n\t"
+        "movaps (%%rdi), %%xmm12\n\t"
+        "movaps 16(%%rdi), %%xmm13\n\t"
+        "movd 0(%%rsi), %%xmm14\n\t"        // A[i][k]
+        "pshufd $0, %%xmm14, %%xmm14\n\t"   // ... in every lane
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "pmulld %%xmm12, %%xmm15\n\t"
+        "paddd %%xmm15, %%xmm0\n\t"
+        "pmulld %%xmm13, %%xmm14\n\t"
+        "paddd %%xmm14, %%xmm1\n\t"
+        "movd 4(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "pmulld %%xmm12, %%xmm15\n\t"
+        "paddd %%xmm15, %%xmm2\n\t"
+        "pmulld %%xmm13, %%xmm14\n\t"
+        "paddd %%xmm14, %%xmm3\n\t"
+        "movd 8(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "pmulld %%xmm12, %%xmm15\n\t"
+        "paddd %%xmm15, %%xmm4\n\t"
+        "pmulld %%xmm13, %%xmm14\n\t"
+        "paddd %%xmm14, %%xmm5\n\t"
+        "movd 12(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "pmulld %%xmm12, %%xmm15\n\t"
+        "paddd %%xmm15, %%xmm6\n\t"
+        "pmulld %%xmm13, %%xmm14\n\t"
+        "paddd %%xmm14, %%xmm7\n\t"
+        "movd 16(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "pmulld %%xmm12, %%xmm15\n\t"
+        "paddd %%xmm15, %%xmm8\n\t"
+        "pmulld %%xmm13, %%xmm14\n\t"
+        "paddd %%xmm14, %%xmm9\n\t"
+        "movd 20(%%rsi), %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "movdqa %%xmm14, %%xmm15\n\t"
+        "pmulld %%xmm12, %%xmm15\n\t"
+        "paddd %%xmm15, %%xmm10\n\t"
+        "pmulld %%xmm13, %%xmm14\n\t"
+        "paddd %%xmm14, %%xmm11\n\t"
+        "addq $24, %%rsi\n\t"
+        "addq $64, %%rdi\n\t"
+        "decq %%rcx\n\t"
+        "jnz 1b\n\t"
+        "movq %3, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"       // Add to C, row by row
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "paddd %%xmm12, %%xmm0\n\t"
+        "paddd %%xmm13, %%xmm1\n\t"
+        "movups %%xmm0, (%%rdx)\n\t"
+        "movups %%xmm1, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "paddd %%xmm12, %%xmm2\n\t"
+        "paddd %%xmm13, %%xmm3\n\t"
+        "movups %%xmm2, (%%rdx)\n\t"
+        "movups %%xmm3, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "paddd %%xmm12, %%xmm4\n\t"
+        "paddd %%xmm13, %%xmm5\n\t"
+        "movups %%xmm4, (%%rdx)\n\t"
+        "movups %%xmm5, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "paddd %%xmm12, %%xmm6\n\t"
+        "paddd %%xmm13, %%xmm7\n\t"
+        "movups %%xmm6, (%%rdx)\n\t"
+        "movups %%xmm7, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "paddd %%xmm12, %%xmm8\n\t"
+        "paddd %%xmm13, %%xmm9\n\t"
+        "movups %%xmm8, (%%rdx)\n\t"
+        "movups %%xmm9, 16(%%rdx)\n\t"
+        "addq %4, %%rdx\n\t"
+        "movups (%%rdx), %%xmm12\n\t"
+        "movups 16(%%rdx), %%xmm13\n\t"
+        "paddd %%xmm12, %%xmm10\n\t"
+        "paddd %%xmm13, %%xmm11\n\t"
+        "movups %%xmm10, (%%rdx)\n\t"
+        "movups %%xmm11, 16(%%rdx)\n\t"
+        :
+        : "r" (kc), "r" (a), "r" (b), "r" (c), "r" (c_stride)
+        : "rcx", "rdx", "rsi", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory"
+    );
+}
+
+void gemm_f32_kernel_sse2(size_t kc, const void* a, const void* b, void* c, size_t c_stride) {
+    gemm_f32_half_sse2(kc, a, b, c, c_stride * 4);
+    gemm_f32_half_sse2(kc, a, (const float*)b + 8, (float*)c + 8, c_stride * 4);
+}
+
+void gemm_i32_kernel_sse41(size_t kc, const void* a, const void* b, void* c, size_t c_stride) {
+    gemm_i32_half_sse41(kc, a, b, c, c_stride * 4);
+    gemm_i32_half_sse41(kc, a, (const int32_t*)b + 8, (int32_t*)c + 8, c_stride * 4);
+}
+
+// SSE2 has no 32-bit multiply that keeps the low halves (pmulld is SSE4.1)
+void gemm_i32_kernel_scalar(size_t kc, const void* a, const void* b, void* c, size_t c_stride) {
+    const uint32_t* pa = a;
+    const uint32_t* pb = b;
+    uint32_t* pc = c;
+    uint32_t acc[GEMM_MR][GEMM_NR] = {{0}};
+
+    for (size_t p = 0; p < kc; ++p, pa += GEMM_MR, pb += GEMM_NR) {
+        for (size_t i = 0; i < GEMM_MR; ++i) {
+            for (size_t j = 0; j < GEMM_NR; ++j) acc[i][j] += pa[i] * pb[j];
+        }
+    }
+    for (size_t i = 0; i < GEMM_MR; ++i) {
+        for (size_t j = 0; j < GEMM_NR; ++j) pc[i * c_stride + j] += acc[i][j];
+    }
+}
+
+// kc x nc block of B into 16-column panels, zero-padded past nc
+static void gemm_pack_b(uint32_t* dst, const uint32_t* b, size_t stride, size_t kc, size_t nc) {
+    for (size_t j0 = 0; j0 < nc; j0 += GEMM_NR) {
+        size_t w = nc - j0 < GEMM_NR ? nc - j0 : GEMM_NR;
+        for (size_t p = 0; p < kc; ++p, dst += GEMM_NR) {
+            const uint32_t* row = b + p * stride + j0;
+            size_t j = 0;
+            for (; j < w; ++j) dst[j] = row[j];
+            for (; j < GEMM_NR; ++j) dst[j] = 0;
+        }
+    }
+}
+
+// mc x kc block of A into 6-row panels, zero-padded past mc
+static void gemm_pack_a(uint32_t* dst, const uint32_t* a, size_t stride, size_t mc, size_t kc) {
+    for (size_t i0 = 0; i0 < mc; i0 += GEMM_MR) {
+        size_t h = mc - i0 < GEMM_MR ? mc - i0 : GEMM_MR;
+        for (size_t p = 0; p < kc; ++p, dst += GEMM_MR) {
+            size_t i = 0;
+            for (; i < h; ++i) dst[i] = a[(i0 + i) * stride + p];
+            for (; i < GEMM_MR; ++i) dst[i] = 0;
+        }
+    }
+}
+
+static void* gemm_alloc(size_t elements) {
+    size_t bytes = (elements * sizeof(uint32_t) + 63) & ~(size_t)63;
+    return aligned_alloc(64, bytes);
+}
+
+// C = A * B on raw 32-bit elements; the kernel decides what they are
+static int gemm_blocked(gemm_kernel_fn kernel, int is_float, uint32_t* c, size_t c_stride,
+                        const uint32_t* a, size_t a_stride, const uint32_t* b, size_t b_stride,
+                        size_t m, size_t n, size_t k) {
+    size_t kc_max = k < GEMM_KC ? k : GEMM_KC;
+    size_t nc_max = n < GEMM_NC ? (n + GEMM_NR - 1) / GEMM_NR * GEMM_NR : GEMM_NC;
+    size_t mc_max = m < GEMM_MC ? (m + GEMM_MR - 1) / GEMM_MR * GEMM_MR : GEMM_MC;
+    uint32_t* pack_a = NULL;
+    uint32_t* pack_b = NULL;
+    uint32_t tile[GEMM_MR * GEMM_NR] __attribute__((aligned(32)));
+
+    if (k && m && n) {
+        pack_a = gemm_alloc(mc_max * kc_max);
+        pack_b = gemm_alloc(kc_max * nc_max);
+        if (!pack_a || !pack_b) {
+            free(pack_a);
+            free(pack_b);
+            return 0;
+        }
+    }
+    for (size_t i = 0; i < m; ++i) memset(c + i * c_stride, 0, n * sizeof(uint32_t));
+    if (!pack_a) return 1;
+
+    for (size_t jc = 0; jc < n; jc += GEMM_NC) {
+        size_t nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+        for (size_t pc = 0; pc < k; pc += GEMM_KC) {
+            size_t kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+            gemm_pack_b(pack_b, b + pc * b_stride + jc, b_stride, kc, nc);
+            for (size_t ic = 0; ic < m; ic += GEMM_MC) {
+                size_t mc = m - ic < GEMM_MC ? m - ic : GEMM_MC;
+                gemm_pack_a(pack_a, a + ic * a_stride + pc, a_stride, mc, kc);
+
+                // One B panel against every A panel while it sits in L1
+                for (size_t jr = 0; jr < nc; jr += GEMM_NR) {
+                    for (size_t ir = 0; ir < mc; ir += GEMM_MR) {
+                        const uint32_t* pa = pack_a + ir * kc;
+                        const uint32_t* pb = pack_b + jr * kc;
+                        uint32_t* pc_tile = c + (ic + ir) * c_stride + jc + jr;
+                        size_t h = mc - ir < GEMM_MR ? mc - ir : GEMM_MR;
+                        size_t w = nc - jr < GEMM_NR ? nc - jr : GEMM_NR;
+
+                        if (h == GEMM_MR && w == GEMM_NR) {
+                            kernel(kc, pa, pb, pc_tile, c_stride);
+                            continue;
+                        }
+                        memset(tile, 0, sizeof(tile));
+                        kernel(kc, pa, pb, tile, GEMM_NR);
+                        for (size_t i = 0; i < h; ++i) {
+                            for (size_t j = 0; j < w; ++j) {
+                                uint32_t* dst = pc_tile + i * c_stride + j;
+                                if (is_float) {
+                                    float sum, part;
+                                    memcpy(&sum, dst, sizeof(sum));
+                                    memcpy(&part, &tile[i * GEMM_NR + j], sizeof(part));
+                                    sum += part;
+                                    memcpy(dst, &sum, sizeof(sum));
+                                } else {
+                                    *dst += tile[i * GEMM_NR + j];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    free(pack_a);
+    free(pack_b);
+    return 1;
+}
+
+int matrix_multiply_f32_with(gemm_kernel_fn kernel, struct assm_matrix_f32 c,
+                             struct assm_matrix_f32 a, struct assm_matrix_f32 b) {
+    if (a.cols != b.rows || c.rows != a.rows || c.cols != b.cols) return 0;
+    return gemm_blocked(kernel, 1, (uint32_t*)c.data, c.stride, (const uint32_t*)a.data, a.stride,
+                        (const uint32_t*)b.data, b.stride, a.rows, b.cols, a.cols);
+}
+
+int matrix_multiply_i32_with(gemm_kernel_fn kernel, struct assm_matrix_i32 c,
+                             struct assm_matrix_i32 a, struct assm_matrix_i32 b) {
+    if (a.cols != b.rows || c.rows != a.rows || c.cols != b.cols) return 0;
+    return gemm_blocked(kernel, 0, (uint32_t*)c.data, c.stride, (const uint32_t*)a.data, a.stride,
+                        (const uint32_t*)b.data, b.stride, a.rows, b.cols, a.cols);
+}
+
+int assm_matrix_multiply_f32(struct assm_matrix_f32 c, struct assm_matrix_f32 a,
+                             struct assm_matrix_f32 b) {
+    return matrix_multiply_f32_with(ASSM_DISPATCH(gemm_f32_kernel), c, a, b);
+}
+
+int assm_matrix_multiply_i32(struct assm_matrix_i32 c, struct assm_matrix_i32 a,
+                             struct assm_matrix_i32 b) {
+    return matrix_multiply_i32_with(ASSM_DISPATCH(gemm_i32_kernel), c, a, b);
+}
+
+void matrix_add_row_f32_sse2(float* sums, const float* row, size_t n) {
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"
+        "1:\n\t"                            // loop_8
+        "leaq 8(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 3f\n\t"
+        "movups (%0,%%rax,4), %%xmm0\n\t"
+        "movups 16(%0,%%rax,4), %%xmm1\n\t"
+        "movups (%1,%%rax,4), %%xmm2\n\t"
+        "movups 16(%1,%%rax,4), %%xmm3\n\t"
+        "addps %%xmm2, %%xmm0\n\t"
+        "addps %%xmm3, %%xmm1\n\t"
+        "movups %%xmm0, (%0,%%rax,4)\n\t"
+        "movups %%xmm1, 16(%0,%%rax,4)\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rax\n\t"
+        "jae 4f\n\t"
+        "movss (%0,%%rax,4), %%xmm0\n\t"
+        "addss (%1,%%rax,4), %%xmm0\n\t"
+        "movss %%xmm0, (%0,%%rax,4)\n\t"
+        "incq %%rax\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        :
+        : "r" (sums), "r" (row), "r" (n)
+        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+}
+
+void matrix_add_row_f32_avx2(float* sums, const float* row, size_t n) {
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"
+        "1:\n\t"                            // loop_32
+        "leaq 32(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 2f\n\t"
+        "vmovups (%0,%%rax,4), %%ymm0\n\t"
+        "vmovups 32(%0,%%rax,4), %%ymm1\n\t"
+        "vmovups 64(%0,%%rax,4), %%ymm2\n\t"
+        "vmovups 96(%0,%%rax,4), %%ymm3\n\t"
+        "vaddps (%1,%%rax,4), %%ymm0, %%ymm0\n\t"
+        "vaddps 32(%1,%%rax,4), %%ymm1, %%ymm1\n\t"
+        "vaddps 64(%1,%%rax,4), %%ymm2, %%ymm2\n\t"
+        "vaddps 96(%1,%%rax,4), %%ymm3, %%ymm3\n\t"
+        "vmovups %%ymm0, (%0,%%rax,4)\n\t"
+        "vmovups %%ymm1, 32(%0,%%rax,4)\n\t"
+        "vmovups %%ymm2, 64(%0,%%rax,4)\n\t"
+        "vmovups %%ymm3, 96(%0,%%rax,4)\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // loop_8
+        "leaq 8(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 3f\n\t"
+        "vmovups (%0,%%rax,4), %%ymm0\n\t"
+        "vaddps (%1,%%rax,4), %%ymm0, %%ymm0\n\t"
+        "vmovups %%ymm0, (%0,%%rax,4)\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rax\n\t"
+        "jae 4f\n\t"
+        "vmovss (%0,%%rax,4), %%xmm0\n\t"
+        "vaddss (%1,%%rax,4), %%xmm0, %%xmm0\n\t"
+        "vmovss %%xmm0, (%0,%%rax,4)\n\t"
+        "incq %%rax\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        "vzeroupper\n\t"
+        :
+        : "r" (sums), "r" (row), "r" (n)
+        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+}
+
+void matrix_add_row_i32_sse2(int64_t* sums, const int32_t* row, size_t n) {
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"
+        "1:\n\t"                            // loop_4
+        "leaq 4(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 3f\n\t"
+        "movdqu (%1,%%rax,4), %%xmm1\n\t"
+        "movdqa %%xmm1, %%xmm2\n\t"
+        "psrad $31, %%xmm2\n\t"             // Sign of each element
+        "movdqa %%xmm1, %%xmm0\n\t"
+        "punpckldq %%xmm2, %%xmm0\n\t"      // Elements 0, 1 as int64
+        "punpckhdq %%xmm2, %%xmm1\n\t"      // Elements 2, 3
+        "movdqu (%0,%%rax,8), %%xmm3\n\t"
+        "movdqu 16(%0,%%rax,8), %%xmm4\n\t"
+        "paddq %%xmm3, %%xmm0\n\t"
+        "paddq %%xmm4, %%xmm1\n\t"
+        "movdqu %%xmm0, (%0,%%rax,8)\n\t"
+        "movdqu %%xmm1, 16(%0,%%rax,8)\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rax\n\t"
+        "jae 4f\n\t"
+        "movslq (%1,%%rax,4), %%rcx\n\t"
+        "addq %%rcx, (%0,%%rax,8)\n\t"
+        "incq %%rax\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        :
+        : "r" (sums), "r" (row), "r" (n)
+        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "memory"
+    );
+}
+
+void matrix_add_row_i32_avx2(int64_t* sums, const int32_t* row, size_t n) {
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"
+        "1:\n\t"                            // loop_16
+        "leaq 16(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 2f\n\t"
+        "vpmovsxdq (%1,%%rax,4), %%ymm0\n\t" // Widen 4 elements to 64 bits
+        "vpmovsxdq 16(%1,%%rax,4), %%ymm1\n\t"
+        "vpmovsxdq 32(%1,%%rax,4), %%ymm2\n\t"
+        "vpmovsxdq 48(%1,%%rax,4), %%ymm3\n\t"
+        "vpaddq (%0,%%rax,8), %%ymm0, %%ymm0\n\t"
+        "vpaddq 32(%0,%%rax,8), %%ymm1, %%ymm1\n\t"
+        "vpaddq 64(%0,%%rax,8), %%ymm2, %%ymm2\n\t"
+        "vpaddq 96(%0,%%rax,8), %%ymm3, %%ymm3\n\t"
+        "vmovdqu %%ymm0, (%0,%%rax,8)\n\t"
+        "vmovdqu %%ymm1, 32(%0,%%rax,8)\n\t"
+        "vmovdqu %%ymm2, 64(%0,%%rax,8)\n\t"
+        "vmovdqu %%ymm3, 96(%0,%%rax,8)\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // loop_4
+        "leaq 4(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 3f\n\t"
+        "vpmovsxdq (%1,%%rax,4), %%ymm0\n\t"
+        "vpaddq (%0,%%rax,8), %%ymm0, %%ymm0\n\t"
+        "vmovdqu %%ymm0, (%0,%%rax,8)\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rax\n\t"
+        "jae 4f\n\t"
+        "movslq (%1,%%rax,4), %%rcx\n\t"
+        "addq %%rcx, (%0,%%rax,8)\n\t"
+        "incq %%rax\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        "vzeroupper\n\t"
+        :
+        : "r" (sums), "r" (row), "r" (n)
+        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+}
+
+float matrix_row_sum_f32_sse2(const float* row, size_t n) {
+    float sum;
+
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"
+        "xorps %%xmm0, %%xmm0\n\t"          // Two accumulators
+        "xorps %%xmm1, %%xmm1\n\t"
+        "1:\n\t"                            // loop_8
+        "leaq 8(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 3f\n\t"
+        "movups (%1,%%rax,4), %%xmm2\n\t"
+        "movups 16(%1,%%rax,4), %%xmm3\n\t"
+        "addps %%xmm2, %%xmm0\n\t"
+        "addps %%xmm3, %%xmm1\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"                            // reduce
+        "addps %%xmm1, %%xmm0\n\t"
+        "movhlps %%xmm0, %%xmm1\n\t"
+        "addps %%xmm1, %%xmm0\n\t"
+        "movaps %%xmm0, %%xmm1\n\t"
+        "shufps $0x55, %%xmm1, %%xmm1\n\t"
+        "addss %%xmm1, %%xmm0\n\t"
+        "4:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rax\n\t"
+        "jae 5f\n\t"
+        "addss (%1,%%rax,4), %%xmm0\n\t"
+        "incq %%rax\n\t"
+        "jmp 4b\n\t"
+        "5:\n\t"
+        "movss %%xmm0, %0\n\t"
+        : "=m" (sum)
+        : "r" (row), "r" (n)
+        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+
+    return sum;
+}
+
+float matrix_row_sum_f32_avx2(const float* row, size_t n) {
+    float sum;
+
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"
+        "vxorps %%xmm0, %%xmm0, %%xmm0\n\t" // Four accumulators
+        "vxorps %%xmm1, %%xmm1, %%xmm1\n\t"
+        "vxorps %%xmm2, %%xmm2, %%xmm2\n\t"
+        "vxorps %%xmm3, %%xmm3, %%xmm3\n\t"
+        "1:\n\t"                            // loop_32
+        "leaq 32(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 2f\n\t"
+        "vaddps (%1,%%rax,4), %%ymm0, %%ymm0\n\t"
+        "vaddps 32(%1,%%rax,4), %%ymm1, %%ymm1\n\t"
+        "vaddps 64(%1,%%rax,4), %%ymm2, %%ymm2\n\t"
+        "vaddps 96(%1,%%rax,4), %%ymm3, %%ymm3\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // loop_8
+        "leaq 8(%%rax), %%rcx\n\t"
+        "cmpq %2, %%rcx\n\t"
+        "ja 3f\n\t"
+        "vaddps (%1,%%rax,4), %%ymm0, %%ymm0\n\t"
+        "movq %%rcx, %%rax\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // reduce
+        "vaddps %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vaddps %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vaddps %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vextractf128 $1, %%ymm0, %%xmm1\n\t"
+        "vaddps %%xmm1, %%xmm0, %%xmm0\n\t"
+        "vmovhlps %%xmm0, %%xmm0, %%xmm1\n\t"
+        "vaddps %%xmm1, %%xmm0, %%xmm0\n\t"
+        "vmovshdup %%xmm0, %%xmm1\n\t"
+        "vaddss %%xmm1, %%xmm0, %%xmm0\n\t"
+        "4:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rax\n\t"
+        "jae 5f\n\t"
+        "vaddss (%1,%%rax,4), %%xmm0, %%xmm0\n\t"
+        "incq %%rax\n\t"
+        "jmp 4b\n\t"
+        "5:\n\t"
+        "vmovss %%xmm0, %0\n\t"
+        "vzeroupper\n\t"
+        : "=m" (sum)
+        : "r" (row), "r" (n)
+        : "rax", "rcx", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+
+    return sum;
+}
+
+int64_t matrix_row_sum_i32_sse2(const int32_t* row, size_t n) {
+    int64_t sum;
+
+    __asm__ volatile (
+        "xorl %%ecx, %%ecx\n\t"
+        "pxor %%xmm5, %%xmm5\n\t"           // Two int64 accumulators
+        "pxor %%xmm6, %%xmm6\n\t"
+        "1:\n\t"                            // loop_4
+        "leaq 4(%%rcx), %%rdx\n\t"
+        "cmpq %2, %%rdx\n\t"
+        "ja 2f\n\t"
+        "movdqu (%1,%%rcx,4), %%xmm1\n\t"
+        "movdqa %%xmm1, %%xmm2\n\t"
+        "psrad $31, %%xmm2\n\t"             // Sign of each element
+        "movdqa %%xmm1, %%xmm0\n\t"
+        "punpckldq %%xmm2, %%xmm0\n\t"      // Elements 0, 1 as int64
+        "punpckhdq %%xmm2, %%xmm1\n\t"      // Elements 2, 3
+        "paddq %%xmm0, %%xmm5\n\t"
+        "paddq %%xmm1, %%xmm6\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // reduce
+        "paddq %%xmm6, %%xmm5\n\t"
+        "pshufd $0x4e, %%xmm5, %%xmm6\n\t"
+        "paddq %%xmm6, %%xmm5\n\t"
+        "movq %%xmm5, %%rax\n\t"
+        "3:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rcx\n\t"
+        "jae 4f\n\t"
+        "movslq (%1,%%rcx,4), %%rdx\n\t"
+        "addq %%rdx, %%rax\n\t"
+        "incq %%rcx\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        : "=&a" (sum)
+        : "r" (row), "r" (n)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm5", "xmm6", "memory"
+    );
+
+    return sum;
+}
+
+int64_t matrix_row_sum_i32_avx2(const int32_t* row, size_t n) {
+    int64_t sum;
+
+    __asm__ volatile (
+        "xorl %%ecx, %%ecx\n\t"
+        "vpxor %%ymm0, %%ymm0, %%ymm0\n\t"  // Four int64 accumulators
+        "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"
+        "vpxor %%ymm2, %%ymm2, %%ymm2\n\t"
+        "vpxor %%ymm3, %%ymm3, %%ymm3\n\t"
+        "1:\n\t"                            // loop_16
+        "leaq 16(%%rcx), %%rdx\n\t"
+        "cmpq %2, %%rdx\n\t"
+        "ja 2f\n\t"
+        "vpmovsxdq (%1,%%rcx,4), %%ymm4\n\t"
+        "vpmovsxdq 16(%1,%%rcx,4), %%ymm5\n\t"
+        "vpmovsxdq 32(%1,%%rcx,4), %%ymm6\n\t"
+        "vpmovsxdq 48(%1,%%rcx,4), %%ymm7\n\t"
+        "vpaddq %%ymm4, %%ymm0, %%ymm0\n\t"
+        "vpaddq %%ymm5, %%ymm1, %%ymm1\n\t"
+        "vpaddq %%ymm6, %%ymm2, %%ymm2\n\t"
+        "vpaddq %%ymm7, %%ymm3, %%ymm3\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // reduce
+        "vpaddq %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpaddq %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpaddq %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vextracti128 $1, %%ymm0, %%xmm1\n\t"
+        "vpaddq %%xmm1, %%xmm0, %%xmm0\n\t"
+        "vpshufd $0x4e, %%xmm0, %%xmm1\n\t"
+        "vpaddq %%xmm1, %%xmm0, %%xmm0\n\t"
+        "vmovq %%xmm0, %%rax\n\t"
+        "3:\n\t"                            // tail: one at a time
+        "cmpq %2, %%rcx\n\t"
+        "jae 4f\n\t"
+        "movslq (%1,%%rcx,4), %%rdx\n\t"
+        "addq %%rdx, %%rax\n\t"
+        "incq %%rcx\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        "vzeroupper\n\t"
+        : "=&a" (sum)
+        : "r" (row), "r" (n)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "memory"
+    );
+
+    return sum;
+}
+
+void assm_matrix_row_sums_f32(struct assm_matrix_f32 m, float* sums) {
+    float (*row_sum)(const float*, size_t) = ASSM_DISPATCH(matrix_row_sum_f32);
+
+    for (size_t i = 0; i < m.rows; ++i) sums[i] = row_sum(m.data + i * m.stride, m.cols);
+}
+
+void assm_matrix_row_sums_i32(struct assm_matrix_i32 m, int64_t* sums) {
+    int64_t (*row_sum)(const int32_t*, size_t) = ASSM_DISPATCH(matrix_row_sum_i32);
+
+    for (size_t i = 0; i < m.rows; ++i) sums[i] = row_sum(m.data + i * m.stride, m.cols);
+}
+
+void assm_matrix_col_sums_f32(struct assm_matrix_f32 m, float* sums) {
+    void (*add_row)(float*, const float*, size_t) = ASSM_DISPATCH(matrix_add_row_f32);
+
+    if (m.cols == 0) return;                    // sums may be NULL
+    memset(sums, 0, m.cols * sizeof(*sums));
+    for (size_t j = 0; j < m.cols; j += MATRIX_SUM_STRIP) {
+        size_t w = m.cols - j < MATRIX_SUM_STRIP ? m.cols - j : MATRIX_SUM_STRIP;
+        for (size_t i = 0; i < m.rows; ++i) add_row(sums + j, m.data + i * m.stride + j, w);
+    }
+}
+
+void assm_matrix_col_sums_i32(struct assm_matrix_i32 m, int64_t* sums) {
+    void (*add_row)(int64_t*, const int32_t*, size_t) = ASSM_DISPATCH(matrix_add_row_i32);
+
+    if (m.cols == 0) return;                    // sums may be NULL
+    memset(sums, 0, m.cols * sizeof(*sums));
+    for (size_t j = 0; j < m.cols; j += MATRIX_SUM_STRIP) {
+        size_t w = m.cols - j < MATRIX_SUM_STRIP ? m.cols - j : MATRIX_SUM_STRIP;
+        for (size_t i = 0; i < m.rows; ++i) add_row(sums + j, m.data + i * m.stride + j, w);
+    }
+}
+
+// Storage layouts for long matrices (matrix_get_asm's element type). In
+// Z-order element (row, col) sits at the interleave of the bits of col (even
+// positions) and row (odd positions), so every aligned 2^k x 2^k square is
+// contiguous and a 2D neighbourhood shares cache lines and pages whichever
+// way it is walked. The index is two pdep instructions with BMI2; without it
+// each coordinate is spread with five shift/mask steps. The tiled layout
+// stores ASSM_MATRIX_TILE x ASSM_MATRIX_TILE squares one after another, row
+// by row, each square row-major: one 64-byte line per tile row.
+#define MORTON_EVEN 0x5555555555555555ull
+
+size_t matrix_morton_index_bmi2(size_t row, size_t col) {
+    size_t index;
+
+    __asm__ (
+        "movabsq $0x5555555555555555, %%rcx\n\t"
+        "pdepq %%rcx, %2, %0\n\t"           // col bits to the even positions
+        "movabsq $0xaaaaaaaaaaaaaaaa, %%rcx\n\t"
+        "pdepq %%rcx, %1, %%rcx\n\t"        // row bits to the odd positions
+        "orq %%rcx, %0\n\t"
+        : "=&r" (index)
+        : "r" (row), "r" (col)
+        : "rcx"
+    );
+
+    return index;
+}
+
+// The low 32 bits of x to the even bit positions
+static inline uint64_t morton_spread(uint64_t x) {
+    x &= 0xFFFFFFFFull;
+    x = (x | x << 16) & 0x0000FFFF0000FFFFull;
+    x = (x | x << 8) & 0x00FF00FF00FF00FFull;
+    x = (x | x << 4) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | x << 2) & 0x3333333333333333ull;
+    x = (x | x << 1) & 0x5555555555555555ull;
+    return x;
+}
+
+size_t matrix_morton_index_shift(size_t row, size_t col) {
+    return morton_spread(col) | morton_spread(row) << 1;
+}
+
+size_t matrix_morton_index(size_t row, size_t col) {
+    return ASSM_DISPATCH(morton_index)(row, col);
+}
+
+// Morton order is monotonic in each coordinate, so the last element is the
+// highest index
+size_t matrix_morton_size(size_t rows, size_t cols) {
+    return rows && cols ? matrix_morton_index_shift(rows - 1, cols - 1) + 1 : 0;
+}
+
+long matrix_get_morton_asm(const long* matrix, size_t row, size_t col) {
+    return matrix[ASSM_DISPATCH(morton_index)(row, col)];
+}
+
+// Walks the source rows two at a time so the writes fill whole lines (a
+// line of Z-order is 2 rows x 4 columns); the column part of the index is
+// stepped in its spread form: (x - mask) & mask adds one to the bits under
+// mask.
+void matrix_to_morton(long* dst, const long* src, size_t rows, size_t cols) {
+    for (size_t i = 0; i < rows; i += 2) {
+        uint64_t y = morton_spread(i) << 1, x = 0;
+        const long* r0 = src + i * cols;
+        if (i + 1 < rows) {
+            const long* r1 = r0 + cols;
+            for (size_t j = 0; j < cols; ++j, x = (x - MORTON_EVEN) & MORTON_EVEN) {
+                dst[y | x] = r0[j];
+                dst[y | 2 | x] = r1[j];
+            }
+        } else {
+            for (size_t j = 0; j < cols; ++j, x = (x - MORTON_EVEN) & MORTON_EVEN) dst[y | x] = r0[j];
+        }
+    }
+}
+
+void matrix_from_morton(long* dst, const long* src, size_t rows, size_t cols) {
+    for (size_t i = 0; i < rows; i += 2) {
+        uint64_t y = morton_spread(i) << 1, x = 0;
+        long* r0 = dst + i * cols;
+        if (i + 1 < rows) {
+            long* r1 = r0 + cols;
+            for (size_t j = 0; j < cols; ++j, x = (x - MORTON_EVEN) & MORTON_EVEN) {
+                r0[j] = src[y | x];
+                r1[j] = src[y | 2 | x];
+            }
+        } else {
+            for (size_t j = 0; j < cols; ++j, x = (x - MORTON_EVEN) & MORTON_EVEN) r0[j] = src[y | x];
+        }
+    }
+}
+
+size_t matrix_tiled_size(size_t rows, size_t cols) {
+    size_t t = ASSM_MATRIX_TILE;
+    return (rows + t - 1) / t * t * ((cols + t - 1) / t * t);
+}
+
+long matrix_get_tiled_asm(const long* matrix, size_t cols, size_t row, size_t col) {
+    long value;
+
+    __asm__ volatile (
+        "leaq 7(%2), %%rax\n\t"
+        "shrq $3, %%rax\n\t"                // Tiles per row
+        "movq %3, %%rdx\n\t"
+        "shrq $3, %%rdx\n\t"
+        "imulq %%rdx, %%rax\n\t"            // Tiles above the row's tile row
+        "movq %4, %%rdx\n\t"
+        "shrq $3, %%rdx\n\t"
+        "addq %%rdx, %%rax\n\t"             // Tile number
+        "shlq $6, %%rax\n\t"                // First element of the tile
+        "movq %3, %%rdx\n\t"
+        "andq $7, %%rdx\n\t"
+        "leaq (%%rax,%%rdx,8), %%rax\n\t"   // Row inside the tile
+        "movq %4, %%rdx\n\t"
+        "andq $7, %%rdx\n\t"
+        "addq %%rdx, %%rax\n\t"             // Column inside the tile
+        "movq (%1,%%rax,8), %0\n\t"
+        : "=&a" (value)
+        : "r" (matrix), "r" (cols), "r" (row), "r" (col)
+        : "rdx", "memory"
+    );
+
+    return value;
+}
+
+// One tile row (up to 8 longs, a cache line) at a time
+void matrix_to_tiled(long* dst, const long* src, size_t rows, size_t cols) {
+    size_t t = ASSM_MATRIX_TILE, tiles_per_row = (cols + t - 1) / t;
+
+    for (size_t i = 0; i < rows; ++i) {
+        long* tile_row = dst + (i / t * tiles_per_row * t + i % t) * t;
+        for (size_t j = 0; j < cols; j += t) {
+            size_t w = cols - j < t ? cols - j : t;
+            memcpy(tile_row + j * t, src + i * cols + j, w * sizeof(long));
+        }
+    }
+}
+
+void matrix_from_tiled(long* dst, const long* src, size_t rows, size_t cols) {
+    size_t t = ASSM_MATRIX_TILE, tiles_per_row = (cols + t - 1) / t;
+
+    for (size_t i = 0; i < rows; ++i) {
+        const long* tile_row = src + (i / t * tiles_per_row * t + i % t) * t;
+        for (size_t j = 0; j < cols; j += t) {
+            size_t w = cols - j < t ? cols - j : t;
+            memcpy(dst + i * cols + j, tile_row + j * t, w * sizeof(long));
+        }
+    }
+}
+
+// Batched lookups: the address math of many lookups overlaps and, with a
+// prefetch distance, so do their cache misses. Each lookup still costs one
+// miss into a large matrix; the aim is to have many in flight. The AVX2
+// kernel computes four addresses at once (row * cols as three vpmuludq, as
+// AVX2 has no 64-bit multiply) and loads them with one vpgatherqq.
+void matrix_gather_scalar(const long* matrix, size_t cols, const size_t* rows, const size_t* col_idx,
+                          size_t n, long* out, size_t distance) {
+    __asm__ volatile (
+        "xorl %%ecx, %%ecx\n\t"
+        "movq %4, %%r8\n\t"
+        "subq %6, %%r8\n\t"                 // Last element with a prefetch target
+        "testq %6, %6\n\t"
+        "jz 3f\n\t"                         // distance 0: no prefetch
+        "cmpq %4, %6\n\t"
+        "jae 3f\n\t"
+        "1:\n\t"                            // loop with prefetch
+        "cmpq %%r8, %%rcx\n\t"
+        "jae 3f\n\t"
+        "leaq (%%rcx,%6), %%rdx\n\t"
+        "movq (%2,%%rdx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq (%3,%%rdx,8), %%rax\n\t"
+        "prefetcht0 (%0,%%rax,8)\n\t"       // Element distance ahead
+        "movq (%2,%%rcx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq (%3,%%rcx,8), %%rax\n\t"
+        "movq (%0,%%rax,8), %%rax\n\t"
+        "movq %%rax, (%5,%%rcx,8)\n\t"
+        "incq %%rcx\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"                            // rest without prefetch
+        "cmpq %4, %%rcx\n\t"
+        "jae 4f\n\t"
+        "movq (%2,%%rcx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq (%3,%%rcx,8), %%rax\n\t"
+        "movq (%0,%%rax,8), %%rax\n\t"
+        "movq %%rax, (%5,%%rcx,8)\n\t"
+        "incq %%rcx\n\t"
+        "jmp 3b\n\t"
+        "4:\n\t"
+        :
+        : "r" (matrix), "r" (cols), "r" (rows), "r" (col_idx), "r" (n), "r" (out), "r" (distance)
+        : "rax", "rcx", "rdx", "r8", "memory"
+    );
+}
+
+void matrix_gather_avx2(const long* matrix, size_t cols, const size_t* rows, const size_t* col_idx,
+                        size_t n, long* out, size_t distance) {
+    __asm__ volatile (
+        "vmovq %1, %%xmm15\n\t"
+        "vpbroadcastq %%xmm15, %%ymm15\n\t" // cols
+        "vpsrlq $32, %%ymm15, %%ymm14\n\t"  // its high half
+        "xorl %%ecx, %%ecx\n\t"
+        "movq %4, %%r8\n\t"
+        "subq %6, %%r8\n\t"
+        "subq $4, %%r8\n\t"                 // Last group with prefetch targets
+        "testq %6, %6\n\t"
+        "jz 3f\n\t"                         // distance 0: no prefetch
+        "leaq 4(%6), %%rdx\n\t"
+        "cmpq %4, %%rdx\n\t"
+        "ja 3f\n\t"
+        "1:\n\t"                            // loop with prefetch: 4 per iteration
+        "cmpq %%r8, %%rcx\n\t"
+        "ja 3f\n\t"
+        "leaq (%%rcx,%6), %%rdx\n\t"
+        "movq (%2,%%rdx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq (%3,%%rdx,8), %%rax\n\t"
+        "prefetcht0 (%0,%%rax,8)\n\t"       // The group distance ahead
+        "movq 8(%2,%%rdx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq 8(%3,%%rdx,8), %%rax\n\t"
+        "prefetcht0 (%0,%%rax,8)\n\t"
+        "movq 16(%2,%%rdx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq 16(%3,%%rdx,8), %%rax\n\t"
+        "prefetcht0 (%0,%%rax,8)\n\t"
+        "movq 24(%2,%%rdx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq 24(%3,%%rdx,8), %%rax\n\t"
+        "prefetcht0 (%0,%%rax,8)\n\t"
+        "vmovdqu (%2,%%rcx,8), %%ymm0\n\t"  // Four row indices
+        "vpsrlq $32, %%ymm0, %%ymm1\n\t"    // row * cols in 64 bits from
+        "vpmuludq %%ymm15, %%ymm1, %%ymm1\n\t" // three 32x32 products
+        "vpmuludq %%ymm14, %%ymm0, %%ymm2\n\t"
+        "vpaddq %%ymm2, %%ymm1, %%ymm1\n\t"
+        "vpsllq $32, %%ymm1, %%ymm1\n\t"
+        "vpmuludq %%ymm15, %%ymm0, %%ymm0\n\t"
+        "vpaddq %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpaddq (%3,%%rcx,8), %%ymm0, %%ymm0\n\t" // + col
+        "vpcmpeqd %%ymm3, %%ymm3, %%ymm3\n\t" // Gather every lane
+        "vpxor %%ymm4, %%ymm4, %%ymm4\n\t"  // No dependency on the last gather
+        "vpgatherqq %%ymm3, (%0,%%ymm0,8), %%ymm4\n\t"
+        "vmovdqu %%ymm4, (%5,%%rcx,8)\n\t"
+        "addq $4, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"                            // rest of the groups
+        "leaq 4(%%rcx), %%rdx\n\t"
+        "cmpq %4, %%rdx\n\t"
+        "ja 5f\n\t"
+        "vmovdqu (%2,%%rcx,8), %%ymm0\n\t"  // Four row indices
+        "vpsrlq $32, %%ymm0, %%ymm1\n\t"    // row * cols in 64 bits from
+        "vpmuludq %%ymm15, %%ymm1, %%ymm1\n\t" // three 32x32 products
+        "vpmuludq %%ymm14, %%ymm0, %%ymm2\n\t"
+        "vpaddq %%ymm2, %%ymm1, %%ymm1\n\t"
+        "vpsllq $32, %%ymm1, %%ymm1\n\t"
+        "vpmuludq %%ymm15, %%ymm0, %%ymm0\n\t"
+        "vpaddq %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpaddq (%3,%%rcx,8), %%ymm0, %%ymm0\n\t" // + col
+        "vpcmpeqd %%ymm3, %%ymm3, %%ymm3\n\t" // Gather every lane
+        "vpxor %%ymm4, %%ymm4, %%ymm4\n\t"  // No dependency on the last gather
+        "vpgatherqq %%ymm3, (%0,%%ymm0,8), %%ymm4\n\t"
+        "vmovdqu %%ymm4, (%5,%%rcx,8)\n\t"
+        "addq $4, %%rcx\n\t"
+        "jmp 3b\n\t"
+        "5:\n\t"                            // tail: one at a time
+        "cmpq %4, %%rcx\n\t"
+        "jae 6f\n\t"
+        "movq (%2,%%rcx,8), %%rax\n\t"
+        "imulq %1, %%rax\n\t"
+        "addq (%3,%%rcx,8), %%rax\n\t"
+        "movq (%0,%%rax,8), %%rax\n\t"
+        "movq %%rax, (%5,%%rcx,8)\n\t"
+        "incq %%rcx\n\t"
+        "jmp 5b\n\t"
+        "6:\n\t"
+        "vzeroupper\n\t"
+        :
+        : "r" (matrix), "r" (cols), "r" (rows), "r" (col_idx), "r" (n), "r" (out), "r" (distance)
+        : "rax", "rcx", "rdx", "r8", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm14", "xmm15",
+          "memory"
+    );
+}
+
+void matrix_get_batch_asm(const long* matrix, size_t cols, const size_t* rows, const size_t* col_idx,
+                          size_t n, long* out, size_t prefetch_distance) {
+    ASSM_DISPATCH(matrix_gather)(matrix, cols, rows, col_idx, n, out, prefetch_distance);
+}
@@ -0,0 +1,525 @@
+// assm_memcpy.c - Size-class memcpy/memmove engine (tutorial 11 copy_array)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// Size classes, with V the vector width (16 for SSE2, 32 for AVX2):
+//   n <= 2V      two overlapping moves of the largest fitting width
+//                (8/16/32 bytes), loads before stores
+//   n <= 4V      two vectors from each end, loads before stores
+//   larger       unrolled loop of four unaligned loads and four aligned
+//                stores; the head vector and the last four vectors are
+//                loaded up front and stored at the end
+//   >= rep_movsb_min    rep movsb (default only on ERMS CPUs)
+//   >= nontemporal_min  the same loop with non-temporal stores, so a copy
+//                       larger than the LLC does not evict it
+// memmove uses the small classes as they are (every load precedes every
+// store) and the loop forwards or backwards depending on the overlap; the
+// rep movsb and streaming classes only apply to disjoint buffers.
+
+// Below this rep movsb loses to the vector loop on ERMS CPUs (its startup
+// cost is tens of cycles); above it the microcode moves whole cache lines
+#define REP_MOVSB_MIN 4096
+
+static struct assm_memcpy_tuning tuning;
+static int tuning_ready;
+
+static const struct assm_memcpy_tuning* current_tuning(void) {
+    if (!__atomic_load_n(&tuning_ready, __ATOMIC_ACQUIRE)) {
+        size_t llc = assm_cpu_llc_size();
+        unsigned features = assm_cpu_features();
+        tuning.rep_movsb_min = (features & ASSM_CPU_ERMS) ? REP_MOVSB_MIN : SIZE_MAX;
+        tuning.nontemporal_min = llc ? llc / 4 * 3 : SIZE_MAX;
+        __atomic_store_n(&tuning_ready, 1, __ATOMIC_RELEASE);
+    }
+    return &tuning;
+}
+
+void assm_memcpy_get_tuning(struct assm_memcpy_tuning* out) {
+    *out = *current_tuning();
+}
+
+void assm_memcpy_set_tuning(const struct assm_memcpy_tuning* in) {
+    tuning = *in;
+    __atomic_store_n(&tuning_ready, 1, __ATOMIC_RELEASE);
+}
+
+static void copy_rep_movsb(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "movq %0, %%rdi\n\t"        // Destination
+        "movq %1, %%rsi\n\t"        // Source
+        "movq %2, %%rcx\n\t"        // Count
+        "rep movsb\n\t"             // Microcoded copy, fast with ERMS/FSRM
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "rsi", "rdi", "memory"
+    );
+}
+
+void* memcpy_erms(void* dest, const void* src, size_t n) {
+    copy_rep_movsb(dest, src, n);
+    return dest;
+}
+
+static void copy_small_sse2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "cmpq $16, %2\n\t"                  // 16..32 bytes?
+        "jb 1f\n\t"
+        "movdqu (%1), %%xmm0\n\t"           // Head
+        "movdqu -16(%1,%2), %%xmm1\n\t"     // Tail, overlapping the head
+        "movdqu %%xmm0, (%0)\n\t"
+        "movdqu %%xmm1, -16(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "1:\n\t"
+        "cmpq $8, %2\n\t"                   // 8..16 bytes?
+        "jb 2f\n\t"
+        "movq (%1), %%rcx\n\t"              // Head
+        "movq -8(%1,%2), %%r8\n\t"          // Tail
+        "movq %%rcx, (%0)\n\t"
+        "movq %%r8, -8(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "2:\n\t"
+        "cmpq $4, %2\n\t"                   // 4..8 bytes?
+        "jb 3f\n\t"
+        "movl (%1), %%ecx\n\t"              // Head
+        "movl -4(%1,%2), %%r8d\n\t"         // Tail
+        "movl %%ecx, (%0)\n\t"
+        "movl %%r8d, -4(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "3:\n\t"
+        "cmpq $2, %2\n\t"                   // 2..4 bytes?
+        "jb 4f\n\t"
+        "movzwl (%1), %%ecx\n\t"            // Head
+        "movzwl -2(%1,%2), %%r8d\n\t"       // Tail
+        "movw %%cx, (%0)\n\t"
+        "movw %%r8w, -2(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "4:\n\t"                            // Zero or one byte
+        "testq %2, %2\n\t"
+        "jz 9f\n\t"
+        "movzbl (%1), %%ecx\n\t"
+        "movb %%cl, (%0)\n\t"
+        "9:\n\t"
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r8", "xmm0", "xmm1", "memory"
+    );
+}
+
+static void copy_forward_sse2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "cmpq $64, %2\n\t"                  // More than 64 bytes?
+        "ja 1f\n\t"                         // Yes, use the loop
+        "movdqu (%1), %%xmm0\n\t"           // First two vectors
+        "movdqu 16(%1), %%xmm1\n\t"
+        "movdqu -32(%1,%2), %%xmm2\n\t"     // Last two (may overlap the first)
+        "movdqu -16(%1,%2), %%xmm3\n\t"
+        "movdqu %%xmm0, (%0)\n\t"           // All loads precede the stores
+        "movdqu %%xmm1, 16(%0)\n\t"
+        "movdqu %%xmm2, -32(%0,%2)\n\t"
+        "movdqu %%xmm3, -16(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "1:\n\t"                            // loop setup: n > 64
+        "movdqu (%1), %%xmm4\n\t"           // Head vector, stored last
+        "movdqu -64(%1,%2), %%xmm5\n\t"     // Tail group, stored last
+        "movdqu -48(%1,%2), %%xmm6\n\t"
+        "movdqu -32(%1,%2), %%xmm7\n\t"
+        "movdqu -16(%1,%2), %%xmm8\n\t"
+        "movq %1, %%r10\n\t"                // r10 = src - dest: the loop indexes
+        "subq %0, %%r10\n\t"                // both buffers through one pointer
+        "leaq -64(%0,%2), %%r9\n\t"         // Tail group destination
+        "leaq 16(%0), %%rcx\n\t"            // First aligned destination after the head
+        "andq $-16, %%rcx\n\t"
+        "2:\n\t"                            // copy_loop: 64 bytes per iteration
+        "cmpq %%r9, %%rcx\n\t"              // Reached the tail group?
+        "jae 3f\n\t"
+        "movdqu (%%rcx,%%r10), %%xmm0\n\t"  // Unaligned source
+        "movdqu 16(%%rcx,%%r10), %%xmm1\n\t"
+        "movdqu 32(%%rcx,%%r10), %%xmm2\n\t"
+        "movdqu 48(%%rcx,%%r10), %%xmm3\n\t"
+        "movdqa %%xmm0, (%%rcx)\n\t"        // Aligned destination
+        "movdqa %%xmm1, 16(%%rcx)\n\t"
+        "movdqa %%xmm2, 32(%%rcx)\n\t"
+        "movdqa %%xmm3, 48(%%rcx)\n\t"
+        "addq $64, %%rcx\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // finish
+        "movdqu %%xmm5, (%%r9)\n\t"         // Tail group
+        "movdqu %%xmm6, 16(%%r9)\n\t"
+        "movdqu %%xmm7, 32(%%r9)\n\t"
+        "movdqu %%xmm8, 48(%%r9)\n\t"
+        "movdqu %%xmm4, (%0)\n\t"           // Head
+        "9:\n\t"
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+          "xmm5", "xmm6", "xmm7", "xmm8", "memory"
+    );
+}
+
+static void copy_backward_sse2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "cmpq $64, %2\n\t"                  // More than 64 bytes?
+        "ja 1f\n\t"                         // Yes, use the loop
+        "movdqu (%1), %%xmm0\n\t"           // First two vectors
+        "movdqu 16(%1), %%xmm1\n\t"
+        "movdqu -32(%1,%2), %%xmm2\n\t"     // Last two (may overlap the first)
+        "movdqu -16(%1,%2), %%xmm3\n\t"
+        "movdqu %%xmm0, (%0)\n\t"           // All loads precede the stores
+        "movdqu %%xmm1, 16(%0)\n\t"
+        "movdqu %%xmm2, -32(%0,%2)\n\t"
+        "movdqu %%xmm3, -16(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "1:\n\t"                            // loop setup: n > 64
+        "movdqu -16(%1,%2), %%xmm4\n\t"     // Tail vector, stored last
+        "movdqu (%1), %%xmm5\n\t"           // Head group, stored last
+        "movdqu 16(%1), %%xmm6\n\t"
+        "movdqu 32(%1), %%xmm7\n\t"
+        "movdqu 48(%1), %%xmm8\n\t"
+        "movq %1, %%r10\n\t"                // r10 = src - dest
+        "subq %0, %%r10\n\t"
+        "leaq 64(%0), %%r9\n\t"             // End of the head group
+        "leaq (%0,%2), %%rcx\n\t"           // Aligned end of the next group
+        "andq $-16, %%rcx\n\t"
+        "2:\n\t"                            // copy_loop: 64 bytes per iteration, high to low
+        "cmpq %%r9, %%rcx\n\t"              // Reached the head group?
+        "jbe 3f\n\t"
+        "movdqu -64(%%rcx,%%r10), %%xmm0\n\t"  // Unaligned source
+        "movdqu -48(%%rcx,%%r10), %%xmm1\n\t"
+        "movdqu -32(%%rcx,%%r10), %%xmm2\n\t"
+        "movdqu -16(%%rcx,%%r10), %%xmm3\n\t"
+        "movdqa %%xmm0, -64(%%rcx)\n\t"     // Aligned destination
+        "movdqa %%xmm1, -48(%%rcx)\n\t"
+        "movdqa %%xmm2, -32(%%rcx)\n\t"
+        "movdqa %%xmm3, -16(%%rcx)\n\t"
+        "subq $64, %%rcx\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // finish
+        "movdqu %%xmm5, (%0)\n\t"           // Head group
+        "movdqu %%xmm6, 16(%0)\n\t"
+        "movdqu %%xmm7, 32(%0)\n\t"
+        "movdqu %%xmm8, 48(%0)\n\t"
+        "movdqu %%xmm4, -16(%0,%2)\n\t"     // Tail
+        "9:\n\t"
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+          "xmm5", "xmm6", "xmm7", "xmm8", "memory"
+    );
+}
+
+static void copy_stream_sse2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "movdqu (%1), %%xmm4\n\t"           // Head vector, stored last
+        "movdqu -64(%1,%2), %%xmm5\n\t"     // Tail group, stored last
+        "movdqu -48(%1,%2), %%xmm6\n\t"
+        "movdqu -32(%1,%2), %%xmm7\n\t"
+        "movdqu -16(%1,%2), %%xmm8\n\t"
+        "movq %1, %%r10\n\t"                // r10 = src - dest: the loop indexes
+        "subq %0, %%r10\n\t"                // both buffers through one pointer
+        "leaq -64(%0,%2), %%r9\n\t"         // Tail group destination
+        "leaq 16(%0), %%rcx\n\t"            // First aligned destination after the head
+        "andq $-16, %%rcx\n\t"
+        "2:\n\t"                            // stream_loop: 64 bytes per iteration
+        "cmpq %%r9, %%rcx\n\t"              // Reached the tail group?
+        "jae 3f\n\t"
+        "movdqu (%%rcx,%%r10), %%xmm0\n\t"  // Unaligned source
+        "movdqu 16(%%rcx,%%r10), %%xmm1\n\t"
+        "movdqu 32(%%rcx,%%r10), %%xmm2\n\t"
+        "movdqu 48(%%rcx,%%r10), %%xmm3\n\t"
+        "movntdq %%xmm0, (%%rcx)\n\t"       // Non-temporal, aligned destination
+        "movntdq %%xmm1, 16(%%rcx)\n\t"
+        "movntdq %%xmm2, 32(%%rcx)\n\t"
+        "movntdq %%xmm3, 48(%%rcx)\n\t"
+        "addq $64, %%rcx\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // finish
+        "sfence\n\t"                        // Order the streaming stores
+        "movdqu %%xmm5, (%%r9)\n\t"         // Tail group
+        "movdqu %%xmm6, 16(%%r9)\n\t"
+        "movdqu %%xmm7, 32(%%r9)\n\t"
+        "movdqu %%xmm8, 48(%%r9)\n\t"
+        "movdqu %%xmm4, (%0)\n\t"           // Head
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+          "xmm5", "xmm6", "xmm7", "xmm8", "memory"
+    );
+}
+
+void* memcpy_loop_sse2(void* dest, const void* src, size_t n) {
+    if (n <= 32) copy_small_sse2(dest, src, n);
+    else copy_forward_sse2(dest, src, n);
+    return dest;
+}
+
+void* memcpy_stream_sse2(void* dest, const void* src, size_t n) {
+    if (n <= 32) copy_small_sse2(dest, src, n);
+    else if (n <= 64) copy_forward_sse2(dest, src, n);
+    else copy_stream_sse2(dest, src, n);
+    return dest;
+}
+
+void* memcpy_sse2(void* dest, const void* src, size_t n) {
+    if (n <= 32) {
+        copy_small_sse2(dest, src, n);
+    } else if (n <= 64) {
+        copy_forward_sse2(dest, src, n);
+    } else {
+        const struct assm_memcpy_tuning* tune = current_tuning();
+        if (n >= tune->nontemporal_min) copy_stream_sse2(dest, src, n);
+        else if (n >= tune->rep_movsb_min) copy_rep_movsb(dest, src, n);
+        else copy_forward_sse2(dest, src, n);
+    }
+    return dest;
+}
+
+void* memmove_sse2(void* dest, const void* src, size_t n) {
+    uintptr_t distance = (uintptr_t)dest - (uintptr_t)src;
+    if (n <= 32) copy_small_sse2(dest, src, n);
+    else if (distance >= n && (uintptr_t)src - (uintptr_t)dest >= n) memcpy_sse2(dest, src, n);
+    else if (distance >= n) copy_forward_sse2(dest, src, n);   // dest below src
+    else copy_backward_sse2(dest, src, n);
+    return dest;
+}
+
+static void copy_small_avx2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "cmpq $32, %2\n\t"                  // 32..64 bytes?
+        "jb 1f\n\t"
+        "vmovdqu (%1), %%ymm0\n\t"          // Head
+        "vmovdqu -32(%1,%2), %%ymm1\n\t"    // Tail, overlapping the head
+        "vmovdqu %%ymm0, (%0)\n\t"          // Both loads happen before any store,
+        "vmovdqu %%ymm1, -32(%0,%2)\n\t"    // so overlapping buffers are fine
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        "jmp 9f\n\t"
+        "1:\n\t"
+        "cmpq $16, %2\n\t"                  // 16..32 bytes?
+        "jb 2f\n\t"
+        "vmovdqu (%1), %%xmm0\n\t"          // Head
+        "vmovdqu -16(%1,%2), %%xmm1\n\t"    // Tail, overlapping the head
+        "vmovdqu %%xmm0, (%0)\n\t"
+        "vmovdqu %%xmm1, -16(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "2:\n\t"
+        "cmpq $8, %2\n\t"                   // 8..16 bytes?
+        "jb 3f\n\t"
+        "movq (%1), %%rcx\n\t"              // Head
+        "movq -8(%1,%2), %%r8\n\t"          // Tail
+        "movq %%rcx, (%0)\n\t"
+        "movq %%r8, -8(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "3:\n\t"
+        "cmpq $4, %2\n\t"                   // 4..8 bytes?
+        "jb 4f\n\t"
+        "movl (%1), %%ecx\n\t"              // Head
+        "movl -4(%1,%2), %%r8d\n\t"         // Tail
+        "movl %%ecx, (%0)\n\t"
+        "movl %%r8d, -4(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "4:\n\t"
+        "cmpq $2, %2\n\t"                   // 2..4 bytes?
+        "jb 5f\n\t"
+        "movzwl (%1), %%ecx\n\t"            // Head
+        "movzwl -2(%1,%2), %%r8d\n\t"       // Tail
+        "movw %%cx, (%0)\n\t"
+        "movw %%r8w, -2(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "5:\n\t"                            // Zero or one byte
+        "testq %2, %2\n\t"
+        "jz 9f\n\t"
+        "movzbl (%1), %%ecx\n\t"
+        "movb %%cl, (%0)\n\t"
+        "9:\n\t"
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r8", "xmm0", "xmm1", "memory"
+    );
+}
+
+static void copy_forward_avx2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "cmpq $128, %2\n\t"                 // More than 128 bytes?
+        "ja 1f\n\t"                         // Yes, use the loop
+        "vmovdqu (%1), %%ymm0\n\t"          // First two vectors
+        "vmovdqu 32(%1), %%ymm1\n\t"
+        "vmovdqu -64(%1,%2), %%ymm2\n\t"    // Last two (may overlap the first)
+        "vmovdqu -32(%1,%2), %%ymm3\n\t"
+        "vmovdqu %%ymm0, (%0)\n\t"          // All loads precede the stores
+        "vmovdqu %%ymm1, 32(%0)\n\t"
+        "vmovdqu %%ymm2, -64(%0,%2)\n\t"
+        "vmovdqu %%ymm3, -32(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "1:\n\t"                            // loop setup: n > 128
+        "vmovdqu (%1), %%ymm4\n\t"          // Head vector, stored last
+        "vmovdqu -128(%1,%2), %%ymm5\n\t"   // Tail group, stored last
+        "vmovdqu -96(%1,%2), %%ymm6\n\t"
+        "vmovdqu -64(%1,%2), %%ymm7\n\t"
+        "vmovdqu -32(%1,%2), %%ymm8\n\t"
+        "movq %1, %%r10\n\t"                // r10 = src - dest: the loop indexes
+        "subq %0, %%r10\n\t"                // both buffers through one pointer
+        "leaq -128(%0,%2), %%r9\n\t"        // Tail group destination
+        "leaq 32(%0), %%rcx\n\t"            // First aligned destination after the head
+        "andq $-32, %%rcx\n\t"
+        "2:\n\t"                            // copy_loop: 128 bytes per iteration
+        "cmpq %%r9, %%rcx\n\t"              // Reached the tail group?
+        "jae 3f\n\t"
+        "vmovdqu (%%rcx,%%r10), %%ymm0\n\t" // Unaligned source
+        "vmovdqu 32(%%rcx,%%r10), %%ymm1\n\t"
+        "vmovdqu 64(%%rcx,%%r10), %%ymm2\n\t"
+        "vmovdqu 96(%%rcx,%%r10), %%ymm3\n\t"
+        "vmovdqa %%ymm0, (%%rcx)\n\t"       // Aligned destination
+        "vmovdqa %%ymm1, 32(%%rcx)\n\t"
+        "vmovdqa %%ymm2, 64(%%rcx)\n\t"
+        "vmovdqa %%ymm3, 96(%%rcx)\n\t"
+        "addq $128, %%rcx\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // finish
+        "vmovdqu %%ymm5, (%%r9)\n\t"        // Tail group
+        "vmovdqu %%ymm6, 32(%%r9)\n\t"
+        "vmovdqu %%ymm7, 64(%%r9)\n\t"
+        "vmovdqu %%ymm8, 96(%%r9)\n\t"
+        "vmovdqu %%ymm4, (%0)\n\t"          // Head
+        "9:\n\t"
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+          "xmm5", "xmm6", "xmm7", "xmm8", "memory"
+    );
+}
+
+static void copy_backward_avx2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "cmpq $128, %2\n\t"                 // More than 128 bytes?
+        "ja 1f\n\t"                         // Yes, use the loop
+        "vmovdqu (%1), %%ymm0\n\t"          // First two vectors
+        "vmovdqu 32(%1), %%ymm1\n\t"
+        "vmovdqu -64(%1,%2), %%ymm2\n\t"    // Last two (may overlap the first)
+        "vmovdqu -32(%1,%2), %%ymm3\n\t"
+        "vmovdqu %%ymm0, (%0)\n\t"          // All loads precede the stores
+        "vmovdqu %%ymm1, 32(%0)\n\t"
+        "vmovdqu %%ymm2, -64(%0,%2)\n\t"
+        "vmovdqu %%ymm3, -32(%0,%2)\n\t"
+        "jmp 9f\n\t"
+        "1:\n\t"                            // loop setup: n > 128
+        "vmovdqu -32(%1,%2), %%ymm4\n\t"    // Tail vector, stored last
+        "vmovdqu (%1), %%ymm5\n\t"          // Head group, stored last
+        "vmovdqu 32(%1), %%ymm6\n\t"
+        "vmovdqu 64(%1), %%ymm7\n\t"
+        "vmovdqu 96(%1), %%ymm8\n\t"
+        "movq %1, %%r10\n\t"                // r10 = src - dest
+        "subq %0, %%r10\n\t"
+        "leaq 128(%0), %%r9\n\t"            // End of the head group
+        "leaq (%0,%2), %%rcx\n\t"           // Aligned end of the next group
+        "andq $-32, %%rcx\n\t"
+        "2:\n\t"                            // copy_loop: 128 bytes per iteration, high to low
+        "cmpq %%r9, %%rcx\n\t"              // Reached the head group?
+        "jbe 3f\n\t"
+        "vmovdqu -128(%%rcx,%%r10), %%ymm0\n\t"  // Unaligned source
+        "vmovdqu -96(%%rcx,%%r10), %%ymm1\n\t"
+        "vmovdqu -64(%%rcx,%%r10), %%ymm2\n\t"
+        "vmovdqu -32(%%rcx,%%r10), %%ymm3\n\t"
+        "vmovdqa %%ymm0, -128(%%rcx)\n\t"   // Aligned destination
+        "vmovdqa %%ymm1, -96(%%rcx)\n\t"
+        "vmovdqa %%ymm2, -64(%%rcx)\n\t"
+        "vmovdqa %%ymm3, -32(%%rcx)\n\t"
+        "subq $128, %%rcx\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // finish
+        "vmovdqu %%ymm5, (%0)\n\t"          // Head group
+        "vmovdqu %%ymm6, 32(%0)\n\t"
+        "vmovdqu %%ymm7, 64(%0)\n\t"
+        "vmovdqu %%ymm8, 96(%0)\n\t"
+        "vmovdqu %%ymm4, -32(%0,%2)\n\t"    // Tail
+        "9:\n\t"
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+          "xmm5", "xmm6", "xmm7", "xmm8", "memory"
+    );
+}
+
+static void copy_stream_avx2(void* dest, const void* src, size_t n) {
+    __asm__ volatile (
+        "vmovdqu (%1), %%ymm4\n\t"          // Head vector, stored last
+        "vmovdqu -128(%1,%2), %%ymm5\n\t"   // Tail group, stored last
+        "vmovdqu -96(%1,%2), %%ymm6\n\t"
+        "vmovdqu -64(%1,%2), %%ymm7\n\t"
+        "vmovdqu -32(%1,%2), %%ymm8\n\t"
+        "movq %1, %%r10\n\t"                // r10 = src - dest: the loop indexes
+        "subq %0, %%r10\n\t"                // both buffers through one pointer
+        "leaq -128(%0,%2), %%r9\n\t"        // Tail group destination
+        "leaq 32(%0), %%rcx\n\t"            // First aligned destination after the head
+        "andq $-32, %%rcx\n\t"
+        "2:\n\t"                            // stream_loop: 128 bytes per iteration
+        "cmpq %%r9, %%rcx\n\t"              // Reached the tail group?
+        "jae 3f\n\t"
+        "vmovdqu (%%rcx,%%r10), %%ymm0\n\t" // Unaligned source
+        "vmovdqu 32(%%rcx,%%r10), %%ymm1\n\t"
+        "vmovdqu 64(%%rcx,%%r10), %%ymm2\n\t"
+        "vmovdqu 96(%%rcx,%%r10), %%ymm3\n\t"
+        "vmovntdq %%ymm0, (%%rcx)\n\t"      // Non-temporal, aligned destination
+        "vmovntdq %%ymm1, 32(%%rcx)\n\t"
+        "vmovntdq %%ymm2, 64(%%rcx)\n\t"
+        "vmovntdq %%ymm3, 96(%%rcx)\n\t"
+        "addq $128, %%rcx\n\t"
+        "jmp 2b\n\t"
+        "3:\n\t"                            // finish
+        "sfence\n\t"                        // Order the streaming stores
+        "vmovdqu %%ymm5, (%%r9)\n\t"        // Tail group
+        "vmovdqu %%ymm6, 32(%%r9)\n\t"
+        "vmovdqu %%ymm7, 64(%%r9)\n\t"
+        "vmovdqu %%ymm8, 96(%%r9)\n\t"
+        "vmovdqu %%ymm4, (%0)\n\t"          // Head
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        :
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+          "xmm5", "xmm6", "xmm7", "xmm8", "memory"
+    );
+}
+
+void* memcpy_loop_avx2(void* dest, const void* src, size_t n) {
+    if (n <= 64) copy_small_avx2(dest, src, n);
+    else copy_forward_avx2(dest, src, n);
+    return dest;
+}
+
+void* memcpy_stream_avx2(void* dest, const void* src, size_t n) {
+    if (n <= 64) copy_small_avx2(dest, src, n);
+    else if (n <= 128) copy_forward_avx2(dest, src, n);
+    else copy_stream_avx2(dest, src, n);
+    return dest;
+}
+
+void* memcpy_avx2(void* dest, const void* src, size_t n) {
+    if (n <= 64) {
+        copy_small_avx2(dest, src, n);
+    } else if (n <= 128) {
+        copy_forward_avx2(dest, src, n);
+    } else {
+        const struct assm_memcpy_tuning* tune = current_tuning();
+        if (n >= tune->nontemporal_min) copy_stream_avx2(dest, src, n);
+        else if (n >= tune->rep_movsb_min) copy_rep_movsb(dest, src, n);
+        else copy_forward_avx2(dest, src, n);
+    }
+    return dest;
+}
+
+void* memmove_avx2(void* dest, const void* src, size_t n) {
+    uintptr_t distance = (uintptr_t)dest - (uintptr_t)src;
+    if (n <= 64) copy_small_avx2(dest, src, n);
+    else if (distance >= n && (uintptr_t)src - (uintptr_t)dest >= n) memcpy_avx2(dest, src, n);
+    else if (distance >= n) copy_forward_avx2(dest, src, n);   // dest below src
+    else copy_backward_avx2(dest, src, n);
+    return dest;
+}
+
+void* memcpy_asm(void* dest, const void* src, size_t n) {
+    return ASSM_DISPATCH(memcpy)(dest, src, n);
+}
+
+void* memmove_asm(void* dest, const void* src, size_t n) {
+    return ASSM_DISPATCH(memmove)(dest, src, n);
+}
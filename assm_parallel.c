@@ -0,0 +1,253 @@
+// assm_parallel.c - Thread pool and parallel reductions
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// One array reduction saturates a core long before it saturates memory, so
+// the *_parallel kernels spread the array over a pool of threads. The
+// workers are started on first use and then sleep on a condition variable
+// between jobs: a job costs a broadcast and a wait, not thread creation.
+// Jobs run one at a time; a job started from inside a worker runs inline.
+#define POOL_THREADS_MAX 256
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t start;           // workers wait for a new generation
+    pthread_cond_t done;            // the caller waits for pending == 0
+    pthread_mutex_t serial;         // one job at a time
+    unsigned threads;               // workers + the calling thread
+    unsigned long generation;
+    unsigned pending;
+    unsigned count;                 // threads taking part in this job
+    unsigned job_count;             // parts the job is split into
+    parallel_fn fn;
+    void* ctx;
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .serial = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static __thread int in_pool_job;
+
+static void* pool_worker(void* arg) {
+    unsigned index = (unsigned)(uintptr_t)arg;
+    unsigned long seen = 0;
+    in_pool_job = 1;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (pool.generation == seen) pthread_cond_wait(&pool.start, &pool.lock);
+        seen = pool.generation;
+        if (index >= pool.count) continue;
+        parallel_fn fn = pool.fn;
+        void* ctx = pool.ctx;
+        unsigned count = pool.job_count;
+        pthread_mutex_unlock(&pool.lock);
+
+        fn(ctx, index, count);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.pending == 0) pthread_cond_signal(&pool.done);
+    }
+    return NULL;
+}
+
+// ASSM_THREADS, or one thread per online CPU
+static unsigned pool_default_threads(void) {
+    const char* forced = getenv(ASSM_THREADS_ENV);
+    if (forced && forced[0]) {
+        char* end;
+        unsigned long requested = strtoul(forced, &end, 10);
+        if (*end == '\0' && requested > 0) {
+            return requested < POOL_THREADS_MAX ? (unsigned)requested : POOL_THREADS_MAX;
+        }
+        fprintf(stderr, "assmkernels: ignoring %s=%s (use a thread count)\n", ASSM_THREADS_ENV, forced);
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) return 1;
+    return cpus < POOL_THREADS_MAX ? (unsigned)cpus : POOL_THREADS_MAX;
+}
+
+// Workers are detached and live as long as the process; a worker that
+// cannot be started shrinks the pool
+static void pool_start(void) {
+    unsigned threads = pool_default_threads();
+    unsigned started = 1;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (; started < threads; started++) {
+        pthread_t id;
+        if (pthread_create(&id, &attr, pool_worker, (void*)(uintptr_t)started) != 0) break;
+    }
+    pthread_attr_destroy(&attr);
+    __atomic_store_n(&pool.threads, started, __ATOMIC_RELEASE);
+}
+
+unsigned assm_parallel_threads(void) {
+    pthread_once(&pool_once, pool_start);
+    return __atomic_load_n(&pool.threads, __ATOMIC_ACQUIRE);
+}
+
+unsigned parallel_threads(unsigned requested) {
+    unsigned threads = assm_parallel_threads();
+    if (in_pool_job) return 1;
+    return requested && requested < threads ? requested : threads;
+}
+
+void parallel_run(parallel_fn fn, void* ctx, unsigned count) {
+    if (count <= 1 || in_pool_job) {
+        for (unsigned i = 0; i < count; i++) fn(ctx, i, count);
+        return;
+    }
+
+    // Parts beyond the pool's size run on the calling thread
+    unsigned workers = assm_parallel_threads();
+    if (workers > count) workers = count;
+    pthread_mutex_lock(&pool.serial);
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.count = workers;
+    pool.job_count = count;
+    pool.pending = workers - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    in_pool_job = 1;
+    fn(ctx, 0, count);
+    for (unsigned i = workers; i < count; i++) fn(ctx, i, count);
+    in_pool_job = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.pending) pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.serial);
+}
+
+// Reductions split the array into blocks of REDUCE_BLOCK bytes or more,
+// whole pages so a block never shares a page with its neighbour, and at
+// most REDUCE_BLOCKS_MAX of them. Thread t of n reduces the t-th of n
+// contiguous runs of blocks, which keeps each thread streaming through its
+// own pages (on NUMA machines, the pages a matching split first touched).
+// The block size depends only on the array length and the per-block
+// results are combined in block order, so results, float ones included,
+// do not change with the thread count. Arrays under two blocks are reduced
+// on the calling thread in one kernel call.
+#define REDUCE_BLOCK (1u << 20)
+#define REDUCE_BLOCKS_MAX 1024
+
+union reduce_value {
+    int64_t i;
+    double f;
+};
+
+struct reduce_job {
+    const char* a;
+    const char* b;                  // second operand (dot product), or NULL
+    size_t size;                    // bytes per element
+    size_t count;
+    size_t block;                   // elements per block
+    size_t blocks;
+    union reduce_value (*kernel)(const void* a, const void* b, size_t n);
+    union reduce_value* results;    // one per block
+};
+
+static void reduce_worker(void* ctx, unsigned index, unsigned count) {
+    struct reduce_job* job = ctx;
+    size_t first = job->blocks * index / count;
+    size_t last = job->blocks * (index + 1) / count;
+    for (size_t k = first; k < last; k++) {
+        size_t start = k * job->block;
+        size_t n = k + 1 == job->blocks ? job->count - start : job->block;
+        const char* b = job->b ? job->b + start * job->size : NULL;
+        job->results[k] = job->kernel(job->a + start * job->size, b, n);
+    }
+}
+
+// Reduces into results[0..blocks) and returns blocks (1 for a small array)
+static size_t reduce_blocks(struct reduce_job* job, unsigned threads,
+                            union reduce_value results[REDUCE_BLOCKS_MAX]) {
+    size_t bytes = job->count * job->size;
+    job->results = results;
+    if (bytes < 2 * (size_t)REDUCE_BLOCK) {
+        results[0] = job->kernel(job->a, job->b, job->count);
+        return 1;
+    }
+    size_t span = (size_t)REDUCE_BLOCK * REDUCE_BLOCKS_MAX;
+    job->block = (bytes + span - 1) / span * REDUCE_BLOCK / job->size;
+    job->blocks = (job->count + job->block - 1) / job->block;
+    threads = parallel_threads(threads);
+    if (threads > job->blocks) threads = (unsigned)job->blocks;
+    parallel_run(reduce_worker, job, threads);
+    return job->blocks;
+}
+
+static union reduce_value reduce_sum(const void* a, const void* b, size_t n) {
+    (void)b;
+    return (union reduce_value){.i = ASSM_DISPATCH(array_sum)(a, n)};
+}
+
+static union reduce_value reduce_max(const void* a, const void* b, size_t n) {
+    (void)b;
+    return (union reduce_value){.i = array_max_asm(a, n)};
+}
+
+static union reduce_value reduce_popcount(const void* a, const void* b, size_t n) {
+    (void)b;
+    return (union reduce_value){.i = (int64_t)ASSM_DISPATCH(popcount_buffer)(a, n * sizeof(uint64_t))};
+}
+
+static union reduce_value reduce_dot(const void* a, const void* b, size_t n) {
+    // n fits an int: a block is REDUCE_BLOCK bytes per REDUCE_BLOCK *
+    // REDUCE_BLOCKS_MAX bytes of array, so INT_MAX floats needs 8 TiB
+    return (union reduce_value){.f = dot_product_sse(a, b, (int)n)};
+}
+
+long array_sum_parallel(const long* arr, size_t count, unsigned threads) {
+    union reduce_value results[REDUCE_BLOCKS_MAX];
+    struct reduce_job job = {.a = (const char*)arr, .size = sizeof(long), .count = count, .kernel = reduce_sum};
+    size_t blocks = reduce_blocks(&job, threads, results);
+    unsigned long sum = 0;
+    for (size_t k = 0; k < blocks; k++) sum += (unsigned long)results[k].i;
+    return (long)sum;
+}
+
+long array_max_parallel(const long* arr, size_t count, unsigned threads) {
+    union reduce_value results[REDUCE_BLOCKS_MAX];
+    struct reduce_job job = {.a = (const char*)arr, .size = sizeof(long), .count = count, .kernel = reduce_max};
+    size_t blocks = reduce_blocks(&job, threads, results);
+    long max = LONG_MIN;
+    for (size_t k = 0; k < blocks; k++) {
+        if (results[k].i > max) max = results[k].i;
+    }
+    return max;
+}
+
+uint64_t popcount_parallel(const uint64_t* words, size_t count, unsigned threads) {
+    union reduce_value results[REDUCE_BLOCKS_MAX];
+    struct reduce_job job = {.a = (const char*)words, .size = sizeof(uint64_t), .count = count,
+                             .kernel = reduce_popcount};
+    size_t blocks = reduce_blocks(&job, threads, results);
+    uint64_t total = 0;
+    for (size_t k = 0; k < blocks; k++) total += (uint64_t)results[k].i;
+    return total;
+}
+
+float dot_product_parallel(const float* a, const float* b, size_t count, unsigned threads) {
+    union reduce_value results[REDUCE_BLOCKS_MAX];
+    struct reduce_job job = {.a = (const char*)a, .b = (const char*)b, .size = sizeof(float),
+                             .count = count, .kernel = reduce_dot};
+    size_t blocks = reduce_blocks(&job, threads, results);
+    double sum = 0.0;
+    for (size_t k = 0; k < blocks; k++) sum += results[k].f;
+    return (float)sum;
+}
@@ -0,0 +1,506 @@
+// assm_scan.c - Prefix sums (scans) of int32 and int64 arrays
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// A serial scan is one add per element on a single dependency chain. The
+// kernels instead scan each vector in registers with log2(lanes) shift and
+// add steps, scan two vectors independently, and only then add the running
+// carry: the chain from one step to the next is a single vector add, off
+// which the shuffles that broadcast each vector's total hang. Cross-lane
+// shuffles run on one port, so the AVX2 kernels scan each 128-bit half
+// with in-lane byte shifts and need one cross-lane step per vector besides
+// the broadcast. An exclusive scan subtracts the inputs back out of the
+// inclusive one in a loop of its own. Loads come before stores, so dst may
+// be src.
+
+int64_t scan_i64_sse2(int64_t* dst, const int64_t* src, size_t n, int64_t carry, int64_t mask) {
+    int64_t total;
+
+    __asm__ volatile (
+        "movq %4, %%xmm15\n\t"
+        "pshufd $0x44, %%xmm15, %%xmm15\n\t" // Carry in every lane
+        "xorl %%ecx, %%ecx\n\t"
+        "testq %5, %5\n\t"
+        "jnz 7f\n\t"
+        "1:\n\t"                            // inclusive loop: two vectors
+        "leaq 4(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 2f\n\t"
+        "movdqu (%2,%%rcx,8), %%xmm0\n\t"
+        "movdqu 16(%2,%%rcx,8), %%xmm1\n\t"
+        "movdqa %%xmm0, %%xmm2\n\t"
+        "pslldq $8, %%xmm2\n\t"             // Scan of the vector
+        "paddq %%xmm2, %%xmm0\n\t"
+        "pshufd $0xee, %%xmm0, %%xmm4\n\t"  // Total of the vector
+        "movdqa %%xmm1, %%xmm3\n\t"
+        "pslldq $8, %%xmm3\n\t"
+        "paddq %%xmm3, %%xmm1\n\t"
+        "pshufd $0xee, %%xmm1, %%xmm5\n\t"
+        "paddq %%xmm4, %%xmm1\n\t"          // Second vector after the first
+        "paddq %%xmm15, %%xmm0\n\t"         // Both after the carry
+        "paddq %%xmm15, %%xmm1\n\t"
+        "paddq %%xmm5, %%xmm4\n\t"
+        "paddq %%xmm4, %%xmm15\n\t"         // Carry chain: one add per step
+        "movdqu %%xmm0, (%1,%%rcx,8)\n\t"
+        "movdqu %%xmm1, 16(%1,%%rcx,8)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "movq %%xmm15, %%rax\n\t"
+        "jmp 4f\n\t"
+        "7:\n\t"                            // exclusive loop: two vectors
+        "leaq 4(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 8f\n\t"
+        "movdqu (%2,%%rcx,8), %%xmm0\n\t"
+        "movdqu 16(%2,%%rcx,8), %%xmm1\n\t"
+        "movdqa %%xmm0, %%xmm10\n\t"
+        "movdqa %%xmm10, %%xmm2\n\t"
+        "pslldq $8, %%xmm2\n\t"
+        "paddq %%xmm2, %%xmm10\n\t"
+        "pshufd $0xee, %%xmm10, %%xmm4\n\t"
+        "movdqa %%xmm1, %%xmm11\n\t"
+        "movdqa %%xmm11, %%xmm3\n\t"
+        "pslldq $8, %%xmm3\n\t"
+        "paddq %%xmm3, %%xmm11\n\t"
+        "pshufd $0xee, %%xmm11, %%xmm5\n\t"
+        "paddq %%xmm4, %%xmm11\n\t"
+        "paddq %%xmm15, %%xmm10\n\t"
+        "paddq %%xmm15, %%xmm11\n\t"
+        "paddq %%xmm5, %%xmm4\n\t"
+        "paddq %%xmm4, %%xmm15\n\t"
+        "psubq %%xmm0, %%xmm10\n\t"         // Minus the inputs
+        "psubq %%xmm1, %%xmm11\n\t"
+        "movdqu %%xmm10, (%1,%%rcx,8)\n\t"
+        "movdqu %%xmm11, 16(%1,%%rcx,8)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 7b\n\t"
+        "8:\n\t"
+        "movq %%xmm15, %%rax\n\t"
+        "jmp 5f\n\t"
+        "4:\n\t"                            // inclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "addq (%2,%%rcx,8), %%rax\n\t"
+        "movq %%rax, (%1,%%rcx,8)\n\t"
+        "incq %%rcx\n\t"
+        "jmp 4b\n\t"
+        "5:\n\t"                            // exclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "movq (%2,%%rcx,8), %%rdx\n\t"
+        "movq %%rax, (%1,%%rcx,8)\n\t"
+        "addq %%rdx, %%rax\n\t"
+        "incq %%rcx\n\t"
+        "jmp 5b\n\t"
+        "6:\n\t"
+        : "=&a"(total)
+        : "r"(dst), "r"(src), "r"(n), "r"(carry), "r"(mask)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm10", "xmm11",
+          "xmm15", "memory", "cc"
+    );
+
+    return total;
+}
+
+int64_t scan_i64_avx2(int64_t* dst, const int64_t* src, size_t n, int64_t carry, int64_t mask) {
+    int64_t total;
+
+    __asm__ volatile (
+        "vmovq %4, %%xmm15\n\t"
+        "vpbroadcastq %%xmm15, %%ymm15\n\t" // Carry in every lane
+        "vpxor %%xmm14, %%xmm14, %%xmm14\n\t"
+        "xorl %%ecx, %%ecx\n\t"
+        "testq %5, %5\n\t"
+        "jnz 7f\n\t"
+        "1:\n\t"                            // inclusive loop: two vectors
+        "leaq 8(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 2f\n\t"
+        "vmovdqu (%2,%%rcx,8), %%ymm0\n\t"
+        "vmovdqu 32(%2,%%rcx,8), %%ymm1\n\t"
+        "vpslldq $8, %%ymm0, %%ymm2\n\t"    // Scan each 128-bit half
+        "vpaddq %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vpermq $0x55, %%ymm0, %%ymm2\n\t"  // Low half's total
+        "vpblendd $0x0f, %%ymm14, %%ymm2, %%ymm2\n\t" // ... into the high half
+        "vpaddq %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vpermq $0xff, %%ymm0, %%ymm4\n\t"  // Total of the vector
+        "vpslldq $8, %%ymm1, %%ymm3\n\t"
+        "vpaddq %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpermq $0x55, %%ymm1, %%ymm3\n\t"
+        "vpblendd $0x0f, %%ymm14, %%ymm3, %%ymm3\n\t"
+        "vpaddq %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpermq $0xff, %%ymm1, %%ymm5\n\t"
+        "vpaddq %%ymm4, %%ymm1, %%ymm1\n\t" // Second vector after the first
+        "vpaddq %%ymm15, %%ymm0, %%ymm0\n\t" // Both after the carry
+        "vpaddq %%ymm15, %%ymm1, %%ymm1\n\t"
+        "vpaddq %%ymm5, %%ymm4, %%ymm4\n\t"
+        "vpaddq %%ymm4, %%ymm15, %%ymm15\n\t" // Carry chain: one add per step
+        "vmovdqu %%ymm0, (%1,%%rcx,8)\n\t"
+        "vmovdqu %%ymm1, 32(%1,%%rcx,8)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "vmovq %%xmm15, %%rax\n\t"
+        "jmp 4f\n\t"
+        "7:\n\t"                            // exclusive loop: two vectors
+        "leaq 8(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 8f\n\t"
+        "vmovdqu (%2,%%rcx,8), %%ymm0\n\t"
+        "vmovdqu 32(%2,%%rcx,8), %%ymm1\n\t"
+        "vpslldq $8, %%ymm0, %%ymm2\n\t"
+        "vpaddq %%ymm2, %%ymm0, %%ymm10\n\t"
+        "vpermq $0x55, %%ymm10, %%ymm2\n\t"
+        "vpblendd $0x0f, %%ymm14, %%ymm2, %%ymm2\n\t"
+        "vpaddq %%ymm2, %%ymm10, %%ymm10\n\t"
+        "vpermq $0xff, %%ymm10, %%ymm4\n\t"
+        "vpslldq $8, %%ymm1, %%ymm3\n\t"
+        "vpaddq %%ymm3, %%ymm1, %%ymm11\n\t"
+        "vpermq $0x55, %%ymm11, %%ymm3\n\t"
+        "vpblendd $0x0f, %%ymm14, %%ymm3, %%ymm3\n\t"
+        "vpaddq %%ymm3, %%ymm11, %%ymm11\n\t"
+        "vpermq $0xff, %%ymm11, %%ymm5\n\t"
+        "vpaddq %%ymm4, %%ymm11, %%ymm11\n\t"
+        "vpaddq %%ymm15, %%ymm10, %%ymm10\n\t"
+        "vpaddq %%ymm15, %%ymm11, %%ymm11\n\t"
+        "vpaddq %%ymm5, %%ymm4, %%ymm4\n\t"
+        "vpaddq %%ymm4, %%ymm15, %%ymm15\n\t"
+        "vpsubq %%ymm0, %%ymm10, %%ymm10\n\t" // Minus the inputs
+        "vpsubq %%ymm1, %%ymm11, %%ymm11\n\t"
+        "vmovdqu %%ymm10, (%1,%%rcx,8)\n\t"
+        "vmovdqu %%ymm11, 32(%1,%%rcx,8)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 7b\n\t"
+        "8:\n\t"
+        "vmovq %%xmm15, %%rax\n\t"
+        "jmp 5f\n\t"
+        "4:\n\t"                            // inclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "addq (%2,%%rcx,8), %%rax\n\t"
+        "movq %%rax, (%1,%%rcx,8)\n\t"
+        "incq %%rcx\n\t"
+        "jmp 4b\n\t"
+        "5:\n\t"                            // exclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "movq (%2,%%rcx,8), %%rdx\n\t"
+        "movq %%rax, (%1,%%rcx,8)\n\t"
+        "addq %%rdx, %%rax\n\t"
+        "incq %%rcx\n\t"
+        "jmp 5b\n\t"
+        "6:\n\t"
+        "vzeroupper\n\t"
+        : "=&a"(total)
+        : "r"(dst), "r"(src), "r"(n), "r"(carry), "r"(mask)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+          "xmm10", "xmm11", "xmm14", "xmm15", "memory", "cc"
+    );
+
+    return total;
+}
+
+int32_t scan_i32_sse2(int32_t* dst, const int32_t* src, size_t n, int32_t carry, int64_t mask) {
+    int32_t total;
+
+    __asm__ volatile (
+        "movd %4, %%xmm15\n\t"
+        "pshufd $0, %%xmm15, %%xmm15\n\t"   // Carry in every lane
+        "xorl %%ecx, %%ecx\n\t"
+        "testq %5, %5\n\t"
+        "jnz 7f\n\t"
+        "1:\n\t"                            // inclusive loop: two vectors
+        "leaq 8(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 2f\n\t"
+        "movdqu (%2,%%rcx,4), %%xmm0\n\t"
+        "movdqu 16(%2,%%rcx,4), %%xmm1\n\t"
+        "movdqa %%xmm0, %%xmm2\n\t"
+        "pslldq $4, %%xmm2\n\t"             // Scan of the vector
+        "paddd %%xmm2, %%xmm0\n\t"
+        "movdqa %%xmm0, %%xmm2\n\t"
+        "pslldq $8, %%xmm2\n\t"
+        "paddd %%xmm2, %%xmm0\n\t"
+        "pshufd $0xff, %%xmm0, %%xmm4\n\t"  // Total of the vector
+        "movdqa %%xmm1, %%xmm3\n\t"
+        "pslldq $4, %%xmm3\n\t"
+        "paddd %%xmm3, %%xmm1\n\t"
+        "movdqa %%xmm1, %%xmm3\n\t"
+        "pslldq $8, %%xmm3\n\t"
+        "paddd %%xmm3, %%xmm1\n\t"
+        "pshufd $0xff, %%xmm1, %%xmm5\n\t"
+        "paddd %%xmm4, %%xmm1\n\t"          // Second vector after the first
+        "paddd %%xmm15, %%xmm0\n\t"         // Both after the carry
+        "paddd %%xmm15, %%xmm1\n\t"
+        "paddd %%xmm5, %%xmm4\n\t"
+        "paddd %%xmm4, %%xmm15\n\t"         // Carry chain: one add per step
+        "movdqu %%xmm0, (%1,%%rcx,4)\n\t"
+        "movdqu %%xmm1, 16(%1,%%rcx,4)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "movd %%xmm15, %%eax\n\t"
+        "jmp 4f\n\t"
+        "7:\n\t"                            // exclusive loop: two vectors
+        "leaq 8(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 8f\n\t"
+        "movdqu (%2,%%rcx,4), %%xmm0\n\t"
+        "movdqu 16(%2,%%rcx,4), %%xmm1\n\t"
+        "movdqa %%xmm0, %%xmm10\n\t"
+        "movdqa %%xmm10, %%xmm2\n\t"
+        "pslldq $4, %%xmm2\n\t"
+        "paddd %%xmm2, %%xmm10\n\t"
+        "movdqa %%xmm10, %%xmm2\n\t"
+        "pslldq $8, %%xmm2\n\t"
+        "paddd %%xmm2, %%xmm10\n\t"
+        "pshufd $0xff, %%xmm10, %%xmm4\n\t"
+        "movdqa %%xmm1, %%xmm11\n\t"
+        "movdqa %%xmm11, %%xmm3\n\t"
+        "pslldq $4, %%xmm3\n\t"
+        "paddd %%xmm3, %%xmm11\n\t"
+        "movdqa %%xmm11, %%xmm3\n\t"
+        "pslldq $8, %%xmm3\n\t"
+        "paddd %%xmm3, %%xmm11\n\t"
+        "pshufd $0xff, %%xmm11, %%xmm5\n\t"
+        "paddd %%xmm4, %%xmm11\n\t"
+        "paddd %%xmm15, %%xmm10\n\t"
+        "paddd %%xmm15, %%xmm11\n\t"
+        "paddd %%xmm5, %%xmm4\n\t"
+        "paddd %%xmm4, %%xmm15\n\t"
+        "psubd %%xmm0, %%xmm10\n\t"         // Minus the inputs
+        "psubd %%xmm1, %%xmm11\n\t"
+        "movdqu %%xmm10, (%1,%%rcx,4)\n\t"
+        "movdqu %%xmm11, 16(%1,%%rcx,4)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 7b\n\t"
+        "8:\n\t"
+        "movd %%xmm15, %%eax\n\t"
+        "jmp 5f\n\t"
+        "4:\n\t"                            // inclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "addl (%2,%%rcx,4), %%eax\n\t"
+        "movl %%eax, (%1,%%rcx,4)\n\t"
+        "incq %%rcx\n\t"
+        "jmp 4b\n\t"
+        "5:\n\t"                            // exclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "movl (%2,%%rcx,4), %%edx\n\t"
+        "movl %%eax, (%1,%%rcx,4)\n\t"
+        "addl %%edx, %%eax\n\t"
+        "incq %%rcx\n\t"
+        "jmp 5b\n\t"
+        "6:\n\t"
+        : "=&a"(total)
+        : "r"(dst), "r"(src), "r"(n), "r"(carry), "r"(mask)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm10", "xmm11",
+          "xmm15", "memory", "cc"
+    );
+
+    return total;
+}
+
+int32_t scan_i32_avx2(int32_t* dst, const int32_t* src, size_t n, int32_t carry, int64_t mask) {
+    int32_t total;
+
+    __asm__ volatile (
+        "vmovd %4, %%xmm15\n\t"
+        "vpbroadcastd %%xmm15, %%ymm15\n\t" // Carry in every lane
+        "vpxor %%xmm14, %%xmm14, %%xmm14\n\t"
+        "xorl %%ecx, %%ecx\n\t"
+        "testq %5, %5\n\t"
+        "jnz 7f\n\t"
+        "1:\n\t"                            // inclusive loop: two vectors
+        "leaq 16(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 2f\n\t"
+        "vmovdqu (%2,%%rcx,4), %%ymm0\n\t"
+        "vmovdqu 32(%2,%%rcx,4), %%ymm1\n\t"
+        "vpslldq $4, %%ymm0, %%ymm2\n\t"    // Scan each 128-bit half
+        "vpaddd %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vpslldq $8, %%ymm0, %%ymm2\n\t"
+        "vpaddd %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vpshufd $0xff, %%ymm0, %%ymm2\n\t" // Totals of both halves
+        "vperm2i128 $0x08, %%ymm2, %%ymm2, %%ymm6\n\t" // Low half's into the high half
+        "vpaddd %%ymm6, %%ymm0, %%ymm0\n\t"
+        "vpaddd %%ymm6, %%ymm2, %%ymm2\n\t"
+        "vpermq $0xff, %%ymm2, %%ymm4\n\t"  // Total of the vector
+        "vpslldq $4, %%ymm1, %%ymm3\n\t"
+        "vpaddd %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpslldq $8, %%ymm1, %%ymm3\n\t"
+        "vpaddd %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpshufd $0xff, %%ymm1, %%ymm3\n\t"
+        "vperm2i128 $0x08, %%ymm3, %%ymm3, %%ymm7\n\t"
+        "vpaddd %%ymm7, %%ymm1, %%ymm1\n\t"
+        "vpaddd %%ymm7, %%ymm3, %%ymm3\n\t"
+        "vpermq $0xff, %%ymm3, %%ymm5\n\t"
+        "vpaddd %%ymm4, %%ymm1, %%ymm1\n\t" // Second vector after the first
+        "vpaddd %%ymm15, %%ymm0, %%ymm0\n\t" // Both after the carry
+        "vpaddd %%ymm15, %%ymm1, %%ymm1\n\t"
+        "vpaddd %%ymm5, %%ymm4, %%ymm4\n\t"
+        "vpaddd %%ymm4, %%ymm15, %%ymm15\n\t" // Carry chain: one add per step
+        "vmovdqu %%ymm0, (%1,%%rcx,4)\n\t"
+        "vmovdqu %%ymm1, 32(%1,%%rcx,4)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "vmovd %%xmm15, %%eax\n\t"
+        "jmp 4f\n\t"
+        "7:\n\t"                            // exclusive loop: two vectors
+        "leaq 16(%%rcx), %%rdx\n\t"
+        "cmpq %3, %%rdx\n\t"
+        "ja 8f\n\t"
+        "vmovdqu (%2,%%rcx,4), %%ymm0\n\t"
+        "vmovdqu 32(%2,%%rcx,4), %%ymm1\n\t"
+        "vpslldq $4, %%ymm0, %%ymm2\n\t"
+        "vpaddd %%ymm2, %%ymm0, %%ymm10\n\t"
+        "vpslldq $8, %%ymm10, %%ymm2\n\t"
+        "vpaddd %%ymm2, %%ymm10, %%ymm10\n\t"
+        "vpshufd $0xff, %%ymm10, %%ymm2\n\t"
+        "vperm2i128 $0x08, %%ymm2, %%ymm2, %%ymm6\n\t"
+        "vpaddd %%ymm6, %%ymm10, %%ymm10\n\t"
+        "vpaddd %%ymm6, %%ymm2, %%ymm2\n\t"
+        "vpermq $0xff, %%ymm2, %%ymm4\n\t"
+        "vpslldq $4, %%ymm1, %%ymm3\n\t"
+        "vpaddd %%ymm3, %%ymm1, %%ymm11\n\t"
+        "vpslldq $8, %%ymm11, %%ymm3\n\t"
+        "vpaddd %%ymm3, %%ymm11, %%ymm11\n\t"
+        "vpshufd $0xff, %%ymm11, %%ymm3\n\t"
+        "vperm2i128 $0x08, %%ymm3, %%ymm3, %%ymm7\n\t"
+        "vpaddd %%ymm7, %%ymm11, %%ymm11\n\t"
+        "vpaddd %%ymm7, %%ymm3, %%ymm3\n\t"
+        "vpermq $0xff, %%ymm3, %%ymm5\n\t"
+        "vpaddd %%ymm4, %%ymm11, %%ymm11\n\t"
+        "vpaddd %%ymm15, %%ymm10, %%ymm10\n\t"
+        "vpaddd %%ymm15, %%ymm11, %%ymm11\n\t"
+        "vpaddd %%ymm5, %%ymm4, %%ymm4\n\t"
+        "vpaddd %%ymm4, %%ymm15, %%ymm15\n\t"
+        "vpsubd %%ymm0, %%ymm10, %%ymm10\n\t" // Minus the inputs
+        "vpsubd %%ymm1, %%ymm11, %%ymm11\n\t"
+        "vmovdqu %%ymm10, (%1,%%rcx,4)\n\t"
+        "vmovdqu %%ymm11, 32(%1,%%rcx,4)\n\t"
+        "movq %%rdx, %%rcx\n\t"
+        "jmp 7b\n\t"
+        "8:\n\t"
+        "vmovd %%xmm15, %%eax\n\t"
+        "jmp 5f\n\t"
+        "4:\n\t"                            // inclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "addl (%2,%%rcx,4), %%eax\n\t"
+        "movl %%eax, (%1,%%rcx,4)\n\t"
+        "incq %%rcx\n\t"
+        "jmp 4b\n\t"
+        "5:\n\t"                            // exclusive tail
+        "cmpq %3, %%rcx\n\t"
+        "jae 6f\n\t"
+        "movl (%2,%%rcx,4), %%edx\n\t"
+        "movl %%eax, (%1,%%rcx,4)\n\t"
+        "addl %%edx, %%eax\n\t"
+        "incq %%rcx\n\t"
+        "jmp 5b\n\t"
+        "6:\n\t"
+        "vzeroupper\n\t"
+        : "=&a"(total)
+        : "r"(dst), "r"(src), "r"(n), "r"(carry), "r"(mask)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+          "xmm10", "xmm11", "xmm14", "xmm15", "memory", "cc"
+    );
+
+    return total;
+}
+
+static int64_t scan_mask(int mode) {
+    return mode == ASSM_SCAN_EXCLUSIVE ? -1 : 0;
+}
+
+void array_scan_i32_asm(int32_t* dst, const int32_t* src, size_t count, int mode) {
+    ASSM_DISPATCH(scan_i32)(dst, src, count, 0, scan_mask(mode));
+}
+
+void array_scan_i64_asm(int64_t* dst, const int64_t* src, size_t count, int mode) {
+    ASSM_DISPATCH(scan_i64)(dst, src, count, 0, scan_mask(mode));
+}
+
+// Parallel scans are two passes over one chunk per pool thread: each
+// thread sums its chunk, the calling thread scans the chunk sums, and each
+// thread scans its chunk again starting from the sum of the chunks before
+// it. Only the second pass writes, so the array streams through memory
+// three times rather than the four of scanning in place and fixing up.
+// Below SCAN_PARALLEL_MIN bytes, about an L2, the serial kernel finishes
+// before the workers would wake.
+#define SCAN_PARALLEL_MIN (1u << 20)
+#define SCAN_CHUNK_MIN (256u << 10)
+#define SCAN_THREADS_MAX 64
+
+struct scan_job {
+    void* dst;
+    const void* src;
+    size_t count;
+    size_t per;                     // elements per chunk but the last
+    int wide;                       // int64 elements, else int32
+    int pass;                       // 1: sum each chunk, 2: scan it
+    int64_t mask;
+    int64_t sums[SCAN_THREADS_MAX]; // pass 1 results, pass 2 carries in
+};
+
+static void scan_worker(void* ctx, unsigned index, unsigned count) {
+    struct scan_job* job = ctx;
+    size_t first = index * job->per;
+    size_t n = index + 1 == count ? job->count - first : job->per;
+    if (job->wide) {
+        const int64_t* src = (const int64_t*)job->src + first;
+        if (job->pass == 1) job->sums[index] = ASSM_DISPATCH(array_sum)((const long*)src, n);
+        else ASSM_DISPATCH(scan_i64)((int64_t*)job->dst + first, src, n, job->sums[index], job->mask);
+    } else {
+        const int32_t* src = (const int32_t*)job->src + first;
+        if (job->pass == 1) job->sums[index] = ASSM_DISPATCH(sum_i32)(src, n);
+        else ASSM_DISPATCH(scan_i32)((int32_t*)job->dst + first, src, n, (int32_t)job->sums[index],
+                                     job->mask);
+    }
+}
+
+static void scan_parallel(void* dst, const void* src, size_t count, int wide, int mode,
+                          unsigned threads) {
+    size_t size = wide ? 8 : 4;
+    size_t bytes = count * size;
+    if (bytes >= SCAN_PARALLEL_MIN) {
+        threads = parallel_threads(threads);
+        if (threads > SCAN_THREADS_MAX) threads = SCAN_THREADS_MAX;
+        if (threads > bytes / SCAN_CHUNK_MIN) threads = (unsigned)(bytes / SCAN_CHUNK_MIN);
+    } else {
+        threads = 1;
+    }
+    if (threads <= 1) {
+        if (wide) array_scan_i64_asm(dst, src, count, mode);
+        else array_scan_i32_asm(dst, src, count, mode);
+        return;
+    }
+
+    // Chunks are whole cache lines so no two threads write the same line
+    struct scan_job job = {dst, src, count, (count / threads) & ~(64 / size - 1), wide, 1,
+                           scan_mask(mode), {0}};
+    parallel_run(scan_worker, &job, threads);
+    uint64_t carry = 0;                         // wraps, like the scan itself;
+                                                // int32 keeps the low 32 bits
+    for (unsigned t = 0; t < threads; t++) {
+        uint64_t sum = (uint64_t)job.sums[t];
+        job.sums[t] = (int64_t)carry;
+        carry += sum;
+    }
+    job.pass = 2;
+    parallel_run(scan_worker, &job, threads);
+}
+
+void array_scan_i32_parallel(int32_t* dst, const int32_t* src, size_t count, int mode,
+                             unsigned threads) {
+    scan_parallel(dst, src, count, 0, mode, threads);
+}
+
+void array_scan_i64_parallel(int64_t* dst, const int64_t* src, size_t count, int mode,
+                             unsigned threads) {
+    scan_parallel(dst, src, count, 1, mode, threads);
+}
@@ -0,0 +1,925 @@
+// assm_search.c - Substring search (memmem/strstr) and multi-pattern matching
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Needles of two or more bytes start with a SIMD filter: one vector
+// compares the needle's first byte at V consecutive haystack positions and
+// a second compares its last byte m - 1 bytes further on; only positions
+// where both match are verified with memcmp_asm. Real text rarely has both
+// bytes line up, so most blocks cost two loads and a movemask, whatever the
+// needle length.
+//
+// The filter alone is O(n * m) on repetitive input ("aaaa" in "aaa...a"),
+// so it counts the bytes it verifies and hands the rest of the haystack to
+// Two-Way once they outgrow the bytes scanned. Two-Way (Crochemore-Perrin)
+// is linear in the worst case; a bad-character table on the window's last
+// byte lets it skip most windows. Its factorization and table are what
+// assm_needle_init precomputes; memmem_asm only builds them on fallback.
+
+// Verification budget: the filter gives up once the bytes it compared
+// exceed twice the positions scanned plus this much
+#define FILTER_SLACK 4096
+
+// Haystacks with fewer candidate positions than the widest block (AVX2)
+// are checked one position at a time
+#define FILTER_MIN_POSITIONS 32
+
+// Candidate scan: from position pos, returns the first block of V positions
+// below limit that holds a candidate, with bit i of *mask set when
+// hay[p + i] == first and hay[p + i + gap] == last. The final block is
+// loaded to end exactly at limit and its mask shifted so it starts at the
+// returned position. Returns limit with *mask == 0 when nothing is left.
+// Loads never pass hay + limit - 1 + gap, so the caller needs limit >= V.
+
+size_t memmem_scan_sse2(const void* hay, size_t pos, size_t limit, int first, int last,
+                        size_t gap, uint32_t* mask) {
+    size_t found;
+    uint32_t bits;
+
+    __asm__ volatile (
+        "movd %4, %%xmm0\n\t"               // First needle byte
+        "punpcklbw %%xmm0, %%xmm0\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm0, %%xmm0\n\t"      // 4 bytes
+        "pshufd $0, %%xmm0, %%xmm0\n\t"     // 16 bytes
+        "movd %5, %%xmm1\n\t"               // Last needle byte
+        "punpcklbw %%xmm1, %%xmm1\n\t"
+        "punpcklwd %%xmm1, %%xmm1\n\t"
+        "pshufd $0, %%xmm1, %%xmm1\n\t"
+        "leaq (%2,%6), %%rdi\n\t"           // Base for the last-byte loads
+        "movq %3, %%rax\n\t"                // Position
+        "1:\n\t"                            // block_loop
+        "leaq 16(%%rax), %%rcx\n\t"         // End of this block
+        "cmpq %7, %%rcx\n\t"                // Past the limit?
+        "ja 5f\n\t"                         // Yes, finish with the last block
+        "movdqu (%2,%%rax), %%xmm2\n\t"     // Candidate first bytes
+        "movdqu (%%rdi,%%rax), %%xmm3\n\t"  // Candidate last bytes
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // First byte matches
+        "pcmpeqb %%xmm1, %%xmm3\n\t"        // Last byte matches
+        "pand %%xmm3, %%xmm2\n\t"           // Both
+        "pmovmskb %%xmm2, %%edx\n\t"        // One bit per position
+        "testl %%edx, %%edx\n\t"            // Any candidate?
+        "jnz 9f\n\t"                        // Yes, return this block
+        "movq %%rcx, %%rax\n\t"             // Next block
+        "jmp 1b\n\t"
+        "5:\n\t"                            // last_block
+        "xorl %%edx, %%edx\n\t"             // No candidates
+        "cmpq %7, %%rax\n\t"                // Positions left?
+        "jae 8f\n\t"                        // No
+        "movq %7, %%rcx\n\t"
+        "subq $16, %%rcx\n\t"               // Block ending at the limit
+        "movdqu (%2,%%rcx), %%xmm2\n\t"
+        "movdqu (%%rdi,%%rcx), %%xmm3\n\t"
+        "pcmpeqb %%xmm0, %%xmm2\n\t"
+        "pcmpeqb %%xmm1, %%xmm3\n\t"
+        "pand %%xmm3, %%xmm2\n\t"
+        "pmovmskb %%xmm2, %%edx\n\t"
+        "negq %%rcx\n\t"
+        "addq %%rax, %%rcx\n\t"             // Positions already scanned
+        "shrl %%cl, %%edx\n\t"              // Drop them
+        "testl %%edx, %%edx\n\t"
+        "jnz 9f\n\t"                        // Candidates left: return them
+        "8:\n\t"                            // exhausted
+        "movq %7, %%rax\n\t"                // Position = limit
+        "9:\n\t"
+        : "=&a" (found), "=&d" (bits)
+        : "r" (hay), "r" (pos), "r" (first), "r" (last), "r" (gap), "r" (limit)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+
+    *mask = bits;
+    return found;
+}
+
+size_t memmem_scan_avx2(const void* hay, size_t pos, size_t limit, int first, int last,
+                        size_t gap, uint32_t* mask) {
+    size_t found;
+    uint32_t bits;
+
+    __asm__ volatile (
+        "vmovd %4, %%xmm0\n\t"              // First needle byte
+        "vpbroadcastb %%xmm0, %%ymm0\n\t"   // in every byte
+        "vmovd %5, %%xmm1\n\t"              // Last needle byte
+        "vpbroadcastb %%xmm1, %%ymm1\n\t"
+        "leaq (%2,%6), %%rdi\n\t"           // Base for the last-byte loads
+        "movq %3, %%rax\n\t"                // Position
+        "1:\n\t"                            // block_loop
+        "leaq 32(%%rax), %%rcx\n\t"         // End of this block
+        "cmpq %7, %%rcx\n\t"                // Past the limit?
+        "ja 5f\n\t"                         // Yes, finish with the last block
+        "vpcmpeqb (%2,%%rax), %%ymm0, %%ymm2\n\t"   // First byte matches
+        "vpcmpeqb (%%rdi,%%rax), %%ymm1, %%ymm3\n\t"  // Last byte matches
+        "vpand %%ymm3, %%ymm2, %%ymm2\n\t"  // Both
+        "vpmovmskb %%ymm2, %%edx\n\t"       // One bit per position
+        "testl %%edx, %%edx\n\t"            // Any candidate?
+        "jnz 9f\n\t"                        // Yes, return this block
+        "movq %%rcx, %%rax\n\t"             // Next block
+        "jmp 1b\n\t"
+        "5:\n\t"                            // last_block
+        "xorl %%edx, %%edx\n\t"             // No candidates
+        "cmpq %7, %%rax\n\t"                // Positions left?
+        "jae 8f\n\t"                        // No
+        "movq %7, %%rcx\n\t"
+        "subq $32, %%rcx\n\t"               // Block ending at the limit
+        "vpcmpeqb (%2,%%rcx), %%ymm0, %%ymm2\n\t"
+        "vpcmpeqb (%%rdi,%%rcx), %%ymm1, %%ymm3\n\t"
+        "vpand %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpmovmskb %%ymm2, %%edx\n\t"
+        "negq %%rcx\n\t"
+        "addq %%rax, %%rcx\n\t"             // Positions already scanned
+        "shrxl %%ecx, %%edx, %%edx\n\t"     // Drop them
+        "testl %%edx, %%edx\n\t"
+        "jnz 9f\n\t"                        // Candidates left: return them
+        "8:\n\t"                            // exhausted
+        "movq %7, %%rax\n\t"                // Position = limit
+        "9:\n\t"
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (found), "=&d" (bits)
+        : "r" (hay), "r" (pos), "r" (first), "r" (last), "r" (gap), "r" (limit)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+
+    *mask = bits;
+    return found;
+}
+
+// Critical factorization: the split point of the needle and the period of
+// its right half, from the larger of the maximal suffixes under both byte
+// orders
+static size_t critical_factorization(const unsigned char* needle, size_t len, size_t* period) {
+    size_t suffix = SIZE_MAX, suffix_rev = SIZE_MAX;
+    size_t j, k, p, p_rev;
+
+    j = 0; k = p = 1;
+    while (j + k < len) {
+        unsigned char a = needle[j + k], b = needle[suffix + k];
+        if (a < b) { j += k; k = 1; p = j - suffix; }
+        else if (a == b) { if (k != p) ++k; else { j += p; k = 1; } }
+        else { suffix = j++; k = p = 1; }
+    }
+
+    j = 0; k = p_rev = 1;
+    while (j + k < len) {
+        unsigned char a = needle[j + k], b = needle[suffix_rev + k];
+        if (a > b) { j += k; k = 1; p_rev = j - suffix_rev; }
+        else if (a == b) { if (k != p_rev) ++k; else { j += p_rev; k = 1; } }
+        else { suffix_rev = j++; k = p_rev = 1; }
+    }
+
+    if (suffix_rev + 1 < suffix + 1) {
+        *period = p;
+        return suffix + 1;
+    }
+    *period = p_rev;
+    return suffix_rev + 1;
+}
+
+static void prepare_two_way(struct assm_needle* needle) {
+    const unsigned char* bytes = needle->bytes;
+    size_t len = needle->len;
+
+    needle->split = critical_factorization(bytes, len, &needle->period);
+    needle->periodic = memcmp_asm(bytes, bytes + needle->period, needle->split) == 0;
+    if (!needle->periodic) {
+        size_t right = len - needle->split;
+        needle->period = (needle->split > right ? needle->split : right) + 1;
+    }
+    for (size_t i = 0; i < 256; ++i) needle->shift[i] = len;
+    for (size_t i = 0; i < len; ++i) needle->shift[bytes[i]] = len - 1 - i;
+    needle->prepared = 1;
+}
+
+// Two-Way with a bad-character skip on the window's last byte. The right
+// half is matched with memcmp_mismatch_asm (the mismatch position sets the
+// shift); the left half only needs equality. len >= 2, n >= len.
+static const unsigned char* two_way(const struct assm_needle* needle,
+                                    const unsigned char* hay, size_t n) {
+    const unsigned char* bytes = needle->bytes;
+    size_t len = needle->len, split = needle->split, period = needle->period;
+    size_t last = len - 1, j = 0;
+
+    if (n < len) return NULL;
+    if (needle->periodic) {
+        // A match shifted by the period keeps len - period bytes matched
+        size_t memory = 0;
+        while (j <= n - len) {
+            size_t shift = needle->shift[hay[j + last]];
+            if (shift) {
+                if (memory && shift < period) shift = len - period;
+                memory = 0;
+                j += shift;
+                continue;
+            }
+            size_t i = split > memory ? split : memory;
+            i += memcmp_mismatch_asm(bytes + i, hay + j + i, last - i);
+            if (i < last) {
+                j += i - split + 1;
+                memory = 0;
+                continue;
+            }
+            if (memcmp_asm(bytes + memory, hay + j + memory, split > memory ? split - memory : 0) == 0) {
+                return hay + j;
+            }
+            j += period;
+            memory = len - period;
+        }
+    } else {
+        while (j <= n - len) {
+            size_t shift = needle->shift[hay[j + last]];
+            if (shift) {
+                j += shift;
+                continue;
+            }
+            size_t i = split + memcmp_mismatch_asm(bytes + split, hay + j + split, last - split);
+            if (i < last) {
+                j += i - split + 1;
+                continue;
+            }
+            if (memcmp_asm(bytes, hay + j, split) == 0) return hay + j;
+            j += period;
+        }
+    }
+    return NULL;
+}
+
+static const unsigned char* two_way_from(const struct assm_needle* needle,
+                                         const unsigned char* hay, size_t n) {
+    if (needle->prepared) return two_way(needle, hay, n);
+    struct assm_needle local = *needle;
+    prepare_two_way(&local);
+    return two_way(&local, hay, n);
+}
+
+// Filtered search for 2 <= len <= n
+static const unsigned char* filter_search(const struct assm_needle* needle,
+                                          const unsigned char* hay, size_t n) {
+    const unsigned char* bytes = needle->bytes;
+    size_t len = needle->len, gap = len - 1, limit = n - len + 1;
+    size_t verified = 0, pos = 0;
+    uint32_t mask;
+
+    if (limit < FILTER_MIN_POSITIONS) {
+        // Too few positions for one block: test them one by one
+        for (; pos < limit; ++pos) {
+            if (hay[pos] == bytes[0] && hay[pos + gap] == bytes[gap] &&
+                memcmp_asm(hay + pos + 1, bytes + 1, len - 2) == 0) {
+                return hay + pos;
+            }
+        }
+        return NULL;
+    }
+
+    // Each scan resumes after the last rejected candidate, whatever the
+    // block width of the dispatched kernel
+    while ((pos = ASSM_DISPATCH(memmem_scan)(hay, pos, limit, bytes[0], bytes[gap], gap, &mask)) < limit) {
+        size_t candidate;
+        do {
+            candidate = pos + (size_t)__builtin_ctz(mask);
+            if (memcmp_asm(hay + candidate + 1, bytes + 1, len - 2) == 0) return hay + candidate;
+            verified += len;
+            if (verified > 2 * candidate + FILTER_SLACK) {
+                // Repetitive input: finish in linear time
+                return two_way_from(needle, hay + candidate + 1, n - candidate - 1);
+            }
+            mask &= mask - 1;
+        } while (mask);
+        pos = candidate + 1;
+    }
+    return NULL;
+}
+
+static const unsigned char* needle_search(const struct assm_needle* needle,
+                                          const unsigned char* hay, size_t n) {
+    if (needle->len == 0) return hay;
+    if (needle->len > n) return NULL;
+    if (needle->len == 1) return memchr_asm(hay, needle->bytes[0], n);
+    return filter_search(needle, hay, n);
+}
+
+void assm_needle_init(struct assm_needle* needle, const void* bytes, size_t len) {
+    needle->bytes = bytes;
+    needle->len = len;
+    needle->prepared = 0;
+    if (len >= 2) prepare_two_way(needle);
+}
+
+void* assm_needle_find(const struct assm_needle* needle, const void* haystack, size_t n) {
+    return (void*)needle_search(needle, haystack, n);
+}
+
+void* memmem_asm(const void* haystack, size_t n, const void* needle, size_t len) {
+    struct assm_needle once;
+    once.bytes = needle;
+    once.len = len;
+    once.prepared = 0;
+    return (void*)needle_search(&once, haystack, n);
+}
+
+char* strstr_asm(const char* haystack, const char* needle) {
+    return memmem_asm(haystack, strlen_asm(haystack), needle, strlen_asm(needle));
+}
+
+// ---------------------------------------------------------------------------
+// Multi-pattern matching
+//
+// Aho-Corasick compiled to a DFA over byte classes: bytes that occur in no
+// pattern share class 0, so a row holds one entry per distinct pattern byte
+// plus one rather than 256. Each entry is the byte offset of the next
+// state's row with bit 0 set when that state reports matches, so the inner
+// loop is a class lookup and one dependent load per byte and leaves only
+// to report. Each state's output list is flattened (its own patterns, then
+// its failure state's), so reporting never walks failure links.
+//
+// Below TEDDY_MAX_PATTERNS (and from the SSE4.2 tier, which implies SSSE3)
+// a Teddy prefilter runs first: patterns are spread over 8 buckets, and
+// for each of their first three bytes two 16-entry tables map the byte's
+// low and high nibble to the buckets allowing it. pshufb looks both up for
+// a whole block of positions; ANDing over the three bytes leaves the
+// buckets whose patterns may start at each position, and only those are
+// verified with memcmp_asm. The automaton covers the last two positions and
+// texts too short for a block, and takes over the rest of the text when
+// the buckets are too crowded to be selective (many patterns over a small
+// alphabet), once verification has cost more than the automaton would.
+// ---------------------------------------------------------------------------
+
+#define TEDDY_MAX_PATTERNS 64
+#define TEDDY_BUCKETS 8
+
+// Teddy needs a full block (32 positions for AVX2) of 3-byte windows
+#define TEDDY_MIN_POSITIONS 32
+
+// Pattern comparisons allowed per 8 positions scanned (plus a fixed
+// allowance) before the automaton takes over
+#define TEDDY_VERIFY_PER_8 1
+#define TEDDY_SLACK 256
+
+struct assm_matcher {
+    size_t count;
+    const unsigned char** patterns;
+    size_t* lengths;
+    unsigned char* arena;           // pattern bytes
+
+    // Aho-Corasick DFA
+    uint8_t classes[256];
+    size_t stride;                  // entries per row (number of classes)
+    uint32_t* table;                // row byte offset | 1 if it reports
+    uint32_t* out_start;            // outputs of state s: [out_start[s], out_start[s + 1])
+    uint32_t* outputs;
+
+    // Teddy
+    int teddy;
+    uint8_t masks[6][16];           // lo/hi nibble tables for bytes 0, 1, 2
+    uint32_t bucket_start[TEDDY_BUCKETS + 1];
+    uint32_t* bucket_patterns;
+};
+
+// Teddy block scan: from position pos, returns the first block of V
+// positions below limit where some bucket survives all three bytes, with
+// bit i of *mask set for each such position and buckets[i] holding its
+// bucket bits. The final block ends exactly at limit; bits for positions
+// before pos are cleared. Returns limit with *mask == 0 when nothing is
+// left. Reads text[pos, limit + 2 + V - 1), so limit >= V.
+
+size_t teddy_scan_ssse3(const uint8_t* masks, const void* text, size_t pos, size_t limit,
+                       uint32_t* mask, uint8_t* buckets) {
+    size_t block;
+    uint32_t bits;
+
+    __asm__ volatile (
+        "movdqu (%2), %%xmm8\n\t"           // Byte 0 low-nibble bucket table
+        "movdqu 16(%2), %%xmm9\n\t"         // Byte 0 high-nibble bucket table
+        "movdqu 32(%2), %%xmm10\n\t"        // Byte 1 low-nibble bucket table
+        "movdqu 48(%2), %%xmm11\n\t"        // Byte 1 high-nibble bucket table
+        "movdqu 64(%2), %%xmm12\n\t"        // Byte 2 low-nibble bucket table
+        "movdqu 80(%2), %%xmm13\n\t"        // Byte 2 high-nibble bucket table
+        "movl $0x0f0f0f0f, %%ecx\n\t"       // Nibble mask
+        "movd %%ecx, %%xmm14\n\t"
+        "pshufd $0, %%xmm14, %%xmm14\n\t"
+        "pxor %%xmm15, %%xmm15\n\t"         // Zero
+        "movq %4, %%rax\n\t"                // Block start
+        "1:\n\t"                            // block_loop
+        "leaq 16(%%rax), %%rcx\n\t"         // End of this block
+        "cmpq %5, %%rcx\n\t"                // Past the limit?
+        "ja 5f\n\t"                         // Yes, finish with the last block
+        "movdqu (%3,%%rax), %%xmm0\n\t"     // Text bytes at offset 0
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "psrlw $4, %%xmm1\n\t"              // High nibbles
+        "pand %%xmm14, %%xmm0\n\t"          // Low nibbles
+        "pand %%xmm14, %%xmm1\n\t"
+        "movdqa %%xmm8, %%xmm4\n\t"
+        "pshufb %%xmm0, %%xmm4\n\t"         // Buckets allowing the low nibble
+        "movdqa %%xmm9, %%xmm5\n\t"
+        "pshufb %%xmm1, %%xmm5\n\t"         // and the high nibble
+        "pand %%xmm5, %%xmm4\n\t"
+        "movdqa %%xmm4, %%xmm2\n\t"         // Buckets matching byte 0
+        "movdqu 1(%3,%%rax), %%xmm0\n\t"    // Text bytes at offset 1
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "psrlw $4, %%xmm1\n\t"              // High nibbles
+        "pand %%xmm14, %%xmm0\n\t"          // Low nibbles
+        "pand %%xmm14, %%xmm1\n\t"
+        "movdqa %%xmm10, %%xmm4\n\t"
+        "pshufb %%xmm0, %%xmm4\n\t"         // Buckets allowing the low nibble
+        "movdqa %%xmm11, %%xmm5\n\t"
+        "pshufb %%xmm1, %%xmm5\n\t"         // and the high nibble
+        "pand %%xmm5, %%xmm4\n\t"
+        "pand %%xmm4, %%xmm2\n\t"           // and byte 1
+        "movdqu 2(%3,%%rax), %%xmm0\n\t"    // Text bytes at offset 2
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "psrlw $4, %%xmm1\n\t"              // High nibbles
+        "pand %%xmm14, %%xmm0\n\t"          // Low nibbles
+        "pand %%xmm14, %%xmm1\n\t"
+        "movdqa %%xmm12, %%xmm4\n\t"
+        "pshufb %%xmm0, %%xmm4\n\t"         // Buckets allowing the low nibble
+        "movdqa %%xmm13, %%xmm5\n\t"
+        "pshufb %%xmm1, %%xmm5\n\t"         // and the high nibble
+        "pand %%xmm5, %%xmm4\n\t"
+        "pand %%xmm4, %%xmm2\n\t"           // and byte 2
+        "movdqa %%xmm2, %%xmm3\n\t"
+        "pcmpeqb %%xmm15, %%xmm3\n\t"       // Positions with no bucket
+        "pmovmskb %%xmm3, %%edx\n\t"
+        "xorl $0xffff, %%edx\n\t"           // Positions with a candidate
+        "jnz 8f\n\t"                        // Candidates: return this block
+        "movq %%rcx, %%rax\n\t"             // Next block
+        "jmp 1b\n\t"
+        "5:\n\t"                            // last_block
+        "cmpq %5, %%rax\n\t"                // Positions left?
+        "jae 7f\n\t"                        // No
+        "movq %%rax, %%rdi\n\t"             // First position not yet scanned
+        "movq %5, %%rax\n\t"
+        "subq $16, %%rax\n\t"               // Block ending at the limit
+        "movdqu (%3,%%rax), %%xmm0\n\t"     // Text bytes at offset 0
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "psrlw $4, %%xmm1\n\t"              // High nibbles
+        "pand %%xmm14, %%xmm0\n\t"          // Low nibbles
+        "pand %%xmm14, %%xmm1\n\t"
+        "movdqa %%xmm8, %%xmm4\n\t"
+        "pshufb %%xmm0, %%xmm4\n\t"         // Buckets allowing the low nibble
+        "movdqa %%xmm9, %%xmm5\n\t"
+        "pshufb %%xmm1, %%xmm5\n\t"         // and the high nibble
+        "pand %%xmm5, %%xmm4\n\t"
+        "movdqa %%xmm4, %%xmm2\n\t"         // Buckets matching byte 0
+        "movdqu 1(%3,%%rax), %%xmm0\n\t"    // Text bytes at offset 1
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "psrlw $4, %%xmm1\n\t"              // High nibbles
+        "pand %%xmm14, %%xmm0\n\t"          // Low nibbles
+        "pand %%xmm14, %%xmm1\n\t"
+        "movdqa %%xmm10, %%xmm4\n\t"
+        "pshufb %%xmm0, %%xmm4\n\t"         // Buckets allowing the low nibble
+        "movdqa %%xmm11, %%xmm5\n\t"
+        "pshufb %%xmm1, %%xmm5\n\t"         // and the high nibble
+        "pand %%xmm5, %%xmm4\n\t"
+        "pand %%xmm4, %%xmm2\n\t"           // and byte 1
+        "movdqu 2(%3,%%rax), %%xmm0\n\t"    // Text bytes at offset 2
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "psrlw $4, %%xmm1\n\t"              // High nibbles
+        "pand %%xmm14, %%xmm0\n\t"          // Low nibbles
+        "pand %%xmm14, %%xmm1\n\t"
+        "movdqa %%xmm12, %%xmm4\n\t"
+        "pshufb %%xmm0, %%xmm4\n\t"         // Buckets allowing the low nibble
+        "movdqa %%xmm13, %%xmm5\n\t"
+        "pshufb %%xmm1, %%xmm5\n\t"         // and the high nibble
+        "pand %%xmm5, %%xmm4\n\t"
+        "pand %%xmm4, %%xmm2\n\t"           // and byte 2
+        "movdqa %%xmm2, %%xmm3\n\t"
+        "pcmpeqb %%xmm15, %%xmm3\n\t"       // Positions with no bucket
+        "pmovmskb %%xmm3, %%edx\n\t"
+        "xorl $0xffff, %%edx\n\t"           // Positions with a candidate
+        "movq %%rdi, %%rcx\n\t"
+        "subq %%rax, %%rcx\n\t"             // Positions already scanned
+        "shrl %%cl, %%edx\n\t"              // Drop them
+        "shll %%cl, %%edx\n\t"
+        "testl %%edx, %%edx\n\t"
+        "jnz 8f\n\t"                        // Candidates left: return them
+        "7:\n\t"                            // exhausted
+        "movq %5, %%rax\n\t"                // Block = limit
+        "xorl %%edx, %%edx\n\t"             // No candidates
+        "jmp 9f\n\t"
+        "8:\n\t"                            // found
+        "movdqu %%xmm2, (%6)\n\t"           // Bucket bits of each position
+        "9:\n\t"
+        : "=&a" (block), "=&d" (bits)
+        : "r" (masks), "r" (text), "r" (pos), "r" (limit), "r" (buckets)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory"
+    );
+
+    *mask = bits;
+    return block;
+}
+
+size_t teddy_scan_avx2(const uint8_t* masks, const void* text, size_t pos, size_t limit,
+                       uint32_t* mask, uint8_t* buckets) {
+    size_t block;
+    uint32_t bits;
+
+    __asm__ volatile (
+        "vbroadcasti128 (%2), %%ymm8\n\t"   // Byte 0 low-nibble bucket table (both lanes)
+        "vbroadcasti128 16(%2), %%ymm9\n\t" // Byte 0 high-nibble bucket table
+        "vbroadcasti128 32(%2), %%ymm10\n\t"  // Byte 1 low-nibble bucket table
+        "vbroadcasti128 48(%2), %%ymm11\n\t"  // Byte 1 high-nibble bucket table
+        "vbroadcasti128 64(%2), %%ymm12\n\t"  // Byte 2 low-nibble bucket table
+        "vbroadcasti128 80(%2), %%ymm13\n\t"  // Byte 2 high-nibble bucket table
+        "movl $0x0f0f0f0f, %%ecx\n\t"       // Nibble mask
+        "vmovd %%ecx, %%xmm14\n\t"
+        "vpbroadcastd %%xmm14, %%ymm14\n\t"
+        "vpxor %%xmm15, %%xmm15, %%xmm15\n\t"  // Zero
+        "movq %4, %%rax\n\t"                // Block start
+        "1:\n\t"                            // block_loop
+        "leaq 32(%%rax), %%rcx\n\t"         // End of this block
+        "cmpq %5, %%rcx\n\t"                // Past the limit?
+        "ja 5f\n\t"                         // Yes, finish with the last block
+        "vmovdqu (%3,%%rax), %%ymm0\n\t"    // Text bytes at offset 0
+        "vpsrlw $4, %%ymm0, %%ymm1\n\t"     // High nibbles
+        "vpand %%ymm14, %%ymm0, %%ymm0\n\t" // Low nibbles
+        "vpand %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vpshufb %%ymm0, %%ymm8, %%ymm0\n\t"  // Buckets allowing the low nibble
+        "vpshufb %%ymm1, %%ymm9, %%ymm1\n\t"  // and the high nibble
+        "vpand %%ymm1, %%ymm0, %%ymm2\n\t"  // Buckets matching byte 0
+        "vmovdqu 1(%3,%%rax), %%ymm0\n\t"   // Text bytes at offset 1
+        "vpsrlw $4, %%ymm0, %%ymm1\n\t"     // High nibbles
+        "vpand %%ymm14, %%ymm0, %%ymm0\n\t" // Low nibbles
+        "vpand %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vpshufb %%ymm0, %%ymm10, %%ymm0\n\t"  // Buckets allowing the low nibble
+        "vpshufb %%ymm1, %%ymm11, %%ymm1\n\t"  // and the high nibble
+        "vpand %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpand %%ymm0, %%ymm2, %%ymm2\n\t"  // and byte 1
+        "vmovdqu 2(%3,%%rax), %%ymm0\n\t"   // Text bytes at offset 2
+        "vpsrlw $4, %%ymm0, %%ymm1\n\t"     // High nibbles
+        "vpand %%ymm14, %%ymm0, %%ymm0\n\t" // Low nibbles
+        "vpand %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vpshufb %%ymm0, %%ymm12, %%ymm0\n\t"  // Buckets allowing the low nibble
+        "vpshufb %%ymm1, %%ymm13, %%ymm1\n\t"  // and the high nibble
+        "vpand %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpand %%ymm0, %%ymm2, %%ymm2\n\t"  // and byte 2
+        "vpcmpeqb %%ymm15, %%ymm2, %%ymm3\n\t"  // Positions with no bucket
+        "vpmovmskb %%ymm3, %%edx\n\t"
+        "xorl $-1, %%edx\n\t"               // Positions with a candidate
+        "jnz 8f\n\t"                        // Candidates: return this block
+        "movq %%rcx, %%rax\n\t"             // Next block
+        "jmp 1b\n\t"
+        "5:\n\t"                            // last_block
+        "cmpq %5, %%rax\n\t"                // Positions left?
+        "jae 7f\n\t"                        // No
+        "movq %%rax, %%rdi\n\t"             // First position not yet scanned
+        "movq %5, %%rax\n\t"
+        "subq $32, %%rax\n\t"               // Block ending at the limit
+        "vmovdqu (%3,%%rax), %%ymm0\n\t"    // Text bytes at offset 0
+        "vpsrlw $4, %%ymm0, %%ymm1\n\t"     // High nibbles
+        "vpand %%ymm14, %%ymm0, %%ymm0\n\t" // Low nibbles
+        "vpand %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vpshufb %%ymm0, %%ymm8, %%ymm0\n\t"  // Buckets allowing the low nibble
+        "vpshufb %%ymm1, %%ymm9, %%ymm1\n\t"  // and the high nibble
+        "vpand %%ymm1, %%ymm0, %%ymm2\n\t"  // Buckets matching byte 0
+        "vmovdqu 1(%3,%%rax), %%ymm0\n\t"   // Text bytes at offset 1
+        "vpsrlw $4, %%ymm0, %%ymm1\n\t"     // High nibbles
+        "vpand %%ymm14, %%ymm0, %%ymm0\n\t" // Low nibbles
+        "vpand %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vpshufb %%ymm0, %%ymm10, %%ymm0\n\t"  // Buckets allowing the low nibble
+        "vpshufb %%ymm1, %%ymm11, %%ymm1\n\t"  // and the high nibble
+        "vpand %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpand %%ymm0, %%ymm2, %%ymm2\n\t"  // and byte 1
+        "vmovdqu 2(%3,%%rax), %%ymm0\n\t"   // Text bytes at offset 2
+        "vpsrlw $4, %%ymm0, %%ymm1\n\t"     // High nibbles
+        "vpand %%ymm14, %%ymm0, %%ymm0\n\t" // Low nibbles
+        "vpand %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vpshufb %%ymm0, %%ymm12, %%ymm0\n\t"  // Buckets allowing the low nibble
+        "vpshufb %%ymm1, %%ymm13, %%ymm1\n\t"  // and the high nibble
+        "vpand %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpand %%ymm0, %%ymm2, %%ymm2\n\t"  // and byte 2
+        "vpcmpeqb %%ymm15, %%ymm2, %%ymm3\n\t"  // Positions with no bucket
+        "vpmovmskb %%ymm3, %%edx\n\t"
+        "xorl $-1, %%edx\n\t"               // Positions with a candidate
+        "movq %%rdi, %%rcx\n\t"
+        "subq %%rax, %%rcx\n\t"             // Positions already scanned
+        "shrxl %%ecx, %%edx, %%edx\n\t"     // Drop them
+        "shlxl %%ecx, %%edx, %%edx\n\t"
+        "testl %%edx, %%edx\n\t"
+        "jnz 8f\n\t"                        // Candidates left: return them
+        "7:\n\t"                            // exhausted
+        "movq %5, %%rax\n\t"                // Block = limit
+        "xorl %%edx, %%edx\n\t"             // No candidates
+        "jmp 9f\n\t"
+        "8:\n\t"                            // found
+        "vmovdqu %%ymm2, (%6)\n\t"          // Bucket bits of each position
+        "9:\n\t"
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (block), "=&d" (bits)
+        : "r" (masks), "r" (text), "r" (pos), "r" (limit), "r" (buckets)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory"
+    );
+
+    *mask = bits;
+    return block;
+}
+
+// Runs the DFA from pos until a byte leads into a reporting state (returned
+// position is just past it, *state has bit 0 set) or the text ends
+static size_t ac_run(const uint32_t* table, const uint8_t* classes, const unsigned char* text,
+                     size_t pos, size_t n, uint32_t* state) {
+    size_t end, row = *state;
+
+    __asm__ volatile (
+        "movq %3, %%rax\n\t"                // Position
+        "1:\n\t"                            // byte_loop
+        "cmpq %4, %%rax\n\t"                // End of text?
+        "jae 9f\n\t"
+        "movzbl (%2,%%rax), %%ecx\n\t"      // Next byte
+        "movzbl (%6,%%rcx), %%ecx\n\t"      // Its class
+        "addq $1, %%rax\n\t"
+        "leaq (%5,%%rcx,4), %%rdi\n\t"      // Its column, off the state chain
+        "movl (%%rdi,%%rdx), %%edx\n\t"     // Next row | reports
+        "testl $1, %%edx\n\t"               // Reporting state?
+        "jz 1b\n\t"                         // No, next byte
+        "9:\n\t"
+        : "=&a" (end), "+d" (row)
+        : "r" (text), "r" (pos), "r" (n), "r" (table), "r" (classes)
+        : "rcx", "rdi", "memory"
+    );
+
+    *state = (uint32_t)row;
+    return end;
+}
+
+static int build_automaton(struct assm_matcher* m) {
+    size_t total = 0, classes = 1, states = 1;
+
+    for (size_t p = 0; p < m->count; ++p) {
+        total += m->lengths[p];
+        for (size_t i = 0; i < m->lengths[p]; ++i) m->classes[m->patterns[p][i]] = 1;
+    }
+    for (size_t b = 0; b < 256; ++b) {
+        if (m->classes[b]) m->classes[b] = (uint8_t)classes++;
+    }
+    m->stride = classes;
+    if (total + 1 > UINT32_MAX / 4 / classes) return 0;
+
+    // Trie with -1 for missing edges, one output chain per state
+    size_t cap = total + 1;
+    int32_t* go = malloc(cap * classes * sizeof(int32_t));
+    uint32_t* fail = malloc(cap * sizeof(uint32_t));
+    uint32_t* order = malloc(cap * sizeof(uint32_t));
+    int32_t* own = malloc(cap * sizeof(int32_t));       // first pattern ending here
+    int32_t* next = malloc(m->count * sizeof(int32_t)); // next pattern ending at the same state
+    m->table = malloc(cap * classes * sizeof(uint32_t));
+    m->out_start = malloc((cap + 1) * sizeof(uint32_t));
+    if (!go || !fail || !order || !own || !next || !m->table || !m->out_start) {
+        free(go); free(fail); free(order); free(own); free(next);
+        return 0;
+    }
+    memset(go, -1, cap * classes * sizeof(int32_t));
+    own[0] = -1;
+    for (size_t p = m->count; p-- > 0;) {
+        size_t s = 0;
+        for (size_t i = 0; i < m->lengths[p]; ++i) {
+            int32_t* edge = &go[s * classes + m->classes[m->patterns[p][i]]];
+            if (*edge < 0) {
+                own[states] = -1;
+                *edge = (int32_t)states++;
+            }
+            s = (size_t)*edge;
+        }
+        next[p] = own[s];           // patterns in input order at each state
+        own[s] = (int32_t)p;
+    }
+
+    // Breadth-first: failure links, then complete every row into a DFA
+    size_t head = 0, tail = 0;
+    fail[0] = 0;
+    order[tail++] = 0;
+    while (head < tail) {
+        size_t s = order[head++];
+        for (size_t c = 0; c < classes; ++c) {
+            int32_t t = go[s * classes + c];
+            if (t >= 0) {
+                fail[t] = s ? (uint32_t)go[fail[s] * classes + c] : 0;
+                order[tail++] = (uint32_t)t;
+            } else {
+                go[s * classes + c] = s ? go[fail[s] * classes + c] : 0;
+            }
+        }
+    }
+
+    // Flattened outputs: a state's own patterns, then its failure state's
+    size_t outputs = 0;
+    uint32_t* count = m->out_start + 1;
+    for (size_t i = 0; i < states; ++i) {
+        size_t s = order[i];
+        count[s] = s ? count[fail[s]] : 0;
+        for (int32_t p = own[s]; p >= 0; p = next[p]) ++count[s];
+        outputs += count[s];
+    }
+    m->outputs = malloc((outputs ? outputs : 1) * sizeof(uint32_t));
+    if (!m->outputs) {
+        free(go); free(fail); free(order); free(own); free(next);
+        return 0;
+    }
+    m->out_start[0] = 0;
+    for (size_t s = 0; s < states; ++s) m->out_start[s + 1] += m->out_start[s];
+    for (size_t i = 0; i < states; ++i) {
+        size_t s = order[i], o = m->out_start[s];
+        for (int32_t p = own[s]; p >= 0; p = next[p]) m->outputs[o++] = (uint32_t)p;
+        if (s) {
+            for (size_t f = m->out_start[fail[s]]; f < m->out_start[fail[s] + 1]; ++f) {
+                m->outputs[o++] = m->outputs[f];
+            }
+        }
+    }
+
+    for (size_t s = 0; s < states; ++s) {
+        for (size_t c = 0; c < classes; ++c) {
+            uint32_t t = (uint32_t)go[s * classes + c];
+            m->table[s * classes + c] = t * 4 * (uint32_t)classes | (m->out_start[t + 1] > m->out_start[t]);
+        }
+    }
+
+    free(go); free(fail); free(order); free(own); free(next);
+    return 1;
+}
+
+static int pattern_less(const struct assm_matcher* m, size_t a, size_t b) {
+    size_t len = m->lengths[a] < m->lengths[b] ? m->lengths[a] : m->lengths[b];
+    int cmp = memcmp_asm(m->patterns[a], m->patterns[b], len);
+    return cmp < 0 || (cmp == 0 && m->lengths[a] < m->lengths[b]);
+}
+
+// Sorted patterns go to buckets in contiguous runs, so patterns sharing a
+// prefix share a bucket and its nibble tables stay selective
+static int build_teddy(struct assm_matcher* m) {
+    uint32_t sorted[TEDDY_MAX_PATTERNS];
+    size_t count = m->count;
+
+    m->bucket_patterns = malloc(count * sizeof(uint32_t));
+    if (!m->bucket_patterns) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t j = i;
+        for (; j > 0 && pattern_less(m, i, sorted[j - 1]); --j) sorted[j] = sorted[j - 1];
+        sorted[j] = (uint32_t)i;
+    }
+
+    memset(m->masks, 0, sizeof(m->masks));
+    for (size_t b = 0; b <= TEDDY_BUCKETS; ++b) m->bucket_start[b] = (uint32_t)(b * count / TEDDY_BUCKETS);
+    for (size_t b = 0; b < TEDDY_BUCKETS; ++b) {
+        for (size_t r = m->bucket_start[b]; r < m->bucket_start[b + 1]; ++r) {
+            size_t p = sorted[r];
+            m->bucket_patterns[r] = (uint32_t)p;
+            for (size_t k = 0; k < 3; ++k) {
+                if (k < m->lengths[p]) {
+                    unsigned char byte = m->patterns[p][k];
+                    m->masks[2 * k][byte & 15] |= (uint8_t)(1u << b);
+                    m->masks[2 * k + 1][byte >> 4] |= (uint8_t)(1u << b);
+                } else {
+                    // Shorter pattern: any byte at this offset
+                    for (size_t nib = 0; nib < 16; ++nib) {
+                        m->masks[2 * k][nib] |= (uint8_t)(1u << b);
+                        m->masks[2 * k + 1][nib] |= (uint8_t)(1u << b);
+                    }
+                }
+            }
+        }
+    }
+    m->teddy = 1;
+    return 1;
+}
+
+struct assm_matcher* assm_matcher_create_with(const char* const* patterns, const size_t* lengths,
+                                              size_t count, int allow_teddy) {
+    struct assm_matcher* m = calloc(1, sizeof(*m));
+    if (!m) return NULL;
+    m->count = count;
+    m->patterns = malloc((count ? count : 1) * sizeof(*m->patterns));
+    m->lengths = malloc((count ? count : 1) * sizeof(*m->lengths));
+    if (!m->patterns || !m->lengths) {
+        assm_matcher_free(m);
+        return NULL;
+    }
+
+    size_t total = 0;
+    for (size_t p = 0; p < count; ++p) {
+        m->lengths[p] = lengths ? lengths[p] : strlen_asm(patterns[p]);
+        if (m->lengths[p] == 0) {
+            assm_matcher_free(m);
+            return NULL;
+        }
+        total += m->lengths[p];
+    }
+    m->arena = malloc(total ? total : 1);
+    if (!m->arena) {
+        assm_matcher_free(m);
+        return NULL;
+    }
+    for (size_t p = 0, at = 0; p < count; at += m->lengths[p], ++p) {
+        memcpy_asm(m->arena + at, patterns[p], m->lengths[p]);
+        m->patterns[p] = m->arena + at;
+    }
+
+    int ok = build_automaton(m);
+    if (ok && allow_teddy && count > 0 && count < TEDDY_MAX_PATTERNS &&
+        assm_cpu_tier() >= ASSM_TIER_SSE42) {
+        ok = build_teddy(m);
+    }
+    if (!ok) {
+        assm_matcher_free(m);
+        return NULL;
+    }
+    return m;
+}
+
+struct assm_matcher* assm_matcher_create(const char* const* patterns, const size_t* lengths,
+                                         size_t count) {
+    return assm_matcher_create_with(patterns, lengths, count, 1);
+}
+
+void assm_matcher_free(struct assm_matcher* m) {
+    if (!m) return;
+    free(m->patterns);
+    free(m->lengths);
+    free(m->arena);
+    free(m->table);
+    free(m->out_start);
+    free(m->outputs);
+    free(m->bucket_patterns);
+    free(m);
+}
+
+// Automaton over text[pos, n): reports the matches starting at pos or later
+static size_t ac_scan(const struct assm_matcher* m, const unsigned char* text, size_t pos, size_t n,
+                      assm_match_fn fn, void* context) {
+    size_t reported = 0, row_bytes = 4 * m->stride;
+    uint32_t state = 0;
+
+    while (pos < n) {
+        pos = ac_run(m->table, m->classes, text, pos, n, &state);
+        if (!(state & 1)) break;
+        state &= ~1u;
+        size_t s = state / row_bytes;
+        for (size_t o = m->out_start[s]; o < m->out_start[s + 1]; ++o) {
+            size_t p = m->outputs[o];
+            ++reported;
+            if (fn(context, p, pos - m->lengths[p])) return reported;
+        }
+    }
+    return reported;
+}
+
+static size_t teddy_scan_text(const struct assm_matcher* m, const unsigned char* text, size_t n,
+                              assm_match_fn fn, void* context) {
+    size_t limit = n - 2, pos = 0, block, reported = 0, verified = 0;
+    uint8_t buckets[32];
+    uint32_t mask;
+
+    while ((block = ASSM_DISPATCH(teddy_scan)(&m->masks[0][0], text, pos, limit, &mask, buckets)) < limit) {
+        size_t at;
+        do {
+            size_t j = (size_t)__builtin_ctz(mask);
+            at = block + j;
+            for (uint32_t bits = buckets[j]; bits; bits &= bits - 1) {
+                size_t b = (size_t)__builtin_ctz(bits);
+                verified += m->bucket_start[b + 1] - m->bucket_start[b];
+                for (size_t r = m->bucket_start[b]; r < m->bucket_start[b + 1]; ++r) {
+                    size_t p = m->bucket_patterns[r], len = m->lengths[p];
+                    if (len <= n - at && memcmp_asm(text + at, m->patterns[p], len) == 0) {
+                        ++reported;
+                        if (fn(context, p, at)) return reported;
+                    }
+                }
+            }
+            mask &= mask - 1;
+        } while (mask);
+        pos = at + 1;
+        // Every match starting before pos is reported, and the automaton
+        // started at pos reports exactly those starting at or after it
+        if (verified > TEDDY_VERIFY_PER_8 * (pos / 8) + TEDDY_SLACK) {
+            return reported + ac_scan(m, text, pos, n, fn, context);
+        }
+    }
+    return reported + ac_scan(m, text, limit, n, fn, context);
+}
+
+size_t assm_matcher_scan(const struct assm_matcher* m, const void* text, size_t n,
+                         assm_match_fn fn, void* context) {
+    if (m->teddy && n >= TEDDY_MIN_POSITIONS + 2) return teddy_scan_text(m, text, n, fn, context);
+    return ac_scan(m, text, 0, n, fn, context);
+}
+
+struct match_buffer {
+    struct assm_match* out;
+    size_t max;
+    size_t stored;
+};
+
+static int store_match(void* context, size_t pattern, size_t start) {
+    struct match_buffer* buf = context;
+    if (buf->stored < buf->max) {
+        buf->out[buf->stored].pattern = pattern;
+        buf->out[buf->stored].start = start;
+    }
+    ++buf->stored;
+    return 0;
+}
+
+size_t assm_matcher_find_all(const struct assm_matcher* m, const void* text, size_t n,
+                             struct assm_match* out, size_t max) {
+    struct match_buffer buf = { out, max, 0 };
+    return assm_matcher_scan(m, text, n, store_match, &buf);
+}
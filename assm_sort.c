@@ -0,0 +1,1662 @@
+// assm_sort.c - Radix sort and sorting networks for int32 and int64 keys
+#include <stdlib.h>
+#include <string.h>
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// Large arrays are sorted with an LSD radix sort on 8-bit digits: one pass
+// over the keys counts every digit at once, then each digit is a stable
+// counting-sort pass from one buffer to the other. A digit on which all
+// keys agree (the high bytes of small values, say) would only copy the
+// array, so its pass is skipped. Keys compare as signed because the top
+// digit's buckets are laid out from 0x80 up, wrapping to 0x7f.
+//
+// The histogram keeps two tables and alternates keys between them: a run
+// of keys with the same digit, which is most of them in a constant digit,
+// otherwise serializes on one counter's load and store. Tables are 32-bit;
+// the caller feeds them at most RADIX_HIST_CHUNK keys at a time.
+#define RADIX_HIST_CHUNK ((size_t)1 << 31)
+
+static void radix_histogram_64(const int64_t* keys, size_t n, uint32_t* tables) {
+    __asm__ volatile (
+        "xorl %%ecx, %%ecx\n\t"
+        "1:\n\t"                            // loop: two keys
+        "leaq 2(%%rcx), %%rdx\n\t"
+        "cmpq %1, %%rdx\n\t"
+        "ja 3f\n\t"
+        "movq (%0,%%rcx,8), %%rax\n\t"
+        "movq 8(%0,%%rcx,8), %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"            // Digit 0
+        "incl 0(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 8192(%2,%%rdx,4)\n\t"         // ... into the second table
+        "shrq $8, %%rax\n\t"
+        "shrq $8, %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 1024(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 9216(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "shrq $8, %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 2048(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 10240(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "shrq $8, %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 3072(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 11264(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "shrq $8, %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 4096(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 12288(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "shrq $8, %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 5120(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 13312(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "shrq $8, %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 6144(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 14336(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "shrq $8, %%rsi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 7168(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 15360(%2,%%rdx,4)\n\t"
+        "addq $2, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"
+        "cmpq %1, %%rcx\n\t"
+        "jae 4f\n\t"
+        "movq (%0,%%rcx,8), %%rax\n\t"      // Odd key out
+        "movzbl %%al, %%edx\n\t"
+        "incl 0(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 1024(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 2048(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 3072(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 4096(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 5120(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 6144(%2,%%rdx,4)\n\t"
+        "shrq $8, %%rax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 7168(%2,%%rdx,4)\n\t"
+        "4:\n\t"
+        :
+        : "r"(keys), "r"(n), "r"(tables)
+        : "rax", "rcx", "rdx", "rsi", "memory", "cc"
+    );
+}
+
+static void radix_histogram_32(const int32_t* keys, size_t n, uint32_t* tables) {
+    __asm__ volatile (
+        "xorl %%ecx, %%ecx\n\t"
+        "1:\n\t"                            // loop: two keys
+        "leaq 2(%%rcx), %%rdx\n\t"
+        "cmpq %1, %%rdx\n\t"
+        "ja 3f\n\t"
+        "movl (%0,%%rcx,4), %%eax\n\t"
+        "movl 4(%0,%%rcx,4), %%esi\n\t"
+        "movzbl %%al, %%edx\n\t"            // Digit 0
+        "incl 0(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 4096(%2,%%rdx,4)\n\t"         // ... into the second table
+        "shrl $8, %%eax\n\t"
+        "shrl $8, %%esi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 1024(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 5120(%2,%%rdx,4)\n\t"
+        "shrl $8, %%eax\n\t"
+        "shrl $8, %%esi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 2048(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 6144(%2,%%rdx,4)\n\t"
+        "shrl $8, %%eax\n\t"
+        "shrl $8, %%esi\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 3072(%2,%%rdx,4)\n\t"
+        "movzbl %%sil, %%edx\n\t"
+        "incl 7168(%2,%%rdx,4)\n\t"
+        "addq $2, %%rcx\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"
+        "cmpq %1, %%rcx\n\t"
+        "jae 4f\n\t"
+        "movl (%0,%%rcx,4), %%eax\n\t"      // Odd key out
+        "movzbl %%al, %%edx\n\t"
+        "incl 0(%2,%%rdx,4)\n\t"
+        "shrl $8, %%eax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 1024(%2,%%rdx,4)\n\t"
+        "shrl $8, %%eax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 2048(%2,%%rdx,4)\n\t"
+        "shrl $8, %%eax\n\t"
+        "movzbl %%al, %%edx\n\t"
+        "incl 3072(%2,%%rdx,4)\n\t"
+        "4:\n\t"
+        :
+        : "r"(keys), "r"(n), "r"(tables)
+        : "rax", "rcx", "rdx", "rsi", "memory", "cc"
+    );
+}
+
+struct radix_scatter {
+    size_t pos[256];                // next slot of each bucket
+    size_t start[256];              // its first slot
+    size_t payload_stream;          // payload lines are aligned for movntdq
+};
+
+static void radix_scatter_64(const int64_t* src, size_t n, struct radix_scatter* ctl, char* dst,
+                             unsigned shift) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %1, %0\n\t"
+        "jae 2f\n\t"
+        "movq (%0), %%rax\n\t"
+        "movq %%rax, %%rdx\n\t"
+        "shrq %%cl, %%rdx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%2,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movq %%rax, (%3,%%r8,8)\n\t"
+        "incq %%r8\n\t"
+        "movq %%r8, (%2,%%rdx,8)\n\t"
+        "addq $8, %0\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        : "+r"(src)
+        : "r"(src + n), "r"(ctl), "r"(dst), "c"(shift)
+        : "rax", "rdx", "r8", "memory", "cc"
+    );
+}
+
+static void radix_scatter_64_payload(const int64_t* src, size_t n, struct radix_scatter* ctl,
+                                     char* dst, unsigned shift, const uint64_t* psrc, char* pdst) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %2, %0\n\t"
+        "jae 2f\n\t"
+        "movq (%0), %%rax\n\t"
+        "movq %%rax, %%rdx\n\t"
+        "shrq %%cl, %%rdx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%3,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movq %%rax, (%4,%%r8,8)\n\t"
+        "movq (%1), %%rax\n\t"              // Payload follows its key
+        "movq %%rax, (%5,%%r8,8)\n\t"
+        "addq $8, %1\n\t"
+        "incq %%r8\n\t"
+        "movq %%r8, (%3,%%rdx,8)\n\t"
+        "addq $8, %0\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        : "+r"(src), "+r"(psrc)
+        : "r"(src + n), "r"(ctl), "r"(dst), "r"(pdst), "c"(shift)
+        : "rax", "rdx", "r8", "memory", "cc"
+    );
+}
+
+static void radix_scatter_32(const int32_t* src, size_t n, struct radix_scatter* ctl, char* dst,
+                             unsigned shift) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %1, %0\n\t"
+        "jae 2f\n\t"
+        "movl (%0), %%eax\n\t"
+        "movl %%eax, %%edx\n\t"
+        "shrl %%cl, %%edx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%2,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movl %%eax, (%3,%%r8,4)\n\t"
+        "incq %%r8\n\t"
+        "movq %%r8, (%2,%%rdx,8)\n\t"
+        "addq $4, %0\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        : "+r"(src)
+        : "r"(src + n), "r"(ctl), "r"(dst), "c"(shift)
+        : "rax", "rdx", "r8", "memory", "cc"
+    );
+}
+
+static void radix_scatter_32_payload(const int32_t* src, size_t n, struct radix_scatter* ctl,
+                                     char* dst, unsigned shift, const uint32_t* psrc, char* pdst) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %2, %0\n\t"
+        "jae 2f\n\t"
+        "movl (%0), %%eax\n\t"
+        "movl %%eax, %%edx\n\t"
+        "shrl %%cl, %%edx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%3,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movl %%eax, (%4,%%r8,4)\n\t"
+        "movl (%1), %%eax\n\t"              // Payload follows its key
+        "movl %%eax, (%5,%%r8,4)\n\t"
+        "addq $4, %1\n\t"
+        "incq %%r8\n\t"
+        "movq %%r8, (%3,%%rdx,8)\n\t"
+        "addq $4, %0\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        : "+r"(src), "+r"(psrc)
+        : "r"(src + n), "r"(ctl), "r"(dst), "r"(pdst), "c"(shift)
+        : "rax", "rdx", "r8", "memory", "cc"
+    );
+}
+
+// Past the caches a pass is bound by its 256 store streams: each key goes
+// to a different line, and often a different page, than the one before
+// it, a TLB miss and a read for ownership per line. There each bucket
+// fills a 64-byte line in L1 instead, and only whole lines are written
+// out, with non-temporal stores. Slots count from a 64-byte boundary of
+// dst so a line in L1 is exactly one line of dst; a bucket's first line,
+// shared with the bucket before it, is copied key by key, and its last,
+// partial one by radix_flush. In the caches the extra bookkeeping costs
+// more than the stores it saves.
+#define RADIX_LINES_MIN ((size_t)32 << 20)
+
+static void radix_scatter_lines_64(const int64_t* src, size_t n, struct radix_scatter* ctl,
+                                   char* dst, unsigned char* lines, unsigned shift) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %1, %0\n\t"
+        "jae 9f\n\t"
+        "movq (%0), %%rax\n\t"
+        "movq %%rax, %%rdx\n\t"
+        "shrq %%cl, %%rdx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%2,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movl %%r8d, %%r9d\n\t"
+        "andl $7, %%r9d\n\t"
+        "leaq (%%r9,%%rdx,8), %%r9\n\t"
+        "movq %%rax, (%4,%%r9,8)\n\t"       // Into the bucket's line
+        "incq %%r8\n\t"
+        "movq %%r8, (%2,%%rdx,8)\n\t"
+        "addq $8, %0\n\t"
+        "testl $7, %%r8d\n\t"
+        "jnz 1b\n\t"
+        "leaq -8(%%r8), %%r9\n\t"           // The line is full
+        "cmpq 2048(%2,%%rdx,8), %%r9\n\t"
+        "jb 7f\n\t"                         // It starts before the bucket
+        "shll $6, %%edx\n\t"
+        "movdqa 0(%4,%%rdx), %%xmm0\n\t"
+        "movdqa 16(%4,%%rdx), %%xmm1\n\t"
+        "movdqa 32(%4,%%rdx), %%xmm2\n\t"
+        "movdqa 48(%4,%%rdx), %%xmm3\n\t"
+        "movntdq %%xmm0, 0(%3,%%r9,8)\n\t"  // Around the cache
+        "movntdq %%xmm1, 16(%3,%%r9,8)\n\t"
+        "movntdq %%xmm2, 32(%3,%%r9,8)\n\t"
+        "movntdq %%xmm3, 48(%3,%%r9,8)\n\t"
+        "jmp 1b\n\t"
+        "7:\n\t"
+        "movq 2048(%2,%%rdx,8), %%r9\n\t"   // Copy out the bucket's part only
+        "8:\n\t"
+        "cmpq %%r8, %%r9\n\t"
+        "jae 1b\n\t"
+        "movl %%r9d, %%eax\n\t"
+        "andl $7, %%eax\n\t"
+        "leaq (%%rax,%%rdx,8), %%rax\n\t"
+        "movq (%4,%%rax,8), %%r10\n\t"
+        "movq %%r10, (%3,%%r9,8)\n\t"
+        "incq %%r9\n\t"
+        "jmp 8b\n\t"
+        "9:\n\t"
+        "sfence\n\t"
+        : "+r"(src)
+        : "r"(src + n), "r"(ctl), "r"(dst), "r"(lines), "c"(shift)
+        : "rax", "rdx", "r8", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "memory", "cc"
+    );
+}
+
+static void radix_scatter_lines_64_payload(const int64_t* src, size_t n, struct radix_scatter* ctl,
+                                           char* dst, unsigned char* lines, unsigned shift,
+                                           const uint64_t* psrc, char* pdst) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %2, %0\n\t"
+        "jae 9f\n\t"
+        "movq (%0), %%rax\n\t"
+        "movq %%rax, %%rdx\n\t"
+        "shrq %%cl, %%rdx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%3,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movl %%r8d, %%r9d\n\t"
+        "andl $7, %%r9d\n\t"
+        "leaq (%%r9,%%rdx,8), %%r9\n\t"
+        "movq %%rax, (%5,%%r9,8)\n\t"       // Into the bucket's line
+        "movq (%1), %%rax\n\t"              // Payload follows its key
+        "movq %%rax, 16384(%5,%%r9,8)\n\t"
+        "addq $8, %1\n\t"
+        "incq %%r8\n\t"
+        "movq %%r8, (%3,%%rdx,8)\n\t"
+        "addq $8, %0\n\t"
+        "testl $7, %%r8d\n\t"
+        "jnz 1b\n\t"
+        "leaq -8(%%r8), %%r9\n\t"           // The line is full
+        "cmpq 2048(%3,%%rdx,8), %%r9\n\t"
+        "jb 7f\n\t"                         // It starts before the bucket
+        "shll $6, %%edx\n\t"
+        "movdqa 0(%5,%%rdx), %%xmm0\n\t"
+        "movdqa 16(%5,%%rdx), %%xmm1\n\t"
+        "movdqa 32(%5,%%rdx), %%xmm2\n\t"
+        "movdqa 48(%5,%%rdx), %%xmm3\n\t"
+        "movntdq %%xmm0, 0(%4,%%r9,8)\n\t"  // Around the cache
+        "movntdq %%xmm1, 16(%4,%%r9,8)\n\t"
+        "movntdq %%xmm2, 32(%4,%%r9,8)\n\t"
+        "movntdq %%xmm3, 48(%4,%%r9,8)\n\t"
+        "movdqa 16384(%5,%%rdx), %%xmm0\n\t"
+        "movdqa 16400(%5,%%rdx), %%xmm1\n\t"
+        "movdqa 16416(%5,%%rdx), %%xmm2\n\t"
+        "movdqa 16432(%5,%%rdx), %%xmm3\n\t"
+        "testb $1, 4096(%3)\n\t"
+        "jz 3f\n\t"                         // Unaligned payload lines
+        "movntdq %%xmm0, 0(%6,%%r9,8)\n\t"
+        "movntdq %%xmm1, 16(%6,%%r9,8)\n\t"
+        "movntdq %%xmm2, 32(%6,%%r9,8)\n\t"
+        "movntdq %%xmm3, 48(%6,%%r9,8)\n\t"
+        "jmp 4f\n\t"
+        "3:\n\t"
+        "movdqu %%xmm0, 0(%6,%%r9,8)\n\t"
+        "movdqu %%xmm1, 16(%6,%%r9,8)\n\t"
+        "movdqu %%xmm2, 32(%6,%%r9,8)\n\t"
+        "movdqu %%xmm3, 48(%6,%%r9,8)\n\t"
+        "4:\n\t"
+        "jmp 1b\n\t"
+        "7:\n\t"
+        "movq 2048(%3,%%rdx,8), %%r9\n\t"   // Copy out the bucket's part only
+        "8:\n\t"
+        "cmpq %%r8, %%r9\n\t"
+        "jae 1b\n\t"
+        "movl %%r9d, %%eax\n\t"
+        "andl $7, %%eax\n\t"
+        "leaq (%%rax,%%rdx,8), %%rax\n\t"
+        "movq (%5,%%rax,8), %%r10\n\t"
+        "movq %%r10, (%4,%%r9,8)\n\t"
+        "movq 16384(%5,%%rax,8), %%r10\n\t"
+        "movq %%r10, (%6,%%r9,8)\n\t"
+        "incq %%r9\n\t"
+        "jmp 8b\n\t"
+        "9:\n\t"
+        "sfence\n\t"
+        : "+r"(src), "+r"(psrc)
+        : "r"(src + n), "r"(ctl), "r"(dst), "r"(lines), "r"(pdst), "c"(shift)
+        : "rax", "rdx", "r8", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "memory", "cc"
+    );
+}
+
+static void radix_scatter_lines_32(const int32_t* src, size_t n, struct radix_scatter* ctl,
+                                   char* dst, unsigned char* lines, unsigned shift) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %1, %0\n\t"
+        "jae 9f\n\t"
+        "movl (%0), %%eax\n\t"
+        "movl %%eax, %%edx\n\t"
+        "shrl %%cl, %%edx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%2,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movl %%r8d, %%r9d\n\t"
+        "andl $15, %%r9d\n\t"
+        "leaq (%%r9,%%rdx,8), %%r9\n\t"
+        "leaq (%%r9,%%rdx,8), %%r9\n\t"
+        "movl %%eax, (%4,%%r9,4)\n\t"       // Into the bucket's line
+        "incq %%r8\n\t"
+        "movq %%r8, (%2,%%rdx,8)\n\t"
+        "addq $4, %0\n\t"
+        "testl $15, %%r8d\n\t"
+        "jnz 1b\n\t"
+        "leaq -16(%%r8), %%r9\n\t"          // The line is full
+        "cmpq 2048(%2,%%rdx,8), %%r9\n\t"
+        "jb 7f\n\t"                         // It starts before the bucket
+        "shll $6, %%edx\n\t"
+        "movdqa 0(%4,%%rdx), %%xmm0\n\t"
+        "movdqa 16(%4,%%rdx), %%xmm1\n\t"
+        "movdqa 32(%4,%%rdx), %%xmm2\n\t"
+        "movdqa 48(%4,%%rdx), %%xmm3\n\t"
+        "movntdq %%xmm0, 0(%3,%%r9,4)\n\t"  // Around the cache
+        "movntdq %%xmm1, 16(%3,%%r9,4)\n\t"
+        "movntdq %%xmm2, 32(%3,%%r9,4)\n\t"
+        "movntdq %%xmm3, 48(%3,%%r9,4)\n\t"
+        "jmp 1b\n\t"
+        "7:\n\t"
+        "movq 2048(%2,%%rdx,8), %%r9\n\t"   // Copy out the bucket's part only
+        "8:\n\t"
+        "cmpq %%r8, %%r9\n\t"
+        "jae 1b\n\t"
+        "movl %%r9d, %%eax\n\t"
+        "andl $15, %%eax\n\t"
+        "leaq (%%rax,%%rdx,8), %%rax\n\t"
+        "leaq (%%rax,%%rdx,8), %%rax\n\t"
+        "movl (%4,%%rax,4), %%r10d\n\t"
+        "movl %%r10d, (%3,%%r9,4)\n\t"
+        "incq %%r9\n\t"
+        "jmp 8b\n\t"
+        "9:\n\t"
+        "sfence\n\t"
+        : "+r"(src)
+        : "r"(src + n), "r"(ctl), "r"(dst), "r"(lines), "c"(shift)
+        : "rax", "rdx", "r8", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "memory", "cc"
+    );
+}
+
+static void radix_scatter_lines_32_payload(const int32_t* src, size_t n, struct radix_scatter* ctl,
+                                           char* dst, unsigned char* lines, unsigned shift,
+                                           const uint32_t* psrc, char* pdst) {
+    __asm__ volatile (
+        "1:\n\t"                            // loop: one key
+        "cmpq %2, %0\n\t"
+        "jae 9f\n\t"
+        "movl (%0), %%eax\n\t"
+        "movl %%eax, %%edx\n\t"
+        "shrl %%cl, %%edx\n\t"
+        "movzbl %%dl, %%edx\n\t"            // Digit
+        "movq (%3,%%rdx,8), %%r8\n\t"       // Its bucket's next slot
+        "movl %%r8d, %%r9d\n\t"
+        "andl $15, %%r9d\n\t"
+        "leaq (%%r9,%%rdx,8), %%r9\n\t"
+        "leaq (%%r9,%%rdx,8), %%r9\n\t"
+        "movl %%eax, (%5,%%r9,4)\n\t"       // Into the bucket's line
+        "movl (%1), %%eax\n\t"              // Payload follows its key
+        "movl %%eax, 16384(%5,%%r9,4)\n\t"
+        "addq $4, %1\n\t"
+        "incq %%r8\n\t"
+        "movq %%r8, (%3,%%rdx,8)\n\t"
+        "addq $4, %0\n\t"
+        "testl $15, %%r8d\n\t"
+        "jnz 1b\n\t"
+        "leaq -16(%%r8), %%r9\n\t"          // The line is full
+        "cmpq 2048(%3,%%rdx,8), %%r9\n\t"
+        "jb 7f\n\t"                         // It starts before the bucket
+        "shll $6, %%edx\n\t"
+        "movdqa 0(%5,%%rdx), %%xmm0\n\t"
+        "movdqa 16(%5,%%rdx), %%xmm1\n\t"
+        "movdqa 32(%5,%%rdx), %%xmm2\n\t"
+        "movdqa 48(%5,%%rdx), %%xmm3\n\t"
+        "movntdq %%xmm0, 0(%4,%%r9,4)\n\t"  // Around the cache
+        "movntdq %%xmm1, 16(%4,%%r9,4)\n\t"
+        "movntdq %%xmm2, 32(%4,%%r9,4)\n\t"
+        "movntdq %%xmm3, 48(%4,%%r9,4)\n\t"
+        "movdqa 16384(%5,%%rdx), %%xmm0\n\t"
+        "movdqa 16400(%5,%%rdx), %%xmm1\n\t"
+        "movdqa 16416(%5,%%rdx), %%xmm2\n\t"
+        "movdqa 16432(%5,%%rdx), %%xmm3\n\t"
+        "testb $1, 4096(%3)\n\t"
+        "jz 3f\n\t"                         // Unaligned payload lines
+        "movntdq %%xmm0, 0(%6,%%r9,4)\n\t"
+        "movntdq %%xmm1, 16(%6,%%r9,4)\n\t"
+        "movntdq %%xmm2, 32(%6,%%r9,4)\n\t"
+        "movntdq %%xmm3, 48(%6,%%r9,4)\n\t"
+        "jmp 4f\n\t"
+        "3:\n\t"
+        "movdqu %%xmm0, 0(%6,%%r9,4)\n\t"
+        "movdqu %%xmm1, 16(%6,%%r9,4)\n\t"
+        "movdqu %%xmm2, 32(%6,%%r9,4)\n\t"
+        "movdqu %%xmm3, 48(%6,%%r9,4)\n\t"
+        "4:\n\t"
+        "jmp 1b\n\t"
+        "7:\n\t"
+        "movq 2048(%3,%%rdx,8), %%r9\n\t"   // Copy out the bucket's part only
+        "8:\n\t"
+        "cmpq %%r8, %%r9\n\t"
+        "jae 1b\n\t"
+        "movl %%r9d, %%eax\n\t"
+        "andl $15, %%eax\n\t"
+        "leaq (%%rax,%%rdx,8), %%rax\n\t"
+        "leaq (%%rax,%%rdx,8), %%rax\n\t"
+        "movl (%5,%%rax,4), %%r10d\n\t"
+        "movl %%r10d, (%4,%%r9,4)\n\t"
+        "movl 16384(%5,%%rax,4), %%r10d\n\t"
+        "movl %%r10d, (%6,%%r9,4)\n\t"
+        "incq %%r9\n\t"
+        "jmp 8b\n\t"
+        "9:\n\t"
+        "sfence\n\t"
+        : "+r"(src), "+r"(psrc)
+        : "r"(src + n), "r"(ctl), "r"(dst), "r"(lines), "r"(pdst), "c"(shift)
+        : "rax", "rdx", "r8", "r9", "r10", "xmm0", "xmm1", "xmm2", "xmm3", "memory", "cc"
+    );
+}
+
+// Writes out what is left in each bucket's last line
+static void radix_flush(const struct radix_scatter* ctl, char* dst, const unsigned char* lines,
+                        size_t size) {
+    size_t lanes = 64 / size;
+    for (unsigned v = 0; v < 256; v++) {
+        size_t end = ctl->pos[v];
+        size_t from = end & ~(lanes - 1);
+        if (from < ctl->start[v]) from = ctl->start[v];
+        memcpy(dst + from * size, lines + v * 64 + (from & (lanes - 1)) * size, (end - from) * size);
+    }
+}
+
+// Small arrays do not amortize the radix passes' 256-entry tables. They
+// are padded with the largest key to whole blocks of one element per lane
+// of L registers (16 int64 or 64 int32), and each block is sorted in
+// registers: a sorting network down the columns, a transpose that turns
+// each column into a sorted register, then bitonic merges of register runs
+// until one run is left. The blocks are then merged pairwise by a vector
+// bitonic merge: the carry register and the next vector from whichever
+// input has the smaller head make a bitonic sequence of 2L, whose lower
+// half is final. Compare-exchange is a min and a max (int64 has no vpminsq
+// in AVX2, so vpcmpgtq and two blends); an in-register step is a shuffle,
+// the min and max, and a blend back.
+static const int64_t sort_keep_max_64[8] __attribute__((aligned(32))) = {
+    0, 0, -1, -1,                   // vpermq $0x4e: upper half keeps the max
+    0, -1, 0, -1,                   // vpshufd $0x4e: odd lanes keep the max
+};
+static const int32_t sort_reverse_32[8] __attribute__((aligned(32))) = {
+    7, 6, 5, 4, 3, 2, 1, 0,
+};
+
+void sort_blocks_i64_avx2(int64_t* keys, size_t blocks) {
+    __asm__ volatile (
+        "vmovdqa (%2), %%ymm14\n\t"         // Lanes that keep the larger
+        "vmovdqa 32(%2), %%ymm15\n\t"
+        "testq %1, %1\n\t"
+        "jz 2f\n\t"
+        "1:\n\t"                            // loop: one block
+        "vmovdqu 0(%0), %%ymm0\n\t"         // Load one block
+        "vmovdqu 32(%0), %%ymm1\n\t"
+        "vmovdqu 64(%0), %%ymm2\n\t"
+        "vmovdqu 96(%0), %%ymm3\n\t"
+        "vpcmpgtq %%ymm1, %%ymm0, %%ymm4\n\t" // Sort each column
+        "vblendvpd %%ymm4, %%ymm1, %%ymm0, %%ymm5\n\t"
+        "vblendvpd %%ymm4, %%ymm0, %%ymm1, %%ymm4\n\t"
+        "vpcmpgtq %%ymm3, %%ymm2, %%ymm0\n\t"
+        "vblendvpd %%ymm0, %%ymm3, %%ymm2, %%ymm1\n\t"
+        "vblendvpd %%ymm0, %%ymm2, %%ymm3, %%ymm0\n\t"
+        "vpcmpgtq %%ymm1, %%ymm5, %%ymm2\n\t"
+        "vblendvpd %%ymm2, %%ymm1, %%ymm5, %%ymm3\n\t"
+        "vblendvpd %%ymm2, %%ymm5, %%ymm1, %%ymm2\n\t"
+        "vpcmpgtq %%ymm0, %%ymm4, %%ymm1\n\t"
+        "vblendvpd %%ymm1, %%ymm0, %%ymm4, %%ymm5\n\t"
+        "vblendvpd %%ymm1, %%ymm4, %%ymm0, %%ymm1\n\t"
+        "vpcmpgtq %%ymm2, %%ymm5, %%ymm0\n\t"
+        "vblendvpd %%ymm0, %%ymm2, %%ymm5, %%ymm4\n\t"
+        "vblendvpd %%ymm0, %%ymm5, %%ymm2, %%ymm0\n\t"
+        "vpunpcklqdq %%ymm4, %%ymm3, %%ymm2\n\t" // Transpose: columns become runs
+        "vpunpckhqdq %%ymm4, %%ymm3, %%ymm4\n\t"
+        "vpunpcklqdq %%ymm1, %%ymm0, %%ymm3\n\t"
+        "vpunpckhqdq %%ymm1, %%ymm0, %%ymm1\n\t"
+        "vperm2i128 $0x20, %%ymm3, %%ymm2, %%ymm0\n\t"
+        "vperm2i128 $0x31, %%ymm3, %%ymm2, %%ymm3\n\t"
+        "vperm2i128 $0x20, %%ymm1, %%ymm4, %%ymm2\n\t"
+        "vperm2i128 $0x31, %%ymm1, %%ymm4, %%ymm1\n\t"
+        "vpermq $0x1b, %%ymm2, %%ymm2\n\t"  // Bitonic merges: runs of 8
+        "vpcmpgtq %%ymm2, %%ymm0, %%ymm4\n\t"
+        "vblendvpd %%ymm4, %%ymm2, %%ymm0, %%ymm5\n\t"
+        "vblendvpd %%ymm4, %%ymm0, %%ymm2, %%ymm4\n\t"
+        "vpermq $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm5, %%ymm2\n\t"
+        "vpxor %%ymm14, %%ymm2, %%ymm2\n\t"
+        "vblendvpd %%ymm2, %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpshufd $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm5, %%ymm2\n\t"
+        "vpxor %%ymm15, %%ymm2, %%ymm2\n\t"
+        "vblendvpd %%ymm2, %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpermq $0x4e, %%ymm4, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm4, %%ymm2\n\t"
+        "vpxor %%ymm14, %%ymm2, %%ymm2\n\t"
+        "vblendvpd %%ymm2, %%ymm0, %%ymm4, %%ymm4\n\t"
+        "vpshufd $0x4e, %%ymm4, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm4, %%ymm2\n\t"
+        "vpxor %%ymm15, %%ymm2, %%ymm2\n\t"
+        "vblendvpd %%ymm2, %%ymm0, %%ymm4, %%ymm4\n\t"
+        "vpermq $0x1b, %%ymm1, %%ymm1\n\t"
+        "vpcmpgtq %%ymm1, %%ymm3, %%ymm0\n\t"
+        "vblendvpd %%ymm0, %%ymm1, %%ymm3, %%ymm2\n\t"
+        "vblendvpd %%ymm0, %%ymm3, %%ymm1, %%ymm0\n\t"
+        "vpermq $0x4e, %%ymm2, %%ymm1\n\t"
+        "vpcmpgtq %%ymm1, %%ymm2, %%ymm3\n\t"
+        "vpxor %%ymm14, %%ymm3, %%ymm3\n\t"
+        "vblendvpd %%ymm3, %%ymm1, %%ymm2, %%ymm2\n\t"
+        "vpshufd $0x4e, %%ymm2, %%ymm1\n\t"
+        "vpcmpgtq %%ymm1, %%ymm2, %%ymm3\n\t"
+        "vpxor %%ymm15, %%ymm3, %%ymm3\n\t"
+        "vblendvpd %%ymm3, %%ymm1, %%ymm2, %%ymm2\n\t"
+        "vpermq $0x4e, %%ymm0, %%ymm1\n\t"
+        "vpcmpgtq %%ymm1, %%ymm0, %%ymm3\n\t"
+        "vpxor %%ymm14, %%ymm3, %%ymm3\n\t"
+        "vblendvpd %%ymm3, %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpshufd $0x4e, %%ymm0, %%ymm1\n\t"
+        "vpcmpgtq %%ymm1, %%ymm0, %%ymm3\n\t"
+        "vpxor %%ymm15, %%ymm3, %%ymm3\n\t"
+        "vblendvpd %%ymm3, %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpermq $0x1b, %%ymm2, %%ymm2\n\t"  // Bitonic merges: runs of 16
+        "vpermq $0x1b, %%ymm0, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm5, %%ymm1\n\t"
+        "vblendvpd %%ymm1, %%ymm0, %%ymm5, %%ymm3\n\t"
+        "vblendvpd %%ymm1, %%ymm5, %%ymm0, %%ymm1\n\t"
+        "vpcmpgtq %%ymm2, %%ymm4, %%ymm0\n\t"
+        "vblendvpd %%ymm0, %%ymm2, %%ymm4, %%ymm5\n\t"
+        "vblendvpd %%ymm0, %%ymm4, %%ymm2, %%ymm0\n\t"
+        "vpcmpgtq %%ymm5, %%ymm3, %%ymm2\n\t"
+        "vblendvpd %%ymm2, %%ymm5, %%ymm3, %%ymm4\n\t"
+        "vblendvpd %%ymm2, %%ymm3, %%ymm5, %%ymm2\n\t"
+        "vpermq $0x4e, %%ymm4, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm4, %%ymm5\n\t"
+        "vpxor %%ymm14, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpshufd $0x4e, %%ymm4, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm4, %%ymm5\n\t"
+        "vpxor %%ymm15, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpermq $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm2, %%ymm5\n\t"
+        "vpxor %%ymm14, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpshufd $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm2, %%ymm5\n\t"
+        "vpxor %%ymm15, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpcmpgtq %%ymm0, %%ymm1, %%ymm3\n\t"
+        "vblendvpd %%ymm3, %%ymm0, %%ymm1, %%ymm5\n\t"
+        "vblendvpd %%ymm3, %%ymm1, %%ymm0, %%ymm3\n\t"
+        "vpermq $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm5, %%ymm1\n\t"
+        "vpxor %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vblendvpd %%ymm1, %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpshufd $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm5, %%ymm1\n\t"
+        "vpxor %%ymm15, %%ymm1, %%ymm1\n\t"
+        "vblendvpd %%ymm1, %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpermq $0x4e, %%ymm3, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm3, %%ymm1\n\t"
+        "vpxor %%ymm14, %%ymm1, %%ymm1\n\t"
+        "vblendvpd %%ymm1, %%ymm0, %%ymm3, %%ymm3\n\t"
+        "vpshufd $0x4e, %%ymm3, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm3, %%ymm1\n\t"
+        "vpxor %%ymm15, %%ymm1, %%ymm1\n\t"
+        "vblendvpd %%ymm1, %%ymm0, %%ymm3, %%ymm3\n\t"
+        "vmovdqu %%ymm4, 0(%0)\n\t"         // Store the sorted block
+        "vmovdqu %%ymm2, 32(%0)\n\t"
+        "vmovdqu %%ymm5, 64(%0)\n\t"
+        "vmovdqu %%ymm3, 96(%0)\n\t"
+        "addq $128, %0\n\t"
+        "decq %1\n\t"
+        "jnz 1b\n\t"
+        "2:\n\t"
+        "vzeroupper\n\t"
+        : "+r"(keys), "+r"(blocks)
+        : "r"(sort_keep_max_64)
+        : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9",
+          "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory", "cc"
+    );
+}
+
+void sort_blocks_i32_avx2(int32_t* keys, size_t blocks) {
+    __asm__ volatile (
+        "vmovdqa (%2), %%ymm15\n\t"         // Lane reversal
+        "testq %1, %1\n\t"
+        "jz 2f\n\t"
+        "1:\n\t"                            // loop: one block
+        "vmovdqu 0(%0), %%ymm0\n\t"         // Load one block
+        "vmovdqu 32(%0), %%ymm1\n\t"
+        "vmovdqu 64(%0), %%ymm2\n\t"
+        "vmovdqu 96(%0), %%ymm3\n\t"
+        "vmovdqu 128(%0), %%ymm4\n\t"
+        "vmovdqu 160(%0), %%ymm5\n\t"
+        "vmovdqu 192(%0), %%ymm6\n\t"
+        "vmovdqu 224(%0), %%ymm7\n\t"
+        "vpminsd %%ymm2, %%ymm0, %%ymm8\n\t" // Sort each column
+        "vpmaxsd %%ymm2, %%ymm0, %%ymm0\n\t"
+        "vpminsd %%ymm3, %%ymm1, %%ymm2\n\t"
+        "vpmaxsd %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpminsd %%ymm6, %%ymm4, %%ymm3\n\t"
+        "vpmaxsd %%ymm6, %%ymm4, %%ymm4\n\t"
+        "vpminsd %%ymm7, %%ymm5, %%ymm6\n\t"
+        "vpmaxsd %%ymm7, %%ymm5, %%ymm5\n\t"
+        "vpminsd %%ymm3, %%ymm8, %%ymm7\n\t"
+        "vpmaxsd %%ymm3, %%ymm8, %%ymm8\n\t"
+        "vpminsd %%ymm6, %%ymm2, %%ymm3\n\t"
+        "vpmaxsd %%ymm6, %%ymm2, %%ymm2\n\t"
+        "vpminsd %%ymm4, %%ymm0, %%ymm6\n\t"
+        "vpmaxsd %%ymm4, %%ymm0, %%ymm0\n\t"
+        "vpminsd %%ymm5, %%ymm1, %%ymm4\n\t"
+        "vpmaxsd %%ymm5, %%ymm1, %%ymm1\n\t"
+        "vpminsd %%ymm3, %%ymm7, %%ymm5\n\t"
+        "vpmaxsd %%ymm3, %%ymm7, %%ymm7\n\t"
+        "vpminsd %%ymm4, %%ymm6, %%ymm3\n\t"
+        "vpmaxsd %%ymm4, %%ymm6, %%ymm6\n\t"
+        "vpminsd %%ymm2, %%ymm8, %%ymm4\n\t"
+        "vpmaxsd %%ymm2, %%ymm8, %%ymm8\n\t"
+        "vpminsd %%ymm1, %%ymm0, %%ymm2\n\t"
+        "vpmaxsd %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpminsd %%ymm4, %%ymm3, %%ymm1\n\t"
+        "vpmaxsd %%ymm4, %%ymm3, %%ymm3\n\t"
+        "vpminsd %%ymm8, %%ymm6, %%ymm4\n\t"
+        "vpmaxsd %%ymm8, %%ymm6, %%ymm6\n\t"
+        "vpminsd %%ymm3, %%ymm7, %%ymm8\n\t"
+        "vpmaxsd %%ymm3, %%ymm7, %%ymm7\n\t"
+        "vpminsd %%ymm2, %%ymm4, %%ymm3\n\t"
+        "vpmaxsd %%ymm2, %%ymm4, %%ymm4\n\t"
+        "vpminsd %%ymm1, %%ymm8, %%ymm2\n\t"
+        "vpmaxsd %%ymm1, %%ymm8, %%ymm8\n\t"
+        "vpminsd %%ymm7, %%ymm3, %%ymm1\n\t"
+        "vpmaxsd %%ymm7, %%ymm3, %%ymm3\n\t"
+        "vpminsd %%ymm4, %%ymm6, %%ymm7\n\t"
+        "vpmaxsd %%ymm4, %%ymm6, %%ymm6\n\t"
+        "vunpcklps %%ymm2, %%ymm5, %%ymm4\n\t" // Transpose: columns become runs
+        "vunpckhps %%ymm2, %%ymm5, %%ymm2\n\t"
+        "vunpcklps %%ymm1, %%ymm8, %%ymm5\n\t"
+        "vunpckhps %%ymm1, %%ymm8, %%ymm1\n\t"
+        "vunpcklps %%ymm7, %%ymm3, %%ymm8\n\t"
+        "vunpckhps %%ymm7, %%ymm3, %%ymm7\n\t"
+        "vunpcklps %%ymm0, %%ymm6, %%ymm3\n\t"
+        "vunpckhps %%ymm0, %%ymm6, %%ymm0\n\t"
+        "vshufps $0x44, %%ymm5, %%ymm4, %%ymm6\n\t"
+        "vshufps $0xee, %%ymm5, %%ymm4, %%ymm5\n\t"
+        "vshufps $0x44, %%ymm1, %%ymm2, %%ymm4\n\t"
+        "vshufps $0xee, %%ymm1, %%ymm2, %%ymm1\n\t"
+        "vshufps $0x44, %%ymm3, %%ymm8, %%ymm2\n\t"
+        "vshufps $0xee, %%ymm3, %%ymm8, %%ymm3\n\t"
+        "vshufps $0x44, %%ymm0, %%ymm7, %%ymm8\n\t"
+        "vshufps $0xee, %%ymm0, %%ymm7, %%ymm0\n\t"
+        "vperm2f128 $0x20, %%ymm2, %%ymm6, %%ymm7\n\t"
+        "vperm2f128 $0x31, %%ymm2, %%ymm6, %%ymm2\n\t"
+        "vperm2f128 $0x20, %%ymm3, %%ymm5, %%ymm6\n\t"
+        "vperm2f128 $0x31, %%ymm3, %%ymm5, %%ymm3\n\t"
+        "vperm2f128 $0x20, %%ymm8, %%ymm4, %%ymm5\n\t"
+        "vperm2f128 $0x31, %%ymm8, %%ymm4, %%ymm8\n\t"
+        "vperm2f128 $0x20, %%ymm0, %%ymm1, %%ymm4\n\t"
+        "vperm2f128 $0x31, %%ymm0, %%ymm1, %%ymm0\n\t"
+        "vpermd %%ymm6, %%ymm15, %%ymm6\n\t" // Bitonic merges: runs of 16
+        "vpminsd %%ymm6, %%ymm7, %%ymm1\n\t"
+        "vpmaxsd %%ymm6, %%ymm7, %%ymm7\n\t"
+        "vpermq $0x4e, %%ymm1, %%ymm6\n\t"
+        "vpminsd %%ymm6, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm6, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xf0, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpshufd $0x4e, %%ymm1, %%ymm6\n\t"
+        "vpminsd %%ymm6, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm6, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xcc, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpshufd $0xb1, %%ymm1, %%ymm6\n\t"
+        "vpminsd %%ymm6, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm6, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xaa, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpermq $0x4e, %%ymm7, %%ymm6\n\t"
+        "vpminsd %%ymm6, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm6, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xf0, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpshufd $0x4e, %%ymm7, %%ymm6\n\t"
+        "vpminsd %%ymm6, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm6, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xcc, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpshufd $0xb1, %%ymm7, %%ymm6\n\t"
+        "vpminsd %%ymm6, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm6, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xaa, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpermd %%ymm4, %%ymm15, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm5, %%ymm6\n\t"
+        "vpmaxsd %%ymm4, %%ymm5, %%ymm5\n\t"
+        "vpermq $0x4e, %%ymm6, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xf0, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpshufd $0x4e, %%ymm6, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xcc, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpshufd $0xb1, %%ymm6, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xaa, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpermq $0x4e, %%ymm5, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xf0, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpshufd $0x4e, %%ymm5, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xcc, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpshufd $0xb1, %%ymm5, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xaa, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpermd %%ymm3, %%ymm15, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm4\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpermq $0x4e, %%ymm4, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xf0, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpshufd $0x4e, %%ymm4, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xcc, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpshufd $0xb1, %%ymm4, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xaa, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpermq $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm9\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xf0, %%ymm2, %%ymm9, %%ymm2\n\t"
+        "vpshufd $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm9\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xcc, %%ymm2, %%ymm9, %%ymm2\n\t"
+        "vpshufd $0xb1, %%ymm2, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm9\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xaa, %%ymm2, %%ymm9, %%ymm2\n\t"
+        "vpermd %%ymm0, %%ymm15, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm8, %%ymm3\n\t"
+        "vpmaxsd %%ymm0, %%ymm8, %%ymm8\n\t"
+        "vpermq $0x4e, %%ymm3, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xf0, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpshufd $0x4e, %%ymm3, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xcc, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpshufd $0xb1, %%ymm3, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xaa, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpermq $0x4e, %%ymm8, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xf0, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpshufd $0x4e, %%ymm8, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xcc, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpshufd $0xb1, %%ymm8, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xaa, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpermd %%ymm6, %%ymm15, %%ymm6\n\t" // Bitonic merges: runs of 32
+        "vpermd %%ymm5, %%ymm15, %%ymm5\n\t"
+        "vpminsd %%ymm5, %%ymm1, %%ymm0\n\t"
+        "vpmaxsd %%ymm5, %%ymm1, %%ymm1\n\t"
+        "vpminsd %%ymm6, %%ymm7, %%ymm5\n\t"
+        "vpmaxsd %%ymm6, %%ymm7, %%ymm7\n\t"
+        "vpminsd %%ymm5, %%ymm0, %%ymm6\n\t"
+        "vpmaxsd %%ymm5, %%ymm0, %%ymm0\n\t"
+        "vpermq $0x4e, %%ymm6, %%ymm5\n\t"
+        "vpminsd %%ymm5, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm5, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xf0, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpshufd $0x4e, %%ymm6, %%ymm5\n\t"
+        "vpminsd %%ymm5, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm5, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xcc, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpshufd $0xb1, %%ymm6, %%ymm5\n\t"
+        "vpminsd %%ymm5, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm5, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xaa, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpermq $0x4e, %%ymm0, %%ymm5\n\t"
+        "vpminsd %%ymm5, %%ymm0, %%ymm9\n\t"
+        "vpmaxsd %%ymm5, %%ymm0, %%ymm0\n\t"
+        "vpblendd $0xf0, %%ymm0, %%ymm9, %%ymm0\n\t"
+        "vpshufd $0x4e, %%ymm0, %%ymm5\n\t"
+        "vpminsd %%ymm5, %%ymm0, %%ymm9\n\t"
+        "vpmaxsd %%ymm5, %%ymm0, %%ymm0\n\t"
+        "vpblendd $0xcc, %%ymm0, %%ymm9, %%ymm0\n\t"
+        "vpshufd $0xb1, %%ymm0, %%ymm5\n\t"
+        "vpminsd %%ymm5, %%ymm0, %%ymm9\n\t"
+        "vpmaxsd %%ymm5, %%ymm0, %%ymm0\n\t"
+        "vpblendd $0xaa, %%ymm0, %%ymm9, %%ymm0\n\t"
+        "vpminsd %%ymm7, %%ymm1, %%ymm5\n\t"
+        "vpmaxsd %%ymm7, %%ymm1, %%ymm1\n\t"
+        "vpermq $0x4e, %%ymm5, %%ymm7\n\t"
+        "vpminsd %%ymm7, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm7, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xf0, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpshufd $0x4e, %%ymm5, %%ymm7\n\t"
+        "vpminsd %%ymm7, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm7, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xcc, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpshufd $0xb1, %%ymm5, %%ymm7\n\t"
+        "vpminsd %%ymm7, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm7, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xaa, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpermq $0x4e, %%ymm1, %%ymm7\n\t"
+        "vpminsd %%ymm7, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm7, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xf0, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpshufd $0x4e, %%ymm1, %%ymm7\n\t"
+        "vpminsd %%ymm7, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm7, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xcc, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpshufd $0xb1, %%ymm1, %%ymm7\n\t"
+        "vpminsd %%ymm7, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm7, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xaa, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpermd %%ymm3, %%ymm15, %%ymm3\n\t"
+        "vpermd %%ymm8, %%ymm15, %%ymm8\n\t"
+        "vpminsd %%ymm8, %%ymm4, %%ymm7\n\t"
+        "vpmaxsd %%ymm8, %%ymm4, %%ymm4\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm8\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpminsd %%ymm8, %%ymm7, %%ymm3\n\t"
+        "vpmaxsd %%ymm8, %%ymm7, %%ymm7\n\t"
+        "vpermq $0x4e, %%ymm3, %%ymm8\n\t"
+        "vpminsd %%ymm8, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm8, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xf0, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpshufd $0x4e, %%ymm3, %%ymm8\n\t"
+        "vpminsd %%ymm8, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm8, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xcc, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpshufd $0xb1, %%ymm3, %%ymm8\n\t"
+        "vpminsd %%ymm8, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm8, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xaa, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpermq $0x4e, %%ymm7, %%ymm8\n\t"
+        "vpminsd %%ymm8, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm8, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xf0, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpshufd $0x4e, %%ymm7, %%ymm8\n\t"
+        "vpminsd %%ymm8, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm8, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xcc, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpshufd $0xb1, %%ymm7, %%ymm8\n\t"
+        "vpminsd %%ymm8, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm8, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xaa, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpminsd %%ymm2, %%ymm4, %%ymm8\n\t"
+        "vpmaxsd %%ymm2, %%ymm4, %%ymm4\n\t"
+        "vpermq $0x4e, %%ymm8, %%ymm2\n\t"
+        "vpminsd %%ymm2, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm2, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xf0, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpshufd $0x4e, %%ymm8, %%ymm2\n\t"
+        "vpminsd %%ymm2, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm2, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xcc, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpshufd $0xb1, %%ymm8, %%ymm2\n\t"
+        "vpminsd %%ymm2, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm2, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xaa, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpermq $0x4e, %%ymm4, %%ymm2\n\t"
+        "vpminsd %%ymm2, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm2, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xf0, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpshufd $0x4e, %%ymm4, %%ymm2\n\t"
+        "vpminsd %%ymm2, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm2, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xcc, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpshufd $0xb1, %%ymm4, %%ymm2\n\t"
+        "vpminsd %%ymm2, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm2, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xaa, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpermd %%ymm3, %%ymm15, %%ymm3\n\t" // Bitonic merges: runs of 64
+        "vpermd %%ymm7, %%ymm15, %%ymm7\n\t"
+        "vpermd %%ymm8, %%ymm15, %%ymm8\n\t"
+        "vpermd %%ymm4, %%ymm15, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm6, %%ymm2\n\t"
+        "vpmaxsd %%ymm4, %%ymm6, %%ymm6\n\t"
+        "vpminsd %%ymm8, %%ymm0, %%ymm4\n\t"
+        "vpmaxsd %%ymm8, %%ymm0, %%ymm0\n\t"
+        "vpminsd %%ymm7, %%ymm5, %%ymm8\n\t"
+        "vpmaxsd %%ymm7, %%ymm5, %%ymm5\n\t"
+        "vpminsd %%ymm3, %%ymm1, %%ymm7\n\t"
+        "vpmaxsd %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpminsd %%ymm8, %%ymm2, %%ymm3\n\t"
+        "vpmaxsd %%ymm8, %%ymm2, %%ymm2\n\t"
+        "vpminsd %%ymm7, %%ymm4, %%ymm8\n\t"
+        "vpmaxsd %%ymm7, %%ymm4, %%ymm4\n\t"
+        "vpminsd %%ymm8, %%ymm3, %%ymm7\n\t"
+        "vpmaxsd %%ymm8, %%ymm3, %%ymm3\n\t"
+        "vpminsd %%ymm4, %%ymm2, %%ymm8\n\t"
+        "vpmaxsd %%ymm4, %%ymm2, %%ymm2\n\t"
+        "vpermq $0x4e, %%ymm7, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xf0, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpshufd $0x4e, %%ymm7, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xcc, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpshufd $0xb1, %%ymm7, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm7, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm7, %%ymm7\n\t"
+        "vpblendd $0xaa, %%ymm7, %%ymm9, %%ymm7\n\t"
+        "vpermq $0x4e, %%ymm3, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xf0, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpshufd $0x4e, %%ymm3, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xcc, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpshufd $0xb1, %%ymm3, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm3, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xaa, %%ymm3, %%ymm9, %%ymm3\n\t"
+        "vpermq $0x4e, %%ymm8, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xf0, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpshufd $0x4e, %%ymm8, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xcc, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpshufd $0xb1, %%ymm8, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm8, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm8, %%ymm8\n\t"
+        "vpblendd $0xaa, %%ymm8, %%ymm9, %%ymm8\n\t"
+        "vpermq $0x4e, %%ymm2, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm2, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xf0, %%ymm2, %%ymm9, %%ymm2\n\t"
+        "vpshufd $0x4e, %%ymm2, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm2, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xcc, %%ymm2, %%ymm9, %%ymm2\n\t"
+        "vpshufd $0xb1, %%ymm2, %%ymm4\n\t"
+        "vpminsd %%ymm4, %%ymm2, %%ymm9\n\t"
+        "vpmaxsd %%ymm4, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xaa, %%ymm2, %%ymm9, %%ymm2\n\t"
+        "vpminsd %%ymm5, %%ymm6, %%ymm4\n\t"
+        "vpmaxsd %%ymm5, %%ymm6, %%ymm6\n\t"
+        "vpminsd %%ymm1, %%ymm0, %%ymm5\n\t"
+        "vpmaxsd %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpminsd %%ymm5, %%ymm4, %%ymm1\n\t"
+        "vpmaxsd %%ymm5, %%ymm4, %%ymm4\n\t"
+        "vpminsd %%ymm0, %%ymm6, %%ymm5\n\t"
+        "vpmaxsd %%ymm0, %%ymm6, %%ymm6\n\t"
+        "vpermq $0x4e, %%ymm1, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xf0, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpshufd $0x4e, %%ymm1, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xcc, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpshufd $0xb1, %%ymm1, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm1, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm1, %%ymm1\n\t"
+        "vpblendd $0xaa, %%ymm1, %%ymm9, %%ymm1\n\t"
+        "vpermq $0x4e, %%ymm4, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xf0, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpshufd $0x4e, %%ymm4, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xcc, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpshufd $0xb1, %%ymm4, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm4, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xaa, %%ymm4, %%ymm9, %%ymm4\n\t"
+        "vpermq $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xf0, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpshufd $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xcc, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpshufd $0xb1, %%ymm5, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm5, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpblendd $0xaa, %%ymm5, %%ymm9, %%ymm5\n\t"
+        "vpermq $0x4e, %%ymm6, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xf0, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpshufd $0x4e, %%ymm6, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xcc, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vpshufd $0xb1, %%ymm6, %%ymm0\n\t"
+        "vpminsd %%ymm0, %%ymm6, %%ymm9\n\t"
+        "vpmaxsd %%ymm0, %%ymm6, %%ymm6\n\t"
+        "vpblendd $0xaa, %%ymm6, %%ymm9, %%ymm6\n\t"
+        "vmovdqu %%ymm7, 0(%0)\n\t"         // Store the sorted block
+        "vmovdqu %%ymm3, 32(%0)\n\t"
+        "vmovdqu %%ymm8, 64(%0)\n\t"
+        "vmovdqu %%ymm2, 96(%0)\n\t"
+        "vmovdqu %%ymm1, 128(%0)\n\t"
+        "vmovdqu %%ymm4, 160(%0)\n\t"
+        "vmovdqu %%ymm5, 192(%0)\n\t"
+        "vmovdqu %%ymm6, 224(%0)\n\t"
+        "addq $256, %0\n\t"
+        "decq %1\n\t"
+        "jnz 1b\n\t"
+        "2:\n\t"
+        "vzeroupper\n\t"
+        : "+r"(keys), "+r"(blocks)
+        : "r"(sort_reverse_32)
+        : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9",
+          "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory", "cc"
+    );
+}
+
+void sort_merge_i64_avx2(const int64_t* a, const int64_t* a_end, const int64_t* b,
+                         const int64_t* b_end, int64_t* out) {
+    __asm__ volatile (
+        "vmovdqa (%5), %%ymm14\n\t"         // Lanes that keep the larger
+        "vmovdqa 32(%5), %%ymm15\n\t"
+        "vmovdqu 0(%0), %%ymm0\n\t"         // Carry: the first vectors of a
+        "vmovdqu 32(%0), %%ymm1\n\t"
+        "addq $64, %0\n\t"
+        "vmovdqu 0(%2), %%ymm2\n\t"
+        "vmovdqu 32(%2), %%ymm3\n\t"
+        "addq $64, %2\n\t"
+        "1:\n\t"                            // loop: 2 vectors out
+        "vpermq $0x1b, %%ymm2, %%ymm2\n\t"  // Merge the carry with the next vectors
+        "vpermq $0x1b, %%ymm3, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm0, %%ymm4\n\t"
+        "vblendvpd %%ymm4, %%ymm3, %%ymm0, %%ymm5\n\t"
+        "vblendvpd %%ymm4, %%ymm0, %%ymm3, %%ymm4\n\t"
+        "vpcmpgtq %%ymm2, %%ymm1, %%ymm0\n\t"
+        "vblendvpd %%ymm0, %%ymm2, %%ymm1, %%ymm3\n\t"
+        "vblendvpd %%ymm0, %%ymm1, %%ymm2, %%ymm0\n\t"
+        "vpcmpgtq %%ymm3, %%ymm5, %%ymm1\n\t"
+        "vblendvpd %%ymm1, %%ymm3, %%ymm5, %%ymm2\n\t"
+        "vblendvpd %%ymm1, %%ymm5, %%ymm3, %%ymm1\n\t"
+        "vpermq $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm2, %%ymm5\n\t"
+        "vpxor %%ymm14, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpshufd $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm2, %%ymm5\n\t"
+        "vpxor %%ymm15, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpermq $0x4e, %%ymm1, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm1, %%ymm5\n\t"
+        "vpxor %%ymm14, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpshufd $0x4e, %%ymm1, %%ymm3\n\t"
+        "vpcmpgtq %%ymm3, %%ymm1, %%ymm5\n\t"
+        "vpxor %%ymm15, %%ymm5, %%ymm5\n\t"
+        "vblendvpd %%ymm5, %%ymm3, %%ymm1, %%ymm1\n\t"
+        "vpcmpgtq %%ymm0, %%ymm4, %%ymm3\n\t"
+        "vblendvpd %%ymm3, %%ymm0, %%ymm4, %%ymm5\n\t"
+        "vblendvpd %%ymm3, %%ymm4, %%ymm0, %%ymm3\n\t"
+        "vpermq $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm5, %%ymm4\n\t"
+        "vpxor %%ymm14, %%ymm4, %%ymm4\n\t"
+        "vblendvpd %%ymm4, %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpshufd $0x4e, %%ymm5, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm5, %%ymm4\n\t"
+        "vpxor %%ymm15, %%ymm4, %%ymm4\n\t"
+        "vblendvpd %%ymm4, %%ymm0, %%ymm5, %%ymm5\n\t"
+        "vpermq $0x4e, %%ymm3, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm3, %%ymm4\n\t"
+        "vpxor %%ymm14, %%ymm4, %%ymm4\n\t"
+        "vblendvpd %%ymm4, %%ymm0, %%ymm3, %%ymm3\n\t"
+        "vpshufd $0x4e, %%ymm3, %%ymm0\n\t"
+        "vpcmpgtq %%ymm0, %%ymm3, %%ymm4\n\t"
+        "vpxor %%ymm15, %%ymm4, %%ymm4\n\t"
+        "vblendvpd %%ymm4, %%ymm0, %%ymm3, %%ymm3\n\t"
+        "vmovdqu %%ymm2, 0(%4)\n\t"         // Emit the lower half
+        "vmovdqu %%ymm1, 32(%4)\n\t"
+        "vmovdqa %%ymm5, %%ymm0\n\t"        // Upper half carries over
+        "vmovdqa %%ymm3, %%ymm1\n\t"
+        "addq $64, %4\n\t"
+        "movq (%0), %%rax\n\t"              // Next vector from the smaller head,
+        "movq (%2), %%rdx\n\t"              // without a branch to mispredict
+        "xorl %%r8d, %%r8d\n\t"
+        "cmpq %%rax, %%rdx\n\t"
+        "setl %%r8b\n\t"                    // b's head is smaller
+        "negl %%r8d\n\t"
+        "cmpq %1, %0\n\t"
+        "sbbl %%r9d, %%r9d\n\t"             // -1 while a lasts
+        "notl %%r9d\n\t"
+        "orl %%r9d, %%r8d\n\t"              // ... or a is used up
+        "cmpq %3, %2\n\t"
+        "sbbl %%r9d, %%r9d\n\t"             // -1 while b lasts
+        "andl %%r9d, %%r8d\n\t"
+        "cmpq %1, %0\n\t"
+        "jb 2f\n\t"
+        "cmpq %3, %2\n\t"
+        "jae 3f\n\t"                        // Both used up
+        "2:\n\t"
+        "movq %0, %%r9\n\t"
+        "testl %%r8d, %%r8d\n\t"
+        "cmovnzq %2, %%r9\n\t"
+        "vmovdqu 0(%%r9), %%ymm2\n\t"
+        "vmovdqu 32(%%r9), %%ymm3\n\t"
+        "andl $64, %%r8d\n\t"
+        "addq %%r8, %2\n\t"
+        "xorl $64, %%r8d\n\t"
+        "addq %%r8, %0\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"
+        "vmovdqu %%ymm0, 0(%4)\n\t"         // Flush the carry
+        "vmovdqu %%ymm1, 32(%4)\n\t"
+        "vzeroupper\n\t"
+        : "+r"(a), "+r"(a_end), "+r"(b), "+r"(b_end), "+r"(out)
+        : "r"(sort_keep_max_64)
+        : "rax", "rdx", "r8", "r9", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory", "cc"
+    );
+}
+
+void sort_merge_i32_avx2(const int32_t* a, const int32_t* a_end, const int32_t* b,
+                         const int32_t* b_end, int32_t* out) {
+    __asm__ volatile (
+        "vmovdqa (%5), %%ymm15\n\t"         // Lane reversal
+        "vmovdqu 0(%0), %%ymm0\n\t"         // Carry: the first vectors of a
+        "vmovdqu 32(%0), %%ymm1\n\t"
+        "addq $64, %0\n\t"
+        "vmovdqu 0(%2), %%ymm2\n\t"
+        "vmovdqu 32(%2), %%ymm3\n\t"
+        "addq $64, %2\n\t"
+        "1:\n\t"                            // loop: 2 vectors out
+        "vpermd %%ymm2, %%ymm15, %%ymm2\n\t" // Merge the carry with the next vectors
+        "vpermd %%ymm3, %%ymm15, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm0, %%ymm4\n\t"
+        "vpmaxsd %%ymm3, %%ymm0, %%ymm0\n\t"
+        "vpminsd %%ymm2, %%ymm1, %%ymm3\n\t"
+        "vpmaxsd %%ymm2, %%ymm1, %%ymm1\n\t"
+        "vpminsd %%ymm3, %%ymm4, %%ymm2\n\t"
+        "vpmaxsd %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpermq $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm5\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xf0, %%ymm2, %%ymm5, %%ymm2\n\t"
+        "vpshufd $0x4e, %%ymm2, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm5\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xcc, %%ymm2, %%ymm5, %%ymm2\n\t"
+        "vpshufd $0xb1, %%ymm2, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm2, %%ymm5\n\t"
+        "vpmaxsd %%ymm3, %%ymm2, %%ymm2\n\t"
+        "vpblendd $0xaa, %%ymm2, %%ymm5, %%ymm2\n\t"
+        "vpermq $0x4e, %%ymm4, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm4, %%ymm5\n\t"
+        "vpmaxsd %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xf0, %%ymm4, %%ymm5, %%ymm4\n\t"
+        "vpshufd $0x4e, %%ymm4, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm4, %%ymm5\n\t"
+        "vpmaxsd %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xcc, %%ymm4, %%ymm5, %%ymm4\n\t"
+        "vpshufd $0xb1, %%ymm4, %%ymm3\n\t"
+        "vpminsd %%ymm3, %%ymm4, %%ymm5\n\t"
+        "vpmaxsd %%ymm3, %%ymm4, %%ymm4\n\t"
+        "vpblendd $0xaa, %%ymm4, %%ymm5, %%ymm4\n\t"
+        "vpminsd %%ymm1, %%ymm0, %%ymm3\n\t"
+        "vpmaxsd %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpermq $0x4e, %%ymm3, %%ymm1\n\t"
+        "vpminsd %%ymm1, %%ymm3, %%ymm5\n\t"
+        "vpmaxsd %%ymm1, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xf0, %%ymm3, %%ymm5, %%ymm3\n\t"
+        "vpshufd $0x4e, %%ymm3, %%ymm1\n\t"
+        "vpminsd %%ymm1, %%ymm3, %%ymm5\n\t"
+        "vpmaxsd %%ymm1, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xcc, %%ymm3, %%ymm5, %%ymm3\n\t"
+        "vpshufd $0xb1, %%ymm3, %%ymm1\n\t"
+        "vpminsd %%ymm1, %%ymm3, %%ymm5\n\t"
+        "vpmaxsd %%ymm1, %%ymm3, %%ymm3\n\t"
+        "vpblendd $0xaa, %%ymm3, %%ymm5, %%ymm3\n\t"
+        "vpermq $0x4e, %%ymm0, %%ymm1\n\t"
+        "vpminsd %%ymm1, %%ymm0, %%ymm5\n\t"
+        "vpmaxsd %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpblendd $0xf0, %%ymm0, %%ymm5, %%ymm0\n\t"
+        "vpshufd $0x4e, %%ymm0, %%ymm1\n\t"
+        "vpminsd %%ymm1, %%ymm0, %%ymm5\n\t"
+        "vpmaxsd %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpblendd $0xcc, %%ymm0, %%ymm5, %%ymm0\n\t"
+        "vpshufd $0xb1, %%ymm0, %%ymm1\n\t"
+        "vpminsd %%ymm1, %%ymm0, %%ymm5\n\t"
+        "vpmaxsd %%ymm1, %%ymm0, %%ymm0\n\t"
+        "vpblendd $0xaa, %%ymm0, %%ymm5, %%ymm0\n\t"
+        "vmovdqu %%ymm2, 0(%4)\n\t"         // Emit the lower half
+        "vmovdqu %%ymm4, 32(%4)\n\t"
+        "vmovdqa %%ymm0, %%ymm1\n\t"        // Upper half carries over
+        "vmovdqa %%ymm3, %%ymm0\n\t"
+        "addq $64, %4\n\t"
+        "movl (%0), %%eax\n\t"              // Next vector from the smaller head,
+        "movl (%2), %%edx\n\t"              // without a branch to mispredict
+        "xorl %%r8d, %%r8d\n\t"
+        "cmpl %%eax, %%edx\n\t"
+        "setl %%r8b\n\t"                    // b's head is smaller
+        "negl %%r8d\n\t"
+        "cmpq %1, %0\n\t"
+        "sbbl %%r9d, %%r9d\n\t"             // -1 while a lasts
+        "notl %%r9d\n\t"
+        "orl %%r9d, %%r8d\n\t"              // ... or a is used up
+        "cmpq %3, %2\n\t"
+        "sbbl %%r9d, %%r9d\n\t"             // -1 while b lasts
+        "andl %%r9d, %%r8d\n\t"
+        "cmpq %1, %0\n\t"
+        "jb 2f\n\t"
+        "cmpq %3, %2\n\t"
+        "jae 3f\n\t"                        // Both used up
+        "2:\n\t"
+        "movq %0, %%r9\n\t"
+        "testl %%r8d, %%r8d\n\t"
+        "cmovnzq %2, %%r9\n\t"
+        "vmovdqu 0(%%r9), %%ymm2\n\t"
+        "vmovdqu 32(%%r9), %%ymm3\n\t"
+        "andl $64, %%r8d\n\t"
+        "addq %%r8, %2\n\t"
+        "xorl $64, %%r8d\n\t"
+        "addq %%r8, %0\n\t"
+        "jmp 1b\n\t"
+        "3:\n\t"
+        "vmovdqu %%ymm0, 0(%4)\n\t"         // Flush the carry
+        "vmovdqu %%ymm1, 32(%4)\n\t"
+        "vzeroupper\n\t"
+        : "+r"(a), "+r"(a_end), "+r"(b), "+r"(b_end), "+r"(out)
+        : "r"(sort_reverse_32)
+        : "rax", "rdx", "r8", "r9", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+          "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory", "cc"
+    );
+}
+
+// Below AVX2: insertion sort within each block and a plain two-way merge
+#define SORT_SCALAR_DEFINE(type, T, BLOCK)                                                     \
+void sort_blocks_##type##_scalar(T* keys, size_t blocks) {                                    \
+    for (size_t k = 0; k < blocks; k++, keys += BLOCK) {                                      \
+        for (size_t i = 1; i < BLOCK; i++) {                                                  \
+            T key = keys[i];                                                                  \
+            size_t j = i;                                                                     \
+            for (; j > 0 && keys[j - 1] > key; j--) keys[j] = keys[j - 1];                    \
+            keys[j] = key;                                                                    \
+        }                                                                                     \
+    }                                                                                         \
+}                                                                                             \
+                                                                                              \
+void sort_merge_##type##_scalar(const T* a, const T* a_end, const T* b, const T* b_end,      \
+                                T* out) {                                                     \
+    while (a < a_end && b < b_end) *out++ = *b < *a ? *b++ : *a++;                            \
+    while (a < a_end) *out++ = *a++;                                                          \
+    while (b < b_end) *out++ = *b++;                                                          \
+}
+
+SORT_SCALAR_DEFINE(i64, int64_t, SORT_BLOCK_I64)
+SORT_SCALAR_DEFINE(i32, int32_t, SORT_BLOCK_I32)
+
+// Below this, padding to a block and the stack copies cost more than the sort
+#define SORT_INSERTION_MAX 16
+
+// Sorts up to SORT_SMALL_MAX_* keys on the stack
+#define SORT_SMALL_DEFINE(type, T, BLOCK, SMALL_MAX, PAD)                                    \
+void sort_small_##type(T* keys, size_t n) {                                                   \
+    T buf[2][SMALL_MAX + 32 / sizeof(T)] __attribute__((aligned(32)));                        \
+    size_t padded = (n + BLOCK - 1) / BLOCK * BLOCK;                                          \
+    T* src = buf[0];                                                                          \
+    T* dst = buf[1];                                                                          \
+                                                                                              \
+    if (n <= SORT_INSERTION_MAX) {                                                            \
+        for (size_t i = 1; i < n; i++) {                                                      \
+            T key = keys[i];                                                                  \
+            size_t j = i;                                                                     \
+            for (; j > 0 && keys[j - 1] > key; j--) keys[j] = keys[j - 1];                    \
+            keys[j] = key;                                                                    \
+        }                                                                                     \
+        return;                                                                               \
+    }                                                                                         \
+    memcpy(src, keys, n * sizeof(T));                                                         \
+    for (size_t i = n; i < padded; i++) src[i] = PAD;                                         \
+    ASSM_DISPATCH(sort_blocks_##type)(src, padded / BLOCK);                                   \
+    for (size_t run = BLOCK; run < padded; run *= 2) {                                        \
+        for (size_t i = 0; i < padded; i += 2 * run) {                                        \
+            if (i + run >= padded) {                                                          \
+                memcpy(dst + i, src + i, (padded - i) * sizeof(T));                           \
+                continue;                                                                     \
+            }                                                                                 \
+            size_t end = padded - i > 2 * run ? i + 2 * run : padded;                         \
+            ASSM_DISPATCH(sort_merge_##type)(src + i, src + i + run, src + i + run,           \
+                                             src + end, dst + i);                             \
+        }                                                                                     \
+        T* t = src;                                                                           \
+        src = dst;                                                                            \
+        dst = t;                                                                              \
+    }                                                                                         \
+    memcpy(keys, src, n * sizeof(T));                                                         \
+}
+
+SORT_SMALL_DEFINE(i64, int64_t, SORT_BLOCK_I64, SORT_SMALL_MAX_I64, INT64_MAX)
+SORT_SMALL_DEFINE(i32, int32_t, SORT_BLOCK_I32, SORT_SMALL_MAX_I32, INT32_MAX)
+
+// Key and payload moves are too few below this for radix passes to pay
+#define SORT_PAYLOAD_INSERTION_MAX 32
+
+#define SORT_INSERTION_PAYLOAD_DEFINE(type, T, P)                                              \
+static void sort_insertion_##type(T* keys, P* payload, size_t n) {                            \
+    for (size_t i = 1; i < n; i++) {                                                          \
+        T key = keys[i];                                                                      \
+        P value = payload[i];                                                                 \
+        size_t j = i;                                                                         \
+        for (; j > 0 && keys[j - 1] > key; j--) {                                             \
+            keys[j] = keys[j - 1];                                                            \
+            payload[j] = payload[j - 1];                                                      \
+        }                                                                                     \
+        keys[j] = key;                                                                        \
+        payload[j] = value;                                                                   \
+    }                                                                                         \
+}
+
+SORT_INSERTION_PAYLOAD_DEFINE(i64, int64_t, uint64_t)
+SORT_INSERTION_PAYLOAD_DEFINE(i32, int32_t, uint32_t)
+
+// One counting-sort pass on digit d from src to dst
+static void radix_pass(const char* src, char* dst, const char* psrc, char* pdst, size_t n, size_t size,
+                       unsigned d, const size_t counts[256], unsigned char* lines) {
+    size_t lanes = 64 / size;
+    int use_lines = n * size >= RADIX_LINES_MIN;
+    struct radix_scatter ctl;
+
+    // With lines, slots count from the 64-byte boundary at or below dst
+    size_t phase = use_lines ? (uintptr_t)dst / size & (lanes - 1) : 0;
+    char* dst_line = (char*)((uintptr_t)dst - phase * size);
+    char* pdst_line = pdst ? (char*)((uintptr_t)pdst - phase * size) : NULL;
+    unsigned top = d + 1 == size ? 0x80 : 0;
+    size_t sum = phase;
+    for (unsigned k = 0; k < 256; k++) {
+        unsigned v = k ^ top;
+        ctl.pos[v] = ctl.start[v] = sum;
+        sum += counts[v];
+    }
+    ctl.payload_stream = (uintptr_t)pdst_line % 16 == 0;
+
+    const int64_t* s64 = (const int64_t*)src;
+    const int32_t* s32 = (const int32_t*)src;
+    if (!use_lines) {
+        if (size == 8 && pdst) radix_scatter_64_payload(s64, n, &ctl, dst, 8 * d, (const uint64_t*)psrc, pdst);
+        else if (size == 8) radix_scatter_64(s64, n, &ctl, dst, 8 * d);
+        else if (pdst) radix_scatter_32_payload(s32, n, &ctl, dst, 8 * d, (const uint32_t*)psrc, pdst);
+        else radix_scatter_32(s32, n, &ctl, dst, 8 * d);
+        return;
+    }
+    if (size == 8 && pdst) {
+        radix_scatter_lines_64_payload(s64, n, &ctl, dst_line, lines, 8 * d, (const uint64_t*)psrc, pdst_line);
+    } else if (size == 8) {
+        radix_scatter_lines_64(s64, n, &ctl, dst_line, lines, 8 * d);
+    } else if (pdst) {
+        radix_scatter_lines_32_payload(s32, n, &ctl, dst_line, lines, 8 * d, (const uint32_t*)psrc, pdst_line);
+    } else {
+        radix_scatter_lines_32(s32, n, &ctl, dst_line, lines, 8 * d);
+    }
+    radix_flush(&ctl, dst_line, lines, size);
+    if (pdst) radix_flush(&ctl, pdst_line, lines + 256 * 64, size);
+}
+
+// counts[d][v]: keys whose digit d is v
+static void radix_count(const char* keys, size_t n, size_t size, size_t counts[8][256]) {
+    unsigned digits = (unsigned)size;
+    uint32_t tables[2][8][256];
+
+    memset(counts, 0, 8 * sizeof(counts[0]));
+    for (size_t start = 0; start < n; start += RADIX_HIST_CHUNK) {
+        size_t chunk = n - start < RADIX_HIST_CHUNK ? n - start : RADIX_HIST_CHUNK;
+        memset(tables, 0, sizeof(tables));
+        if (size == 8) radix_histogram_64((const int64_t*)keys + start, chunk, &tables[0][0][0]);
+        else radix_histogram_32((const int32_t*)keys + start, chunk, &tables[0][0][0]);
+        for (unsigned d = 0; d < digits; d++) {
+            const uint32_t* t0 = &tables[0][0][0] + d * 256;
+            const uint32_t* t1 = &tables[0][0][0] + (digits + d) * 256;
+            for (unsigned v = 0; v < 256; v++) counts[d][v] += (size_t)t0[v] + t1[v];
+        }
+    }
+}
+
+// Every key adds one to every table, so a digit is constant exactly when
+// one bucket holds all n keys
+static int radix_constant(const char* keys, size_t n, size_t size, const size_t counts[8][256], unsigned d) {
+    uint64_t first = size == 8 ? *(const uint64_t*)keys : *(const uint32_t*)keys;
+    return counts[d][(first >> (8 * d)) & 0xff] == n;
+}
+
+// LSD passes over the digits below `digits` from a to b and back; returns
+// 1 if the sorted keys end up in b
+static int radix_lsd(char* a, char* b, char* pa, char* pb, size_t n, size_t size, unsigned digits,
+                     const size_t counts[8][256], unsigned char* lines) {
+    int in_b = 0;
+    for (unsigned d = 0; d < digits; d++) {
+        if (radix_constant(a, n, size, counts, d)) continue;
+        if (in_b) radix_pass(b, a, pb, pa, n, size, d, counts[d], lines);
+        else radix_pass(a, b, pa, pb, n, size, d, counts[d], lines);
+        in_b ^= 1;
+    }
+    return in_b;
+}
+
+// Pulls a range into the caches a line at a time
+static void radix_prefetch(const char* p, size_t bytes) {
+    const char* end = p + bytes;
+
+    __asm__ volatile (
+        "1:\n\t"
+        "cmpq %1, %0\n\t"
+        "jae 2f\n\t"
+        "prefetcht0 (%0)\n\t"
+        "addq $64, %0\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        : "+r"(p)
+        : "r"(end)
+        : "cc"
+    );
+}
+
+// Sorts the n keys at src into dst, using src as scratch
+static void radix_bucket(char* src, char* dst, char* psrc, char* pdst, size_t n, size_t size,
+                         unsigned digits, unsigned char* lines) {
+    size_t counts[8][256];
+
+    if (!pdst && n <= (size == 8 ? SORT_SMALL_MAX_I64 : SORT_SMALL_MAX_I32)) {
+        memcpy(dst, src, n * size);
+        if (size == 8) sort_small_i64((int64_t*)dst, n);
+        else sort_small_i32((int32_t*)dst, n);
+        return;
+    }
+    if (pdst && n <= SORT_PAYLOAD_INSERTION_MAX) {
+        memcpy(dst, src, n * size);
+        memcpy(pdst, psrc, n * size);
+        if (size == 8) sort_insertion_i64((int64_t*)dst, (uint64_t*)pdst, n);
+        else sort_insertion_i32((int32_t*)dst, (uint32_t*)pdst, n);
+        return;
+    }
+    // The first pass scatters into dst: fetch it in order first, rather
+    // than miss on a line at a time in 256 places
+    radix_prefetch(dst, n * size);
+    if (pdst) radix_prefetch(pdst, n * size);
+    radix_count(src, n, size, counts);
+    if (radix_lsd(src, dst, psrc, pdst, n, size, digits, counts, lines)) return;
+    memcpy_asm(dst, src, n * size);
+    if (pdst) memcpy_asm(pdst, psrc, n * size);
+}
+
+// An LSD pass over an array past the caches streams all of it through
+// memory. Large arrays instead take one MSD pass on their highest digit
+// that is not constant into buckets that, for all but skewed keys, fit in
+// L2, and each bucket is then sorted on the digits below in the caches.
+#define RADIX_SPLIT_MIN ((size_t)8 << 20)
+
+int sort_radix(void* keys, void* payload, size_t n, int wide) {
+    size_t size = wide ? 8 : 4;
+    size_t counts[8][256];
+    unsigned char lines[2][256][64] __attribute__((aligned(64)));
+
+    if (n < 2) return 1;
+    radix_count(keys, n, size, counts);
+    unsigned digits = (unsigned)size;
+    while (digits && radix_constant(keys, n, size, counts, digits - 1)) digits--;
+    if (!digits) return 1;
+
+    char* scratch = malloc(n * size);
+    char* pscratch = payload ? malloc(n * size) : NULL;
+    if (!scratch || (payload && !pscratch)) {
+        free(scratch);
+        free(pscratch);
+        return 0;
+    }
+
+    if (n * size < RADIX_SPLIT_MIN || digits == 1) {
+        if (radix_lsd(keys, scratch, payload, pscratch, n, size, digits, counts, &lines[0][0][0])) {
+            memcpy_asm(keys, scratch, n * size);
+            if (payload) memcpy_asm(payload, pscratch, n * size);
+        }
+    } else {
+        unsigned msd = digits - 1;
+        unsigned top = msd + 1 == size ? 0x80 : 0;
+        radix_pass(keys, scratch, payload, pscratch, n, size, msd, counts[msd], &lines[0][0][0]);
+        size_t start = 0;
+        for (unsigned k = 0; k < 256; k++) {
+            size_t count = counts[msd][k ^ top];
+            size_t at = start * size;
+            if (count) radix_bucket(scratch + at, (char*)keys + at, payload ? pscratch + at : NULL,
+                                    payload ? (char*)payload + at : NULL, count, size, msd, &lines[0][0][0]);
+            start += count;
+        }
+    }
+    free(scratch);
+    free(pscratch);
+    return 1;
+}
+
+int array_sort_i64(int64_t* keys, size_t count) {
+    if (count <= SORT_SMALL_MAX_I64) {
+        sort_small_i64(keys, count);
+        return 1;
+    }
+    return sort_radix(keys, NULL, count, 1);
+}
+
+int array_sort_i32(int32_t* keys, size_t count) {
+    if (count <= SORT_SMALL_MAX_I32) {
+        sort_small_i32(keys, count);
+        return 1;
+    }
+    return sort_radix(keys, NULL, count, 0);
+}
+
+int array_sort_i64_payload(int64_t* keys, uint64_t* payload, size_t count) {
+    if (count <= SORT_PAYLOAD_INSERTION_MAX) {
+        sort_insertion_i64(keys, payload, count);
+        return 1;
+    }
+    return sort_radix(keys, payload, count, 1);
+}
+
+int array_sort_i32_payload(int32_t* keys, uint32_t* payload, size_t count) {
+    if (count <= SORT_PAYLOAD_INSERTION_MAX) {
+        sort_insertion_i32(keys, payload, count);
+        return 1;
+    }
+    return sort_radix(keys, payload, count, 0);
+}
@@ -0,0 +1,189 @@
+// assm_sse.c - SSE floating point kernels (tutorial 9)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+float add_floats_sse(float a, float b) {
+    float result;
+    
+    __asm__ volatile (
+        "movss %1, %%xmm0\n\t"      // Load a into XMM0
+        "movss %2, %%xmm1\n\t"      // Load b into XMM1
+        "addss %%xmm1, %%xmm0\n\t"  // Add: XMM0 = XMM0 + XMM1
+        "movss %%xmm0, %0\n\t"      // Store result
+        : "=m" (result)
+        : "m" (a), "m" (b)
+        : "xmm0", "xmm1"
+    );
+    
+    return result;
+}
+
+int compare_floats_sse(float a, float b) {
+    int result;
+    
+    __asm__ volatile (
+        "movss %1, %%xmm0\n\t"      // Load a into XMM0
+        "movss %2, %%xmm1\n\t"      // Load b into XMM1
+        "comiss %%xmm1, %%xmm0\n\t" // Compare XMM0 with XMM1
+        "movl $0, %%eax\n\t"        // Default result = 0 (equal)
+        "je 2f\n\t"                 // If equal, done
+        "movl $-1, %%eax\n\t"       // Assume a < b
+        "jb 2f\n\t"                 // If below (a < b), done
+        "movl $1, %%eax\n\t"        // Otherwise a > b
+        "2:\n\t"                    // end
+        "movl %%eax, %0\n\t"        // Store result
+        : "=m" (result)
+        : "m" (a), "m" (b)
+        : "eax", "xmm0", "xmm1"
+    );
+    
+    return result;
+}
+
+float sqrt_sse(float value) {
+    float result;
+    
+    __asm__ volatile (
+        "movss %1, %%xmm0\n\t"      // Load value into XMM0
+        "sqrtss %%xmm0, %%xmm0\n\t" // Square root: XMM0 = sqrt(XMM0)
+        "movss %%xmm0, %0\n\t"      // Store result
+        : "=m" (result)
+        : "m" (value)
+        : "xmm0"
+    );
+    
+    return result;
+}
+
+void add_vectors_sse(const float* a, const float* b, float* result) {
+    __asm__ volatile (
+        "movups (%0), %%xmm0\n\t"   // Load 4 floats from array a
+        "movups (%1), %%xmm1\n\t"   // Load 4 floats from array b
+        "addps %%xmm1, %%xmm0\n\t"  // Add packed singles: XMM0 = XMM0 + XMM1
+        "movups %%xmm0, (%2)\n\t"   // Store result to output array
+        :
+        : "r" (a), "r" (b), "r" (result)
+        : "xmm0", "xmm1", "memory"
+    );
+}
+
+float dot_product_sse2(const float* a, const float* b, int count) {
+    float result;
+    
+    __asm__ volatile (
+        "xorps %%xmm0, %%xmm0\n\t"  // Clear accumulator
+        "movl %3, %%ecx\n\t"        // Load count
+        "shrl $2, %%ecx\n\t"        // Divide by 4 (process 4 floats at a time)
+        "jz 2f\n\t"                 // If less than 4 elements, skip vector loop
+        "1:\n\t"                    // vector_loop
+        "movups (%1), %%xmm1\n\t"   // Load 4 floats from a
+        "movups (%2), %%xmm2\n\t"   // Load 4 floats from b
+        "mulps %%xmm2, %%xmm1\n\t"  // Multiply: XMM1 = XMM1 * XMM2
+        "addps %%xmm1, %%xmm0\n\t"  // Add to accumulator
+        "addq $16, %1\n\t"          // Advance pointer a by 16 bytes (4 floats)
+        "addq $16, %2\n\t"          // Advance pointer b by 16 bytes
+        "decl %%ecx\n\t"            // Decrement counter
+        "jnz 1b\n\t"                // Continue if not zero
+        "2:\n\t"                    // sum_vector
+        // Horizontal sum of XMM0
+        "movaps %%xmm0, %%xmm1\n\t" // Copy XMM0 to XMM1
+        "shufps $0x4E, %%xmm1, %%xmm1\n\t" // Shuffle high 64 bits to low
+        "addps %%xmm1, %%xmm0\n\t"  // Add high and low parts
+        "movaps %%xmm0, %%xmm1\n\t" // Copy again
+        "shufps $0xB1, %%xmm1, %%xmm1\n\t" // Shuffle remaining elements
+        "addss %%xmm1, %%xmm0\n\t"  // Final sum in XMM0[0]
+        "movl %3, %%ecx\n\t"        // Reload count
+        "andl $3, %%ecx\n\t"        // Remaining 0-3 elements
+        "jz 4f\n\t"                 // No tail, done
+        "3:\n\t"                    // tail_loop
+        "movss (%1), %%xmm1\n\t"    // Load one float from a
+        "mulss (%2), %%xmm1\n\t"    // Multiply by one float from b
+        "addss %%xmm1, %%xmm0\n\t"  // Add to the sum
+        "addq $4, %1\n\t"           // Advance pointer a
+        "addq $4, %2\n\t"           // Advance pointer b
+        "decl %%ecx\n\t"            // Decrement counter
+        "jnz 3b\n\t"                // Continue if not zero
+        "4:\n\t"                    // end
+        "movss %%xmm0, %0\n\t"      // Store result
+        : "=m" (result), "+r" (a), "+r" (b)
+        : "m" (count)
+        : "ecx", "xmm0", "xmm1", "xmm2", "memory"
+    );
+    
+    return result;
+}
+
+// 16 floats per iteration in two independent FMA chains
+float dot_product_avx2(const float* a, const float* b, int count) {
+    float result;
+    
+    __asm__ volatile (
+        "vxorps %%ymm0, %%ymm0, %%ymm0\n\t"  // Clear accumulator 0
+        "vxorps %%ymm1, %%ymm1, %%ymm1\n\t"  // Clear accumulator 1
+        "movl %3, %%ecx\n\t"                 // Load count
+        "shrl $4, %%ecx\n\t"                 // 16 floats per iteration
+        "jz 2f\n\t"                          // Fewer than 16, skip main loop
+        "1:\n\t"                             // vector_loop
+        "vmovups (%1), %%ymm2\n\t"           // Load a[0..7]
+        "vmovups 32(%1), %%ymm3\n\t"         // Load a[8..15]
+        "vfmadd231ps (%2), %%ymm2, %%ymm0\n\t"   // acc0 += a[0..7] * b[0..7]
+        "vfmadd231ps 32(%2), %%ymm3, %%ymm1\n\t" // acc1 += a[8..15] * b[8..15]
+        "addq $64, %1\n\t"                   // Advance a by 16 floats
+        "addq $64, %2\n\t"                   // Advance b by 16 floats
+        "decl %%ecx\n\t"                     // Decrement counter
+        "jnz 1b\n\t"                         // Continue if not zero
+        "2:\n\t"                             // half_block
+        "testl $8, %3\n\t"                   // 8 or more floats left?
+        "jz 3f\n\t"                          // No, reduce
+        "vmovups (%1), %%ymm2\n\t"           // Load a[0..7]
+        "vfmadd231ps (%2), %%ymm2, %%ymm0\n\t"   // acc0 += a[0..7] * b[0..7]
+        "addq $32, %1\n\t"                   // Advance a by 8 floats
+        "addq $32, %2\n\t"                   // Advance b by 8 floats
+        "3:\n\t"                             // reduce
+        "vaddps %%ymm1, %%ymm0, %%ymm0\n\t"  // Combine the two chains
+        "vextractf128 $1, %%ymm0, %%xmm1\n\t"    // High 128 bits
+        "vaddps %%xmm1, %%xmm0, %%xmm0\n\t"  // 8 lanes -> 4 lanes
+        "vmovhlps %%xmm0, %%xmm0, %%xmm1\n\t"    // High 64 bits to low
+        "vaddps %%xmm1, %%xmm0, %%xmm0\n\t"  // 4 lanes -> 2 lanes
+        "vmovshdup %%xmm0, %%xmm1\n\t"       // Lane 1 to lane 0
+        "vaddss %%xmm1, %%xmm0, %%xmm0\n\t"  // 2 lanes -> 1 lane
+        "movl %3, %%ecx\n\t"                 // Reload count
+        "andl $7, %%ecx\n\t"                 // Remaining 0-7 elements
+        "jz 5f\n\t"                          // No tail, done
+        "4:\n\t"                             // tail_loop
+        "vmovss (%1), %%xmm1\n\t"            // Load one float from a
+        "vfmadd231ss (%2), %%xmm1, %%xmm0\n\t"   // sum += a[i] * b[i]
+        "addq $4, %1\n\t"                    // Advance pointer a
+        "addq $4, %2\n\t"                    // Advance pointer b
+        "decl %%ecx\n\t"                     // Decrement counter
+        "jnz 4b\n\t"                         // Continue if not zero
+        "5:\n\t"                             // end
+        "vmovss %%xmm0, %0\n\t"              // Store result
+        "vzeroupper\n\t"                     // Avoid AVX-SSE transition penalties
+        : "=m" (result), "+r" (a), "+r" (b)
+        : "m" (count)
+        : "ecx", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+    
+    return result;
+}
+
+float dot_product_sse(const float* a, const float* b, int count) {
+    if (count <= 0) return 0.0f;
+    return ASSM_DISPATCH(dot_product)(a, b, count);
+}
+
+float fast_inv_sqrt_sse(float value) {
+    float result;
+    
+    __asm__ volatile (
+        "movss %1, %%xmm0\n\t"      // Load value into XMM0
+        "rsqrtss %%xmm0, %%xmm0\n\t" // Reciprocal square root approximation
+        "movss %%xmm0, %0\n\t"      // Store result
+        : "=m" (result)
+        : "m" (value)
+        : "xmm0"
+    );
+    
+    return result;
+}
@@ -0,0 +1,2256 @@
+// assm_string.c - String and memory kernels (tutorial 6)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// One byte per iteration in microcode; kept as the tutorial reference
+size_t strlen_scasb(const char* str) {
+    size_t len;
+    
+    __asm__ volatile (
+        "movq %1, %%rdi\n\t"        // Load string pointer into RDI
+        "xorq %%rax, %%rax\n\t"     // Clear RAX (will be our counter)
+        "movq $-1, %%rcx\n\t"       // Set RCX to -1 (maximum count)
+        "cld\n\t"                   // Clear direction flag (forward)
+        "repne scasb\n\t"           // Scan for null byte (AL = 0)
+        "notq %%rcx\n\t"            // Invert RCX
+        "decq %%rcx\n\t"            // Subtract 1 (don't count null terminator)
+        "movq %%rcx, %0\n\t"        // Store result
+        : "=m" (len)
+        : "m" (str)
+        : "rax", "rcx", "rdi", "memory"
+    );
+    
+    return len;
+}
+
+// Vector string scans only issue aligned loads: an aligned 16/32-byte block
+// (or a 64/128-byte group aligned to its own size) never straddles a 4 KiB
+// page, so reading past the terminator cannot fault.
+
+size_t strlen_sse2(const char* str) {
+    size_t len;
+    
+    __asm__ volatile (
+        "movq %1, %%rdi\n\t"                // Block pointer starts at str
+        "andq $-16, %%rdi\n\t"              // Round down to a 16-byte boundary
+        "pxor %%xmm0, %%xmm0\n\t"           // xmm0 = 16 zero bytes
+        "movdqa (%%rdi), %%xmm1\n\t"        // First (partial) block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // 0xFF where byte == 0
+        "pmovmskb %%xmm1, %%eax\n\t"        // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of str
+        "andl $15, %%ecx\n\t"               // Offset of str in the block
+        "shrl %%cl, %%eax\n\t"              // Drop bytes before str
+        "testl %%eax, %%eax\n\t"            // Terminator in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "bsfl %%eax, %%eax\n\t"             // Index relative to str
+        "jmp 9f\n\t"                        // Done
+        "1:\n\t"                            // single_blocks
+        "addq $16, %%rdi\n\t"               // Next block
+        "testq $63, %%rdi\n\t"              // Reached a 64-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Compare with zero
+        "pmovmskb %%xmm1, %%eax\n\t"        // Mask
+        "testl %%eax, %%eax\n\t"            // Any terminator?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 8f\n\t"                        // Yes, compute length
+        "2:\n\t"                            // group_loop: 64 bytes per iteration
+        "movdqa (%%rdi), %%xmm1\n\t"        // Block 0
+        "movdqa 16(%%rdi), %%xmm2\n\t"      // Block 1
+        "movdqa 32(%%rdi), %%xmm3\n\t"      // Block 2
+        "movdqa 48(%%rdi), %%xmm4\n\t"      // Block 3
+        "movdqa %%xmm1, %%xmm5\n\t"         // Copy block 0
+        "pminub %%xmm2, %%xmm5\n\t"         // min(block 0, block 1)
+        "movdqa %%xmm3, %%xmm6\n\t"         // Copy block 2
+        "pminub %%xmm4, %%xmm6\n\t"         // min(block 2, block 3)
+        "pminub %%xmm6, %%xmm5\n\t"         // A zero byte anywhere stays zero
+        "pcmpeqb %%xmm0, %%xmm5\n\t"        // Compare with zero
+        "pmovmskb %%xmm5, %%eax\n\t"        // Mask for the whole group
+        "testl %%eax, %%eax\n\t"            // Any terminator in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "addq $64, %%rdi\n\t"               // Next group
+        "jmp 2b\n\t"                        // Continue
+        "3:\n\t"                            // locate_block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Block 0
+        "pmovmskb %%xmm1, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $16, %%rdi\n\t"
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // Block 1
+        "pmovmskb %%xmm2, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $16, %%rdi\n\t"
+        "pcmpeqb %%xmm0, %%xmm3\n\t"        // Block 2
+        "pmovmskb %%xmm3, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $16, %%rdi\n\t"
+        "pcmpeqb %%xmm0, %%xmm4\n\t"        // Block 3 (must hold the terminator)
+        "pmovmskb %%xmm4, %%eax\n\t"
+        "8:\n\t"                            // found: RDI = block, EAX = mask
+        "bsfl %%eax, %%eax\n\t"             // Index in the block
+        "addq %%rdi, %%rax\n\t"             // Address of the terminator
+        "subq %1, %%rax\n\t"                // Length = terminator - str
+        "9:\n\t"                            // end
+        : "=&a" (len)
+        : "r" (str)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return len;
+}
+
+size_t strlen_avx2(const char* str) {
+    size_t len;
+    
+    __asm__ volatile (
+        "movq %1, %%rdi\n\t"                // Block pointer starts at str
+        "andq $-32, %%rdi\n\t"              // Round down to a 32-byte boundary
+        "vpxor %%xmm0, %%xmm0, %%xmm0\n\t"  // ymm0 = 32 zero bytes
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // 0xFF where byte == 0
+        "vpmovmskb %%ymm1, %%eax\n\t"       // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of str
+        "andl $31, %%ecx\n\t"               // Offset of str in the block
+        "shrxl %%ecx, %%eax, %%eax\n\t"     // Drop bytes before str
+        "testl %%eax, %%eax\n\t"            // Terminator in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "tzcntl %%eax, %%eax\n\t"           // Index relative to str
+        "jmp 9f\n\t"                        // Done
+        "1:\n\t"                            // single_blocks
+        "addq $32, %%rdi\n\t"               // Next block
+        "testq $127, %%rdi\n\t"             // Reached a 128-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Compare block with zero
+        "vpmovmskb %%ymm1, %%eax\n\t"       // Mask
+        "testl %%eax, %%eax\n\t"            // Any terminator?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 8f\n\t"                        // Yes, compute length
+        "2:\n\t"                            // group_loop: 128 bytes per iteration
+        "vmovdqa (%%rdi), %%ymm1\n\t"       // Block 0
+        "vmovdqa 32(%%rdi), %%ymm2\n\t"     // Block 1
+        "vmovdqa 64(%%rdi), %%ymm3\n\t"     // Block 2
+        "vmovdqa 96(%%rdi), %%ymm4\n\t"     // Block 3
+        "vpminub %%ymm2, %%ymm1, %%ymm5\n\t"    // min(block 0, block 1)
+        "vpminub %%ymm4, %%ymm3, %%ymm6\n\t"    // min(block 2, block 3)
+        "vpminub %%ymm6, %%ymm5, %%ymm5\n\t"    // A zero byte anywhere stays zero
+        "vpcmpeqb %%ymm0, %%ymm5, %%ymm5\n\t"   // Compare with zero
+        "vpmovmskb %%ymm5, %%eax\n\t"       // Mask for the whole group
+        "testl %%eax, %%eax\n\t"            // Any terminator in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "subq $-128, %%rdi\n\t"             // Next group (imm8 encoding)
+        "jmp 2b\n\t"                        // Continue
+        "3:\n\t"                            // locate_block
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm1\n\t"   // Block 0
+        "vpmovmskb %%ymm1, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $32, %%rdi\n\t"
+        "vpcmpeqb %%ymm0, %%ymm2, %%ymm2\n\t"   // Block 1
+        "vpmovmskb %%ymm2, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $32, %%rdi\n\t"
+        "vpcmpeqb %%ymm0, %%ymm3, %%ymm3\n\t"   // Block 2
+        "vpmovmskb %%ymm3, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $32, %%rdi\n\t"
+        "vpcmpeqb %%ymm0, %%ymm4, %%ymm4\n\t"   // Block 3 (must hold the terminator)
+        "vpmovmskb %%ymm4, %%eax\n\t"
+        "8:\n\t"                            // found: RDI = block, EAX = mask
+        "tzcntl %%eax, %%eax\n\t"           // Index in the block
+        "addq %%rdi, %%rax\n\t"             // Address of the terminator
+        "subq %1, %%rax\n\t"                // Length = terminator - str
+        "9:\n\t"                            // end
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (len)
+        : "r" (str)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return len;
+}
+
+size_t strlen_asm(const char* str) {
+    return ASSM_DISPATCH(strlen)(str);
+}
+
+// Bounded scans use the same aligned blocks and groups as strlen and check
+// the limit before each one. A block that starts inside the bound is
+// readable, so finishing it is page-safe even if maxlen ends mid-block.
+
+size_t strnlen_sse2(const char* str, size_t maxlen) {
+    size_t len;
+    
+    if (maxlen == 0) return 0;
+    
+    __asm__ volatile (
+        "movq %1, %%rdi\n\t"                // Block pointer starts at str
+        "andq $-16, %%rdi\n\t"              // Round down to a 16-byte boundary
+        "pxor %%xmm0, %%xmm0\n\t"           // xmm0 = 16 zero bytes
+        "movdqa (%%rdi), %%xmm1\n\t"        // First (partial) block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // 0xFF where byte == 0
+        "pmovmskb %%xmm1, %%eax\n\t"        // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of str
+        "andl $15, %%ecx\n\t"               // Offset of str in the block
+        "shrl %%cl, %%eax\n\t"              // Drop bytes before str
+        "testl %%eax, %%eax\n\t"            // Terminator in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "bsfl %%eax, %%eax\n\t"             // Index relative to str
+        "jmp 8f\n\t"                        // Clamp and finish
+        "1:\n\t"                            // single_blocks
+        "addq $16, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past maxlen?
+        "jae 7f\n\t"                        // Yes, no terminator within the bound
+        "testq $63, %%rdi\n\t"              // Reached a 64-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Compare with zero
+        "pmovmskb %%xmm1, %%ecx\n\t"        // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any terminator?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 64 bytes per iteration
+        "movdqa (%%rdi), %%xmm1\n\t"        // Block 0
+        "movdqa 16(%%rdi), %%xmm2\n\t"      // Block 1
+        "movdqa 32(%%rdi), %%xmm3\n\t"      // Block 2
+        "movdqa 48(%%rdi), %%xmm4\n\t"      // Block 3
+        "movdqa %%xmm1, %%xmm5\n\t"         // Copy block 0
+        "pminub %%xmm2, %%xmm5\n\t"         // min(block 0, block 1)
+        "movdqa %%xmm3, %%xmm6\n\t"         // Copy block 2
+        "pminub %%xmm4, %%xmm6\n\t"         // min(block 2, block 3)
+        "pminub %%xmm6, %%xmm5\n\t"         // A zero byte anywhere stays zero
+        "pcmpeqb %%xmm0, %%xmm5\n\t"        // Compare with zero
+        "pmovmskb %%xmm5, %%ecx\n\t"        // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any terminator in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "addq $64, %%rdi\n\t"               // Next group
+        "addq $64, %%rax\n\t"               // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past maxlen?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, no terminator within the bound
+        "3:\n\t"                            // locate_block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Block 0
+        "pmovmskb %%xmm1, %%ecx\n\t"
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // Block 1
+        "pmovmskb %%xmm2, %%ecx\n\t"
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pcmpeqb %%xmm0, %%xmm3\n\t"        // Block 2
+        "pmovmskb %%xmm3, %%ecx\n\t"
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pcmpeqb %%xmm0, %%xmm4\n\t"        // Block 3 (must hold the terminator)
+        "pmovmskb %%xmm4, %%ecx\n\t"
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "bsfl %%ecx, %%ecx\n\t"             // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Length = block offset + index
+        "jmp 8f\n\t"                        // Clamp and finish
+        "7:\n\t"                            // bound_reached
+        "movq %2, %%rax\n\t"                // Length = maxlen
+        "8:\n\t"                            // clamp
+        "cmpq %2, %%rax\n\t"                // Terminator past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then the answer is maxlen
+        : "=&a" (len)
+        : "r" (str), "r" (maxlen)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return len;
+}
+
+size_t strnlen_avx2(const char* str, size_t maxlen) {
+    size_t len;
+    
+    if (maxlen == 0) return 0;
+    
+    __asm__ volatile (
+        "movq %1, %%rdi\n\t"                // Block pointer starts at str
+        "andq $-32, %%rdi\n\t"              // Round down to a 32-byte boundary
+        "vpxor %%xmm0, %%xmm0, %%xmm0\n\t"  // ymm0 = 32 zero bytes
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // 0xFF where byte == 0
+        "vpmovmskb %%ymm1, %%eax\n\t"       // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of str
+        "andl $31, %%ecx\n\t"               // Offset of str in the block
+        "shrxl %%ecx, %%eax, %%eax\n\t"     // Drop bytes before str
+        "testl %%eax, %%eax\n\t"            // Terminator in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "tzcntl %%eax, %%eax\n\t"           // Index relative to str
+        "jmp 8f\n\t"                        // Clamp and finish
+        "1:\n\t"                            // single_blocks
+        "addq $32, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past maxlen?
+        "jae 7f\n\t"                        // Yes, no terminator within the bound
+        "testq $127, %%rdi\n\t"             // Reached a 128-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Compare block with zero
+        "vpmovmskb %%ymm1, %%ecx\n\t"       // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any terminator?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 128 bytes per iteration
+        "vmovdqa (%%rdi), %%ymm1\n\t"       // Block 0
+        "vmovdqa 32(%%rdi), %%ymm2\n\t"     // Block 1
+        "vmovdqa 64(%%rdi), %%ymm3\n\t"     // Block 2
+        "vmovdqa 96(%%rdi), %%ymm4\n\t"     // Block 3
+        "vpminub %%ymm2, %%ymm1, %%ymm5\n\t"  // min(block 0, block 1)
+        "vpminub %%ymm4, %%ymm3, %%ymm6\n\t"  // min(block 2, block 3)
+        "vpminub %%ymm6, %%ymm5, %%ymm5\n\t"  // A zero byte anywhere stays zero
+        "vpcmpeqb %%ymm0, %%ymm5, %%ymm5\n\t"  // Compare with zero
+        "vpmovmskb %%ymm5, %%ecx\n\t"       // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any terminator in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "subq $-128, %%rdi\n\t"             // Next group
+        "subq $-128, %%rax\n\t"             // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past maxlen?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, no terminator within the bound
+        "3:\n\t"                            // locate_block
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm1\n\t"  // Block 0
+        "vpmovmskb %%ymm1, %%ecx\n\t"
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpcmpeqb %%ymm0, %%ymm2, %%ymm2\n\t"  // Block 1
+        "vpmovmskb %%ymm2, %%ecx\n\t"
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpcmpeqb %%ymm0, %%ymm3, %%ymm3\n\t"  // Block 2
+        "vpmovmskb %%ymm3, %%ecx\n\t"
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpcmpeqb %%ymm0, %%ymm4, %%ymm4\n\t"  // Block 3 (must hold the terminator)
+        "vpmovmskb %%ymm4, %%ecx\n\t"
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "tzcntl %%ecx, %%ecx\n\t"           // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Length = block offset + index
+        "jmp 8f\n\t"                        // Clamp and finish
+        "7:\n\t"                            // bound_reached
+        "movq %2, %%rax\n\t"                // Length = maxlen
+        "8:\n\t"                            // clamp
+        "cmpq %2, %%rax\n\t"                // Terminator past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then the answer is maxlen
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (len)
+        : "r" (str), "r" (maxlen)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return len;
+}
+
+size_t strnlen_asm(const char* str, size_t maxlen) {
+    return ASSM_DISPATCH(strnlen)(str, maxlen);
+}
+
+// One byte per iteration; kept as the tutorial reference
+void strcpy_lodsb(char* dest, const char* src) {
+    __asm__ volatile (
+        "movq %0, %%rdi\n\t"        // Load dest into RDI
+        "movq %1, %%rsi\n\t"        // Load src into RSI
+        "cld\n\t"                   // Clear direction flag
+        "1:\n\t"                    // loop_start
+        "lodsb\n\t"                 // Load byte from [RSI] into AL, increment RSI
+        "stosb\n\t"                 // Store AL into [RDI], increment RDI
+        "testb %%al, %%al\n\t"      // Test if AL is zero (null terminator)
+        "jnz 1b\n\t"                // If not zero, loop back
+        :
+        : "m" (dest), "m" (src)
+        : "rax", "rsi", "rdi", "memory"
+    );
+}
+
+// Bounded copy: min(strlen(src), n) bytes plus a terminator, returning the
+// number of string bytes copied. Source blocks are read with aligned loads
+// (page-safe like strlen) and never past the block holding src[n - 1].
+// Strings shorter than two vectors are copied with two overlapping loads and
+// stores of the largest fitting width. Longer ones store the first vector
+// unaligned, then copy aligned source blocks (four per iteration once p is
+// aligned to the group size, so the group stays within one page) and finish
+// with a vector that ends at the stop. n == SIZE_MAX makes the copy
+// unbounded.
+
+size_t strcpy_bounded_sse2(char* dest, const char* src, size_t n) {
+    size_t len;
+    
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"             // len = 0
+        "testq %3, %3\n\t"                  // n == 0?
+        "jz 9f\n\t"                         // Then only the terminator is written
+        "movq %2, %%rdx\n\t"                // end = src
+        "addq %3, %%rdx\n\t"                // end = src + n
+        "jnc 1f\n\t"                        // No wraparound
+        "movq $-1, %%rdx\n\t"               // Unbounded copy: saturate end
+        "1:\n\t"                            // first_block
+        "movq %2, %%rsi\n\t"                // p = src
+        "andq $-16, %%rsi\n\t"              // Round down to a 16-byte boundary
+        "pxor %%xmm0, %%xmm0\n\t"           // xmm0 = 16 zero bytes
+        "movdqa (%%rsi), %%xmm1\n\t"        // Aligned 16-byte block
+        "movdqa %%xmm1, %%xmm2\n\t"         // Keep the data for the store
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // 0xFF where byte == 0
+        "pmovmskb %%xmm2, %%eax\n\t"        // One bit per byte
+        "movl %k2, %%ecx\n\t"               // Low bits of src
+        "andl $15, %%ecx\n\t"               // Offset of src in the block
+        "orl $0x10000, %%eax\n\t"           // Sentinel bit: block end
+        "shrl %%cl, %%eax\n\t"              // Drop bytes before src
+        "bsfl %%eax, %%eax\n\t"             // Terminator or block end, relative to src
+        "cmpq %3, %%rax\n\t"                // Bound reached first?
+        "jae 7f\n\t"                        // Yes, copy n bytes
+        "leal (%%rax,%%rcx), %%r8d\n\t"     // Block offset of the stop
+        "cmpl $16, %%r8d\n\t"               // Stopped at the sentinel?
+        "jb 8f\n\t"                         // No, terminator found: short copy
+        "addq $16, %%rsi\n\t"               // Second block (still below end)
+        "movdqa (%%rsi), %%xmm1\n\t"        // Aligned 16-byte block
+        "movdqa %%xmm1, %%xmm2\n\t"         // Keep the data for the store
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // 0xFF where byte == 0
+        "pmovmskb %%xmm2, %%r8d\n\t"        // One bit per byte
+        "orl $0x10000, %%r8d\n\t"           // Sentinel bit: block end
+        "bsfl %%r8d, %%r8d\n\t"             // Terminator or block end
+        "leaq (%%rsi,%%r8), %%rax\n\t"      // Stop address
+        "subq %2, %%rax\n\t"                // len = stop - src
+        "cmpq %3, %%rax\n\t"                // Bound reached first?
+        "jae 7f\n\t"                        // Yes, copy n bytes
+        "cmpl $16, %%r8d\n\t"               // Terminator in the second block?
+        "jb 8f\n\t"                         // Yes, short copy
+        "movq %1, %%r9\n\t"                 // r9 = dest - src, so block p
+        "subq %2, %%r9\n\t"                 // is stored at (p, r9)
+        "movdqu (%2), %%xmm2\n\t"           // First 16 bytes are known to be valid
+        "movdqu %%xmm2, (%1)\n\t"           // Store them
+        "movdqu %%xmm1, (%%rsi,%%r9)\n\t"   // Store the second block
+        "leaq -64(%%rdx), %%r11\n\t"        // r11 = last p whose group fits the bound
+        "subq $16, %%rdx\n\t"               // rdx = last p whose block fits the bound
+        "30:\n\t"                           // next_block
+        "addq $16, %%rsi\n\t"               // Advance p
+        "32:\n\t"                           // check_block
+        "cmpq %%rdx, %%rsi\n\t"             // Block crosses the bound?
+        "ja 5f\n\t"                         // Yes, handle the tail
+        "testq $63, %%rsi\n\t"              // Reached a 64-byte boundary?
+        "jz 40f\n\t"                        // Yes, try the unrolled loop
+        "31:\n\t"                           // single_block: 16 bytes
+        "movdqa (%%rsi), %%xmm1\n\t"        // Aligned 16-byte block
+        "movdqa %%xmm1, %%xmm2\n\t"         // Keep the data for the store
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // 0xFF where byte == 0
+        "pmovmskb %%xmm2, %%r8d\n\t"        // One bit per byte
+        "testl %%r8d, %%r8d\n\t"            // Any terminator?
+        "jnz 4f\n\t"                        // Yes, finish
+        "movdqu %%xmm1, (%%rsi,%%r9)\n\t"   // Store the block
+        "jmp 30b\n\t"                       // Continue
+        "40:\n\t"                           // group_loop: 64 bytes per iteration
+        "cmpq %%r11, %%rsi\n\t"             // Group crosses the bound?
+        "ja 31b\n\t"                        // Yes, finish block by block
+        "movdqa (%%rsi), %%xmm1\n\t"        // Block 0
+        "movdqa 16(%%rsi), %%xmm2\n\t"      // Block 1
+        "movdqa 32(%%rsi), %%xmm3\n\t"      // Block 2
+        "movdqa 48(%%rsi), %%xmm4\n\t"      // Block 3
+        "movdqa %%xmm1, %%xmm5\n\t"         // Copy block 0
+        "pminub %%xmm2, %%xmm5\n\t"         // min(block 0, block 1)
+        "movdqa %%xmm3, %%xmm6\n\t"         // Copy block 2
+        "pminub %%xmm4, %%xmm6\n\t"         // min(block 2, block 3)
+        "pminub %%xmm6, %%xmm5\n\t"         // A zero byte anywhere stays zero
+        "pcmpeqb %%xmm0, %%xmm5\n\t"        // Compare with zero
+        "pmovmskb %%xmm5, %%r8d\n\t"        // Mask for the whole group
+        "testl %%r8d, %%r8d\n\t"            // Any terminator in the group?
+        "jnz 31b\n\t"                       // Yes, find it block by block
+        "movdqu %%xmm1, (%%rsi,%%r9)\n\t"   // Store block 0
+        "movdqu %%xmm2, 16(%%rsi,%%r9)\n\t" // Store block 1
+        "movdqu %%xmm3, 32(%%rsi,%%r9)\n\t" // Store block 2
+        "movdqu %%xmm4, 48(%%rsi,%%r9)\n\t" // Store block 3
+        "addq $64, %%rsi\n\t"               // Next group
+        "jmp 32b\n\t"                       // Continue (the bound check runs first)
+        "4:\n\t"                            // terminator_in_loop
+        "bsfl %%r8d, %%r8d\n\t"             // Index of the terminator
+        "leaq (%%rsi,%%r8), %%rax\n\t"      // Terminator address
+        "subq %2, %%rax\n\t"                // len (below n inside the loop)
+        "jmp 6f\n\t"                        // Copy the last bytes
+        "5:\n\t"                            // tail: block crosses the bound
+        "movq %3, %%rax\n\t"                // Default len = n
+        "leaq 16(%%rdx), %%r10\n\t"         // end
+        "cmpq %%r10, %%rsi\n\t"             // Block starts at or past the bound?
+        "jae 6f\n\t"                        // Yes, copy n bytes
+        "movdqa (%%rsi), %%xmm1\n\t"        // Aligned 16-byte block
+        "movdqa %%xmm1, %%xmm2\n\t"         // Keep the data for the store
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // 0xFF where byte == 0
+        "pmovmskb %%xmm2, %%r8d\n\t"        // One bit per byte
+        "orl $0x10000, %%r8d\n\t"           // Sentinel bit: block end
+        "bsfl %%r8d, %%r8d\n\t"             // Terminator or block end
+        "leaq (%%rsi,%%r8), %%r10\n\t"      // Stop address
+        "subq %2, %%r10\n\t"                // Candidate len
+        "cmpq %%r10, %%rax\n\t"             // Stop before the bound?
+        "cmovaq %%r10, %%rax\n\t"           // Then len = candidate
+        "6:\n\t"                            // last_block: len >= 16
+        "movdqu -16(%2,%%rax), %%xmm1\n\t"  // Last 16 bytes before the stop
+        "movdqu %%xmm1, -16(%1,%%rax)\n\t"  // overlap bytes already stored
+        "jmp 9f\n\t"                        // Terminate
+        "7:\n\t"                            // bound_reached
+        "movq %3, %%rax\n\t"                // len = n
+        "8:\n\t"                            // short_copy: len < 32, overlapping loads
+        "cmpq $16, %%rax\n\t"               // At least 16 bytes?
+        "jb 81f\n\t"
+        "movdqu (%2), %%xmm1\n\t"           // Head
+        "movdqu -16(%2,%%rax), %%xmm2\n\t"  // Tail (may overlap the head)
+        "movdqu %%xmm1, (%1)\n\t"
+        "movdqu %%xmm2, -16(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "81:\n\t"
+        "cmpq $8, %%rax\n\t"                // At least 8 bytes?
+        "jb 82f\n\t"
+        "movq (%2), %%rcx\n\t"              // Head
+        "movq -8(%2,%%rax), %%r8\n\t"       // Tail
+        "movq %%rcx, (%1)\n\t"
+        "movq %%r8, -8(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "82:\n\t"
+        "cmpq $4, %%rax\n\t"                // At least 4 bytes?
+        "jb 83f\n\t"
+        "movl (%2), %%ecx\n\t"              // Head
+        "movl -4(%2,%%rax), %%r8d\n\t"      // Tail
+        "movl %%ecx, (%1)\n\t"
+        "movl %%r8d, -4(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "83:\n\t"
+        "cmpq $2, %%rax\n\t"                // At least 2 bytes?
+        "jb 84f\n\t"
+        "movzwl (%2), %%ecx\n\t"            // Head
+        "movzwl -2(%2,%%rax), %%r8d\n\t"    // Tail
+        "movw %%cx, (%1)\n\t"
+        "movw %%r8w, -2(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "84:\n\t"                           // zero or one byte
+        "testq %%rax, %%rax\n\t"            // Empty?
+        "jz 9f\n\t"
+        "movzbl (%2), %%ecx\n\t"            // Single byte
+        "movb %%cl, (%1)\n\t"
+        "9:\n\t"                            // terminate
+        "movb $0, (%1,%%rax)\n\t"           // dest[len] = 0
+        : "=&a" (len)
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "rdx", "rsi", "r8", "r9", "r10", "r11",
+          "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return len;
+}
+
+size_t strcpy_bounded_avx2(char* dest, const char* src, size_t n) {
+    size_t len;
+    
+    __asm__ volatile (
+        "xorl %%eax, %%eax\n\t"             // len = 0
+        "testq %3, %3\n\t"                  // n == 0?
+        "jz 9f\n\t"                         // Then only the terminator is written
+        "movq %2, %%rdx\n\t"                // end = src
+        "addq %3, %%rdx\n\t"                // end = src + n
+        "jnc 1f\n\t"                        // No wraparound
+        "movq $-1, %%rdx\n\t"               // Unbounded copy: saturate end
+        "1:\n\t"                            // first_block
+        "movq %2, %%rsi\n\t"                // p = src
+        "andq $-32, %%rsi\n\t"              // Round down to a 32-byte boundary
+        "vpxor %%xmm0, %%xmm0, %%xmm0\n\t"  // ymm0 = 32 zero bytes
+        "vmovdqa (%%rsi), %%ymm1\n\t"       // Aligned 32-byte block
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm2\n\t"  // 0xFF where byte == 0
+        "vpmovmskb %%ymm2, %%eax\n\t"       // One bit per byte
+        "movl %k2, %%ecx\n\t"               // Low bits of src
+        "andl $31, %%ecx\n\t"               // Offset of src in the block
+        "btsq $32, %%rax\n\t"               // Sentinel bit: block end
+        "shrq %%cl, %%rax\n\t"              // Drop bytes before src
+        "tzcntq %%rax, %%rax\n\t"           // Terminator or block end, relative to src
+        "cmpq %3, %%rax\n\t"                // Bound reached first?
+        "jae 7f\n\t"                        // Yes, copy n bytes
+        "leal (%%rax,%%rcx), %%r8d\n\t"     // Block offset of the stop
+        "cmpl $32, %%r8d\n\t"               // Stopped at the sentinel?
+        "jb 8f\n\t"                         // No, terminator found: short copy
+        "addq $32, %%rsi\n\t"               // Second block (still below end)
+        "vmovdqa (%%rsi), %%ymm1\n\t"       // Aligned 32-byte block
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm2\n\t"  // 0xFF where byte == 0
+        "vpmovmskb %%ymm2, %%r8d\n\t"       // One bit per byte
+        "btsq $32, %%r8\n\t"                // Sentinel bit: block end
+        "tzcntq %%r8, %%r8\n\t"             // Terminator or block end
+        "leaq (%%rsi,%%r8), %%rax\n\t"      // Stop address
+        "subq %2, %%rax\n\t"                // len = stop - src
+        "cmpq %3, %%rax\n\t"                // Bound reached first?
+        "jae 7f\n\t"                        // Yes, copy n bytes
+        "cmpl $32, %%r8d\n\t"               // Terminator in the second block?
+        "jb 8f\n\t"                         // Yes, short copy
+        "movq %1, %%r9\n\t"                 // r9 = dest - src, so block p
+        "subq %2, %%r9\n\t"                 // is stored at (p, r9)
+        "vmovdqu (%2), %%ymm2\n\t"          // First 32 bytes are known to be valid
+        "vmovdqu %%ymm2, (%1)\n\t"          // Store them
+        "vmovdqu %%ymm1, (%%rsi,%%r9)\n\t"  // Store the second block
+        "leaq -128(%%rdx), %%r11\n\t"       // r11 = last p whose group fits the bound
+        "subq $32, %%rdx\n\t"               // rdx = last p whose block fits the bound
+        "30:\n\t"                           // next_block
+        "addq $32, %%rsi\n\t"               // Advance p
+        "32:\n\t"                           // check_block
+        "cmpq %%rdx, %%rsi\n\t"             // Block crosses the bound?
+        "ja 5f\n\t"                         // Yes, handle the tail
+        "testq $127, %%rsi\n\t"             // Reached a 128-byte boundary?
+        "jz 40f\n\t"                        // Yes, try the unrolled loop
+        "31:\n\t"                           // single_block: 32 bytes
+        "vmovdqa (%%rsi), %%ymm1\n\t"       // Aligned 32-byte block
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm2\n\t"  // 0xFF where byte == 0
+        "vpmovmskb %%ymm2, %%r8d\n\t"       // One bit per byte
+        "testl %%r8d, %%r8d\n\t"            // Any terminator?
+        "jnz 4f\n\t"                        // Yes, finish
+        "vmovdqu %%ymm1, (%%rsi,%%r9)\n\t"  // Store the block
+        "jmp 30b\n\t"                       // Continue
+        "40:\n\t"                           // group_loop: 128 bytes per iteration
+        "cmpq %%r11, %%rsi\n\t"             // Group crosses the bound?
+        "ja 31b\n\t"                        // Yes, finish block by block
+        "vmovdqa (%%rsi), %%ymm1\n\t"       // Block 0
+        "vmovdqa 32(%%rsi), %%ymm2\n\t"     // Block 1
+        "vmovdqa 64(%%rsi), %%ymm3\n\t"     // Block 2
+        "vmovdqa 96(%%rsi), %%ymm4\n\t"     // Block 3
+        "vpminub %%ymm2, %%ymm1, %%ymm5\n\t"  // min(block 0, block 1)
+        "vpminub %%ymm4, %%ymm3, %%ymm6\n\t"  // min(block 2, block 3)
+        "vpminub %%ymm6, %%ymm5, %%ymm5\n\t"  // A zero byte anywhere stays zero
+        "vpcmpeqb %%ymm0, %%ymm5, %%ymm5\n\t"  // Compare with zero
+        "vpmovmskb %%ymm5, %%r8d\n\t"       // Mask for the whole group
+        "testl %%r8d, %%r8d\n\t"            // Any terminator in the group?
+        "jnz 31b\n\t"                       // Yes, find it block by block
+        "vmovdqu %%ymm1, (%%rsi,%%r9)\n\t"  // Store block 0
+        "vmovdqu %%ymm2, 32(%%rsi,%%r9)\n\t"  // Store block 1
+        "vmovdqu %%ymm3, 64(%%rsi,%%r9)\n\t"  // Store block 2
+        "vmovdqu %%ymm4, 96(%%rsi,%%r9)\n\t"  // Store block 3
+        "addq $128, %%rsi\n\t"              // Next group
+        "jmp 32b\n\t"                       // Continue (the bound check runs first)
+        "4:\n\t"                            // terminator_in_loop
+        "tzcntl %%r8d, %%r8d\n\t"           // Index of the terminator
+        "leaq (%%rsi,%%r8), %%rax\n\t"      // Terminator address
+        "subq %2, %%rax\n\t"                // len (below n inside the loop)
+        "jmp 6f\n\t"                        // Copy the last bytes
+        "5:\n\t"                            // tail: block crosses the bound
+        "movq %3, %%rax\n\t"                // Default len = n
+        "leaq 32(%%rdx), %%r10\n\t"         // end
+        "cmpq %%r10, %%rsi\n\t"             // Block starts at or past the bound?
+        "jae 6f\n\t"                        // Yes, copy n bytes
+        "vmovdqa (%%rsi), %%ymm1\n\t"       // Aligned 32-byte block
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm2\n\t"  // 0xFF where byte == 0
+        "vpmovmskb %%ymm2, %%r8d\n\t"       // One bit per byte
+        "btsq $32, %%r8\n\t"                // Sentinel bit: block end
+        "tzcntq %%r8, %%r8\n\t"             // Terminator or block end
+        "leaq (%%rsi,%%r8), %%r10\n\t"      // Stop address
+        "subq %2, %%r10\n\t"                // Candidate len
+        "cmpq %%r10, %%rax\n\t"             // Stop before the bound?
+        "cmovaq %%r10, %%rax\n\t"           // Then len = candidate
+        "6:\n\t"                            // last_block: len >= 32
+        "vmovdqu -32(%2,%%rax), %%ymm1\n\t" // Last 32 bytes before the stop
+        "vmovdqu %%ymm1, -32(%1,%%rax)\n\t" // overlap bytes already stored
+        "jmp 9f\n\t"                        // Terminate
+        "7:\n\t"                            // bound_reached
+        "movq %3, %%rax\n\t"                // len = n
+        "8:\n\t"                            // short_copy: len < 64, overlapping loads
+        "cmpq $32, %%rax\n\t"               // At least 32 bytes?
+        "jb 81f\n\t"
+        "vmovdqu (%2), %%ymm1\n\t"          // Head
+        "vmovdqu -32(%2,%%rax), %%ymm2\n\t" // Tail (may overlap the head)
+        "vmovdqu %%ymm1, (%1)\n\t"
+        "vmovdqu %%ymm2, -32(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "81:\n\t"
+        "cmpq $16, %%rax\n\t"               // At least 16 bytes?
+        "jb 82f\n\t"
+        "vmovdqu (%2), %%xmm1\n\t"          // Head
+        "vmovdqu -16(%2,%%rax), %%xmm2\n\t" // Tail (may overlap the head)
+        "vmovdqu %%xmm1, (%1)\n\t"
+        "vmovdqu %%xmm2, -16(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "82:\n\t"
+        "cmpq $8, %%rax\n\t"                // At least 8 bytes?
+        "jb 83f\n\t"
+        "movq (%2), %%rcx\n\t"              // Head
+        "movq -8(%2,%%rax), %%r8\n\t"       // Tail
+        "movq %%rcx, (%1)\n\t"
+        "movq %%r8, -8(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "83:\n\t"
+        "cmpq $4, %%rax\n\t"                // At least 4 bytes?
+        "jb 84f\n\t"
+        "movl (%2), %%ecx\n\t"              // Head
+        "movl -4(%2,%%rax), %%r8d\n\t"      // Tail
+        "movl %%ecx, (%1)\n\t"
+        "movl %%r8d, -4(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "84:\n\t"
+        "cmpq $2, %%rax\n\t"                // At least 2 bytes?
+        "jb 85f\n\t"
+        "movzwl (%2), %%ecx\n\t"            // Head
+        "movzwl -2(%2,%%rax), %%r8d\n\t"    // Tail
+        "movw %%cx, (%1)\n\t"
+        "movw %%r8w, -2(%1,%%rax)\n\t"
+        "jmp 9f\n\t"
+        "85:\n\t"                           // zero or one byte
+        "testq %%rax, %%rax\n\t"            // Empty?
+        "jz 9f\n\t"
+        "movzbl (%2), %%ecx\n\t"            // Single byte
+        "movb %%cl, (%1)\n\t"
+        "9:\n\t"                            // terminate
+        "movb $0, (%1,%%rax)\n\t"           // dest[len] = 0
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (len)
+        : "r" (dest), "r" (src), "r" (n)
+        : "rcx", "rdx", "rsi", "r8", "r9", "r10", "r11",
+          "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return len;
+}
+
+char* stpcpy_asm(char* dest, const char* src) {
+    return dest + ASSM_DISPATCH(strcpy_bounded)(dest, src, SIZE_MAX);
+}
+
+void strcpy_asm(char* dest, const char* src) {
+    ASSM_DISPATCH(strcpy_bounded)(dest, src, SIZE_MAX);
+}
+
+size_t strlcpy_asm(char* dest, const char* src, size_t size) {
+    if (size == 0) return strlen_asm(src);
+    size_t copied = ASSM_DISPATCH(strcpy_bounded)(dest, src, size - 1);
+    if (copied < size - 1) return copied;
+    return copied + strlen_asm(src + copied);   // Truncated: finish the length
+}
+
+ptrdiff_t strscpy_asm(char* dest, const char* src, size_t size) {
+    if (size == 0) return -1;
+    size_t copied = ASSM_DISPATCH(strcpy_bounded)(dest, src, size - 1);
+    if (copied < size - 1 || src[copied] == '\0') return (ptrdiff_t)copied;
+    return -1;
+}
+
+// One byte per iteration in microcode; kept as the tutorial reference
+int memcmp_cmpsb(const void* ptr1, const void* ptr2, size_t num) {
+    int result;
+    
+    __asm__ volatile (
+        "movq %1, %%rsi\n\t"        // Load ptr1 into RSI
+        "movq %2, %%rdi\n\t"        // Load ptr2 into RDI  
+        "movq %3, %%rcx\n\t"        // Load num into RCX
+        "xorl %%eax, %%eax\n\t"     // Default result = 0 (equal)
+        "testq %%rcx, %%rcx\n\t"    // Nothing to compare?
+        "jz 2f\n\t"                 // Then equal (repe leaves flags untouched)
+        "cld\n\t"                   // Clear direction flag
+        "repe cmpsb\n\t"            // Compare bytes while equal
+        "je 2f\n\t"                 // If equal, skip to end
+        "movl $-1, %%eax\n\t"       // Assume ptr1 < ptr2
+        "jb 2f\n\t"                 // If below, result = -1
+        "movl $1, %%eax\n\t"        // Otherwise ptr1 > ptr2, result = 1
+        "2:\n\t"                    // end
+        "movl %%eax, %0\n\t"        // Store result
+        : "=m" (result)
+        : "m" (ptr1), "m" (ptr2), "m" (num)
+        : "rax", "rcx", "rsi", "rdi", "memory"
+    );
+    
+    return result;
+}
+
+// Mismatch search: index of the first differing byte, or num when the
+// buffers are equal. memcmp_{sse2,avx2} run the same search and return the
+// difference of the first differing bytes instead. Inputs of at least two
+// vectors compare two blocks per iteration and finish with one block that
+// overlaps bytes already known to be equal. Shorter inputs use two
+// overlapping words, so a 16-64 byte key costs two or three compares. One
+// movemask/xor + tzcnt finds the byte; nothing is read when num == 0.
+
+size_t memcmp_mismatch_sse2(const void* ptr1, const void* ptr2, size_t num) {
+    size_t index;
+    
+    __asm__ volatile (
+        "cmpq $16, %3\n\t"                  // Short inputs take the word path
+        "jb 20f\n\t"
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $32, %3\n\t"                  // At least two blocks?
+        "jb 2f\n\t"                         // No, go to the tail
+        "1:\n\t"                            // pair_loop: 32 bytes per iteration
+        "movdqu (%1,%%rcx), %%xmm0\n\t"     // Load 16 bytes of a
+        "movdqu (%2,%%rcx), %%xmm3\n\t"     // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm0\n\t"        // 0xFF where a == b
+        "movdqu 16(%1,%%rcx), %%xmm1\n\t"   // Load 16 bytes of a
+        "movdqu 16(%2,%%rcx), %%xmm3\n\t"   // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm1\n\t"        // 0xFF where a == b
+        "movdqa %%xmm0, %%xmm2\n\t"         // Copy block 0 result
+        "pand %%xmm1, %%xmm2\n\t"           // Equal in both blocks
+        "pmovmskb %%xmm2, %%eax\n\t"        // One bit per equal byte
+        "xorl $0xFFFF, %%eax\n\t"           // Zero when all 32 bytes are equal
+        "jnz 3f\n\t"                        // Mismatch in this pair
+        "addq $32, %%rcx\n\t"               // Next pair
+        "leaq 32(%%rcx), %%r8\n\t"          // End of the next pair
+        "cmpq %3, %%r8\n\t"                 // Still inside the buffers?
+        "jbe 1b\n\t"                        // Yes, continue
+        "2:\n\t"                            // tail: fewer than 32 bytes left at RCX
+        "leaq 16(%%rcx), %%r8\n\t"          // End of one more block
+        "cmpq %3, %%r8\n\t"                 // Does a whole block fit?
+        "ja 4f\n\t"                         // No, only the overlapping last block
+        "movdqu (%1,%%rcx), %%xmm0\n\t"     // Load 16 bytes of a
+        "movdqu (%2,%%rcx), %%xmm3\n\t"     // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm0\n\t"        // 0xFF where a == b
+        "pmovmskb %%xmm0, %%eax\n\t"        // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in this block
+        "movq %%r8, %%rcx\n\t"              // Advance past the block
+        "4:\n\t"                            // last_block
+        "cmpq %3, %%rcx\n\t"                // Anything left?
+        "jae 9f\n\t"                        // No, buffers are equal
+        "movq %3, %%rcx\n\t"                // Last block ends at n
+        "subq $16, %%rcx\n\t"               // and overlaps bytes already known to be equal
+        "movdqu (%1,%%rcx), %%xmm0\n\t"     // Load 16 bytes of a
+        "movdqu (%2,%%rcx), %%xmm3\n\t"     // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm0\n\t"        // 0xFF where a == b
+        "pmovmskb %%xmm0, %%eax\n\t"        // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in the last block
+        "jmp 9f\n\t"                        // Buffers are equal
+        "3:\n\t"                            // locate: which block of the pair differs
+        "pmovmskb %%xmm0, %%eax\n\t"        // Block 0 equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in block 0
+        "addq $16, %%rcx\n\t"               // Otherwise block 1
+        "pmovmskb %%xmm1, %%eax\n\t"        // Block 1 equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "5:\n\t"                            // found: RCX = block offset, EAX = mismatch mask
+        "bsfl %%eax, %%eax\n\t"             // First differing byte in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + position
+        "jmp 10f\n\t"                       // Done
+        "20:\n\t"                           // short: fewer than 16 bytes
+        "22:\n\t"                           // 8-15 bytes: two overlapping 64-bit words
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $8, %3\n\t"
+        "jb 24f\n\t"
+        "movq (%1), %%rax\n\t"              // First word of a
+        "xorq (%2), %%rax\n\t"              // Set bits where a and b differ
+        "jnz 25f\n\t"                       // Mismatch in the first word
+        "movq %3, %%rcx\n\t"                // Last word ends at n
+        "subq $8, %%rcx\n\t"
+        "movq (%1,%%rcx), %%rax\n\t"        // Last word of a
+        "xorq (%2,%%rcx), %%rax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "25:\n\t"                           // word_found: RCX = offset, RAX = xor
+        "bsfq %%rax, %%rax\n\t"             // Lowest differing bit (little-endian: first byte)
+        "shrq $3, %%rax\n\t"                // Bit index -> byte index
+        "addq %%rcx, %%rax\n\t"             // Index = word offset + byte
+        "jmp 10f\n\t"                       // Done
+        "24:\n\t"                           // 4-7 bytes: two overlapping 32-bit words
+        "cmpq $4, %3\n\t"
+        "jb 26f\n\t"
+        "movl (%1), %%eax\n\t"              // First dword of a
+        "xorl (%2), %%eax\n\t"              // Set bits where a and b differ
+        "jnz 25b\n\t"                       // Mismatch in the first dword
+        "movq %3, %%rcx\n\t"                // Last dword ends at n
+        "subq $4, %%rcx\n\t"
+        "movl (%1,%%rcx), %%eax\n\t"        // Last dword of a
+        "xorl (%2,%%rcx), %%eax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "jmp 25b\n\t"                       // Locate the byte
+        "26:\n\t"                           // 0-3 bytes: one at a time (n == 0 reads nothing)
+        "cmpq %3, %%rcx\n\t"                // Past the end?
+        "jae 9f\n\t"                        // Yes, buffers are equal
+        "movzbl (%1,%%rcx), %%eax\n\t"      // Byte of a
+        "cmpb (%2,%%rcx), %%al\n\t"         // Compare with byte of b
+        "jne 28f\n\t"                       // Found the mismatch
+        "incq %%rcx\n\t"                    // Next byte
+        "jmp 26b\n\t"
+        "28:\n\t"
+        "movq %%rcx, %%rax\n\t"             // Index of the mismatch
+        "jmp 10f\n\t"                       // Done
+        "9:\n\t"                            // equal
+        "movq %3, %%rax\n\t"                // No mismatch: index = n
+        "10:\n\t"                           // end
+        : "=&a" (index)
+        : "r" (ptr1), "r" (ptr2), "r" (num)
+        : "rcx", "r8", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+    
+    return index;
+}
+
+size_t memcmp_mismatch_avx2(const void* ptr1, const void* ptr2, size_t num) {
+    size_t index;
+    
+    __asm__ volatile (
+        "cmpq $32, %3\n\t"                  // Short inputs take the word path
+        "jb 20f\n\t"
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $64, %3\n\t"                  // At least two blocks?
+        "jb 2f\n\t"                         // No, go to the tail
+        "1:\n\t"                            // pair_loop: 64 bytes per iteration
+        "vmovdqu (%1,%%rcx), %%ymm0\n\t"    // Load 32 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%ymm0, %%ymm0\n\t"  // 0xFF where a == b
+        "vmovdqu 32(%1,%%rcx), %%ymm1\n\t"  // Load 32 bytes of a
+        "vpcmpeqb 32(%2,%%rcx), %%ymm1, %%ymm1\n\t"  // 0xFF where a == b
+        "vpand %%ymm1, %%ymm0, %%ymm2\n\t"  // Equal in both blocks
+        "vpmovmskb %%ymm2, %%eax\n\t"       // One bit per equal byte
+        "incl %%eax\n\t"                    // All-equal 0xFFFFFFFF wraps to zero
+        "jnz 3f\n\t"                        // Mismatch in this pair
+        "addq $64, %%rcx\n\t"               // Next pair
+        "leaq 64(%%rcx), %%r8\n\t"          // End of the next pair
+        "cmpq %3, %%r8\n\t"                 // Still inside the buffers?
+        "jbe 1b\n\t"                        // Yes, continue
+        "2:\n\t"                            // tail: fewer than 64 bytes left at RCX
+        "leaq 32(%%rcx), %%r8\n\t"          // End of one more block
+        "cmpq %3, %%r8\n\t"                 // Does a whole block fit?
+        "ja 4f\n\t"                         // No, only the overlapping last block
+        "vmovdqu (%1,%%rcx), %%ymm0\n\t"    // Load 32 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%ymm0, %%ymm0\n\t"  // 0xFF where a == b
+        "vpmovmskb %%ymm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in this block
+        "movq %%r8, %%rcx\n\t"              // Advance past the block
+        "4:\n\t"                            // last_block
+        "cmpq %3, %%rcx\n\t"                // Anything left?
+        "jae 9f\n\t"                        // No, buffers are equal
+        "movq %3, %%rcx\n\t"                // Last block ends at n
+        "subq $32, %%rcx\n\t"               // and overlaps bytes already known to be equal
+        "vmovdqu (%1,%%rcx), %%ymm0\n\t"    // Load 32 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%ymm0, %%ymm0\n\t"  // 0xFF where a == b
+        "vpmovmskb %%ymm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in the last block
+        "jmp 9f\n\t"                        // Buffers are equal
+        "3:\n\t"                            // locate: which block of the pair differs
+        "vpmovmskb %%ymm0, %%eax\n\t"       // Block 0 equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in block 0
+        "addq $32, %%rcx\n\t"               // Otherwise block 1
+        "vpmovmskb %%ymm1, %%eax\n\t"       // Block 1 equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Mismatch mask
+        "5:\n\t"                            // found: RCX = block offset, EAX = mismatch mask
+        "tzcntl %%eax, %%eax\n\t"           // First differing byte in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + position
+        "jmp 10f\n\t"                       // Done
+        "20:\n\t"                           // short: fewer than 32 bytes
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $16, %3\n\t"                  // 16-31 bytes: two overlapping XMM blocks
+        "jb 22f\n\t"
+        "vmovdqu (%1), %%xmm0\n\t"          // First 16 bytes of a
+        "vpcmpeqb (%2), %%xmm0, %%xmm0\n\t" // 0xFF where a == b
+        "vpmovmskb %%xmm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "jnz 5b\n\t"                        // Mismatch in the first 16
+        "movq %3, %%rcx\n\t"                // Last 16 bytes end at n
+        "subq $16, %%rcx\n\t"
+        "vmovdqu (%1,%%rcx), %%xmm0\n\t"    // Last 16 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%xmm0, %%xmm0\n\t"  // 0xFF where a == b
+        "vpmovmskb %%xmm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "jnz 5b\n\t"                        // Mismatch in the last 16
+        "jmp 9f\n\t"                        // Buffers are equal
+        "22:\n\t"                           // 8-15 bytes: two overlapping 64-bit words
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $8, %3\n\t"
+        "jb 24f\n\t"
+        "movq (%1), %%rax\n\t"              // First word of a
+        "xorq (%2), %%rax\n\t"              // Set bits where a and b differ
+        "jnz 25f\n\t"                       // Mismatch in the first word
+        "movq %3, %%rcx\n\t"                // Last word ends at n
+        "subq $8, %%rcx\n\t"
+        "movq (%1,%%rcx), %%rax\n\t"        // Last word of a
+        "xorq (%2,%%rcx), %%rax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "25:\n\t"                           // word_found: RCX = offset, RAX = xor
+        "tzcntq %%rax, %%rax\n\t"           // Lowest differing bit (little-endian: first byte)
+        "shrq $3, %%rax\n\t"                // Bit index -> byte index
+        "addq %%rcx, %%rax\n\t"             // Index = word offset + byte
+        "jmp 10f\n\t"                       // Done
+        "24:\n\t"                           // 4-7 bytes: two overlapping 32-bit words
+        "cmpq $4, %3\n\t"
+        "jb 26f\n\t"
+        "movl (%1), %%eax\n\t"              // First dword of a
+        "xorl (%2), %%eax\n\t"              // Set bits where a and b differ
+        "jnz 25b\n\t"                       // Mismatch in the first dword
+        "movq %3, %%rcx\n\t"                // Last dword ends at n
+        "subq $4, %%rcx\n\t"
+        "movl (%1,%%rcx), %%eax\n\t"        // Last dword of a
+        "xorl (%2,%%rcx), %%eax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "jmp 25b\n\t"                       // Locate the byte
+        "26:\n\t"                           // 0-3 bytes: one at a time (n == 0 reads nothing)
+        "cmpq %3, %%rcx\n\t"                // Past the end?
+        "jae 9f\n\t"                        // Yes, buffers are equal
+        "movzbl (%1,%%rcx), %%eax\n\t"      // Byte of a
+        "cmpb (%2,%%rcx), %%al\n\t"         // Compare with byte of b
+        "jne 28f\n\t"                       // Found the mismatch
+        "incq %%rcx\n\t"                    // Next byte
+        "jmp 26b\n\t"
+        "28:\n\t"
+        "movq %%rcx, %%rax\n\t"             // Index of the mismatch
+        "jmp 10f\n\t"                       // Done
+        "9:\n\t"                            // equal
+        "movq %3, %%rax\n\t"                // No mismatch: index = n
+        "10:\n\t"                           // end
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (index)
+        : "r" (ptr1), "r" (ptr2), "r" (num)
+        : "rcx", "r8", "xmm0", "xmm1", "xmm2", "memory"
+    );
+    
+    return index;
+}
+
+int memcmp_sse2(const void* ptr1, const void* ptr2, size_t num) {
+    int result;
+    
+    __asm__ volatile (
+        "cmpq $16, %3\n\t"                  // Short inputs take the word path
+        "jb 20f\n\t"
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $32, %3\n\t"                  // At least two blocks?
+        "jb 2f\n\t"                         // No, go to the tail
+        "1:\n\t"                            // pair_loop: 32 bytes per iteration
+        "movdqu (%1,%%rcx), %%xmm0\n\t"     // Load 16 bytes of a
+        "movdqu (%2,%%rcx), %%xmm3\n\t"     // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm0\n\t"        // 0xFF where a == b
+        "movdqu 16(%1,%%rcx), %%xmm1\n\t"   // Load 16 bytes of a
+        "movdqu 16(%2,%%rcx), %%xmm3\n\t"   // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm1\n\t"        // 0xFF where a == b
+        "movdqa %%xmm0, %%xmm2\n\t"         // Copy block 0 result
+        "pand %%xmm1, %%xmm2\n\t"           // Equal in both blocks
+        "pmovmskb %%xmm2, %%eax\n\t"        // One bit per equal byte
+        "xorl $0xFFFF, %%eax\n\t"           // Zero when all 32 bytes are equal
+        "jnz 3f\n\t"                        // Mismatch in this pair
+        "addq $32, %%rcx\n\t"               // Next pair
+        "leaq 32(%%rcx), %%r8\n\t"          // End of the next pair
+        "cmpq %3, %%r8\n\t"                 // Still inside the buffers?
+        "jbe 1b\n\t"                        // Yes, continue
+        "2:\n\t"                            // tail: fewer than 32 bytes left at RCX
+        "leaq 16(%%rcx), %%r8\n\t"          // End of one more block
+        "cmpq %3, %%r8\n\t"                 // Does a whole block fit?
+        "ja 4f\n\t"                         // No, only the overlapping last block
+        "movdqu (%1,%%rcx), %%xmm0\n\t"     // Load 16 bytes of a
+        "movdqu (%2,%%rcx), %%xmm3\n\t"     // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm0\n\t"        // 0xFF where a == b
+        "pmovmskb %%xmm0, %%eax\n\t"        // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in this block
+        "movq %%r8, %%rcx\n\t"              // Advance past the block
+        "4:\n\t"                            // last_block
+        "cmpq %3, %%rcx\n\t"                // Anything left?
+        "jae 9f\n\t"                        // No, buffers are equal
+        "movq %3, %%rcx\n\t"                // Last block ends at n
+        "subq $16, %%rcx\n\t"               // and overlaps bytes already known to be equal
+        "movdqu (%1,%%rcx), %%xmm0\n\t"     // Load 16 bytes of a
+        "movdqu (%2,%%rcx), %%xmm3\n\t"     // Load 16 bytes of b
+        "pcmpeqb %%xmm3, %%xmm0\n\t"        // 0xFF where a == b
+        "pmovmskb %%xmm0, %%eax\n\t"        // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in the last block
+        "jmp 9f\n\t"                        // Buffers are equal
+        "3:\n\t"                            // locate: which block of the pair differs
+        "pmovmskb %%xmm0, %%eax\n\t"        // Block 0 equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in block 0
+        "addq $16, %%rcx\n\t"               // Otherwise block 1
+        "pmovmskb %%xmm1, %%eax\n\t"        // Block 1 equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "5:\n\t"                            // found: RCX = block offset, EAX = mismatch mask
+        "bsfl %%eax, %%eax\n\t"             // First differing byte in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + position
+        "jmp 11f\n\t"                       // Compute the byte difference
+        "20:\n\t"                           // short: fewer than 16 bytes
+        "22:\n\t"                           // 8-15 bytes: two overlapping 64-bit words
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $8, %3\n\t"
+        "jb 24f\n\t"
+        "movq (%1), %%rax\n\t"              // First word of a
+        "xorq (%2), %%rax\n\t"              // Set bits where a and b differ
+        "jnz 25f\n\t"                       // Mismatch in the first word
+        "movq %3, %%rcx\n\t"                // Last word ends at n
+        "subq $8, %%rcx\n\t"
+        "movq (%1,%%rcx), %%rax\n\t"        // Last word of a
+        "xorq (%2,%%rcx), %%rax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "25:\n\t"                           // word_found: RCX = offset, RAX = xor
+        "bsfq %%rax, %%rax\n\t"             // Lowest differing bit (little-endian: first byte)
+        "shrq $3, %%rax\n\t"                // Bit index -> byte index
+        "addq %%rcx, %%rax\n\t"             // Index = word offset + byte
+        "jmp 11f\n\t"                       // Compute the byte difference
+        "24:\n\t"                           // 4-7 bytes: two overlapping 32-bit words
+        "cmpq $4, %3\n\t"
+        "jb 26f\n\t"
+        "movl (%1), %%eax\n\t"              // First dword of a
+        "xorl (%2), %%eax\n\t"              // Set bits where a and b differ
+        "jnz 25b\n\t"                       // Mismatch in the first dword
+        "movq %3, %%rcx\n\t"                // Last dword ends at n
+        "subq $4, %%rcx\n\t"
+        "movl (%1,%%rcx), %%eax\n\t"        // Last dword of a
+        "xorl (%2,%%rcx), %%eax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "jmp 25b\n\t"                       // Locate the byte
+        "26:\n\t"                           // 0-3 bytes: one at a time (n == 0 reads nothing)
+        "cmpq %3, %%rcx\n\t"                // Past the end?
+        "jae 9f\n\t"                        // Yes, buffers are equal
+        "movzbl (%1,%%rcx), %%eax\n\t"      // Byte of a
+        "cmpb (%2,%%rcx), %%al\n\t"         // Compare with byte of b
+        "jne 28f\n\t"                       // Found the mismatch
+        "incq %%rcx\n\t"                    // Next byte
+        "jmp 26b\n\t"
+        "28:\n\t"
+        "movq %%rcx, %%rax\n\t"             // Index of the mismatch
+        "jmp 11f\n\t"                       // Compute the byte difference
+        "9:\n\t"                            // equal
+        "xorl %%eax, %%eax\n\t"             // Equal buffers compare as 0
+        "jmp 10f\n\t"
+        "11:\n\t"                           // difference: RAX = mismatch index
+        "movzbl (%1,%%rax), %%ecx\n\t"      // Byte of a
+        "movzbl (%2,%%rax), %%eax\n\t"      // Byte of b
+        "subl %%eax, %%ecx\n\t"             // a[i] - b[i] orders the buffers
+        "movl %%ecx, %%eax\n\t"             // Result
+        "10:\n\t"                           // end
+        : "=&a" (result)
+        : "r" (ptr1), "r" (ptr2), "r" (num)
+        : "rcx", "r8", "xmm0", "xmm1", "xmm2", "xmm3", "memory"
+    );
+    
+    return result;
+}
+
+int memcmp_avx2(const void* ptr1, const void* ptr2, size_t num) {
+    int result;
+    
+    __asm__ volatile (
+        "cmpq $32, %3\n\t"                  // Short inputs take the word path
+        "jb 20f\n\t"
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $64, %3\n\t"                  // At least two blocks?
+        "jb 2f\n\t"                         // No, go to the tail
+        "1:\n\t"                            // pair_loop: 64 bytes per iteration
+        "vmovdqu (%1,%%rcx), %%ymm0\n\t"    // Load 32 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%ymm0, %%ymm0\n\t"  // 0xFF where a == b
+        "vmovdqu 32(%1,%%rcx), %%ymm1\n\t"  // Load 32 bytes of a
+        "vpcmpeqb 32(%2,%%rcx), %%ymm1, %%ymm1\n\t"  // 0xFF where a == b
+        "vpand %%ymm1, %%ymm0, %%ymm2\n\t"  // Equal in both blocks
+        "vpmovmskb %%ymm2, %%eax\n\t"       // One bit per equal byte
+        "incl %%eax\n\t"                    // All-equal 0xFFFFFFFF wraps to zero
+        "jnz 3f\n\t"                        // Mismatch in this pair
+        "addq $64, %%rcx\n\t"               // Next pair
+        "leaq 64(%%rcx), %%r8\n\t"          // End of the next pair
+        "cmpq %3, %%r8\n\t"                 // Still inside the buffers?
+        "jbe 1b\n\t"                        // Yes, continue
+        "2:\n\t"                            // tail: fewer than 64 bytes left at RCX
+        "leaq 32(%%rcx), %%r8\n\t"          // End of one more block
+        "cmpq %3, %%r8\n\t"                 // Does a whole block fit?
+        "ja 4f\n\t"                         // No, only the overlapping last block
+        "vmovdqu (%1,%%rcx), %%ymm0\n\t"    // Load 32 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%ymm0, %%ymm0\n\t"  // 0xFF where a == b
+        "vpmovmskb %%ymm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in this block
+        "movq %%r8, %%rcx\n\t"              // Advance past the block
+        "4:\n\t"                            // last_block
+        "cmpq %3, %%rcx\n\t"                // Anything left?
+        "jae 9f\n\t"                        // No, buffers are equal
+        "movq %3, %%rcx\n\t"                // Last block ends at n
+        "subq $32, %%rcx\n\t"               // and overlaps bytes already known to be equal
+        "vmovdqu (%1,%%rcx), %%ymm0\n\t"    // Load 32 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%ymm0, %%ymm0\n\t"  // 0xFF where a == b
+        "vpmovmskb %%ymm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Now a mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in the last block
+        "jmp 9f\n\t"                        // Buffers are equal
+        "3:\n\t"                            // locate: which block of the pair differs
+        "vpmovmskb %%ymm0, %%eax\n\t"       // Block 0 equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Mismatch mask
+        "jnz 5f\n\t"                        // Mismatch in block 0
+        "addq $32, %%rcx\n\t"               // Otherwise block 1
+        "vpmovmskb %%ymm1, %%eax\n\t"       // Block 1 equal-byte mask
+        "xorl $-1, %%eax\n\t"               // Mismatch mask
+        "5:\n\t"                            // found: RCX = block offset, EAX = mismatch mask
+        "tzcntl %%eax, %%eax\n\t"           // First differing byte in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + position
+        "jmp 11f\n\t"                       // Compute the byte difference
+        "20:\n\t"                           // short: fewer than 32 bytes
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $16, %3\n\t"                  // 16-31 bytes: two overlapping XMM blocks
+        "jb 22f\n\t"
+        "vmovdqu (%1), %%xmm0\n\t"          // First 16 bytes of a
+        "vpcmpeqb (%2), %%xmm0, %%xmm0\n\t" // 0xFF where a == b
+        "vpmovmskb %%xmm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "jnz 5b\n\t"                        // Mismatch in the first 16
+        "movq %3, %%rcx\n\t"                // Last 16 bytes end at n
+        "subq $16, %%rcx\n\t"
+        "vmovdqu (%1,%%rcx), %%xmm0\n\t"    // Last 16 bytes of a
+        "vpcmpeqb (%2,%%rcx), %%xmm0, %%xmm0\n\t"  // 0xFF where a == b
+        "vpmovmskb %%xmm0, %%eax\n\t"       // Equal-byte mask
+        "xorl $0xFFFF, %%eax\n\t"           // Mismatch mask
+        "jnz 5b\n\t"                        // Mismatch in the last 16
+        "jmp 9f\n\t"                        // Buffers are equal
+        "22:\n\t"                           // 8-15 bytes: two overlapping 64-bit words
+        "xorl %%ecx, %%ecx\n\t"             // Offset = 0
+        "cmpq $8, %3\n\t"
+        "jb 24f\n\t"
+        "movq (%1), %%rax\n\t"              // First word of a
+        "xorq (%2), %%rax\n\t"              // Set bits where a and b differ
+        "jnz 25f\n\t"                       // Mismatch in the first word
+        "movq %3, %%rcx\n\t"                // Last word ends at n
+        "subq $8, %%rcx\n\t"
+        "movq (%1,%%rcx), %%rax\n\t"        // Last word of a
+        "xorq (%2,%%rcx), %%rax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "25:\n\t"                           // word_found: RCX = offset, RAX = xor
+        "tzcntq %%rax, %%rax\n\t"           // Lowest differing bit (little-endian: first byte)
+        "shrq $3, %%rax\n\t"                // Bit index -> byte index
+        "addq %%rcx, %%rax\n\t"             // Index = word offset + byte
+        "jmp 11f\n\t"                       // Compute the byte difference
+        "24:\n\t"                           // 4-7 bytes: two overlapping 32-bit words
+        "cmpq $4, %3\n\t"
+        "jb 26f\n\t"
+        "movl (%1), %%eax\n\t"              // First dword of a
+        "xorl (%2), %%eax\n\t"              // Set bits where a and b differ
+        "jnz 25b\n\t"                       // Mismatch in the first dword
+        "movq %3, %%rcx\n\t"                // Last dword ends at n
+        "subq $4, %%rcx\n\t"
+        "movl (%1,%%rcx), %%eax\n\t"        // Last dword of a
+        "xorl (%2,%%rcx), %%eax\n\t"        // Set bits where a and b differ
+        "jz 9f\n\t"                         // Buffers are equal
+        "jmp 25b\n\t"                       // Locate the byte
+        "26:\n\t"                           // 0-3 bytes: one at a time (n == 0 reads nothing)
+        "cmpq %3, %%rcx\n\t"                // Past the end?
+        "jae 9f\n\t"                        // Yes, buffers are equal
+        "movzbl (%1,%%rcx), %%eax\n\t"      // Byte of a
+        "cmpb (%2,%%rcx), %%al\n\t"         // Compare with byte of b
+        "jne 28f\n\t"                       // Found the mismatch
+        "incq %%rcx\n\t"                    // Next byte
+        "jmp 26b\n\t"
+        "28:\n\t"
+        "movq %%rcx, %%rax\n\t"             // Index of the mismatch
+        "jmp 11f\n\t"                       // Compute the byte difference
+        "9:\n\t"                            // equal
+        "xorl %%eax, %%eax\n\t"             // Equal buffers compare as 0
+        "jmp 10f\n\t"
+        "11:\n\t"                           // difference: RAX = mismatch index
+        "movzbl (%1,%%rax), %%ecx\n\t"      // Byte of a
+        "movzbl (%2,%%rax), %%eax\n\t"      // Byte of b
+        "subl %%eax, %%ecx\n\t"             // a[i] - b[i] orders the buffers
+        "movl %%ecx, %%eax\n\t"             // Result
+        "10:\n\t"                           // end
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (result)
+        : "r" (ptr1), "r" (ptr2), "r" (num)
+        : "rcx", "r8", "xmm0", "xmm1", "xmm2", "memory"
+    );
+    
+    return result;
+}
+
+size_t memcmp_mismatch_asm(const void* ptr1, const void* ptr2, size_t num) {
+    return ASSM_DISPATCH(memcmp_mismatch)(ptr1, ptr2, num);
+}
+
+int memcmp_asm(const void* ptr1, const void* ptr2, size_t num) {
+    return ASSM_DISPATCH(memcmp)(ptr1, ptr2, num);
+}
+
+// Byte search: index of the first byte equal to any needle, or n when there
+// is none. The scan is strnlen's with the compare against zero replaced by
+// one compare per needle (OR-ed together), so blocks stay aligned and
+// page-safe and the bound is checked before each block or group. Within a
+// group the per-block match vectors are kept, so locating the block needs no
+// second pass over memory.
+
+size_t memchr_index_sse2(const void* ptr, int c, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "movd %3, %%xmm0\n\t"               // Needle byte
+        "punpcklbw %%xmm0, %%xmm0\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm0, %%xmm0\n\t"      // 4 bytes
+        "pshufd $0, %%xmm0, %%xmm0\n\t"     // 16 bytes
+        "movq %1, %%rdi\n\t"                // Block pointer starts at ptr
+        "andq $-16, %%rdi\n\t"              // Round down to a 16-byte boundary
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle
+        "pmovmskb %%xmm1, %%eax\n\t"        // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of ptr
+        "andl $15, %%ecx\n\t"               // Offset of ptr in the block
+        "shrl %%cl, %%eax\n\t"              // Drop bytes before ptr
+        "testl %%eax, %%eax\n\t"            // Match in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "bsfl %%eax, %%eax\n\t"             // Index relative to ptr
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "1:\n\t"                            // single_blocks
+        "addq $16, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past n?
+        "jae 7f\n\t"                        // Yes, not found
+        "testq $63, %%rdi\n\t"              // Reached a 64-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle
+        "pmovmskb %%xmm1, %%ecx\n\t"        // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 64 bytes per iteration
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle
+        "movdqa 16(%%rdi), %%xmm2\n\t"      // Load block
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // Match needle
+        "movdqa 32(%%rdi), %%xmm3\n\t"      // Load block
+        "pcmpeqb %%xmm0, %%xmm3\n\t"        // Match needle
+        "movdqa 48(%%rdi), %%xmm4\n\t"      // Load block
+        "pcmpeqb %%xmm0, %%xmm4\n\t"        // Match needle
+        "movdqa %%xmm1, %%xmm5\n\t"         // Combine blocks 0 and 1
+        "por %%xmm2, %%xmm5\n\t"
+        "movdqa %%xmm3, %%xmm6\n\t"         // Combine blocks 2 and 3
+        "por %%xmm4, %%xmm6\n\t"
+        "por %%xmm6, %%xmm5\n\t"            // Any match in the group
+        "pmovmskb %%xmm5, %%ecx\n\t"        // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any match in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "addq $64, %%rdi\n\t"               // Next group
+        "addq $64, %%rax\n\t"               // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past n?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, not found
+        "3:\n\t"                            // locate_block
+        "pmovmskb %%xmm1, %%ecx\n\t"        // Block 0
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm2, %%ecx\n\t"        // Block 1
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm3, %%ecx\n\t"        // Block 2
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm4, %%ecx\n\t"        // Block 3 (must hold the match)
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "bsfl %%ecx, %%ecx\n\t"             // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + index
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "8:\n\t"                            // bound
+        "cmpq %2, %%rax\n\t"                // Match past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then it does not count
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return index;
+}
+
+size_t memchr_index_avx2(const void* ptr, int c, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "vmovd %3, %%xmm0\n\t"              // Needle byte
+        "vpbroadcastb %%xmm0, %%ymm0\n\t"   // in every byte
+        "movq %1, %%rdi\n\t"                // Block pointer starts at ptr
+        "andq $-32, %%rdi\n\t"              // Round down to a 32-byte boundary
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle
+        "vpmovmskb %%ymm1, %%eax\n\t"       // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of ptr
+        "andl $31, %%ecx\n\t"               // Offset of ptr in the block
+        "shrxl %%ecx, %%eax, %%eax\n\t"     // Drop bytes before ptr
+        "testl %%eax, %%eax\n\t"            // Match in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "tzcntl %%eax, %%eax\n\t"           // Index relative to ptr
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "1:\n\t"                            // single_blocks
+        "addq $32, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past n?
+        "jae 7f\n\t"                        // Yes, not found
+        "testq $127, %%rdi\n\t"             // Reached a 128-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle
+        "vpmovmskb %%ymm1, %%ecx\n\t"       // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 128 bytes per iteration
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle
+        "vpcmpeqb 32(%%rdi), %%ymm0, %%ymm2\n\t"  // Match needle
+        "vpcmpeqb 64(%%rdi), %%ymm0, %%ymm3\n\t"  // Match needle
+        "vpcmpeqb 96(%%rdi), %%ymm0, %%ymm4\n\t"  // Match needle
+        "vpor %%ymm2, %%ymm1, %%ymm5\n\t"   // Combine blocks 0 and 1
+        "vpor %%ymm4, %%ymm3, %%ymm6\n\t"   // Combine blocks 2 and 3
+        "vpor %%ymm6, %%ymm5, %%ymm5\n\t"   // Any match in the group
+        "vpmovmskb %%ymm5, %%ecx\n\t"       // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any match in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "subq $-128, %%rdi\n\t"             // Next group
+        "subq $-128, %%rax\n\t"             // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past n?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, not found
+        "3:\n\t"                            // locate_block
+        "vpmovmskb %%ymm1, %%ecx\n\t"       // Block 0
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm2, %%ecx\n\t"       // Block 1
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm3, %%ecx\n\t"       // Block 2
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm4, %%ecx\n\t"       // Block 3 (must hold the match)
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "tzcntl %%ecx, %%ecx\n\t"           // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + index
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "8:\n\t"                            // bound
+        "cmpq %2, %%rax\n\t"                // Match past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then it does not count
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return index;
+}
+
+size_t memchr2_index_sse2(const void* ptr, int c1, int c2, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "movd %3, %%xmm0\n\t"               // Needle 1
+        "punpcklbw %%xmm0, %%xmm0\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm0, %%xmm0\n\t"      // 4 bytes
+        "pshufd $0, %%xmm0, %%xmm0\n\t"     // 16 bytes
+        "movd %4, %%xmm8\n\t"               // Needle 2
+        "punpcklbw %%xmm8, %%xmm8\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm8, %%xmm8\n\t"      // 4 bytes
+        "pshufd $0, %%xmm8, %%xmm8\n\t"     // 16 bytes
+        "movq %1, %%rdi\n\t"                // Block pointer starts at ptr
+        "andq $-16, %%rdi\n\t"              // Round down to a 16-byte boundary
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "movdqa %%xmm1, %%xmm10\n\t"        // Copy for the next needle
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm1\n\t"
+        "pmovmskb %%xmm1, %%eax\n\t"        // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of ptr
+        "andl $15, %%ecx\n\t"               // Offset of ptr in the block
+        "shrl %%cl, %%eax\n\t"              // Drop bytes before ptr
+        "testl %%eax, %%eax\n\t"            // Match in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "bsfl %%eax, %%eax\n\t"             // Index relative to ptr
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "1:\n\t"                            // single_blocks
+        "addq $16, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past n?
+        "jae 7f\n\t"                        // Yes, not found
+        "testq $63, %%rdi\n\t"              // Reached a 64-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "movdqa %%xmm1, %%xmm10\n\t"        // Copy for the next needle
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm1\n\t"
+        "pmovmskb %%xmm1, %%ecx\n\t"        // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 64 bytes per iteration
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "movdqa %%xmm1, %%xmm10\n\t"        // Copy for the next needle
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm1\n\t"
+        "movdqa 16(%%rdi), %%xmm2\n\t"      // Load block
+        "movdqa %%xmm2, %%xmm10\n\t"        // Copy for the next needle
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm2\n\t"
+        "movdqa 32(%%rdi), %%xmm3\n\t"      // Load block
+        "movdqa %%xmm3, %%xmm10\n\t"        // Copy for the next needle
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm0, %%xmm3\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm3\n\t"
+        "movdqa 48(%%rdi), %%xmm4\n\t"      // Load block
+        "movdqa %%xmm4, %%xmm10\n\t"        // Copy for the next needle
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm0, %%xmm4\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm4\n\t"
+        "movdqa %%xmm1, %%xmm5\n\t"         // Combine blocks 0 and 1
+        "por %%xmm2, %%xmm5\n\t"
+        "movdqa %%xmm3, %%xmm6\n\t"         // Combine blocks 2 and 3
+        "por %%xmm4, %%xmm6\n\t"
+        "por %%xmm6, %%xmm5\n\t"            // Any match in the group
+        "pmovmskb %%xmm5, %%ecx\n\t"        // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any match in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "addq $64, %%rdi\n\t"               // Next group
+        "addq $64, %%rax\n\t"               // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past n?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, not found
+        "3:\n\t"                            // locate_block
+        "pmovmskb %%xmm1, %%ecx\n\t"        // Block 0
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm2, %%ecx\n\t"        // Block 1
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm3, %%ecx\n\t"        // Block 2
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm4, %%ecx\n\t"        // Block 3 (must hold the match)
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "bsfl %%ecx, %%ecx\n\t"             // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + index
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "8:\n\t"                            // bound
+        "cmpq %2, %%rax\n\t"                // Match past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then it does not count
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c1), "r" (c2)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm8", "xmm10", "memory"
+    );
+    
+    return index;
+}
+
+size_t memchr2_index_avx2(const void* ptr, int c1, int c2, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "vmovd %3, %%xmm0\n\t"              // Needle 1
+        "vpbroadcastb %%xmm0, %%ymm0\n\t"   // in every byte
+        "vmovd %4, %%xmm8\n\t"              // Needle 2
+        "vpbroadcastb %%xmm8, %%ymm8\n\t"   // in every byte
+        "movq %1, %%rdi\n\t"                // Block pointer starts at ptr
+        "andq $-32, %%rdi\n\t"              // Round down to a 32-byte boundary
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle 1
+        "vpcmpeqb (%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpmovmskb %%ymm1, %%eax\n\t"       // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of ptr
+        "andl $31, %%ecx\n\t"               // Offset of ptr in the block
+        "shrxl %%ecx, %%eax, %%eax\n\t"     // Drop bytes before ptr
+        "testl %%eax, %%eax\n\t"            // Match in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "tzcntl %%eax, %%eax\n\t"           // Index relative to ptr
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "1:\n\t"                            // single_blocks
+        "addq $32, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past n?
+        "jae 7f\n\t"                        // Yes, not found
+        "testq $127, %%rdi\n\t"             // Reached a 128-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle 1
+        "vpcmpeqb (%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpmovmskb %%ymm1, %%ecx\n\t"       // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 128 bytes per iteration
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle 1
+        "vpcmpeqb (%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpcmpeqb 32(%%rdi), %%ymm0, %%ymm2\n\t"  // Match needle 1
+        "vpcmpeqb 32(%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm2, %%ymm2\n\t"
+        "vpcmpeqb 64(%%rdi), %%ymm0, %%ymm3\n\t"  // Match needle 1
+        "vpcmpeqb 64(%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm3, %%ymm3\n\t"
+        "vpcmpeqb 96(%%rdi), %%ymm0, %%ymm4\n\t"  // Match needle 1
+        "vpcmpeqb 96(%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm4, %%ymm4\n\t"
+        "vpor %%ymm2, %%ymm1, %%ymm5\n\t"   // Combine blocks 0 and 1
+        "vpor %%ymm4, %%ymm3, %%ymm6\n\t"   // Combine blocks 2 and 3
+        "vpor %%ymm6, %%ymm5, %%ymm5\n\t"   // Any match in the group
+        "vpmovmskb %%ymm5, %%ecx\n\t"       // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any match in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "subq $-128, %%rdi\n\t"             // Next group
+        "subq $-128, %%rax\n\t"             // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past n?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, not found
+        "3:\n\t"                            // locate_block
+        "vpmovmskb %%ymm1, %%ecx\n\t"       // Block 0
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm2, %%ecx\n\t"       // Block 1
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm3, %%ecx\n\t"       // Block 2
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm4, %%ecx\n\t"       // Block 3 (must hold the match)
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "tzcntl %%ecx, %%ecx\n\t"           // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + index
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "8:\n\t"                            // bound
+        "cmpq %2, %%rax\n\t"                // Match past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then it does not count
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c1), "r" (c2)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm8", "xmm10", "memory"
+    );
+    
+    return index;
+}
+
+size_t memchr3_index_sse2(const void* ptr, int c1, int c2, int c3, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "movd %3, %%xmm0\n\t"               // Needle 1
+        "punpcklbw %%xmm0, %%xmm0\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm0, %%xmm0\n\t"      // 4 bytes
+        "pshufd $0, %%xmm0, %%xmm0\n\t"     // 16 bytes
+        "movd %4, %%xmm8\n\t"               // Needle 2
+        "punpcklbw %%xmm8, %%xmm8\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm8, %%xmm8\n\t"      // 4 bytes
+        "pshufd $0, %%xmm8, %%xmm8\n\t"     // 16 bytes
+        "movd %5, %%xmm9\n\t"               // Needle 3
+        "punpcklbw %%xmm9, %%xmm9\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm9, %%xmm9\n\t"      // 4 bytes
+        "pshufd $0, %%xmm9, %%xmm9\n\t"     // 16 bytes
+        "movq %1, %%rdi\n\t"                // Block pointer starts at ptr
+        "andq $-16, %%rdi\n\t"              // Round down to a 16-byte boundary
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "movdqa %%xmm1, %%xmm10\n\t"        // Copy for the next needle
+        "movdqa %%xmm1, %%xmm11\n\t"
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm9, %%xmm11\n\t"       // Match needle 3
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm1\n\t"
+        "por %%xmm11, %%xmm1\n\t"
+        "pmovmskb %%xmm1, %%eax\n\t"        // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of ptr
+        "andl $15, %%ecx\n\t"               // Offset of ptr in the block
+        "shrl %%cl, %%eax\n\t"              // Drop bytes before ptr
+        "testl %%eax, %%eax\n\t"            // Match in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "bsfl %%eax, %%eax\n\t"             // Index relative to ptr
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "1:\n\t"                            // single_blocks
+        "addq $16, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past n?
+        "jae 7f\n\t"                        // Yes, not found
+        "testq $63, %%rdi\n\t"              // Reached a 64-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "movdqa %%xmm1, %%xmm10\n\t"        // Copy for the next needle
+        "movdqa %%xmm1, %%xmm11\n\t"
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm9, %%xmm11\n\t"       // Match needle 3
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm1\n\t"
+        "por %%xmm11, %%xmm1\n\t"
+        "pmovmskb %%xmm1, %%ecx\n\t"        // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 64 bytes per iteration
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "movdqa %%xmm1, %%xmm10\n\t"        // Copy for the next needle
+        "movdqa %%xmm1, %%xmm11\n\t"
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm9, %%xmm11\n\t"       // Match needle 3
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm1\n\t"
+        "por %%xmm11, %%xmm1\n\t"
+        "movdqa 16(%%rdi), %%xmm2\n\t"      // Load block
+        "movdqa %%xmm2, %%xmm10\n\t"        // Copy for the next needle
+        "movdqa %%xmm2, %%xmm11\n\t"
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm9, %%xmm11\n\t"       // Match needle 3
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm2\n\t"
+        "por %%xmm11, %%xmm2\n\t"
+        "movdqa 32(%%rdi), %%xmm3\n\t"      // Load block
+        "movdqa %%xmm3, %%xmm10\n\t"        // Copy for the next needle
+        "movdqa %%xmm3, %%xmm11\n\t"
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm9, %%xmm11\n\t"       // Match needle 3
+        "pcmpeqb %%xmm0, %%xmm3\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm3\n\t"
+        "por %%xmm11, %%xmm3\n\t"
+        "movdqa 48(%%rdi), %%xmm4\n\t"      // Load block
+        "movdqa %%xmm4, %%xmm10\n\t"        // Copy for the next needle
+        "movdqa %%xmm4, %%xmm11\n\t"
+        "pcmpeqb %%xmm8, %%xmm10\n\t"       // Match needle 2
+        "pcmpeqb %%xmm9, %%xmm11\n\t"       // Match needle 3
+        "pcmpeqb %%xmm0, %%xmm4\n\t"        // Match needle 1
+        "por %%xmm10, %%xmm4\n\t"
+        "por %%xmm11, %%xmm4\n\t"
+        "movdqa %%xmm1, %%xmm5\n\t"         // Combine blocks 0 and 1
+        "por %%xmm2, %%xmm5\n\t"
+        "movdqa %%xmm3, %%xmm6\n\t"         // Combine blocks 2 and 3
+        "por %%xmm4, %%xmm6\n\t"
+        "por %%xmm6, %%xmm5\n\t"            // Any match in the group
+        "pmovmskb %%xmm5, %%ecx\n\t"        // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any match in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "addq $64, %%rdi\n\t"               // Next group
+        "addq $64, %%rax\n\t"               // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past n?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, not found
+        "3:\n\t"                            // locate_block
+        "pmovmskb %%xmm1, %%ecx\n\t"        // Block 0
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm2, %%ecx\n\t"        // Block 1
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm3, %%ecx\n\t"        // Block 2
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $16, %%rax\n\t"
+        "pmovmskb %%xmm4, %%ecx\n\t"        // Block 3 (must hold the match)
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "bsfl %%ecx, %%ecx\n\t"             // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + index
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "8:\n\t"                            // bound
+        "cmpq %2, %%rax\n\t"                // Match past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then it does not count
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c1), "r" (c2), "r" (c3)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm8", "xmm9", "xmm10", "xmm11", "memory"
+    );
+    
+    return index;
+}
+
+size_t memchr3_index_avx2(const void* ptr, int c1, int c2, int c3, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "vmovd %3, %%xmm0\n\t"              // Needle 1
+        "vpbroadcastb %%xmm0, %%ymm0\n\t"   // in every byte
+        "vmovd %4, %%xmm8\n\t"              // Needle 2
+        "vpbroadcastb %%xmm8, %%ymm8\n\t"   // in every byte
+        "vmovd %5, %%xmm9\n\t"              // Needle 3
+        "vpbroadcastb %%xmm9, %%ymm9\n\t"   // in every byte
+        "movq %1, %%rdi\n\t"                // Block pointer starts at ptr
+        "andq $-32, %%rdi\n\t"              // Round down to a 32-byte boundary
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle 1
+        "vpcmpeqb (%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpcmpeqb (%%rdi), %%ymm9, %%ymm10\n\t"  // Match needle 3
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpmovmskb %%ymm1, %%eax\n\t"       // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of ptr
+        "andl $31, %%ecx\n\t"               // Offset of ptr in the block
+        "shrxl %%ecx, %%eax, %%eax\n\t"     // Drop bytes before ptr
+        "testl %%eax, %%eax\n\t"            // Match in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "tzcntl %%eax, %%eax\n\t"           // Index relative to ptr
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "1:\n\t"                            // single_blocks
+        "addq $32, %%rdi\n\t"               // Next block
+        "movq %%rdi, %%rax\n\t"             // Block address
+        "subq %1, %%rax\n\t"                // Bytes before this block
+        "cmpq %2, %%rax\n\t"                // Block starts at or past n?
+        "jae 7f\n\t"                        // Yes, not found
+        "testq $127, %%rdi\n\t"             // Reached a 128-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle 1
+        "vpcmpeqb (%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpcmpeqb (%%rdi), %%ymm9, %%ymm10\n\t"  // Match needle 3
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpmovmskb %%ymm1, %%ecx\n\t"       // Mask
+        "testl %%ecx, %%ecx\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 6f\n\t"                        // Yes, add its index
+        "2:\n\t"                            // group_loop: 128 bytes per iteration
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle 1
+        "vpcmpeqb (%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpcmpeqb (%%rdi), %%ymm9, %%ymm10\n\t"  // Match needle 3
+        "vpor %%ymm10, %%ymm1, %%ymm1\n\t"
+        "vpcmpeqb 32(%%rdi), %%ymm0, %%ymm2\n\t"  // Match needle 1
+        "vpcmpeqb 32(%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm2, %%ymm2\n\t"
+        "vpcmpeqb 32(%%rdi), %%ymm9, %%ymm10\n\t"  // Match needle 3
+        "vpor %%ymm10, %%ymm2, %%ymm2\n\t"
+        "vpcmpeqb 64(%%rdi), %%ymm0, %%ymm3\n\t"  // Match needle 1
+        "vpcmpeqb 64(%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm3, %%ymm3\n\t"
+        "vpcmpeqb 64(%%rdi), %%ymm9, %%ymm10\n\t"  // Match needle 3
+        "vpor %%ymm10, %%ymm3, %%ymm3\n\t"
+        "vpcmpeqb 96(%%rdi), %%ymm0, %%ymm4\n\t"  // Match needle 1
+        "vpcmpeqb 96(%%rdi), %%ymm8, %%ymm10\n\t"  // Match needle 2
+        "vpor %%ymm10, %%ymm4, %%ymm4\n\t"
+        "vpcmpeqb 96(%%rdi), %%ymm9, %%ymm10\n\t"  // Match needle 3
+        "vpor %%ymm10, %%ymm4, %%ymm4\n\t"
+        "vpor %%ymm2, %%ymm1, %%ymm5\n\t"   // Combine blocks 0 and 1
+        "vpor %%ymm4, %%ymm3, %%ymm6\n\t"   // Combine blocks 2 and 3
+        "vpor %%ymm6, %%ymm5, %%ymm5\n\t"   // Any match in the group
+        "vpmovmskb %%ymm5, %%ecx\n\t"       // Mask for the whole group
+        "testl %%ecx, %%ecx\n\t"            // Any match in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "subq $-128, %%rdi\n\t"             // Next group
+        "subq $-128, %%rax\n\t"             // Offset of the next group
+        "cmpq %2, %%rax\n\t"                // Group starts at or past n?
+        "jb 2b\n\t"                         // No, continue
+        "jmp 7f\n\t"                        // Yes, not found
+        "3:\n\t"                            // locate_block
+        "vpmovmskb %%ymm1, %%ecx\n\t"       // Block 0
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm2, %%ecx\n\t"       // Block 1
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm3, %%ecx\n\t"       // Block 2
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 6f\n\t"
+        "addq $32, %%rax\n\t"
+        "vpmovmskb %%ymm4, %%ecx\n\t"       // Block 3 (must hold the match)
+        "6:\n\t"                            // found: RAX = block offset, ECX = mask
+        "tzcntl %%ecx, %%ecx\n\t"           // Index in the block
+        "addq %%rcx, %%rax\n\t"             // Index = block offset + index
+        "jmp 8f\n\t"                        // Check the bound and finish
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "8:\n\t"                            // bound
+        "cmpq %2, %%rax\n\t"                // Match past the bound?
+        "cmovaq %2, %%rax\n\t"              // Then it does not count
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c1), "r" (c2), "r" (c3)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm8", "xmm9", "xmm10", "memory"
+    );
+    
+    return index;
+}
+
+// strchr scans like strlen, without a bound: min(x ^ c, x) is zero exactly
+// where a byte is c or the terminator, so one compare with zero per group
+// (after pminub folds the four blocks) finds either. Returns the index of
+// the first stop; the caller checks which one it was.
+
+size_t strchr_index_sse2(const char* str, int c) {
+    size_t index;
+    
+    __asm__ volatile (
+        "movd %2, %%xmm7\n\t"               // Needle byte
+        "punpcklbw %%xmm7, %%xmm7\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm7, %%xmm7\n\t"      // 4 bytes
+        "pshufd $0, %%xmm7, %%xmm7\n\t"     // 16 bytes
+        "pxor %%xmm0, %%xmm0\n\t"           // xmm0 = 16 zero bytes
+        "movq %1, %%rdi\n\t"                // Block pointer starts at str
+        "andq $-16, %%rdi\n\t"              // Round down to a 16-byte boundary
+        "movdqa (%%rdi), %%xmm1\n\t"        // First (partial) block
+        "movdqa %%xmm1, %%xmm8\n\t"
+        "pxor %%xmm7, %%xmm8\n\t"           // Zero where byte == c
+        "pminub %%xmm8, %%xmm1\n\t"         // and where byte == 0
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // 0xFF where byte == c or 0
+        "pmovmskb %%xmm1, %%eax\n\t"        // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of str
+        "andl $15, %%ecx\n\t"               // Offset of str in the block
+        "shrl %%cl, %%eax\n\t"              // Drop bytes before str
+        "testl %%eax, %%eax\n\t"            // Stop in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "bsfl %%eax, %%eax\n\t"             // Index relative to str
+        "jmp 9f\n\t"                        // Done
+        "1:\n\t"                            // single_blocks
+        "addq $16, %%rdi\n\t"               // Next block
+        "testq $63, %%rdi\n\t"              // Reached a 64-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "movdqa %%xmm1, %%xmm8\n\t"
+        "pxor %%xmm7, %%xmm8\n\t"           // Zero where byte == c
+        "pminub %%xmm8, %%xmm1\n\t"         // and where byte == 0
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Compare with zero
+        "pmovmskb %%xmm1, %%eax\n\t"        // Mask
+        "testl %%eax, %%eax\n\t"            // Any stop?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 8f\n\t"                        // Yes, compute the index
+        "2:\n\t"                            // group_loop: 64 bytes per iteration
+        "movdqa (%%rdi), %%xmm1\n\t"        // Block 0
+        "movdqa %%xmm1, %%xmm8\n\t"
+        "pxor %%xmm7, %%xmm8\n\t"           // Zero where byte == c
+        "pminub %%xmm8, %%xmm1\n\t"         // and where byte == 0
+        "movdqa 16(%%rdi), %%xmm2\n\t"      // Block 1
+        "movdqa %%xmm2, %%xmm9\n\t"
+        "pxor %%xmm7, %%xmm9\n\t"           // Zero where byte == c
+        "pminub %%xmm9, %%xmm2\n\t"         // and where byte == 0
+        "movdqa 32(%%rdi), %%xmm3\n\t"      // Block 2
+        "movdqa %%xmm3, %%xmm10\n\t"
+        "pxor %%xmm7, %%xmm10\n\t"          // Zero where byte == c
+        "pminub %%xmm10, %%xmm3\n\t"        // and where byte == 0
+        "movdqa 48(%%rdi), %%xmm4\n\t"      // Block 3
+        "movdqa %%xmm4, %%xmm11\n\t"
+        "pxor %%xmm7, %%xmm11\n\t"          // Zero where byte == c
+        "pminub %%xmm11, %%xmm4\n\t"        // and where byte == 0
+        "movdqa %%xmm1, %%xmm5\n\t"         // Copy block 0
+        "pminub %%xmm2, %%xmm5\n\t"         // min(block 0, block 1)
+        "movdqa %%xmm3, %%xmm6\n\t"         // Copy block 2
+        "pminub %%xmm4, %%xmm6\n\t"         // min(block 2, block 3)
+        "pminub %%xmm6, %%xmm5\n\t"         // A zero byte anywhere stays zero
+        "pcmpeqb %%xmm0, %%xmm5\n\t"        // Compare with zero
+        "pmovmskb %%xmm5, %%eax\n\t"        // Mask for the whole group
+        "testl %%eax, %%eax\n\t"            // Any stop in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "addq $64, %%rdi\n\t"               // Next group
+        "jmp 2b\n\t"                        // Continue
+        "3:\n\t"                            // locate_block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Block 0
+        "pmovmskb %%xmm1, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $16, %%rdi\n\t"
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // Block 1
+        "pmovmskb %%xmm2, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $16, %%rdi\n\t"
+        "pcmpeqb %%xmm0, %%xmm3\n\t"        // Block 2
+        "pmovmskb %%xmm3, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $16, %%rdi\n\t"
+        "pcmpeqb %%xmm0, %%xmm4\n\t"        // Block 3 (must hold the stop)
+        "pmovmskb %%xmm4, %%eax\n\t"
+        "8:\n\t"                            // found: RDI = block, EAX = mask
+        "bsfl %%eax, %%eax\n\t"             // Index in the block
+        "addq %%rdi, %%rax\n\t"             // Address of the stop
+        "subq %1, %%rax\n\t"                // Index = stop - str
+        "9:\n\t"                            // end
+        : "=&a" (index)
+        : "r" (str), "r" (c)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "memory"
+    );
+    
+    return index;
+}
+
+size_t strchr_index_avx2(const char* str, int c) {
+    size_t index;
+    
+    __asm__ volatile (
+        "vmovd %2, %%xmm7\n\t"              // Needle byte
+        "vpbroadcastb %%xmm7, %%ymm7\n\t"   // in every byte
+        "vpxor %%xmm0, %%xmm0, %%xmm0\n\t"  // ymm0 = 32 zero bytes
+        "movq %1, %%rdi\n\t"                // Block pointer starts at str
+        "andq $-32, %%rdi\n\t"              // Round down to a 32-byte boundary
+        "vmovdqa (%%rdi), %%ymm1\n\t"       // First (partial) block
+        "vpxor %%ymm1, %%ymm7, %%ymm8\n\t"  // Zero where byte == c
+        "vpminub %%ymm8, %%ymm1, %%ymm1\n\t"  // and where byte == 0
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm1\n\t"  // 0xFF where byte == c or 0
+        "vpmovmskb %%ymm1, %%eax\n\t"       // One bit per byte
+        "movl %k1, %%ecx\n\t"               // Low bits of str
+        "andl $31, %%ecx\n\t"               // Offset of str in the block
+        "shrxl %%ecx, %%eax, %%eax\n\t"     // Drop bytes before str
+        "testl %%eax, %%eax\n\t"            // Stop in the first block?
+        "jz 1f\n\t"                         // No, keep scanning
+        "tzcntl %%eax, %%eax\n\t"           // Index relative to str
+        "jmp 9f\n\t"                        // Done
+        "1:\n\t"                            // single_blocks
+        "addq $32, %%rdi\n\t"               // Next block
+        "testq $127, %%rdi\n\t"             // Reached a 128-byte boundary?
+        "jz 2f\n\t"                         // Yes, switch to the unrolled loop
+        "vmovdqa (%%rdi), %%ymm1\n\t"       // Load block
+        "vpxor %%ymm1, %%ymm7, %%ymm8\n\t"  // Zero where byte == c
+        "vpminub %%ymm8, %%ymm1, %%ymm1\n\t"  // and where byte == 0
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm1\n\t"  // Compare with zero
+        "vpmovmskb %%ymm1, %%eax\n\t"       // Mask
+        "testl %%eax, %%eax\n\t"            // Any stop?
+        "jz 1b\n\t"                         // No, next block
+        "jmp 8f\n\t"                        // Yes, compute the index
+        "2:\n\t"                            // group_loop: 128 bytes per iteration
+        "vmovdqa (%%rdi), %%ymm1\n\t"       // Block 0
+        "vpxor %%ymm1, %%ymm7, %%ymm8\n\t"  // Zero where byte == c
+        "vpminub %%ymm8, %%ymm1, %%ymm1\n\t"  // and where byte == 0
+        "vmovdqa 32(%%rdi), %%ymm2\n\t"     // Block 1
+        "vpxor %%ymm2, %%ymm7, %%ymm9\n\t"  // Zero where byte == c
+        "vpminub %%ymm9, %%ymm2, %%ymm2\n\t"  // and where byte == 0
+        "vmovdqa 64(%%rdi), %%ymm3\n\t"     // Block 2
+        "vpxor %%ymm3, %%ymm7, %%ymm10\n\t" // Zero where byte == c
+        "vpminub %%ymm10, %%ymm3, %%ymm3\n\t"  // and where byte == 0
+        "vmovdqa 96(%%rdi), %%ymm4\n\t"     // Block 3
+        "vpxor %%ymm4, %%ymm7, %%ymm11\n\t" // Zero where byte == c
+        "vpminub %%ymm11, %%ymm4, %%ymm4\n\t"  // and where byte == 0
+        "vpminub %%ymm2, %%ymm1, %%ymm5\n\t"  // min(block 0, block 1)
+        "vpminub %%ymm4, %%ymm3, %%ymm6\n\t"  // min(block 2, block 3)
+        "vpminub %%ymm6, %%ymm5, %%ymm5\n\t"  // A zero byte anywhere stays zero
+        "vpcmpeqb %%ymm0, %%ymm5, %%ymm5\n\t"  // Compare with zero
+        "vpmovmskb %%ymm5, %%eax\n\t"       // Mask for the whole group
+        "testl %%eax, %%eax\n\t"            // Any stop in the group?
+        "jnz 3f\n\t"                        // Yes, find the block
+        "subq $-128, %%rdi\n\t"             // Next group
+        "jmp 2b\n\t"                        // Continue
+        "3:\n\t"                            // locate_block
+        "vpcmpeqb %%ymm0, %%ymm1, %%ymm1\n\t"  // Block 0
+        "vpmovmskb %%ymm1, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $32, %%rdi\n\t"
+        "vpcmpeqb %%ymm0, %%ymm2, %%ymm2\n\t"  // Block 1
+        "vpmovmskb %%ymm2, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $32, %%rdi\n\t"
+        "vpcmpeqb %%ymm0, %%ymm3, %%ymm3\n\t"  // Block 2
+        "vpmovmskb %%ymm3, %%eax\n\t"
+        "testl %%eax, %%eax\n\t"
+        "jnz 8f\n\t"
+        "addq $32, %%rdi\n\t"
+        "vpcmpeqb %%ymm0, %%ymm4, %%ymm4\n\t"  // Block 3 (must hold the stop)
+        "vpmovmskb %%ymm4, %%eax\n\t"
+        "8:\n\t"                            // found: RDI = block, EAX = mask
+        "tzcntl %%eax, %%eax\n\t"           // Index in the block
+        "addq %%rdi, %%rax\n\t"             // Address of the stop
+        "subq %1, %%rax\n\t"                // Index = stop - str
+        "9:\n\t"                            // end
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (index)
+        : "r" (str), "r" (c)
+        : "rcx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "memory"
+    );
+    
+    return index;
+}
+
+void* memchr_asm(const void* ptr, int c, size_t n) {
+    size_t index = ASSM_DISPATCH(memchr)(ptr, c, n);
+    return index < n ? (char*)ptr + index : NULL;
+}
+
+void* memchr2_asm(const void* ptr, int c1, int c2, size_t n) {
+    size_t index = ASSM_DISPATCH(memchr2)(ptr, c1, c2, n);
+    return index < n ? (char*)ptr + index : NULL;
+}
+
+void* memchr3_asm(const void* ptr, int c1, int c2, int c3, size_t n) {
+    size_t index = ASSM_DISPATCH(memchr3)(ptr, c1, c2, c3, n);
+    return index < n ? (char*)ptr + index : NULL;
+}
+
+char* strchr_asm(const char* str, int c) {
+    const char* stop = str + ASSM_DISPATCH(strchr)(str, c);
+    return *stop == (char)c ? (char*)stop : NULL;
+}
+
+// Reverse search: the same aligned blocks walked down from the one holding
+// the last byte, four at a time once the block pointer reaches a group
+// boundary and the whole group lies inside the buffer. Bits past the end are
+// masked off the first block; a match found below ptr means there is none.
+
+size_t memrchr_index_sse2(const void* ptr, int c, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "movd %3, %%xmm0\n\t"               // Needle byte
+        "punpcklbw %%xmm0, %%xmm0\n\t"      // Replicate to 2 bytes
+        "punpcklwd %%xmm0, %%xmm0\n\t"      // 4 bytes
+        "pshufd $0, %%xmm0, %%xmm0\n\t"     // 16 bytes
+        "leaq -1(%1,%2), %%rdi\n\t"         // Last byte
+        "movl %%edi, %%ecx\n\t"             // Its offset in the block
+        "andl $15, %%ecx\n\t"
+        "andq $-16, %%rdi\n\t"              // Last block
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle
+        "pmovmskb %%xmm1, %%eax\n\t"        // One bit per byte
+        "movl $2, %%edx\n\t"                // Keep bits 0..ECX:
+        "shlq %%cl, %%rdx\n\t"              // (2 << ECX) - 1
+        "decq %%rdx\n\t"
+        "andq %%rdx, %%rax\n\t"             // Drop bytes past the end
+        "jnz 6f\n\t"                        // Match in the last block
+        "1:\n\t"                            // next_lower
+        "cmpq %1, %%rdi\n\t"                // Block starts at or below ptr?
+        "jbe 7f\n\t"                        // Yes, everything is scanned
+        "testq $63, %%rdi\n\t"              // At a 64-byte boundary?
+        "jnz 4f\n\t"                        // No, single block
+        "leaq -64(%%rdi), %%rdx\n\t"        // Start of the lower group
+        "cmpq %1, %%rdx\n\t"                // Group entirely inside the buffer?
+        "jb 4f\n\t"                         // No, single block
+        "2:\n\t"                            // group_loop: 64 bytes per iteration, high to low
+        "movdqa (%%rdx), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle
+        "movdqa 16(%%rdx), %%xmm2\n\t"      // Load block
+        "pcmpeqb %%xmm0, %%xmm2\n\t"        // Match needle
+        "movdqa 32(%%rdx), %%xmm3\n\t"      // Load block
+        "pcmpeqb %%xmm0, %%xmm3\n\t"        // Match needle
+        "movdqa 48(%%rdx), %%xmm4\n\t"      // Load block
+        "pcmpeqb %%xmm0, %%xmm4\n\t"        // Match needle
+        "movdqa %%xmm1, %%xmm5\n\t"         // Combine blocks 0 and 1
+        "por %%xmm2, %%xmm5\n\t"
+        "movdqa %%xmm3, %%xmm6\n\t"         // Combine blocks 2 and 3
+        "por %%xmm4, %%xmm6\n\t"
+        "por %%xmm6, %%xmm5\n\t"            // Any match in the group
+        "pmovmskb %%xmm5, %%eax\n\t"        // Mask for the whole group
+        "movq %%rdx, %%rdi\n\t"             // The group is now scanned
+        "testl %%eax, %%eax\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, continue below
+        "addq $48, %%rdi\n\t"               // Highest block first
+        "pmovmskb %%xmm4, %%eax\n\t"        // Block 3
+        "testl %%eax, %%eax\n\t"
+        "jnz 6f\n\t"
+        "subq $16, %%rdi\n\t"
+        "pmovmskb %%xmm3, %%eax\n\t"        // Block 2
+        "testl %%eax, %%eax\n\t"
+        "jnz 6f\n\t"
+        "subq $16, %%rdi\n\t"
+        "pmovmskb %%xmm2, %%eax\n\t"        // Block 1
+        "testl %%eax, %%eax\n\t"
+        "jnz 6f\n\t"
+        "subq $16, %%rdi\n\t"
+        "pmovmskb %%xmm1, %%eax\n\t"        // Block 0 (must hold the match)
+        "jmp 6f\n\t"
+        "4:\n\t"                            // single_block
+        "subq $16, %%rdi\n\t"               // Next lower block
+        "movdqa (%%rdi), %%xmm1\n\t"        // Load block
+        "pcmpeqb %%xmm0, %%xmm1\n\t"        // Match needle
+        "pmovmskb %%xmm1, %%eax\n\t"        // Mask
+        "testl %%eax, %%eax\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, continue below
+        "6:\n\t"                            // found: RDI = block, RAX = mask
+        "bsrq %%rax, %%rax\n\t"             // Highest match in the block
+        "addq %%rdi, %%rax\n\t"             // Its address
+        "subq %1, %%rax\n\t"                // Index relative to ptr
+        "jae 9f\n\t"                        // Inside the buffer: done
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "9:\n\t"
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c)
+        : "rcx", "rdx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return index;
+}
+
+size_t memrchr_index_avx2(const void* ptr, int c, size_t n) {
+    size_t index;
+    
+    if (n == 0) return 0;
+    
+    __asm__ volatile (
+        "vmovd %3, %%xmm0\n\t"              // Needle byte
+        "vpbroadcastb %%xmm0, %%ymm0\n\t"   // in every byte
+        "leaq -1(%1,%2), %%rdi\n\t"         // Last byte
+        "movl %%edi, %%ecx\n\t"             // Its offset in the block
+        "andl $31, %%ecx\n\t"
+        "andq $-32, %%rdi\n\t"              // Last block
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle
+        "vpmovmskb %%ymm1, %%eax\n\t"       // One bit per byte
+        "movl $2, %%edx\n\t"                // Keep bits 0..ECX:
+        "shlq %%cl, %%rdx\n\t"              // (2 << ECX) - 1
+        "decq %%rdx\n\t"
+        "andq %%rdx, %%rax\n\t"             // Drop bytes past the end
+        "jnz 6f\n\t"                        // Match in the last block
+        "1:\n\t"                            // next_lower
+        "cmpq %1, %%rdi\n\t"                // Block starts at or below ptr?
+        "jbe 7f\n\t"                        // Yes, everything is scanned
+        "testq $127, %%rdi\n\t"             // At a 128-byte boundary?
+        "jnz 4f\n\t"                        // No, single block
+        "leaq -128(%%rdi), %%rdx\n\t"       // Start of the lower group
+        "cmpq %1, %%rdx\n\t"                // Group entirely inside the buffer?
+        "jb 4f\n\t"                         // No, single block
+        "2:\n\t"                            // group_loop: 128 bytes per iteration, high to low
+        "vpcmpeqb (%%rdx), %%ymm0, %%ymm1\n\t"  // Match needle
+        "vpcmpeqb 32(%%rdx), %%ymm0, %%ymm2\n\t"  // Match needle
+        "vpcmpeqb 64(%%rdx), %%ymm0, %%ymm3\n\t"  // Match needle
+        "vpcmpeqb 96(%%rdx), %%ymm0, %%ymm4\n\t"  // Match needle
+        "vpor %%ymm2, %%ymm1, %%ymm5\n\t"   // Combine blocks 0 and 1
+        "vpor %%ymm4, %%ymm3, %%ymm6\n\t"   // Combine blocks 2 and 3
+        "vpor %%ymm6, %%ymm5, %%ymm5\n\t"   // Any match in the group
+        "vpmovmskb %%ymm5, %%eax\n\t"       // Mask for the whole group
+        "movq %%rdx, %%rdi\n\t"             // The group is now scanned
+        "testl %%eax, %%eax\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, continue below
+        "addq $96, %%rdi\n\t"               // Highest block first
+        "vpmovmskb %%ymm4, %%eax\n\t"       // Block 3
+        "testl %%eax, %%eax\n\t"
+        "jnz 6f\n\t"
+        "subq $32, %%rdi\n\t"
+        "vpmovmskb %%ymm3, %%eax\n\t"       // Block 2
+        "testl %%eax, %%eax\n\t"
+        "jnz 6f\n\t"
+        "subq $32, %%rdi\n\t"
+        "vpmovmskb %%ymm2, %%eax\n\t"       // Block 1
+        "testl %%eax, %%eax\n\t"
+        "jnz 6f\n\t"
+        "subq $32, %%rdi\n\t"
+        "vpmovmskb %%ymm1, %%eax\n\t"       // Block 0 (must hold the match)
+        "jmp 6f\n\t"
+        "4:\n\t"                            // single_block
+        "subq $32, %%rdi\n\t"               // Next lower block
+        "vpcmpeqb (%%rdi), %%ymm0, %%ymm1\n\t"  // Match needle
+        "vpmovmskb %%ymm1, %%eax\n\t"       // Mask
+        "testl %%eax, %%eax\n\t"            // Any match?
+        "jz 1b\n\t"                         // No, continue below
+        "6:\n\t"                            // found: RDI = block, RAX = mask
+        "bsrq %%rax, %%rax\n\t"             // Highest match in the block
+        "addq %%rdi, %%rax\n\t"             // Its address
+        "subq %1, %%rax\n\t"                // Index relative to ptr
+        "jae 9f\n\t"                        // Inside the buffer: done
+        "7:\n\t"                            // not_found
+        "movq %2, %%rax\n\t"                // Index = n
+        "9:\n\t"
+        "vzeroupper\n\t"                    // Avoid AVX-SSE transition penalties
+        : "=&a" (index)
+        : "r" (ptr), "r" (n), "r" (c)
+        : "rcx", "rdx", "rdi", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "memory"
+    );
+    
+    return index;
+}
+
+void* memrchr_asm(const void* ptr, int c, size_t n) {
+    size_t index = ASSM_DISPATCH(memrchr)(ptr, c, n);
+    return index < n ? (char*)ptr + index : NULL;
+}
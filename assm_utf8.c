@@ -0,0 +1,348 @@
+// assm_utf8.c - UTF-8 validation and code point counting (tutorial 6 strings)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+
+// Valid means RFC 3629: no overlong forms, no surrogates (U+D800..U+DFFF),
+// nothing past U+10FFFF and no sequence cut short by the end of the input.
+//
+// The SIMD kernels classify every byte together with the byte before it
+// using three 16-entry tables looked up with pshufb: by the high and the
+// low nibble of the previous byte and the high nibble of the current one.
+// Each entry is a set of error bits (below) and a pair is invalid when all
+// three lookups agree on a bit. The only rule that needs more context, that
+// the 3rd and 4th bytes of a sequence are continuations, comes from checking
+// the bytes two and three back for 3- and 4-byte leads, and cancels the
+// TWO_CONTS bit exactly where two continuations in a row are expected. A
+// block with no byte >= 0x80 skips all of it: one pmovmskb, plus a check
+// that the previous block did not end inside a character.
+//
+// The kernels stop at the first block that fails and leave it to the
+// scalar decoder in C to find the exact offset; the sse2 kernel only skips
+// ASCII and hands every other block to the decoder.
+#define TOO_SHORT   0x01    // lead byte not followed by a continuation
+#define TOO_LONG    0x02    // continuation after ASCII
+#define OVERLONG_3  0x04    // E0 80..9F
+#define TOO_LARGE   0x08    // F4 90..BF, F5..FF
+#define SURROGATE   0x10    // ED A0..BF
+#define OVERLONG_2  0x20    // C0, C1
+#define TOO_LARGE_1000 0x40 // F5..FF 80..8F
+#define OVERLONG_4  0x40    // F0 80..8F
+#define TWO_CONTS   0x80    // continuation after continuation
+#define CARRY (TOO_SHORT | TOO_LONG | TWO_CONTS)
+
+// Widest kernel block (AVX2)
+#define UTF8_BLOCK_MAX 32
+
+#define ROW2(...) __VA_ARGS__, __VA_ARGS__
+#define BYTES16(b) b, b, b, b, b, b, b, b, b, b, b, b, b, b, b, b
+
+// 32-byte rows; 16-entry tables are repeated for both AVX2 lanes. The
+// sse4.2 kernel reads the last 16 bytes of the incomplete-end row.
+static const uint8_t utf8_tables[9 * 32] __attribute__((aligned(32))) = {
+    // Previous byte's high nibble
+    ROW2(TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+         TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+         TOO_SHORT | OVERLONG_2,
+         TOO_SHORT,
+         TOO_SHORT | OVERLONG_3 | SURROGATE,
+         TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4),
+    // Previous byte's low nibble
+    ROW2(CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+         CARRY | OVERLONG_2,
+         CARRY,
+         CARRY,
+         CARRY | TOO_LARGE,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+         CARRY | TOO_LARGE | TOO_LARGE_1000,
+         CARRY | TOO_LARGE | TOO_LARGE_1000),
+    // Current byte's high nibble
+    ROW2(TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+         TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+         TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+         TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+         TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+         TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT),
+    ROW2(BYTES16(0x0F)),
+    ROW2(BYTES16(0xE0 - 0x80)),     // saturating subtract: >= 0xE0 keeps bit 7
+    ROW2(BYTES16(0xF0 - 0x80)),
+    ROW2(BYTES16(0x80)),
+    // Largest byte allowed in each of the last three positions of a block
+    BYTES16(0xFF), 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+    ROW2(BYTES16(0xBF)),            // signed compare: continuations are <= (int8_t)0xBF
+};
+
+size_t utf8_scan_sse2(const void* data, size_t pos, size_t n, size_t* count) {
+    size_t stop;
+
+    __asm__ volatile (
+        "movq %2, %%rax\n\t"                // Position
+        "1:\n\t"                            // block_loop
+        "leaq 16(%%rax), %%rcx\n\t"
+        "cmpq %3, %%rcx\n\t"                // Full block left?
+        "ja 9f\n\t"
+        "movdqu (%1,%%rax), %%xmm0\n\t"
+        "pmovmskb %%xmm0, %%ecx\n\t"        // Any byte >= 0x80?
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 9f\n\t"                        // Yes, decode it in C
+        "addq $16, %%rax\n\t"
+        "jmp 1b\n\t"
+        "9:\n\t"
+        "movq %%rax, %%rcx\n\t"             // Every byte skipped is a code point
+        "subq %2, %%rcx\n\t"
+        "movq %%rcx, (%4)\n\t"
+        : "=&a" (stop)
+        : "r" (data), "r" (pos), "r" (n), "r" (count)
+        : "rcx", "xmm0", "memory"
+    );
+
+    return stop;
+}
+
+size_t utf8_scan_sse42(const void* data, size_t pos, size_t n, size_t* count) {
+    size_t stop;
+
+    __asm__ volatile (
+        "movq %2, %%rax\n\t"                // Position
+        "xorl %%edx, %%edx\n\t"             // Code points counted
+        "movdqa 96(%4), %%xmm8\n\t"         // 0x0F
+        "pxor %%xmm14, %%xmm14\n\t"         // Previous block: as if ASCII
+        "pxor %%xmm13, %%xmm13\n\t"         // Nothing left incomplete
+        "1:\n\t"                            // block_loop
+        "leaq 16(%%rax), %%rcx\n\t"
+        "cmpq %3, %%rcx\n\t"                // Full block left?
+        "ja 9f\n\t"
+        "movdqu (%1,%%rax), %%xmm0\n\t"
+        "pmovmskb %%xmm0, %%ecx\n\t"        // Any byte >= 0x80?
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 2f\n\t"
+        "ptest %%xmm13, %%xmm13\n\t"        // ASCII: previous block cut a character?
+        "jnz 9f\n\t"
+        "addq $16, %%rdx\n\t"               // Every byte is a code point
+        "addq $16, %%rax\n\t"
+        "movdqa %%xmm0, %%xmm14\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // classify: each byte with the three before it
+        "movdqa %%xmm0, %%xmm2\n\t"
+        "palignr $15, %%xmm14, %%xmm2\n\t"  // prev1: input shifted in by 1 byte
+        "movdqa %%xmm0, %%xmm3\n\t"
+        "palignr $14, %%xmm14, %%xmm3\n\t"  // prev2
+        "movdqa %%xmm0, %%xmm4\n\t"
+        "palignr $13, %%xmm14, %%xmm4\n\t"  // prev3
+        "movdqa %%xmm2, %%xmm6\n\t"
+        "psrlw $4, %%xmm6\n\t"
+        "pand %%xmm8, %%xmm6\n\t"
+        "movdqa (%4), %%xmm5\n\t"
+        "pshufb %%xmm6, %%xmm5\n\t"         // Lookup: prev1 high nibble
+        "pand %%xmm8, %%xmm2\n\t"
+        "movdqa 32(%4), %%xmm6\n\t"
+        "pshufb %%xmm2, %%xmm6\n\t"         // Lookup: prev1 low nibble
+        "pand %%xmm6, %%xmm5\n\t"
+        "movdqa %%xmm0, %%xmm2\n\t"
+        "psrlw $4, %%xmm2\n\t"
+        "pand %%xmm8, %%xmm2\n\t"
+        "movdqa 64(%4), %%xmm6\n\t"
+        "pshufb %%xmm2, %%xmm6\n\t"         // Lookup: input high nibble
+        "pand %%xmm6, %%xmm5\n\t"           // Two-byte errors (all three agree)
+        "psubusb 128(%4), %%xmm3\n\t"       // prev2 >= 0xE0 -> bit 7
+        "psubusb 160(%4), %%xmm4\n\t"       // prev3 >= 0xF0 -> bit 7
+        "por %%xmm4, %%xmm3\n\t"
+        "pand 192(%4), %%xmm3\n\t"          // Must be a 3rd/4th byte continuation
+        "pxor %%xmm3, %%xmm5\n\t"           // ...which cancels TWO_CONTS there
+        "ptest %%xmm5, %%xmm5\n\t"          // Any error?
+        "jnz 9f\n\t"
+        "movdqa %%xmm0, %%xmm13\n\t"
+        "psubusb 240(%4), %%xmm13\n\t"      // Lead byte too close to the end
+        "movdqa %%xmm0, %%xmm1\n\t"
+        "pcmpgtb 256(%4), %%xmm1\n\t"       // Signed > 0xBF: not a continuation
+        "pmovmskb %%xmm1, %%ecx\n\t"
+        "popcntl %%ecx, %%ecx\n\t"
+        "addq %%rcx, %%rdx\n\t"
+        "addq $16, %%rax\n\t"
+        "movdqa %%xmm0, %%xmm14\n\t"
+        "jmp 1b\n\t"
+        "9:\n\t"
+        "movq %%rdx, (%5)\n\t"
+        : "=&a" (stop)
+        : "r" (data), "r" (pos), "r" (n), "r" (utf8_tables), "r" (count)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm8",
+          "xmm13", "xmm14", "memory"
+    );
+
+    return stop;
+}
+
+size_t utf8_scan_avx2(const void* data, size_t pos, size_t n, size_t* count) {
+    size_t stop;
+
+    __asm__ volatile (
+        "movq %2, %%rax\n\t"                // Position
+        "xorl %%edx, %%edx\n\t"             // Code points counted
+        "vmovdqa (%4), %%ymm11\n\t"         // Error bits by high nibble of byte 1
+        "vmovdqa 32(%4), %%ymm10\n\t"       // ... by low nibble of byte 1
+        "vmovdqa 64(%4), %%ymm9\n\t"        // ... by high nibble of byte 2
+        "vmovdqa 96(%4), %%ymm8\n\t"        // 0x0F
+        "vpxor %%ymm14, %%ymm14, %%ymm14\n\t" // Previous block: as if ASCII
+        "vpxor %%ymm13, %%ymm13, %%ymm13\n\t" // Nothing left incomplete
+        "1:\n\t"                            // block_loop
+        "leaq 32(%%rax), %%rcx\n\t"
+        "cmpq %3, %%rcx\n\t"                // Full block left?
+        "ja 9f\n\t"
+        "vmovdqu (%1,%%rax), %%ymm0\n\t"
+        "vpmovmskb %%ymm0, %%ecx\n\t"       // Any byte >= 0x80?
+        "testl %%ecx, %%ecx\n\t"
+        "jnz 2f\n\t"
+        "vptest %%ymm13, %%ymm13\n\t"       // ASCII: previous block cut a character?
+        "jnz 9f\n\t"
+        "addq $32, %%rdx\n\t"               // Every byte is a code point
+        "addq $32, %%rax\n\t"
+        "vmovdqa %%ymm0, %%ymm14\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"                            // classify: each byte with the three before it
+        "vperm2i128 $0x21, %%ymm0, %%ymm14, %%ymm1\n\t" // Previous high lane, current low lane
+        "vpalignr $15, %%ymm1, %%ymm0, %%ymm2\n\t" // prev1: input shifted in by 1 byte
+        "vpalignr $14, %%ymm1, %%ymm0, %%ymm3\n\t" // prev2
+        "vpalignr $13, %%ymm1, %%ymm0, %%ymm4\n\t" // prev3
+        "vpsrlw $4, %%ymm2, %%ymm5\n\t"
+        "vpand %%ymm8, %%ymm5, %%ymm5\n\t"
+        "vpshufb %%ymm5, %%ymm11, %%ymm5\n\t" // Lookup: prev1 high nibble
+        "vpand %%ymm8, %%ymm2, %%ymm6\n\t"
+        "vpshufb %%ymm6, %%ymm10, %%ymm6\n\t" // Lookup: prev1 low nibble
+        "vpand %%ymm6, %%ymm5, %%ymm5\n\t"
+        "vpsrlw $4, %%ymm0, %%ymm6\n\t"
+        "vpand %%ymm8, %%ymm6, %%ymm6\n\t"
+        "vpshufb %%ymm6, %%ymm9, %%ymm6\n\t" // Lookup: input high nibble
+        "vpand %%ymm6, %%ymm5, %%ymm5\n\t"  // Two-byte errors (all three agree)
+        "vpsubusb 128(%4), %%ymm3, %%ymm3\n\t" // prev2 >= 0xE0 -> bit 7
+        "vpsubusb 160(%4), %%ymm4, %%ymm4\n\t" // prev3 >= 0xF0 -> bit 7
+        "vpor %%ymm4, %%ymm3, %%ymm3\n\t"
+        "vpand 192(%4), %%ymm3, %%ymm3\n\t" // Must be a 3rd/4th byte continuation
+        "vpxor %%ymm3, %%ymm5, %%ymm5\n\t"  // ...which cancels TWO_CONTS there
+        "vptest %%ymm5, %%ymm5\n\t"         // Any error?
+        "jnz 9f\n\t"
+        "vpsubusb 224(%4), %%ymm0, %%ymm13\n\t" // Lead byte too close to the end
+        "vpcmpgtb 256(%4), %%ymm0, %%ymm1\n\t" // Signed > 0xBF: not a continuation
+        "vpmovmskb %%ymm1, %%ecx\n\t"
+        "popcntl %%ecx, %%ecx\n\t"
+        "addq %%rcx, %%rdx\n\t"
+        "addq $32, %%rax\n\t"
+        "vmovdqa %%ymm0, %%ymm14\n\t"
+        "jmp 1b\n\t"
+        "9:\n\t"
+        "movq %%rdx, (%5)\n\t"
+        "vzeroupper\n\t"
+        : "=&a" (stop)
+        : "r" (data), "r" (pos), "r" (n), "r" (utf8_tables), "r" (count)
+        : "rcx", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm8",
+          "xmm9", "xmm10", "xmm11", "xmm13", "xmm14", "memory"
+    );
+
+    return stop;
+}
+
+// Decodes characters starting at *pos until *pos >= end (the last one may
+// run past end, up to n). Returns 0 with *pos at the start of an invalid
+// or truncated character, 1 otherwise; adds the characters to *count.
+static int utf8_decode(const unsigned char* p, size_t* pos, size_t end, size_t n, size_t* count) {
+    size_t i = *pos, chars = 0;
+    int ok = 1;
+
+    while (i < end) {
+        unsigned char b = p[i];
+        size_t len;
+        unsigned char lo = 0x80, hi = 0xBF;     // range of the second byte
+
+        if (b < 0x80) {
+            ++i;
+            ++chars;
+            continue;
+        }
+        if (b >= 0xC2 && b <= 0xDF) {
+            len = 2;
+        } else if (b >= 0xE0 && b <= 0xEF) {
+            len = 3;
+            if (b == 0xE0) lo = 0xA0;           // overlong
+            if (b == 0xED) hi = 0x9F;           // surrogates
+        } else if (b >= 0xF0 && b <= 0xF4) {
+            len = 4;
+            if (b == 0xF0) lo = 0x90;           // overlong
+            if (b == 0xF4) hi = 0x8F;           // past U+10FFFF
+        } else {
+            ok = 0;
+            break;
+        }
+        if (len > n - i || p[i + 1] < lo || p[i + 1] > hi) {
+            ok = 0;
+            break;
+        }
+        for (size_t k = 2; k < len; ++k) {
+            if ((p[i + k] & 0xC0) != 0x80) ok = 0;
+        }
+        if (!ok) break;
+        i += len;
+        ++chars;
+    }
+    *pos = i;
+    *count += chars;
+    return ok;
+}
+
+size_t utf8_validate_with(utf8_scan_fn scan, const void* data, size_t n, size_t* count) {
+    const unsigned char* p = data;
+    size_t pos = 0, total = 0;
+
+    for (;;) {
+        size_t counted = 0, stop = pos;
+        if (n - pos >= UTF8_BLOCK_MAX) stop = scan(p, pos, n, &counted);
+        total += counted;
+
+        // The kernel may have stopped inside a character: restart the
+        // decoder at its lead byte, which the kernel already counted
+        size_t start = stop;
+        for (size_t back = 1; back <= 3 && back <= stop - pos; ++back) {
+            unsigned char b = p[stop - back];
+            if (b < 0x80) break;
+            if (b >= 0xC0) {
+                start = stop - back;
+                --total;
+                break;
+            }
+        }
+
+        // The last block or less: validate it zero-padded (the padding is
+        // ASCII, so a cut-off character still fails), which spares short
+        // inputs the decoder
+        if (n - stop < UTF8_BLOCK_MAX) {
+            unsigned char tail[2 * UTF8_BLOCK_MAX] __attribute__((aligned(32))) = { 0 };
+            memcpy_asm(tail, p + start, n - start);
+            if (scan(tail, 0, sizeof(tail), &counted) == sizeof(tail)) {
+                if (count) *count = total + counted - (sizeof(tail) - (n - start));
+                return n;
+            }
+        }
+
+        // Past the kernel's failing block, or to the end
+        size_t end = n - stop > UTF8_BLOCK_MAX ? stop + UTF8_BLOCK_MAX : n;
+        if (!utf8_decode(p, &start, end, n, &total) || start >= n) {
+            if (count) *count = total;
+            return start;
+        }
+        pos = start;
+    }
+}
+
+size_t assm_utf8_validate(const void* data, size_t n) {
+    return utf8_validate_with(ASSM_DISPATCH(utf8_scan), data, n, NULL);
+}
+
+size_t assm_utf8_validate_count(const void* data, size_t n, size_t* count) {
+    return utf8_validate_with(ASSM_DISPATCH(utf8_scan), data, n, count);
+}
@@ -0,0 +1,107 @@
+// bench.h - Microbenchmark harness for libassmkernels (make bench)
+//
+// A benchmark group compares one kernel with its natural baseline over a
+// sweep of input sizes. For every size the group builds a Case: a set of
+// variants that all process the same input and must return the same
+// result. The runner verifies them against each other, then times each one
+// with warmup, calibrated batches and repeated samples.
+#ifndef ASSM_BENCH_H
+#define ASSM_BENCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bench {
+
+// Keep the compiler from discarding a value or assuming memory is unchanged
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    __asm__ volatile("" : : "r,m" (value) : "memory");
+}
+
+inline void clobber_memory() {
+    __asm__ volatile("" : : : "memory");
+}
+
+// What a variant returns. Integers (sizes, indices, sums, hashes, integer
+// checksums) are kept as uint64_t and must match exactly, since a double
+// would drop the low bits of anything past 2^53; floating-point results
+// match within the case's tolerance.
+struct Value {
+    bool exact;
+    uint64_t bits;
+    double real;
+
+    template<typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    Value(T v) : exact(true), bits(static_cast<uint64_t>(v)), real(static_cast<double>(v)) {}
+    Value(double v) : exact(false), bits(0), real(v) {}
+};
+
+// One implementation of the operation being measured. run() processes the
+// whole input once and returns a value the runner checks and consumes.
+struct Variant {
+    std::string name;
+    std::function<Value()> run;
+};
+
+// Inputs for one size, shared by all variants. The first variant is the
+// baseline that speedups are reported against.
+struct Case {
+    std::vector<Variant> variants;
+    size_t bytes = 0;        // bytes touched per run (for GB/s)
+    size_t items = 0;        // logical elements per run (for ns/item)
+    double tolerance = 0.0;  // relative tolerance when verifying results
+};
+
+struct Group {
+    std::string name;
+    size_t min_bytes = 0;    // clamp the global sweep (0 = no clamp)
+    size_t max_bytes = 0;
+    std::function<Case(size_t bytes)> prepare;
+};
+
+// Registers a group at static-initialization time
+struct Registrar {
+    explicit Registrar(Group group);
+};
+
+std::vector<Group>& registry();
+
+// Zero-initialized, 64-byte aligned buffer owned by the lambdas that use it
+template<typename T>
+std::shared_ptr<T> make_buffer(size_t count) {
+    size_t bytes = (count * sizeof(T) + 63) & ~size_t(63);
+    void* ptr = aligned_alloc(64, bytes ? bytes : 64);
+    if (!ptr) throw std::bad_alloc();
+    std::memset(ptr, 0, bytes ? bytes : 64);
+    return std::shared_ptr<T>(static_cast<T*>(ptr), [](T* p) { free(p); });
+}
+
+// Deterministic xorshift generator for input data
+struct Rng {
+    uint64_t state;
+    explicit Rng(uint64_t seed = 0x9E3779B97F4A7C15ull) : state(seed) {}
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+} // namespace bench
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT2(a, b)
+#define BENCH_GROUP(...) \
+    static bench::Registrar BENCH_CONCAT(bench_registrar_, __LINE__)(bench::Group{__VA_ARGS__})
+
+#endif // ASSM_BENCH_H
@@ -0,0 +1,570 @@
+// bench_array.cpp - Array kernel benchmarks (assm_array.c vs the STL)
+#include "assm_array.hpp"
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// Small random values so sums stay exact when compared as doubles
+std::shared_ptr<long> make_longs(size_t count) {
+    auto arr = bench::make_buffer<long>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) {
+        arr.get()[i] = static_cast<long>(rng.next() % 2048) - 1024;
+    }
+    return arr;
+}
+
+BENCH_GROUP("array_sum", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    auto arr = make_longs(count);
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    auto kernel = [arr, count](long (*fn)(const long*, size_t)) {
+        return [arr, count, fn] { return fn(arr.get(), count); };
+    };
+    c.variants = {
+        {"std::accumulate", [arr, count] {
+            const long* p = arr.get();
+            bench::do_not_optimize(p);
+            return std::accumulate(p, p + count, 0L);
+        }},
+        {"array_sum_loop (one chain)", kernel(array_sum_loop)},
+        {"array_sum_sse2", kernel(array_sum_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"array_sum_avx2", kernel(array_sum_avx2)});
+    }
+    c.variants.push_back({"array_sum_asm", kernel(array_sum_asm)});
+    return c;
+});
+
+// Overflow-checked sums: the usual per-element __builtin_add_overflow loop
+// (which stops at the first overflow, so it also rejects sums that would
+// come back into range) against the exact 128-bit kernels
+BENCH_GROUP("array_sum_checked", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    auto arr = make_longs(count);
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    auto wide = [arr, count](__int128 (*fn)(const long*, size_t)) {
+        return [arr, count, fn] { return static_cast<long>(fn(arr.get(), count)); };
+    };
+    c.variants = {
+        {"__builtin_add_overflow loop", [arr, count] {
+            const long* p = arr.get();
+            bench::do_not_optimize(p);
+            long sum = 0;
+            for (size_t i = 0; i < count; ++i) {
+                if (__builtin_add_overflow(sum, p[i], &sum)) return -1L;
+            }
+            return sum;
+        }},
+        {"array_sum_wide_sse2 (adcq)", wide(array_sum_wide_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"array_sum_wide_avx2", wide(array_sum_wide_avx2)});
+    }
+    c.variants.push_back({"array_sum_checked_asm", [arr, count] {
+        long sum;
+        if (!array_sum_checked_asm(arr.get(), count, &sum)) return -1L;
+        return sum;
+    }});
+    return c;
+});
+
+// The target sits in the last slot so every variant scans the whole array
+BENCH_GROUP("array_search", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    auto arr = make_longs(count);
+    const long target = 1L << 40;
+    arr.get()[count - 1] = target;
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    auto kernel = [arr, count, target](size_t (*fn)(const long*, size_t, long)) {
+        return [arr, count, target, fn] { return fn(arr.get(), count, target); };
+    };
+    c.variants = {
+        {"std::find", [arr, count, target] {
+            const long* p = arr.get();
+            bench::do_not_optimize(p);
+            return std::find(p, p + count, target) - p;
+        }},
+        {"array_search_loop", kernel(array_search_loop)},
+        {"array_search_sse2", kernel(array_search_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"array_search_avx2", kernel(array_search_avx2)});
+    }
+    c.variants.push_back({"array_search_asm", kernel(array_search_asm)});
+    return c;
+});
+
+// Random lookups into a sorted array of the given size (half of the keys
+// present). Each variant sums the elements found, the first >= the key.
+BENCH_GROUP("sorted_search", 8, 0, [](size_t bytes) {
+    const size_t lookups = 4096;
+    size_t count = bytes / sizeof(long);
+    auto sorted = bench::make_buffer<long>(count);
+    auto tree = bench::make_buffer<long>(count + 1);
+    auto keys = bench::make_buffer<long>(lookups);
+    auto slots = bench::make_buffer<size_t>(lookups);
+    bench::Rng rng(3);
+    for (size_t i = 0; i < count; ++i) sorted.get()[i] = static_cast<long>(2 * i + 1);
+    array_eytzinger_build(sorted.get(), count, tree.get());
+    for (size_t i = 0; i < lookups; ++i) keys.get()[i] = static_cast<long>(rng.next() % (2 * count + 1));
+    bench::Case c;
+    c.bytes = lookups * sizeof(long);
+    c.items = lookups;
+    c.variants = {
+        {"std::lower_bound", [=] {
+            const long* p = sorted.get();
+            bench::do_not_optimize(p);
+            long sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                const long* it = std::lower_bound(p, p + count, keys.get()[i]);
+                sum += it == p + count ? 0 : *it;
+            }
+            return sum;
+        }},
+        {"array_lower_bound_asm", [=] {
+            long sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                size_t index = array_lower_bound_asm(sorted.get(), count, keys.get()[i]);
+                sum += index == count ? 0 : sorted.get()[index];
+            }
+            return sum;
+        }},
+        {"array_eytzinger_search", [=] {
+            long sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                size_t slot = array_eytzinger_search(tree.get(), count, keys.get()[i]);
+                sum += slot ? tree.get()[slot] : 0;
+            }
+            return sum;
+        }},
+        {"array_eytzinger_search_batch", [=] {
+            array_eytzinger_search_batch(tree.get(), count, keys.get(), lookups, slots.get());
+            long sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                size_t slot = slots.get()[i];
+                sum += slot ? tree.get()[slot] : 0;
+            }
+            return sum;
+        }},
+    };
+    return c;
+});
+
+BENCH_GROUP("array_max", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    auto arr = make_longs(count);
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    c.variants = {
+        {"std::max_element", [arr, count] {
+            const long* p = arr.get();
+            bench::do_not_optimize(p);
+            return *std::max_element(p, p + count);
+        }},
+        {"array_max_asm", [arr, count] {
+            return array_max_asm(arr.get(), count);
+        }},
+    };
+    return c;
+});
+
+// Min, max and both indices: two STL passes against one pass. Every
+// variant returns min + max + argmin + argmax, the values (integral in the
+// test data) cast to int64_t.
+template <typename T, typename Result>
+bench::Case make_minmax_case(size_t bytes, Result (*dispatched)(const T*, size_t),
+                             void (*scalar)(const T*, size_t, Result*),
+                             void (*avx2)(const T*, size_t, Result*)) {
+    size_t count = bytes / sizeof(T);
+    auto arr = bench::make_buffer<T>(count);
+    bench::Rng rng(11);
+    for (size_t i = 0; i < count; ++i) {
+        arr.get()[i] = static_cast<T>(static_cast<long>(rng.next() % 2000001) - 1000000);
+    }
+    auto total = [](const Result& r) {
+        return static_cast<uint64_t>(static_cast<int64_t>(r.min)) +
+               static_cast<uint64_t>(static_cast<int64_t>(r.max)) + r.argmin + r.argmax;
+    };
+    auto kernel = [arr, count, total](void (*fn)(const T*, size_t, Result*)) {
+        return [arr, count, total, fn] {
+            Result r;
+            fn(arr.get(), count, &r);
+            return total(r);
+        };
+    };
+    bench::Case c;
+    c.bytes = count * sizeof(T);
+    c.items = count;
+    c.variants = {
+        {"std::min_element + max_element", [arr, count, total] {
+            const T* p = arr.get();
+            bench::do_not_optimize(p);
+            const T* lo = std::min_element(p, p + count);
+            const T* hi = std::max_element(p, p + count);
+            return total(Result{*lo, *hi, static_cast<size_t>(lo - p), static_cast<size_t>(hi - p)});
+        }},
+        {"scalar", kernel(scalar)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"avx2", kernel(avx2)});
+    }
+    c.variants.push_back({"array_minmax_asm", [arr, count, total, dispatched] {
+        return total(dispatched(arr.get(), count));
+    }});
+    return c;
+}
+
+BENCH_GROUP("minmax_i32", 4, 0, [](size_t bytes) {
+    return make_minmax_case(bytes, array_minmax_i32_asm, array_minmax_i32_scalar, array_minmax_i32_avx2);
+});
+
+BENCH_GROUP("minmax_i64", 8, 0, [](size_t bytes) {
+    return make_minmax_case(bytes, array_minmax_i64_asm, array_minmax_i64_scalar, array_minmax_i64_avx2);
+});
+
+BENCH_GROUP("minmax_f32", 4, 0, [](size_t bytes) {
+    return make_minmax_case(bytes, array_minmax_f32_asm, array_minmax_f32_scalar, array_minmax_f32_avx2);
+});
+
+BENCH_GROUP("minmax_f64", 8, 0, [](size_t bytes) {
+    return make_minmax_case(bytes, array_minmax_f64_asm, array_minmax_f64_scalar, array_minmax_f64_avx2);
+});
+
+BENCH_GROUP("minmax_i8", 1, 0, [](size_t bytes) {
+    return make_minmax_case(bytes, array_minmax_i8_asm, array_minmax_i8_scalar, array_minmax_i8_avx2);
+});
+
+BENCH_GROUP("minmax_i16", 2, 0, [](size_t bytes) {
+    return make_minmax_case(bytes, array_minmax_i16_asm, array_minmax_i16_scalar, array_minmax_i16_avx2);
+});
+
+BENCH_GROUP("minmax_u64", 8, 0, [](size_t bytes) {
+    return make_minmax_case(bytes, array_minmax_u64_asm, array_minmax_u64_scalar, array_minmax_u64_avx2);
+});
+
+// Typed sums and searches through assm_array.hpp. Elements are small
+// integers (also for floats, so every sum is exact); searches look for a
+// value that only the last element holds.
+template <typename T>
+std::shared_ptr<T> make_typed(size_t count) {
+    auto arr = bench::make_buffer<T>(count);
+    bench::Rng rng(5);
+    for (size_t i = 0; i < count; ++i) arr.get()[i] = static_cast<T>(static_cast<int>(rng.next() % 200) - 100);
+    return arr;
+}
+
+template <typename T>
+bench::Case make_typed_sum_case(size_t bytes, typename assm::array_traits<T>::sum_type (*scalar)(const T*, size_t),
+                                typename assm::array_traits<T>::sum_type (*avx2)(const T*, size_t)) {
+    using S = typename assm::array_traits<T>::sum_type;
+    size_t count = bytes / sizeof(T);
+    auto arr = make_typed<T>(count);
+    bench::Case c;
+    c.bytes = count * sizeof(T);
+    c.items = count;
+    auto kernel = [arr, count](S (*fn)(const T*, size_t)) {
+        return [arr, count, fn] { return fn(arr.get(), count); };
+    };
+    c.variants = {
+        {"std::accumulate (widened)", [arr, count] {
+            const T* p = arr.get();
+            bench::do_not_optimize(p);
+            return std::accumulate(p, p + count, S(0));
+        }},
+        {"scalar", kernel(scalar)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"avx2", kernel(avx2)});
+    }
+    c.variants.push_back({"assm::sum", [arr, count] {
+        return assm::sum(arr.get(), count);
+    }});
+    return c;
+}
+
+template <typename T>
+bench::Case make_typed_search_case(size_t bytes, size_t (*scalar)(const T*, size_t, T),
+                                   size_t (*avx2)(const T*, size_t, T)) {
+    size_t count = bytes / sizeof(T);
+    auto arr = make_typed<T>(count);
+    const T target = 111;
+    arr.get()[count - 1] = target;
+    bench::Case c;
+    c.bytes = count * sizeof(T);
+    c.items = count;
+    auto kernel = [arr, count, target](size_t (*fn)(const T*, size_t, T)) {
+        return [arr, count, target, fn] { return fn(arr.get(), count, target); };
+    };
+    c.variants = {
+        {"std::find", [arr, count, target] {
+            const T* p = arr.get();
+            bench::do_not_optimize(p);
+            return std::find(p, p + count, target) - p;
+        }},
+        {"scalar", kernel(scalar)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"avx2", kernel(avx2)});
+    }
+    c.variants.push_back({"assm::search", [arr, count, target] {
+        return assm::search(arr.get(), count, target);
+    }});
+    return c;
+}
+
+BENCH_GROUP("sum_i8", 1, 0, [](size_t bytes) {
+    return make_typed_sum_case<int8_t>(bytes, array_sum_i8_scalar, array_sum_i8_avx2);
+});
+
+BENCH_GROUP("sum_i16", 2, 0, [](size_t bytes) {
+    return make_typed_sum_case<int16_t>(bytes, array_sum_i16_scalar, array_sum_i16_avx2);
+});
+
+BENCH_GROUP("sum_i32", 4, 0, [](size_t bytes) {
+    return make_typed_sum_case<int32_t>(bytes, array_sum_i32_scalar, array_sum_i32_avx2);
+});
+
+BENCH_GROUP("sum_f32", 4, 0, [](size_t bytes) {
+    return make_typed_sum_case<float>(bytes, array_sum_f32_scalar, array_sum_f32_avx2);
+});
+
+BENCH_GROUP("sum_f64", 8, 0, [](size_t bytes) {
+    return make_typed_sum_case<double>(bytes, array_sum_f64_scalar, array_sum_f64_avx2);
+});
+
+BENCH_GROUP("search_i8", 1, 0, [](size_t bytes) {
+    return make_typed_search_case<int8_t>(bytes, array_search_i8_scalar, array_search_i8_avx2);
+});
+
+BENCH_GROUP("search_i16", 2, 0, [](size_t bytes) {
+    return make_typed_search_case<int16_t>(bytes, array_search_i16_scalar, array_search_i16_avx2);
+});
+
+BENCH_GROUP("search_i32", 4, 0, [](size_t bytes) {
+    return make_typed_search_case<int32_t>(bytes, array_search_i32_scalar, array_search_i32_avx2);
+});
+
+BENCH_GROUP("search_f32", 4, 0, [](size_t bytes) {
+    return make_typed_search_case<float>(bytes, array_search_f32_scalar, array_search_f32_avx2);
+});
+
+BENCH_GROUP("search_f64", 8, 0, [](size_t bytes) {
+    return make_typed_search_case<double>(bytes, array_search_f64_scalar, array_search_f64_avx2);
+});
+
+// Histograms of random values and of runs of 16 equal values; the runs
+// are where the plain counts[x]++ loop waits on store forwarding. Variants
+// return a few of the counts.
+template <typename T>
+bench::Case make_histogram_case(size_t bytes, bool runs, size_t buckets,
+                                void (*serial)(const T*, size_t, uint64_t*),
+                                void (*parallel)(const T*, size_t, uint64_t*, unsigned)) {
+    size_t count = bytes / sizeof(T);
+    auto data = bench::make_buffer<T>(count);
+    auto counts = std::make_shared<std::vector<uint64_t>>(buckets);
+    bench::Rng rng(5);
+    T value = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!runs || i % 16 == 0) value = static_cast<T>(rng.next());
+        data.get()[i] = value;
+    }
+    bench::Case c;
+    c.bytes = count * sizeof(T);
+    c.items = count;
+    auto result = [counts] {
+        bench::clobber_memory();
+        const uint64_t* k = counts->data();
+        return k[0] + k[7] + k[200];
+    };
+    c.variants = {
+        {"counts[x]++", [data, count, counts, result] {
+            const T* d = data.get();
+            uint64_t* k = counts->data();
+            bench::do_not_optimize(d);
+            std::fill(counts->begin(), counts->end(), 0);
+            for (size_t i = 0; i < count; ++i) k[d[i]]++;
+            return result();
+        }},
+        {"array_histogram_*_asm", [data, count, counts, result, serial] {
+            std::fill(counts->begin(), counts->end(), 0);
+            serial(data.get(), count, counts->data());
+            return result();
+        }},
+        {"array_histogram_*_parallel", [data, count, counts, result, parallel] {
+            std::fill(counts->begin(), counts->end(), 0);
+            parallel(data.get(), count, counts->data(), 0);
+            return result();
+        }},
+    };
+    return c;
+}
+
+BENCH_GROUP("histogram_u8", 1, 0, [](size_t bytes) {
+    return make_histogram_case<uint8_t>(bytes, false, 256, array_histogram_u8_asm, array_histogram_u8_parallel);
+});
+
+BENCH_GROUP("histogram_u8_runs", 1, 0, [](size_t bytes) {
+    return make_histogram_case<uint8_t>(bytes, true, 256, array_histogram_u8_asm, array_histogram_u8_parallel);
+});
+
+BENCH_GROUP("histogram_u16", 2, 0, [](size_t bytes) {
+    return make_histogram_case<uint16_t>(bytes, false, 65536, array_histogram_u16_asm,
+                                         array_histogram_u16_parallel);
+});
+
+BENCH_GROUP("histogram_u16_runs", 2, 0, [](size_t bytes) {
+    return make_histogram_case<uint16_t>(bytes, true, 65536, array_histogram_u16_asm,
+                                         array_histogram_u16_parallel);
+});
+
+// 1024 buckets of 4 over [-2048, 2048): the shift and the range check are
+// inline in the plain loop
+BENCH_GROUP("histogram_shift", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    const size_t buckets = 1024;
+    auto arr = make_longs(count);
+    auto counts = std::make_shared<std::vector<uint64_t>>(buckets);
+    for (size_t i = 0; i < count; ++i) arr.get()[i] = arr.get()[i] * 2 + static_cast<long>(i & 1);
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    auto result = [counts] {
+        bench::clobber_memory();
+        const uint64_t* k = counts->data();
+        return k[0] + k[7] + k[700];
+    };
+    c.variants = {
+        {"counts[x]++", [arr, count, counts, result] {
+            const long* a = arr.get();
+            uint64_t* k = counts->data();
+            bench::do_not_optimize(a);
+            std::fill(counts->begin(), counts->end(), 0);
+            for (size_t i = 0; i < count; ++i) {
+                unsigned long bucket = (static_cast<unsigned long>(a[i]) + 2048) >> 2;
+                if (bucket < buckets) k[bucket]++;
+            }
+            return result();
+        }},
+        {"array_histogram_shift_asm", [arr, count, counts, result] {
+            std::fill(counts->begin(), counts->end(), 0);
+            array_histogram_shift_asm(arr.get(), count, -2048, 2, counts->data(), buckets);
+            return result();
+        }},
+        {"array_histogram_shift_parallel", [arr, count, counts, result] {
+            std::fill(counts->begin(), counts->end(), 0);
+            array_histogram_shift_parallel(arr.get(), count, -2048, 2, counts->data(), buckets, 0);
+            return result();
+        }},
+    };
+    return c;
+});
+
+// Elements over the whole long range, LONG_MIN and LONG_MAX included, with
+// base and shift chosen so that the unsigned distance of many elements below
+// base wraps around into the buckets: those must not be counted
+BENCH_GROUP("histogram_shift_wide", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    const size_t buckets = 256;
+    const long base = -61;
+    const unsigned shift = 56;
+    auto arr = bench::make_buffer<long>(count);
+    bench::Rng rng(3);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t r = rng.next();
+        arr.get()[i] = i % 16 == 0 ? LONG_MIN : i % 16 == 1 ? LONG_MAX : static_cast<long>(r);
+    }
+    auto counts = std::make_shared<std::vector<uint64_t>>(buckets);
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    auto result = [counts] {
+        bench::clobber_memory();
+        uint64_t sum = 0;
+        for (size_t b = 0; b < buckets; ++b) sum += (*counts)[b] * (b + 1);
+        return sum;
+    };
+    c.variants = {
+        {"counts[x]++", [arr, count, counts, result, base] {
+            const long* a = arr.get();
+            uint64_t* k = counts->data();
+            bench::do_not_optimize(a);
+            std::fill(counts->begin(), counts->end(), 0);
+            for (size_t i = 0; i < count; ++i) {
+                if (a[i] < base) continue;
+                unsigned long distance = static_cast<unsigned long>(a[i]) - static_cast<unsigned long>(base);
+                unsigned long bucket = distance >> shift;
+                if (bucket < buckets) k[bucket]++;
+            }
+            return result();
+        }},
+        {"array_histogram_shift_asm", [arr, count, counts, result, base] {
+            std::fill(counts->begin(), counts->end(), 0);
+            array_histogram_shift_asm(arr.get(), count, base, shift, counts->data(), buckets);
+            return result();
+        }},
+        {"array_histogram_shift_parallel", [arr, count, counts, result, base] {
+            std::fill(counts->begin(), counts->end(), 0);
+            array_histogram_shift_parallel(arr.get(), count, base, shift, counts->data(), buckets, 0);
+            return result();
+        }},
+    };
+    return c;
+});
+
+// Random (row, col) lookups into a square-ish matrix of the given size
+BENCH_GROUP("matrix_get", 8, 0, [](size_t bytes) {
+    const size_t lookups = 1024;
+    size_t count = bytes / sizeof(long);
+    size_t cols = 1;
+    while (cols * cols < count) cols *= 2;
+    size_t rows = std::max<size_t>(1, count / cols);
+    cols = std::min(cols, count);
+    auto matrix = make_longs(rows * cols);
+    auto rows_idx = bench::make_buffer<size_t>(lookups);
+    auto cols_idx = bench::make_buffer<size_t>(lookups);
+    bench::Rng rng;
+    for (size_t i = 0; i < lookups; ++i) {
+        rows_idx.get()[i] = rng.next() % rows;
+        cols_idx.get()[i] = rng.next() % cols;
+    }
+    bench::Case c;
+    c.bytes = lookups * sizeof(long);
+    c.items = lookups;
+    c.variants = {
+        {"direct index", [=] {
+            const long* m = matrix.get();
+            bench::do_not_optimize(m);
+            long sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                sum += m[rows_idx.get()[i] * cols + cols_idx.get()[i]];
+            }
+            return sum;
+        }},
+        {"matrix_get_asm", [=] {
+            long sum = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                sum += matrix_get_asm(matrix.get(), rows, cols, rows_idx.get()[i], cols_idx.get()[i]);
+            }
+            return sum;
+        }},
+    };
+    return c;
+});
+
+} // namespace
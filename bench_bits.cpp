@@ -0,0 +1,112 @@
+// bench_bits.cpp - Bit manipulation benchmarks (assm_bits.c vs builtins)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+namespace {
+
+std::shared_ptr<uint64_t> make_words(size_t count) {
+    auto words = bench::make_buffer<uint64_t>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) words.get()[i] = rng.next();
+    return words;
+}
+
+BENCH_GROUP("popcount", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(uint64_t);
+    auto words = make_words(count);
+    bench::Case c;
+    c.bytes = count * sizeof(uint64_t);
+    c.items = count;
+    c.variants = {
+        {"__builtin_popcountll", [words, count] {
+            const uint64_t* w = words.get();
+            bench::do_not_optimize(w);
+            uint64_t total = 0;
+            for (size_t i = 0; i < count; ++i) total += __builtin_popcountll(w[i]);
+            return total;
+        }},
+        {"popcount_asm", [words, count] {
+            const uint64_t* w = words.get();
+            uint64_t total = 0;
+            for (size_t i = 0; i < count; ++i) total += popcount_asm(w[i]);
+            return total;
+        }},
+        {"popcount_loop", [words, count] {
+            const uint64_t* w = words.get();
+            uint64_t total = 0;
+            for (size_t i = 0; i < count; ++i) total += popcount_loop(w[i]);
+            return total;
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_SSE42) {
+        c.variants.push_back({"popcount_popcnt", [words, count] {
+            const uint64_t* w = words.get();
+            uint64_t total = 0;
+            for (size_t i = 0; i < count; ++i) total += popcount_popcnt(w[i]);
+            return total;
+        }});
+    }
+    return c;
+});
+
+// Bitmap-sized counts: a popcount_asm call per word against the bulk
+// kernels, which only differ in how they count 8, 32 or 512 bytes at a time
+BENCH_GROUP("popcount_buffer", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(uint64_t);
+    auto words = make_words(count);
+    bench::Case c;
+    c.bytes = count * sizeof(uint64_t);
+    c.items = count;
+    auto kernel = [words, count](uint64_t (*fn)(const void*, size_t)) {
+        return [words, count, fn] { return fn(words.get(), count * sizeof(uint64_t)); };
+    };
+    c.variants = {
+        {"popcount_asm per word", [words, count] {
+            const uint64_t* w = words.get();
+            uint64_t total = 0;
+            for (size_t i = 0; i < count; ++i) total += popcount_asm(w[i]);
+            return total;
+        }},
+        {"popcount_buffer_swar", kernel(popcount_buffer_swar)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_SSE42) {
+        c.variants.push_back({"popcount_buffer_popcnt", kernel(popcount_buffer_popcnt)});
+    }
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"popcount_buffer_avx2", kernel(popcount_buffer_avx2)});
+    }
+    c.variants.push_back({"popcount_buffer_asm", kernel(popcount_buffer_asm)});
+    return c;
+});
+
+BENCH_GROUP("rotate_left", 8, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(uint64_t);
+    auto words = make_words(count);
+    bench::Case c;
+    c.bytes = count * sizeof(uint64_t);
+    c.items = count;
+    c.variants = {
+        {"shift/or rotate", [words, count] {
+            const uint64_t* w = words.get();
+            bench::do_not_optimize(w);
+            uint64_t acc = 0;
+            for (size_t i = 0; i < count; ++i) {
+                int n = static_cast<int>(i & 63);
+                acc ^= (w[i] << n) | (w[i] >> ((64 - n) & 63));
+            }
+            return acc >> 11;
+        }},
+        {"rotate_left_asm", [words, count] {
+            const uint64_t* w = words.get();
+            uint64_t acc = 0;
+            for (size_t i = 0; i < count; ++i) {
+                acc ^= rotate_left_asm(w[i], static_cast<int>(i & 63));
+            }
+            return acc >> 11;
+        }},
+    };
+    return c;
+});
+
+} // namespace
@@ -0,0 +1,110 @@
+// bench_filter.cpp - Stream compaction benchmarks (assm_filter.c vs a branchy loop)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+namespace {
+
+enum class Pred { eq, range, bits };
+
+// Random elements in [0, 100) and a random bitmap, each passing with about
+// percent% probability, so the branchy loop mispredicts as often as the
+// predicate is unpredictable. Variants return the count kept plus the last
+// output entry.
+bench::Case make_filter_case(size_t bytes, Pred pred, int percent, bool indices) {
+    size_t count = bytes / sizeof(long);
+    auto src = bench::make_buffer<long>(count);
+    auto bits = bench::make_buffer<uint64_t>(count / 64 + 1);
+    auto out = bench::make_buffer<long>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) src.get()[i] = static_cast<long>(rng.next() % 100);
+    for (size_t w = 0; w <= count / 64; ++w) {
+        uint64_t word = 0;
+        for (int b = 0; b < 64; ++b) word |= uint64_t(rng.next() % 100 < uint64_t(percent)) << b;
+        bits.get()[w] = word;
+    }
+    long value = 7;                       // percent is 1 for eq
+    long lo = 0;
+    long hi = percent - 1;
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    auto result = [out](size_t kept) {
+        bench::clobber_memory();
+        return kept + (kept ? static_cast<uint64_t>(out.get()[kept - 1]) : 0);
+    };
+    auto kernel = [=](size_t (*eq)(const int64_t*, size_t, int64_t, int64_t*, int),
+                      size_t (*range)(const int64_t*, size_t, int64_t, int64_t, int64_t*, int),
+                      size_t (*sel)(const int64_t*, const uint64_t*, size_t, int64_t*, int)) {
+        return [=] {
+            const int64_t* s = reinterpret_cast<const int64_t*>(src.get());
+            int64_t* o = reinterpret_cast<int64_t*>(out.get());
+            bench::do_not_optimize(s);
+            size_t kept = pred == Pred::eq ? eq(s, count, value, o, indices)
+                        : pred == Pred::range ? range(s, count, lo, hi, o, indices)
+                        : sel(s, bits.get(), count, o, indices);
+            return result(kept);
+        };
+    };
+    c.variants = {
+        {"branchy loop", [=] {
+            const long* s = src.get();
+            const uint64_t* b = bits.get();
+            long* o = out.get();
+            bench::do_not_optimize(s);
+            size_t kept = 0;
+            for (size_t i = 0; i < count; ++i) {
+                bool pass = pred == Pred::eq ? s[i] == value
+                          : pred == Pred::range ? s[i] >= lo && s[i] <= hi
+                          : (b[i / 64] >> (i % 64)) & 1;
+                if (pass) o[kept++] = indices ? static_cast<long>(i) : s[i];
+            }
+            return result(kept);
+        }},
+        {"scalar", kernel(filter_eq_scalar, filter_range_scalar, filter_bits_scalar)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"avx2", kernel(filter_eq_avx2, filter_range_avx2, filter_bits_avx2)});
+    }
+    c.variants.push_back({"array_filter_*", [=] {
+        const long* s = src.get();
+        size_t* idx = reinterpret_cast<size_t*>(out.get());
+        bench::do_not_optimize(s);
+        size_t kept;
+        if (pred == Pred::eq) {
+            kept = indices ? array_filter_eq_index_asm(s, count, value, idx)
+                           : array_filter_eq_asm(s, count, value, out.get());
+        } else if (pred == Pred::range) {
+            kept = indices ? array_filter_range_index_asm(s, count, lo, hi, idx)
+                           : array_filter_range_asm(s, count, lo, hi, out.get());
+        } else {
+            kept = indices ? array_filter_bits_index_asm(bits.get(), count, idx)
+                           : array_filter_bits_asm(s, bits.get(), count, out.get());
+        }
+        return result(kept);
+    }});
+    return c;
+}
+
+BENCH_GROUP("filter_eq", 8, 0, [](size_t bytes) {
+    return make_filter_case(bytes, Pred::eq, 1, false);
+});
+
+// Half the elements pass: the worst case for the branchy loop
+BENCH_GROUP("filter_range", 8, 0, [](size_t bytes) {
+    return make_filter_case(bytes, Pred::range, 50, false);
+});
+
+BENCH_GROUP("filter_range_index", 8, 0, [](size_t bytes) {
+    return make_filter_case(bytes, Pred::range, 50, true);
+});
+
+BENCH_GROUP("filter_bits", 8, 0, [](size_t bytes) {
+    return make_filter_case(bytes, Pred::bits, 50, false);
+});
+
+BENCH_GROUP("filter_bits_index", 8, 0, [](size_t bytes) {
+    return make_filter_case(bytes, Pred::bits, 50, true);
+});
+
+} // namespace
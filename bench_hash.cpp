@@ -0,0 +1,130 @@
+// bench_hash.cpp - CRC32C and 64-bit hash benchmarks (assm_hash.c)
+//
+// Each run hashes a batch of keys of the given size (16 KiB of keys in all,
+// or one key from 16 KiB up), so ns/item is the cost of hashing one key.
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <functional>
+#include <string_view>
+
+namespace {
+
+const size_t batch_bytes = 16384;
+
+struct Keys {
+    std::shared_ptr<unsigned char> data;
+    size_t size;            // bytes per key
+    size_t count;
+};
+
+Keys make_keys(size_t bytes) {
+    Keys keys{nullptr, bytes, bytes < batch_bytes ? batch_bytes / bytes : 1};
+    keys.data = bench::make_buffer<unsigned char>(keys.size * keys.count);
+    bench::Rng rng(5);
+    for (size_t i = 0; i < keys.size * keys.count; ++i) {
+        keys.data.get()[i] = static_cast<unsigned char>(rng.next());
+    }
+    return keys;
+}
+
+// Classic byte-at-a-time table CRC (Sarwate), the usual portable version
+uint32_t crc32c_bytewise(const unsigned char* p, size_t n) {
+    static const auto table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int i = 0; i < 8; ++i) crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1)));
+            t[b] = crc;
+        }
+        return t;
+    }();
+    uint32_t crc = ~0u;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+// FNV-1a: one multiply per byte, the simplest common string hash
+uint64_t fnv1a(const unsigned char* p, size_t n) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 0x100000001B3ull;
+    return h;
+}
+
+using CrcFn = std::function<uint32_t(const unsigned char*, size_t)>;
+using HashFn = std::function<uint64_t(const unsigned char*, size_t)>;
+
+// The CRC kernels work on the raw register; wrap them like assm_crc32c
+CrcFn raw_crc(uint32_t (*kernel)(uint32_t, const void*, size_t)) {
+    return [kernel](const unsigned char* p, size_t n) { return ~kernel(~0u, p, n); };
+}
+
+// Sum of the key CRCs, identical for every variant
+BENCH_GROUP("crc32c", 8, 1 << 20, [](size_t bytes) {
+    Keys keys = make_keys(bytes);
+    std::vector<std::pair<const char*, CrcFn>> fns = {
+        {"bytewise table", crc32c_bytewise},
+        {"crc32c_sw (slicing-by-8)", raw_crc(crc32c_sw)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_SSE42) {
+        fns.push_back({"crc32c_serial_sse42", raw_crc(crc32c_serial_sse42)});
+        fns.push_back({"crc32c_sse42 (3 streams)", raw_crc(crc32c_sse42)});
+    }
+    fns.push_back({"assm_crc32c", [](const unsigned char* p, size_t n) { return assm_crc32c(p, n); }});
+    bench::Case c;
+    c.bytes = keys.size * keys.count;
+    c.items = keys.count;
+    for (const auto& fn : fns) {
+        CrcFn crc = fn.second;
+        c.variants.push_back({fn.first, [keys, crc] {
+            const unsigned char* p = keys.data.get();
+            bench::do_not_optimize(p);
+            uint64_t sum = 0;
+            for (size_t k = 0; k < keys.count; ++k) sum += crc(p + k * keys.size, keys.size);
+            return sum;
+        }});
+    }
+    return c;
+});
+
+// Different hash functions disagree, so every variant returns the key count
+// and the hashes are only kept alive
+BENCH_GROUP("hash64", 8, 1 << 20, [](size_t bytes) {
+    Keys keys = make_keys(bytes);
+    std::vector<std::pair<const char*, HashFn>> fns = {
+        {"std::hash (libstdc++)", [](const unsigned char* p, size_t n) {
+            return static_cast<uint64_t>(std::hash<std::string_view>()(
+                std::string_view(reinterpret_cast<const char*>(p), n)));
+        }},
+        {"fnv1a", fnv1a},
+        {"assm_hash64", [](const unsigned char* p, size_t n) { return assm_hash64(p, n, 0); }},
+        {"assm_hash64 streaming", [](const unsigned char* p, size_t n) {
+            assm_hash64_state state;
+            assm_hash64_init(&state, 0);
+            assm_hash64_update(&state, p, n);
+            return assm_hash64_final(&state);
+        }},
+        {"assm_crc32c", [](const unsigned char* p, size_t n) {
+            return static_cast<uint64_t>(assm_crc32c(p, n));
+        }},
+    };
+    bench::Case c;
+    c.bytes = keys.size * keys.count;
+    c.items = keys.count;
+    for (const auto& fn : fns) {
+        HashFn hash = fn.second;
+        c.variants.push_back({fn.first, [keys, hash] {
+            const unsigned char* p = keys.data.get();
+            bench::do_not_optimize(p);
+            for (size_t k = 0; k < keys.count; ++k) {
+                uint64_t h = hash(p + k * keys.size, keys.size);
+                bench::do_not_optimize(h);
+            }
+            return keys.count;
+        }});
+    }
+    return c;
+});
+
+} // namespace
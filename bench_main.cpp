@@ -0,0 +1,300 @@
+// bench_main.cpp - Runner for the libassmkernels microbenchmarks
+//
+//   ./assm_bench [--filter SUBSTR] [--min-size N] [--max-size N] [--step K]
+//                [--reps N] [--min-sample-us N] [--format table|csv|json]
+//                [--output FILE] [--list]
+//
+// Sizes accept K/M/G suffixes (powers of 1024).
+#include "assm_kernels.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+std::vector<Group>& registry() {
+    static std::vector<Group> groups;
+    return groups;
+}
+
+Registrar::Registrar(Group group) {
+    registry().push_back(std::move(group));
+}
+
+} // namespace bench
+
+namespace {
+
+enum class Format { Table, Csv, Json };
+
+struct Config {
+    std::string filter;
+    size_t min_bytes = 16;
+    size_t max_bytes = size_t(1) << 30;
+    size_t step = 4;
+    int reps = 21;
+    int warmup = 3;
+    double min_sample_ns = 2e6;   // each sample runs for at least 2 ms
+    Format format = Format::Table;
+    const char* output = nullptr;
+    bool list = false;
+};
+
+struct Result {
+    std::string group;
+    std::string variant;
+    size_t size;      // sweep size (working set) for this case
+    size_t bytes;
+    size_t items;
+    double median_ns;
+    double p10_ns;
+    double p90_ns;
+    double min_ns;
+    double speedup;   // baseline median / this median
+    bool verified;
+};
+
+using Clock = std::chrono::steady_clock;
+
+size_t parse_size(const char* text) {
+    char* end = nullptr;
+    double value = std::strtod(text, &end);
+    switch (*end) {
+        case 'k': case 'K': value *= 1024.0; break;
+        case 'm': case 'M': value *= 1024.0 * 1024.0; break;
+        case 'g': case 'G': value *= 1024.0 * 1024.0 * 1024.0; break;
+        default: break;
+    }
+    return static_cast<size_t>(value);
+}
+
+void usage(const char* prog) {
+    std::fprintf(stderr,
+        "Usage: %s [--filter SUBSTR] [--min-size N] [--max-size N] [--step K]\n"
+        "          [--reps N] [--min-sample-us N] [--format table|csv|json]\n"
+        "          [--output FILE] [--list]\n", prog);
+}
+
+bool parse_args(int argc, char** argv, Config& cfg) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--list") == 0) { cfg.list = true; continue; }
+        if (!value) { usage(argv[0]); return false; }
+        if (std::strcmp(arg, "--filter") == 0) cfg.filter = value;
+        else if (std::strcmp(arg, "--min-size") == 0) cfg.min_bytes = parse_size(value);
+        else if (std::strcmp(arg, "--max-size") == 0) cfg.max_bytes = parse_size(value);
+        else if (std::strcmp(arg, "--step") == 0) cfg.step = std::max<size_t>(2, parse_size(value));
+        else if (std::strcmp(arg, "--reps") == 0) cfg.reps = std::max(1, std::atoi(value));
+        else if (std::strcmp(arg, "--min-sample-us") == 0) cfg.min_sample_ns = std::atof(value) * 1e3;
+        else if (std::strcmp(arg, "--output") == 0) cfg.output = value;
+        else if (std::strcmp(arg, "--format") == 0) {
+            if (std::strcmp(value, "csv") == 0) cfg.format = Format::Csv;
+            else if (std::strcmp(value, "json") == 0) cfg.format = Format::Json;
+            else if (std::strcmp(value, "table") == 0) cfg.format = Format::Table;
+            else { usage(argv[0]); return false; }
+        } else { usage(argv[0]); return false; }
+        ++i;
+    }
+    return true;
+}
+
+// Integers compare exactly, floating point within tolerance; a variant
+// returning the other kind than the baseline does not match
+bool results_match(const bench::Value& expected, const bench::Value& actual, double tolerance) {
+    if (expected.exact || actual.exact) return expected.exact == actual.exact && expected.bits == actual.bits;
+    if (expected.real == actual.real) return true;
+    double scale = std::max(std::fabs(expected.real), std::fabs(actual.real));
+    return std::fabs(expected.real - actual.real) <= tolerance * scale;
+}
+
+// Time one batch of `iters` calls, returning nanoseconds per call
+double time_batch(const bench::Variant& variant, size_t iters) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < iters; ++i) {
+        bench::Value value = variant.run();
+        bench::do_not_optimize(value.bits);
+        bench::do_not_optimize(value.real);
+        bench::clobber_memory();
+    }
+    auto end = Clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / static_cast<double>(iters);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    double pos = p * static_cast<double>(sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    double frac = pos - static_cast<double>(lo);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * frac;
+}
+
+Result measure(const Config& cfg, const bench::Variant& variant) {
+    // Warmup also gives the first estimate of the per-call cost
+    double estimate = 0.0;
+    for (int i = 0; i < cfg.warmup; ++i) {
+        estimate = time_batch(variant, 1);
+    }
+
+    // Calibrate the batch so each sample outlasts timer resolution and noise
+    size_t iters = 1;
+    if (estimate < cfg.min_sample_ns) {
+        iters = static_cast<size_t>(cfg.min_sample_ns / std::max(estimate, 1.0)) + 1;
+        double per_call = time_batch(variant, iters);
+        iters = static_cast<size_t>(cfg.min_sample_ns / std::max(per_call, 0.1)) + 1;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(cfg.reps);
+    for (int r = 0; r < cfg.reps; ++r) {
+        samples.push_back(time_batch(variant, iters));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result{};
+    result.variant = variant.name;
+    result.median_ns = percentile(samples, 0.5);
+    result.p10_ns = percentile(samples, 0.1);
+    result.p90_ns = percentile(samples, 0.9);
+    result.min_ns = samples.front();
+    return result;
+}
+
+std::vector<size_t> size_sweep(const Config& cfg, const bench::Group& group) {
+    size_t lo = std::max(cfg.min_bytes, group.min_bytes);
+    size_t hi = group.max_bytes ? std::min(cfg.max_bytes, group.max_bytes) : cfg.max_bytes;
+    std::vector<size_t> sizes;
+    for (size_t bytes = lo; bytes && bytes <= hi; bytes *= cfg.step) {
+        sizes.push_back(bytes);
+        if (bytes > hi / cfg.step) break;
+    }
+    return sizes;
+}
+
+void print_table_row(FILE* out, const Result& r) {
+    double gbps = r.median_ns > 0 ? static_cast<double>(r.bytes) / r.median_ns : 0.0;
+    double per_item = r.items ? r.median_ns / static_cast<double>(r.items) : 0.0;
+    std::fprintf(out, "%-18s %-26s %12zu %14.1f %14.1f %14.1f %9.2f %10.3f %8.2fx%s\n",
+                 r.group.c_str(), r.variant.c_str(), r.size, r.median_ns,
+                 r.p10_ns, r.p90_ns, gbps, per_item, r.speedup,
+                 r.verified ? "" : "  MISMATCH");
+}
+
+void print_results(FILE* out, Format format, const std::vector<Result>& results) {
+    if (format == Format::Csv) {
+        std::fprintf(out, "group,variant,size,bytes,items,median_ns,p10_ns,p90_ns,min_ns,"
+                          "gb_per_s,ns_per_item,speedup,verified\n");
+        for (const Result& r : results) {
+            double gbps = r.median_ns > 0 ? static_cast<double>(r.bytes) / r.median_ns : 0.0;
+            double per_item = r.items ? r.median_ns / static_cast<double>(r.items) : 0.0;
+            std::fprintf(out, "%s,%s,%zu,%zu,%zu,%.2f,%.2f,%.2f,%.2f,%.4f,%.4f,%.4f,%d\n",
+                         r.group.c_str(), r.variant.c_str(), r.size, r.bytes, r.items,
+                         r.median_ns, r.p10_ns, r.p90_ns, r.min_ns, gbps, per_item,
+                         r.speedup, r.verified ? 1 : 0);
+        }
+    } else if (format == Format::Json) {
+        std::fprintf(out, "[\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            double gbps = r.median_ns > 0 ? static_cast<double>(r.bytes) / r.median_ns : 0.0;
+            double per_item = r.items ? r.median_ns / static_cast<double>(r.items) : 0.0;
+            std::fprintf(out, "  {\"group\": \"%s\", \"variant\": \"%s\", \"size\": %zu, \"bytes\": %zu, "
+                              "\"items\": %zu, \"median_ns\": %.2f, \"p10_ns\": %.2f, "
+                              "\"p90_ns\": %.2f, \"min_ns\": %.2f, \"gb_per_s\": %.4f, "
+                              "\"ns_per_item\": %.4f, \"speedup\": %.4f, \"verified\": %s}%s\n",
+                         r.group.c_str(), r.variant.c_str(), r.size, r.bytes, r.items,
+                         r.median_ns, r.p10_ns, r.p90_ns, r.min_ns, gbps, per_item,
+                         r.speedup, r.verified ? "true" : "false",
+                         i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(out, "]\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config cfg;
+    if (!parse_args(argc, argv, cfg)) return 2;
+
+    std::vector<bench::Group>& groups = bench::registry();
+    std::sort(groups.begin(), groups.end(),
+              [](const bench::Group& a, const bench::Group& b) { return a.name < b.name; });
+
+    if (cfg.list) {
+        for (const bench::Group& group : groups) std::printf("%s\n", group.name.c_str());
+        return 0;
+    }
+
+    FILE* out = stdout;
+    if (cfg.output) {
+        out = std::fopen(cfg.output, "w");
+        if (!out) {
+            std::perror(cfg.output);
+            return 1;
+        }
+    }
+
+    std::fprintf(stderr, "assm_bench: dispatch tier %s (detected %s)\n",
+                 assm_tier_name(assm_cpu_tier()), assm_tier_name(assm_cpu_detected_tier()));
+
+    if (cfg.format == Format::Table) {
+        std::fprintf(out, "%-18s %-26s %12s %14s %14s %14s %9s %10s %9s\n",
+                     "group", "variant", "size", "median_ns", "p10_ns", "p90_ns",
+                     "GB/s", "ns/item", "speedup");
+    }
+
+    std::vector<Result> results;
+    bool all_verified = true;
+    for (const bench::Group& group : groups) {
+        if (!cfg.filter.empty() && group.name.find(cfg.filter) == std::string::npos) continue;
+
+        for (size_t bytes : size_sweep(cfg, group)) {
+            bench::Case c = group.prepare(bytes);
+            if (c.variants.empty()) continue;
+
+            // Every variant must agree with the baseline before it is timed; one
+            // that does not gets a MISMATCH row without timings
+            bench::Value expected = c.variants.front().run();
+            double baseline_ns = 0.0;
+            for (const bench::Variant& variant : c.variants) {
+                bool verified = results_match(expected, variant.run(), c.tolerance);
+                Result r{};
+                if (verified) {
+                    r = measure(cfg, variant);
+                } else {
+                    r.variant = variant.name;
+                }
+                r.group = group.name;
+                r.size = bytes;
+                r.bytes = c.bytes;
+                r.items = c.items;
+                r.verified = verified;
+                if (baseline_ns == 0.0) baseline_ns = r.median_ns;
+                r.speedup = r.median_ns > 0 ? baseline_ns / r.median_ns : 0.0;
+                all_verified = all_verified && r.verified;
+                if (cfg.format == Format::Table) {
+                    print_table_row(out, r);
+                    std::fflush(out);
+                }
+                results.push_back(r);
+            }
+        }
+    }
+
+    print_results(out, cfg.format, results);
+    if (out != stdout) std::fclose(out);
+
+    if (!all_verified) {
+        std::fprintf(stderr, "assm_bench: some variants disagree with their baseline\n");
+        return 1;
+    }
+    return 0;
+}
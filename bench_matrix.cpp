@@ -0,0 +1,418 @@
+// bench_matrix.cpp - Matrix benchmarks (assm_matrix.c vs naive loops)
+//
+// Sizes are the bytes of one square n x n matrix of 32-bit elements, so n
+// runs from 64 up past the last-level cache (the multiply stops at 512:
+// the naive triple loop needs seconds per run beyond that).
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+size_t side(size_t bytes) {
+    return std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(bytes / 4))));
+}
+
+// Small integers (floats hold them exactly) so every variant agrees
+template<typename T>
+std::shared_ptr<T> make_matrix(size_t n, uint64_t seed) {
+    auto m = bench::make_buffer<T>(n * n);
+    bench::Rng rng(seed);
+    for (size_t i = 0; i < n * n; ++i) m.get()[i] = static_cast<T>(static_cast<int>(rng.next() % 17) - 8);
+    return m;
+}
+
+// Integer results are summed exactly (wrapping), float ones in double
+template<typename T>
+using Sum = typename std::conditional<std::is_integral<T>::value, uint64_t, double>::type;
+
+// A few elements from every quarter of the result
+template<typename T>
+bench::Value probe(const T* m, size_t n) {
+    Sum<T> sum = 0;
+    for (size_t i = 0; i < n; i += n / 4 + 1) {
+        for (size_t j = 0; j < n; j += n / 4 + 1) sum += static_cast<Sum<T>>(m[i * n + j]) * (i + 2 * j + 1);
+    }
+    return sum + static_cast<Sum<T>>(m[n * n - 1]);
+}
+
+// Sum of the first n outputs weighted by position, so a misplaced sum shows
+template<typename T>
+bench::Value weighted(const T* sums, size_t n) {
+    Sum<T> sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += static_cast<Sum<T>>(sums[i]) * static_cast<Sum<T>>(i % 7 + 1);
+    return sum;
+}
+
+// The textbook element loop: reads along rows, writes down columns
+BENCH_GROUP("matrix_transpose", 16384, 256 << 20, [](size_t bytes) {
+    size_t n = side(bytes);
+    auto src = make_matrix<float>(n, 3);
+    auto dst = bench::make_buffer<float>(n * n);
+    bench::Case c;
+    c.bytes = 2 * n * n * sizeof(float);
+    c.items = n * n;
+    auto with = [src, dst, n](transpose_tile_fn tile) {
+        return [src, dst, n, tile] {
+            matrix_transpose32_with(tile, dst.get(), n, src.get(), n, n, n);
+            return probe(dst.get(), n);
+        };
+    };
+    c.variants = {
+        {"naive loop", [src, dst, n] {
+            const float* s = src.get();
+            float* d = dst.get();
+            bench::do_not_optimize(s);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t j = 0; j < n; ++j) d[j * n + i] = s[i * n + j];
+            }
+            bench::clobber_memory();
+            return probe(d, n);
+        }},
+        {"blocked, sse2 tiles", with(transpose32_tile_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"blocked, avx2 tiles", with(transpose32_tile_avx2)});
+    }
+    c.variants.push_back({"assm_matrix_transpose_f32", [src, dst, n] {
+        assm_matrix_transpose_f32(assm_matrix_f32_view(dst.get(), n, n, n),
+                                  assm_matrix_f32_view(src.get(), n, n, n));
+        return probe(dst.get(), n);
+    }});
+    return c;
+});
+
+template<typename T>
+void naive_multiply(T* c, const T* a, const T* b, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            T sum = 0;
+            for (size_t k = 0; k < n; ++k) sum += a[i * n + k] * b[k * n + j];
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+// items are multiply-adds (n^3); bytes are the three matrices
+BENCH_GROUP("matrix_multiply_f32", 16384, 1 << 20, [](size_t bytes) {
+    size_t n = side(bytes);
+    auto a = make_matrix<float>(n, 1);
+    auto b = make_matrix<float>(n, 2);
+    auto out = bench::make_buffer<float>(n * n);
+    auto view = [n](const std::shared_ptr<float>& m) { return assm_matrix_f32_view(m.get(), n, n, n); };
+    bench::Case c;
+    c.bytes = 3 * n * n * sizeof(float);
+    c.items = n * n * n;
+    auto with = [=](gemm_kernel_fn kernel) {
+        return [=] {
+            matrix_multiply_f32_with(kernel, view(out), view(a), view(b));
+            return probe(out.get(), n);
+        };
+    };
+    c.variants = {
+        {"naive triple loop", [=] {
+            naive_multiply(out.get(), a.get(), b.get(), n);
+            bench::clobber_memory();
+            return probe(out.get(), n);
+        }},
+        {"tiled, sse2 6x16", with(gemm_f32_kernel_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"tiled, avx2 fma 6x16", with(gemm_f32_kernel_avx2)});
+    }
+    c.variants.push_back({"assm_matrix_multiply_f32", [=] {
+        assm_matrix_multiply_f32(view(out), view(a), view(b));
+        return probe(out.get(), n);
+    }});
+    return c;
+});
+
+BENCH_GROUP("matrix_multiply_i32", 16384, 1 << 20, [](size_t bytes) {
+    size_t n = side(bytes);
+    auto a = make_matrix<int32_t>(n, 1);
+    auto b = make_matrix<int32_t>(n, 2);
+    auto out = bench::make_buffer<int32_t>(n * n);
+    auto view = [n](const std::shared_ptr<int32_t>& m) { return assm_matrix_i32_view(m.get(), n, n, n); };
+    bench::Case c;
+    c.bytes = 3 * n * n * sizeof(int32_t);
+    c.items = n * n * n;
+    auto with = [=](gemm_kernel_fn kernel) {
+        return [=] {
+            matrix_multiply_i32_with(kernel, view(out), view(a), view(b));
+            return probe(out.get(), n);
+        };
+    };
+    c.variants = {
+        {"naive triple loop", [=] {
+            naive_multiply(out.get(), a.get(), b.get(), n);
+            bench::clobber_memory();
+            return probe(out.get(), n);
+        }},
+        {"tiled, scalar 6x16", with(gemm_i32_kernel_scalar)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_SSE42) {
+        c.variants.push_back({"tiled, sse4.1 6x16", with(gemm_i32_kernel_sse41)});
+    }
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"tiled, avx2 6x16", with(gemm_i32_kernel_avx2)});
+    }
+    c.variants.push_back({"assm_matrix_multiply_i32", [=] {
+        assm_matrix_multiply_i32(view(out), view(a), view(b));
+        return probe(out.get(), n);
+    }});
+    return c;
+});
+
+// Row sums: one reduction per row against a scalar loop
+BENCH_GROUP("matrix_row_sums_f32", 16384, 0, [](size_t bytes) {
+    size_t n = side(bytes);
+    auto m = make_matrix<float>(n, 4);
+    auto sums = bench::make_buffer<float>(n);
+    bench::Case c;
+    c.bytes = n * n * sizeof(float);
+    c.items = n * n;
+    auto with = [=](float (*row_sum)(const float*, size_t)) {
+        return [=] {
+            for (size_t i = 0; i < n; ++i) sums.get()[i] = row_sum(m.get() + i * n, n);
+            return weighted(sums.get(), n);
+        };
+    };
+    c.variants = {
+        {"naive loop", [=] {
+            const float* p = m.get();
+            bench::do_not_optimize(p);
+            for (size_t i = 0; i < n; ++i) {
+                float sum = 0.0f;
+                for (size_t j = 0; j < n; ++j) sum += p[i * n + j];
+                sums.get()[i] = sum;
+            }
+            return weighted(sums.get(), n);
+        }},
+        {"matrix_row_sum_f32_sse2", with(matrix_row_sum_f32_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"matrix_row_sum_f32_avx2", with(matrix_row_sum_f32_avx2)});
+    }
+    c.variants.push_back({"assm_matrix_row_sums_f32", [=] {
+        assm_matrix_row_sums_f32(assm_matrix_f32_view(m.get(), n, n, n), sums.get());
+        return weighted(sums.get(), n);
+    }});
+    return c;
+});
+
+// Column sums: the naive loop walks down each column, one cache line per
+// element; the kernels add whole rows into the sums
+template<typename T, typename S>
+bench::Case make_col_sums_case(size_t bytes, void (*add_row_sse2)(S*, const T*, size_t),
+                               void (*add_row_avx2)(S*, const T*, size_t), const char* assm_name,
+                               void (*assm_sums)(T*, size_t, S*)) {
+    size_t n = side(bytes);
+    auto m = make_matrix<T>(n, 5);
+    auto sums = bench::make_buffer<S>(n);
+    bench::Case c;
+    c.bytes = n * n * sizeof(T);
+    c.items = n * n;
+    auto with = [=](void (*add_row)(S*, const T*, size_t)) {
+        return [=] {
+            std::memset(sums.get(), 0, n * sizeof(S));
+            for (size_t i = 0; i < n; ++i) add_row(sums.get(), m.get() + i * n, n);
+            return weighted(sums.get(), n);
+        };
+    };
+    c.variants = {
+        {"naive column loop", [=] {
+            const T* p = m.get();
+            bench::do_not_optimize(p);
+            for (size_t j = 0; j < n; ++j) {
+                S sum = 0;
+                for (size_t i = 0; i < n; ++i) sum += p[i * n + j];
+                sums.get()[j] = sum;
+            }
+            return weighted(sums.get(), n);
+        }},
+        {"row order, sse2", with(add_row_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"row order, avx2", with(add_row_avx2)});
+    }
+    c.variants.push_back({assm_name, [=] {
+        assm_sums(m.get(), n, sums.get());
+        return weighted(sums.get(), n);
+    }});
+    return c;
+}
+
+BENCH_GROUP("matrix_col_sums_f32", 16384, 0, [](size_t bytes) {
+    return make_col_sums_case<float, float>(
+        bytes, matrix_add_row_f32_sse2, matrix_add_row_f32_avx2, "assm_matrix_col_sums_f32",
+        [](float* data, size_t n, float* sums) {
+            assm_matrix_col_sums_f32(assm_matrix_f32_view(data, n, n, n), sums);
+        });
+});
+
+BENCH_GROUP("matrix_col_sums_i32", 16384, 0, [](size_t bytes) {
+    return make_col_sums_case<int32_t, int64_t>(
+        bytes, matrix_add_row_i32_sse2, matrix_add_row_i32_avx2, "assm_matrix_col_sums_i32",
+        [](int32_t* data, size_t n, int64_t* sums) {
+            assm_matrix_col_sums_i32(assm_matrix_i32_view(data, n, n, n), sums);
+        });
+});
+
+// Storage layouts: the same walk over each layout, with the index computed
+// inline (the cache and TLB behaviour) and through the library accessors
+// (which add a call per element).
+enum class Walk { rows, cols, stencil };
+
+struct Layouts {
+    size_t n;
+    std::shared_ptr<long> row_major, morton, tiled;
+};
+
+Layouts make_layouts(size_t bytes) {
+    size_t n = std::max<size_t>(3, static_cast<size_t>(std::sqrt(static_cast<double>(bytes / 8))));
+    Layouts l{n, bench::make_buffer<long>(n * n), bench::make_buffer<long>(matrix_morton_size(n, n)),
+              bench::make_buffer<long>(matrix_tiled_size(n, n))};
+    for (size_t i = 0; i < n * n; ++i) l.row_major.get()[i] = static_cast<long>(i % 1000);
+    matrix_to_morton(l.morton.get(), l.row_major.get(), n, n);
+    matrix_to_tiled(l.tiled.get(), l.row_major.get(), n, n);
+    return l;
+}
+
+// The layouts' index math, inlined
+inline uint64_t spread(uint64_t x) {
+    x = (x | x << 16) & 0x0000FFFF0000FFFFull;
+    x = (x | x << 8) & 0x00FF00FF00FF00FFull;
+    x = (x | x << 4) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | x << 2) & 0x3333333333333333ull;
+    return (x | x << 1) & 0x5555555555555555ull;
+}
+
+inline size_t tiled_index(size_t n, size_t i, size_t j) {
+    const size_t t = ASSM_MATRIX_TILE;
+    return ((i / t * ((n + t - 1) / t) + j / t) * t + i % t) * t + j % t;
+}
+
+template<typename Get>
+long walk(Walk w, size_t n, Get get) {
+    long sum = 0;
+    if (w == Walk::rows) {
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) sum += get(i, j);
+        }
+    } else if (w == Walk::cols) {
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < n; ++i) sum += get(i, j);
+        }
+    } else {
+        // 5-point stencil at every interior point, row by row
+        for (size_t i = 1; i + 1 < n; ++i) {
+            for (size_t j = 1; j + 1 < n; ++j) {
+                sum += 4 * get(i, j) - get(i - 1, j) - get(i + 1, j) - get(i, j - 1) - get(i, j + 1);
+            }
+        }
+    }
+    return sum;
+}
+
+bench::Case make_layout_case(size_t bytes, Walk w) {
+    Layouts l = make_layouts(bytes);
+    size_t n = l.n;
+    bench::Case c;
+    c.items = w == Walk::stencil ? 5 * (n - 2) * (n - 2) : n * n;
+    c.bytes = c.items * sizeof(long);
+    c.variants = {
+        {"row-major, direct index", [l, n, w] {
+            const long* m = l.row_major.get();
+            bench::do_not_optimize(m);
+            return walk(w, n, [m, n](size_t i, size_t j) { return m[i * n + j]; });
+        }},
+        {"z-order, inline index", [l, n, w] {
+            const long* m = l.morton.get();
+            bench::do_not_optimize(m);
+            return walk(w, n, [m](size_t i, size_t j) { return m[spread(j) | spread(i) << 1]; });
+        }},
+        {"tiled, inline index", [l, n, w] {
+            const long* m = l.tiled.get();
+            bench::do_not_optimize(m);
+            return walk(w, n, [m, n](size_t i, size_t j) { return m[tiled_index(n, i, j)]; });
+        }},
+        {"row-major, matrix_get_asm", [l, n, w] {
+            const long* m = l.row_major.get();
+            return walk(w, n, [m, n](size_t i, size_t j) { return matrix_get_asm(m, n, n, i, j); });
+        }},
+        {"z-order, matrix_get_morton_asm", [l, n, w] {
+            const long* m = l.morton.get();
+            return walk(w, n, [m](size_t i, size_t j) { return matrix_get_morton_asm(m, i, j); });
+        }},
+        {"tiled, matrix_get_tiled_asm", [l, n, w] {
+            const long* m = l.tiled.get();
+            return walk(w, n, [m, n](size_t i, size_t j) { return matrix_get_tiled_asm(m, n, i, j); });
+        }},
+    };
+    return c;
+}
+
+BENCH_GROUP("matrix_layout_rows", 16384, 64 << 20, [](size_t bytes) { return make_layout_case(bytes, Walk::rows); });
+BENCH_GROUP("matrix_layout_cols", 16384, 64 << 20, [](size_t bytes) { return make_layout_case(bytes, Walk::cols); });
+BENCH_GROUP("matrix_layout_stencil", 16384, 64 << 20, [](size_t bytes) {
+    return make_layout_case(bytes, Walk::stencil);
+});
+
+// Random (row, col) lookups into an n x n long matrix: one call each
+// against the batched kernels at a few prefetch distances
+BENCH_GROUP("matrix_get_batch", 16384, 0, [](size_t bytes) {
+    const size_t lookups = 65536;
+    size_t n = std::max<size_t>(1, static_cast<size_t>(std::sqrt(static_cast<double>(bytes / 8))));
+    auto matrix = bench::make_buffer<long>(n * n);
+    auto rows = bench::make_buffer<size_t>(lookups);
+    auto cols = bench::make_buffer<size_t>(lookups);
+    auto out = bench::make_buffer<long>(lookups);
+    for (size_t i = 0; i < n * n; ++i) matrix.get()[i] = static_cast<long>(i % 4099);
+    bench::Rng rng(9);
+    for (size_t i = 0; i < lookups; ++i) {
+        rows.get()[i] = rng.next() % n;
+        cols.get()[i] = rng.next() % n;
+    }
+    auto total = [out] {
+        long sum = 0;
+        for (size_t i = 0; i < lookups; ++i) sum += out.get()[i];
+        return sum;
+    };
+    using GatherFn = void (*)(const long*, size_t, const size_t*, const size_t*, size_t, long*, size_t);
+    auto with = [=](GatherFn gather, size_t distance) {
+        return [=] {
+            gather(matrix.get(), n, rows.get(), cols.get(), lookups, out.get(), distance);
+            return total();
+        };
+    };
+    bench::Case c;
+    c.bytes = lookups * sizeof(long);
+    c.items = lookups;
+    c.variants = {
+        {"matrix_get_asm per lookup", [=] {
+            for (size_t i = 0; i < lookups; ++i) {
+                out.get()[i] = matrix_get_asm(matrix.get(), n, n, rows.get()[i], cols.get()[i]);
+            }
+            return total();
+        }},
+        {"scalar, no prefetch", with(matrix_gather_scalar, 0)},
+        {"scalar, prefetch 16", with(matrix_gather_scalar, 16)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"vpgatherqq, no prefetch", with(matrix_gather_avx2, 0)});
+        c.variants.push_back({"vpgatherqq, prefetch 16", with(matrix_gather_avx2, 16)});
+        c.variants.push_back({"vpgatherqq, prefetch 64", with(matrix_gather_avx2, 64)});
+    }
+    c.variants.push_back({"matrix_get_batch_asm", [=] {
+        matrix_get_batch_asm(matrix.get(), n, rows.get(), cols.get(), lookups, out.get(),
+                             ASSM_MATRIX_PREFETCH_DISTANCE);
+        return total();
+    }});
+    return c;
+});
+
+} // namespace
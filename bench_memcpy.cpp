@@ -0,0 +1,127 @@
+// bench_memcpy.cpp - Copy engine benchmarks (assm_memcpy.c vs glibc)
+//
+// The per-strategy variants (loop, erms, stream) run one strategy at every
+// size, so their curves show where the size-class thresholds should sit.
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+using CopyFn = void* (*)(void*, const void*, size_t);
+
+std::shared_ptr<unsigned char> make_bytes(size_t count, uint64_t seed) {
+    auto buf = bench::make_buffer<unsigned char>(count);
+    bench::Rng rng(seed);
+    for (size_t i = 0; i < count; ++i) buf.get()[i] = static_cast<unsigned char>(rng.next());
+    return buf;
+}
+
+// Variants shared by the memcpy groups, best available first after libc
+std::vector<std::pair<const char*, CopyFn>> copy_variants() {
+    std::vector<std::pair<const char*, CopyFn>> fns = {
+        {"memcpy (libc)", [](void* d, const void* s, size_t n) { return std::memcpy(d, s, n); }},
+        {"memcpy_asm", memcpy_asm},
+        {"memcpy_loop_sse2", memcpy_loop_sse2},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        fns.push_back({"memcpy_loop_avx2", memcpy_loop_avx2});
+        fns.push_back({"memcpy_stream_avx2", memcpy_stream_avx2});
+    } else {
+        fns.push_back({"memcpy_stream_sse2", memcpy_stream_sse2});
+    }
+    if (assm_cpu_features() & ASSM_CPU_ERMS) fns.push_back({"memcpy_erms", memcpy_erms});
+    return fns;
+}
+
+// One copy of `bytes` bytes per run; src and dst both count toward GB/s
+BENCH_GROUP("memcpy", 1, 0, [](size_t bytes) {
+    auto src = make_bytes(bytes, 1);
+    auto dst = bench::make_buffer<unsigned char>(bytes);
+    bench::Case c;
+    c.bytes = 2 * bytes;
+    c.items = bytes;
+    for (const auto& fn : copy_variants()) {
+        CopyFn copy = fn.second;
+        c.variants.push_back({fn.first, [src, dst, bytes, copy] {
+            unsigned char* d = dst.get();
+            bench::do_not_optimize(d);
+            copy(d, src.get(), bytes);
+            bench::clobber_memory();
+            return d[0] + d[bytes / 2] * 3u + d[bytes - 1] * 7u;
+        }});
+    }
+    return c;
+});
+
+// 256 copies per run with sizes drawn from [bytes / 2, bytes] and random
+// offsets, so the size-class branches are not perfectly predicted
+BENCH_GROUP("memcpy_random", 8, 16384, [](size_t bytes) {
+    const size_t copies = 256;
+    const size_t span = 2 * bytes + 64;
+    auto src = make_bytes(span, 1);
+    auto dst = bench::make_buffer<unsigned char>(span);
+    auto sizes = bench::make_buffer<uint32_t>(copies);
+    auto offsets = bench::make_buffer<uint32_t>(copies);
+    bench::Rng rng(7);
+    size_t total = 0;
+    for (size_t i = 0; i < copies; ++i) {
+        sizes.get()[i] = static_cast<uint32_t>(bytes / 2 + rng.next() % (bytes / 2 + 1));
+        offsets.get()[i] = static_cast<uint32_t>(rng.next() % (span - sizes.get()[i] + 1));
+        total += sizes.get()[i];
+    }
+    bench::Case c;
+    c.bytes = 2 * total;
+    c.items = copies;
+    for (const auto& fn : copy_variants()) {
+        CopyFn copy = fn.second;
+        c.variants.push_back({fn.first, [src, dst, sizes, offsets, copy] {
+            unsigned char* d = dst.get();
+            uint64_t sum = 0;
+            for (size_t i = 0; i < copies; ++i) {
+                size_t n = sizes.get()[i], off = offsets.get()[i];
+                bench::do_not_optimize(d);
+                copy(d + off, src.get() + off, n);
+                bench::clobber_memory();
+                sum += d[off] + d[off + n - 1];
+            }
+            return sum;
+        }});
+    }
+    return c;
+});
+
+// Overlapping moves by one cache line, up then back down, so every run
+// leaves the buffer as it found it and exercises both loop directions
+BENCH_GROUP("memmove_overlap", 16, 0, [](size_t bytes) {
+    const size_t shift = 64;
+    auto buf = make_bytes(bytes + shift, 3);
+    bench::Case c;
+    c.bytes = 4 * bytes;
+    c.items = 2 * bytes;
+    auto run = [buf, bytes](CopyFn move) {
+        unsigned char* b = buf.get();
+        bench::do_not_optimize(b);
+        move(b + shift, b, bytes);
+        bench::clobber_memory();
+        move(b, b + shift, bytes);
+        bench::clobber_memory();
+        return b[0] + b[bytes / 2] * 3u + b[bytes + shift - 1] * 7u;
+    };
+    c.variants = {
+        {"memmove (libc)", [run] {
+            return run([](void* d, const void* s, size_t n) { return std::memmove(d, s, n); });
+        }},
+        {"memmove_asm", [run] { return run(memmove_asm); }},
+        {"memmove_sse2", [run] { return run(memmove_sse2); }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"memmove_avx2", [run] { return run(memmove_avx2); }});
+    }
+    return c;
+});
+
+} // namespace
@@ -0,0 +1,135 @@
+// bench_parallel.cpp - Parallel reduction benchmarks (assm_parallel.c): thread scaling against
+// the single-threaded kernels and the pool's read bandwidth
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// 1, 2, 4, ... threads and the whole pool
+std::vector<unsigned> thread_counts() {
+    std::vector<unsigned> counts;
+    unsigned pool = assm_parallel_threads();
+    for (unsigned t = 1; t < pool; t *= 2) counts.push_back(t);
+    counts.push_back(pool);
+    return counts;
+}
+
+std::string threads_name(unsigned t) {
+    return std::to_string(t) + (t == 1 ? " thread" : " threads");
+}
+
+// The baseline, then fn(t) for every thread count
+template <typename Fn>
+void add_thread_variants(bench::Case& c, Fn fn) {
+    for (unsigned t : thread_counts()) {
+        c.variants.push_back({threads_name(t), [fn, t] { return fn(t); }});
+    }
+}
+
+std::shared_ptr<long> make_longs(size_t count) {
+    auto arr = bench::make_buffer<long>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) arr.get()[i] = static_cast<long>(rng.next() % 2048) - 1024;
+    return arr;
+}
+
+// The ceiling for every group below: each thread streams its share of the
+// buffer through memchr_asm, which loads and compares and nothing else
+struct read_job {
+    const char* data;
+    size_t bytes;
+    size_t found;
+};
+
+void read_worker(void* ctx, unsigned index, unsigned count) {
+    auto* job = static_cast<read_job*>(ctx);
+    size_t first = job->bytes * index / count & ~size_t(63);
+    size_t last = index + 1 == count ? job->bytes : job->bytes * (index + 1) / count & ~size_t(63);
+    if (memchr_asm(job->data + first, 1, last - first)) __atomic_fetch_add(&job->found, 1, __ATOMIC_RELAXED);
+}
+
+BENCH_GROUP("parallel_read_bandwidth", 1 << 20, 0, [](size_t bytes) {
+    auto buf = bench::make_buffer<char>(bytes);
+    bench::Case c;
+    c.bytes = c.items = bytes;
+    add_thread_variants(c, [buf, bytes](unsigned t) {
+        read_job job = {buf.get(), bytes, 0};
+        parallel_run(read_worker, &job, parallel_threads(t));
+        return job.found;
+    });
+    return c;
+});
+
+BENCH_GROUP("parallel_sum", 1 << 20, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    auto arr = make_longs(count);
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    c.variants = {{"array_sum_asm", [arr, count] { return array_sum_asm(arr.get(), count); }}};
+    add_thread_variants(c, [arr, count](unsigned t) {
+        return array_sum_parallel(arr.get(), count, t);
+    });
+    return c;
+});
+
+BENCH_GROUP("parallel_max", 1 << 20, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(long);
+    auto arr = make_longs(count);
+    bench::Case c;
+    c.bytes = count * sizeof(long);
+    c.items = count;
+    c.variants = {{"array_max_asm", [arr, count] { return array_max_asm(arr.get(), count); }}};
+    add_thread_variants(c, [arr, count](unsigned t) {
+        return array_max_parallel(arr.get(), count, t);
+    });
+    return c;
+});
+
+BENCH_GROUP("parallel_popcount", 1 << 20, 0, [](size_t bytes) {
+    size_t count = bytes / sizeof(uint64_t);
+    auto words = bench::make_buffer<uint64_t>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) words.get()[i] = rng.next();
+    bench::Case c;
+    c.bytes = count * sizeof(uint64_t);
+    c.items = count;
+    c.variants = {{"popcount_asm loop", [words, count] {
+        const uint64_t* w = words.get();
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; ++i) total += popcount_asm(w[i]);
+        return total;
+    }}};
+    add_thread_variants(c, [words, count](unsigned t) {
+        return popcount_parallel(words.get(), count, t);
+    });
+    return c;
+});
+
+BENCH_GROUP("parallel_dot", 1 << 20, 0, [](size_t bytes) {
+    size_t count = bytes / (2 * sizeof(float));
+    auto a = bench::make_buffer<float>(count);
+    auto b = bench::make_buffer<float>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) {
+        a.get()[i] = static_cast<float>(rng.next() % 1000) / 1000.0f;
+        b.get()[i] = static_cast<float>(rng.next() % 1000) / 1000.0f;
+    }
+    bench::Case c;
+    c.bytes = 2 * count * sizeof(float);
+    c.items = count;
+    c.tolerance = 1e-4;
+    c.variants = {{"dot_product_sse", [a, b, count] {
+        return dot_product_sse(a.get(), b.get(), static_cast<int>(count));
+    }}};
+    add_thread_variants(c, [a, b, count](unsigned t) {
+        return dot_product_parallel(a.get(), b.get(), count, t);
+    });
+    return c;
+});
+
+} // namespace
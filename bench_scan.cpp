@@ -0,0 +1,90 @@
+// bench_scan.cpp - Prefix sum benchmarks (assm_scan.c vs a serial loop and the STL)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <numeric>
+
+namespace {
+
+// Out-of-place scans of small random values. Each variant returns a few
+// entries of its output, which every correct scan agrees on.
+template <typename T>
+bench::Case make_scan_case(size_t bytes, int mode,
+                           T (*sse2)(T*, const T*, size_t, T, int64_t),
+                           T (*avx2)(T*, const T*, size_t, T, int64_t),
+                           void (*serial)(T*, const T*, size_t, int),
+                           void (*parallel)(T*, const T*, size_t, int, unsigned)) {
+    size_t count = bytes / sizeof(T);
+    auto src = bench::make_buffer<T>(count);
+    auto dst = bench::make_buffer<T>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) src.get()[i] = static_cast<T>(rng.next() % 2048) - 1024;
+    bench::Case c;
+    c.bytes = 2 * count * sizeof(T);
+    c.items = count;
+    auto result = [dst, count] {
+        bench::clobber_memory();
+        const T* d = dst.get();
+        return static_cast<uint64_t>(d[count / 2]) + static_cast<uint64_t>(d[count - 1]);
+    };
+    auto kernel = [src, dst, count, mode, result](T (*fn)(T*, const T*, size_t, T, int64_t)) {
+        return [src, dst, count, mode, result, fn] {
+            fn(dst.get(), src.get(), count, 0, mode == ASSM_SCAN_EXCLUSIVE ? -1 : 0);
+            return result();
+        };
+    };
+    c.variants = {
+        {"serial loop", [src, dst, count, mode, result] {
+            const T* s = src.get();
+            T* d = dst.get();
+            bench::do_not_optimize(s);
+            T sum = 0;
+            if (mode == ASSM_SCAN_EXCLUSIVE) {
+                for (size_t i = 0; i < count; ++i) {
+                    d[i] = sum;
+                    sum += s[i];
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) d[i] = sum += s[i];
+            }
+            return result();
+        }},
+        {mode == ASSM_SCAN_EXCLUSIVE ? "std::exclusive_scan" : "std::inclusive_scan",
+         [src, dst, count, mode, result] {
+            const T* s = src.get();
+            bench::do_not_optimize(s);
+            if (mode == ASSM_SCAN_EXCLUSIVE) std::exclusive_scan(s, s + count, dst.get(), T(0));
+            else std::inclusive_scan(s, s + count, dst.get());
+            return result();
+        }},
+        {"sse2", kernel(sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) c.variants.push_back({"avx2", kernel(avx2)});
+    c.variants.push_back({"array_scan_*_asm", [src, dst, count, mode, result, serial] {
+        serial(dst.get(), src.get(), count, mode);
+        return result();
+    }});
+    c.variants.push_back({"array_scan_*_parallel", [src, dst, count, mode, result, parallel] {
+        parallel(dst.get(), src.get(), count, mode, 0);
+        return result();
+    }});
+    return c;
+}
+
+BENCH_GROUP("scan_i64_inclusive", 8, 0, [](size_t bytes) {
+    return make_scan_case<int64_t>(bytes, ASSM_SCAN_INCLUSIVE, scan_i64_sse2, scan_i64_avx2,
+                                   array_scan_i64_asm, array_scan_i64_parallel);
+});
+
+BENCH_GROUP("scan_i64_exclusive", 8, 0, [](size_t bytes) {
+    return make_scan_case<int64_t>(bytes, ASSM_SCAN_EXCLUSIVE, scan_i64_sse2, scan_i64_avx2,
+                                   array_scan_i64_asm, array_scan_i64_parallel);
+});
+
+BENCH_GROUP("scan_i32_inclusive", 4, 0, [](size_t bytes) {
+    return make_scan_case<int32_t>(bytes, ASSM_SCAN_INCLUSIVE, scan_i32_sse2, scan_i32_avx2,
+                                   array_scan_i32_asm, array_scan_i32_parallel);
+});
+
+} // namespace
@@ -0,0 +1,263 @@
+// bench_search.cpp - Substring and multi-pattern search benchmarks
+// (assm_search.c vs libc/STL)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Log-like text: lines of words from a small vocabulary, so first/last byte
+// pairs of a needle do occur but rarely line up
+std::shared_ptr<char> make_log(size_t bytes) {
+    static const char* const words[] = {
+        "INFO", "WARN", "request", "served", "user", "id=", "latency", "ms", "GET", "POST",
+        "/api/v1/items", "status=200", "cache", "hit", "miss", "worker", "queue", "retry",
+    };
+    const size_t count = sizeof(words) / sizeof(words[0]);
+    auto buf = bench::make_buffer<char>(bytes + 1);
+    char* text = buf.get();
+    bench::Rng rng(11);
+    size_t pos = 0, line = 0;
+    while (pos < bytes) {
+        const char* word = words[rng.next() % count];
+        size_t len = std::min(std::strlen(word), bytes - pos);
+        std::memcpy(text + pos, word, len);
+        pos += len;
+        line += len;
+        if (pos < bytes) text[pos++] = line > 80 ? '\n' : ' ';
+        if (line > 80) line = 0;
+    }
+    text[bytes] = '\0';
+    return buf;
+}
+
+// Offset of the match, or the haystack size when there is none
+size_t offset_of(const void* match, const char* hay, size_t n) {
+    return match ? static_cast<size_t>(static_cast<const char*>(match) - hay) : n;
+}
+
+// The plain loop the request replaces: memcmp at every position
+const char* naive_search(const char* hay, size_t n, const char* needle, size_t len) {
+    for (size_t i = 0; i + len <= n; ++i) {
+        if (std::memcmp(hay + i, needle, len) == 0) return hay + i;
+    }
+    return nullptr;
+}
+
+// One needle searched in a bytes-long haystack; the needle is planted at the
+// very end, so every variant scans the whole haystack
+bench::Case make_memmem_case(std::shared_ptr<char> hay, size_t bytes, std::string needle,
+                             bool with_naive) {
+    if (needle.size() <= bytes) {
+        std::memcpy(hay.get() + bytes - needle.size(), needle.data(), needle.size());
+    }
+    auto pre = std::make_shared<assm_needle>();
+    auto pattern = std::make_shared<std::string>(needle);
+    assm_needle_init(pre.get(), pattern->data(), pattern->size());
+    bench::Case c;
+    c.bytes = c.items = bytes;
+    c.variants = {
+        {"memmem (libc)", [hay, bytes, pattern] {
+            const char* h = hay.get();
+            bench::do_not_optimize(h);
+            return offset_of(memmem(h, bytes, pattern->data(), pattern->size()), h, bytes);
+        }},
+        {"std::search (BMH)", [hay, bytes, pattern] {
+            const char* h = hay.get();
+            bench::do_not_optimize(h);
+            std::boyer_moore_horspool_searcher<std::string::const_iterator> searcher(
+                pattern->begin(), pattern->end());
+            const char* found = std::search(h, h + bytes, searcher);
+            return offset_of(found == h + bytes ? nullptr : found, h, bytes);
+        }},
+        {"memmem_asm", [hay, bytes, pattern] {
+            const char* h = hay.get();
+            return offset_of(memmem_asm(h, bytes, pattern->data(), pattern->size()), h, bytes);
+        }},
+        {"assm_needle_find", [hay, bytes, pattern, pre] {
+            const char* h = hay.get();
+            return offset_of(assm_needle_find(pre.get(), h, bytes), h, bytes);
+        }},
+    };
+    if (with_naive) {
+        c.variants.push_back({"naive loop", [hay, bytes, pattern] {
+            const char* h = hay.get();
+            bench::do_not_optimize(h);
+            return offset_of(naive_search(h, bytes, pattern->data(), pattern->size()), h, bytes);
+        }});
+    }
+    return c;
+}
+
+// Short needle in log text: the SIMD first/last byte filter
+BENCH_GROUP("memmem_log", 64, 0, [](size_t bytes) {
+    return make_memmem_case(make_log(bytes), bytes, "status=503", bytes <= (64 << 20));
+});
+
+// 200-byte needle made of log words
+BENCH_GROUP("memmem_long", 256, 0, [](size_t bytes) {
+    std::string needle;
+    while (needle.size() < 200) needle += "latency retry queue worker ms ";
+    needle.resize(200);
+    return make_memmem_case(make_log(bytes), bytes, needle, false);
+});
+
+// Repetitive input (a^n against a^15 b a^16): first and last byte match at
+// every position, so the filter hands over to Two-Way early on
+BENCH_GROUP("memmem_worst", 64, 0, [](size_t bytes) {
+    auto hay = bench::make_buffer<char>(bytes + 1);
+    std::memset(hay.get(), 'a', bytes);
+    return make_memmem_case(hay, bytes, std::string(15, 'a') + "b" + std::string(16, 'a'), false);
+});
+
+// Many short lines searched for one pattern: per-call setup dominates
+BENCH_GROUP("memmem_lines", 4096, 0, [](size_t bytes) {
+    const size_t line = 96;
+    auto hay = make_log(bytes);
+    auto pattern = std::make_shared<std::string>("request served user id= latency ms GET /api/v1/items status=503 worker queue retry cache");
+    auto pre = std::make_shared<assm_needle>();
+    assm_needle_init(pre.get(), pattern->data(), pattern->size());
+    size_t lines = bytes / line;
+    auto scan = [hay, lines](const std::function<const void*(const char*)>& find) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < lines; ++i) {
+            const char* h = hay.get() + i * line;
+            bench::do_not_optimize(h);
+            sum += offset_of(find(h), h, line);
+        }
+        return sum;
+    };
+    bench::Case c;
+    c.bytes = lines * line;
+    c.items = lines;
+    c.variants = {
+        {"memmem (libc)", [scan, pattern] {
+            return scan([&](const char* h) { return memmem(h, line, pattern->data(), pattern->size()); });
+        }},
+        {"memmem_asm", [scan, pattern] {
+            return scan([&](const char* h) { return memmem_asm(h, line, pattern->data(), pattern->size()); });
+        }},
+        {"assm_needle_find", [scan, pre] {
+            return scan([&](const char* h) { return assm_needle_find(pre.get(), h, line); });
+        }},
+    };
+    return c;
+});
+
+BENCH_GROUP("strstr_log", 64, 0, [](size_t bytes) {
+    auto hay = make_log(bytes);
+    const char* needle = "status=503";
+    std::memcpy(hay.get() + bytes - std::strlen(needle), needle, std::strlen(needle));
+    bench::Case c;
+    c.bytes = c.items = bytes;
+    c.variants = {
+        {"strstr (libc)", [hay, bytes, needle] {
+            const char* h = hay.get();
+            bench::do_not_optimize(h);
+            return offset_of(std::strstr(h, needle), h, bytes);
+        }},
+        {"strstr_asm", [hay, bytes, needle] {
+            const char* h = hay.get();
+            return offset_of(strstr_asm(h, needle), h, bytes);
+        }},
+    };
+    return c;
+});
+
+// Keywords for the multi-pattern groups: a few that occur in the log text,
+// padded with random lowercase words that mostly do not
+std::shared_ptr<std::vector<std::string>> make_keywords(size_t count) {
+    static const char* const hits[] = { "retry", "status=200", "miss", "latency" };
+    auto keywords = std::make_shared<std::vector<std::string>>();
+    bench::Rng rng(23);
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 8 == 0 && i / 8 < 4) {
+            keywords->push_back(hits[i / 8]);
+            continue;
+        }
+        std::string word(4 + rng.next() % 8, ' ');
+        for (char& ch : word) ch = static_cast<char>('a' + rng.next() % 26);
+        keywords->push_back(word);
+    }
+    return keywords;
+}
+
+// Order-independent checksum, since the automaton and the prefilter report
+// matches in different orders
+struct MatchSum {
+    uint64_t sum = 0;
+    void add(size_t pattern, size_t start) { sum += pattern * 1000003 + start; }
+};
+
+int add_match(void* context, size_t pattern, size_t start) {
+    static_cast<MatchSum*>(context)->add(pattern, start);
+    return 0;
+}
+
+// Every occurrence of every keyword in bytes of log text; the baseline runs
+// memmem_asm once per keyword, which the matchers replace
+bench::Case make_matcher_case(size_t bytes, size_t count) {
+    auto hay = make_log(bytes);
+    auto keywords = make_keywords(count);
+    std::vector<const char*> patterns;
+    std::vector<size_t> lengths;
+    for (const auto& k : *keywords) {
+        patterns.push_back(k.data());
+        lengths.push_back(k.size());
+    }
+    std::shared_ptr<assm_matcher> matcher(
+        assm_matcher_create(patterns.data(), lengths.data(), count), assm_matcher_free);
+    std::shared_ptr<assm_matcher> automaton(
+        assm_matcher_create_with(patterns.data(), lengths.data(), count, 0), assm_matcher_free);
+    bench::Case c;
+    c.bytes = c.items = bytes;
+    if (count <= 64) {
+        c.variants.push_back({"memmem_asm per keyword", [hay, bytes, keywords] {
+            MatchSum sum;
+            const char* h = hay.get();
+            bench::do_not_optimize(h);
+            for (size_t p = 0; p < keywords->size(); ++p) {
+                const std::string& k = (*keywords)[p];
+                const char* at = h;
+                while (const void* found = memmem_asm(at, bytes - (at - h), k.data(), k.size())) {
+                    at = static_cast<const char*>(found);
+                    sum.add(p, at - h);
+                    ++at;
+                }
+            }
+            return sum.sum;
+        }});
+    }
+    c.variants.push_back({"aho-corasick", [hay, bytes, automaton] {
+        MatchSum sum;
+        const char* h = hay.get();
+        bench::do_not_optimize(h);
+        assm_matcher_scan(automaton.get(), h, bytes, add_match, &sum);
+        return sum.sum;
+    }});
+    if (count < 64) {
+        c.variants.push_back({"assm_matcher_scan", [hay, bytes, matcher] {
+            MatchSum sum;
+            const char* h = hay.get();
+            bench::do_not_optimize(h);
+            assm_matcher_scan(matcher.get(), h, bytes, add_match, &sum);
+            return sum.sum;
+        }});
+    }
+    return c;
+}
+
+// Teddy prefilter territory: one and several buckets' worth of keywords
+BENCH_GROUP("matcher_8", 256, 0, [](size_t bytes) { return make_matcher_case(bytes, 8); });
+BENCH_GROUP("matcher_48", 256, 0, [](size_t bytes) { return make_matcher_case(bytes, 48); });
+
+// A large dictionary: the automaton alone
+BENCH_GROUP("matcher_500", 256, 0, [](size_t bytes) { return make_matcher_case(bytes, 500); });
+
+} // namespace
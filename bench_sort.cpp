@@ -0,0 +1,126 @@
+// bench_sort.cpp - Sorting benchmarks (assm_sort.c vs std::sort and std::stable_sort)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Every run copies the same random input into a work buffer and sorts it
+// there, so the copy is part of each variant's time. Variants return a few
+// entries of the sorted output, which every correct sort agrees on.
+template <typename T>
+bench::Case make_sort_case(size_t bytes, unsigned key_bits, size_t small_max,
+                           int (*sort)(T*, size_t), void (*small)(T*, size_t)) {
+    size_t count = bytes / sizeof(T);
+    auto src = bench::make_buffer<T>(count);
+    auto work = bench::make_buffer<T>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t value = rng.next();
+        src.get()[i] = static_cast<T>(key_bits < 64 ? value >> (64 - key_bits) : value);
+    }
+    bench::Case c;
+    c.bytes = count * sizeof(T);
+    c.items = count;
+    auto load = [src, work, count] {
+        std::memcpy(work.get(), src.get(), count * sizeof(T));
+        bench::clobber_memory();
+        return work.get();
+    };
+    auto result = [work, count] {
+        bench::clobber_memory();
+        const T* w = work.get();
+        return static_cast<uint64_t>(w[0]) + static_cast<uint64_t>(w[count / 2]) +
+               static_cast<uint64_t>(w[count - 1]);
+    };
+    c.variants = {
+        {"std::sort", [load, result, count] {
+            T* w = load();
+            std::sort(w, w + count);
+            return result();
+        }},
+        {"radix", [load, result, count] {
+            sort_radix(load(), nullptr, count, sizeof(T) == 8);
+            return result();
+        }},
+    };
+    if (count <= small_max) {
+        c.variants.push_back({"networks", [load, result, count, small] {
+            small(load(), count);
+            return result();
+        }});
+    }
+    c.variants.push_back({"array_sort_*", [load, result, count, sort] {
+        sort(load(), count);
+        return result();
+    }});
+    return c;
+}
+
+// Keys and payloads in separate arrays; the STL baseline sorts (key,
+// payload) pairs stably and splits them back
+template <typename T, typename P>
+bench::Case make_payload_case(size_t bytes, int (*sort)(T*, P*, size_t)) {
+    size_t count = bytes / sizeof(T);
+    auto src = bench::make_buffer<T>(count);
+    auto keys = bench::make_buffer<T>(count);
+    auto payload = bench::make_buffer<P>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < count; ++i) src.get()[i] = static_cast<T>(rng.next());
+    bench::Case c;
+    c.bytes = count * (sizeof(T) + sizeof(P));
+    c.items = count;
+    auto result = [keys, payload, count] {
+        bench::clobber_memory();
+        return static_cast<uint64_t>(keys.get()[count / 2]) + static_cast<uint64_t>(payload.get()[count / 2]) +
+               static_cast<uint64_t>(payload.get()[count - 1]);
+    };
+    c.variants = {
+        {"std::stable_sort", [src, keys, payload, count, result] {
+            std::vector<std::pair<T, P>> pairs(count);
+            const T* s = src.get();
+            bench::do_not_optimize(s);
+            for (size_t i = 0; i < count; ++i) pairs[i] = {s[i], static_cast<P>(i)};
+            std::stable_sort(pairs.begin(), pairs.end(),
+                             [](const std::pair<T, P>& a, const std::pair<T, P>& b) { return a.first < b.first; });
+            for (size_t i = 0; i < count; ++i) {
+                keys.get()[i] = pairs[i].first;
+                payload.get()[i] = pairs[i].second;
+            }
+            return result();
+        }},
+        {"array_sort_*_payload", [src, keys, payload, count, result, sort] {
+            std::memcpy(keys.get(), src.get(), count * sizeof(T));
+            for (size_t i = 0; i < count; ++i) payload.get()[i] = static_cast<P>(i);
+            sort(keys.get(), payload.get(), count);
+            return result();
+        }},
+    };
+    return c;
+}
+
+constexpr size_t kSortMax = size_t(128) << 20;   // 16M int64 keys
+
+BENCH_GROUP("sort_i64", 8, kSortMax, [](size_t bytes) {
+    return make_sort_case<int64_t>(bytes, 64, SORT_SMALL_MAX_I64, array_sort_i64, sort_small_i64);
+});
+
+// Keys under 2^24: five of the eight digits are constant and skipped
+BENCH_GROUP("sort_i64_narrow", 8, kSortMax, [](size_t bytes) {
+    return make_sort_case<int64_t>(bytes, 24, SORT_SMALL_MAX_I64, array_sort_i64, sort_small_i64);
+});
+
+BENCH_GROUP("sort_i32", 4, kSortMax, [](size_t bytes) {
+    return make_sort_case<int32_t>(bytes, 64, SORT_SMALL_MAX_I32, array_sort_i32, sort_small_i32);
+});
+
+BENCH_GROUP("sort_i64_payload", 8, kSortMax, [](size_t bytes) {
+    return make_payload_case<int64_t, uint64_t>(bytes, array_sort_i64_payload);
+});
+
+} // namespace
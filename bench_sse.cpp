@@ -0,0 +1,81 @@
+// bench_sse.cpp - SSE floating point benchmarks (assm_sse.c vs plain loops)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+namespace {
+
+// Small integers keep every partial sum exact, so summation order does not
+// change the result
+std::shared_ptr<float> make_floats(size_t count, uint64_t seed) {
+    auto arr = bench::make_buffer<float>(count);
+    bench::Rng rng(seed);
+    for (size_t i = 0; i < count; ++i) {
+        arr.get()[i] = static_cast<float>(static_cast<int>(rng.next() % 5) - 2);
+    }
+    return arr;
+}
+
+BENCH_GROUP("dot_product", 8, 0, [](size_t bytes) {
+    size_t count = bytes / (2 * sizeof(float));
+    auto a = make_floats(count, 1);
+    auto b = make_floats(count, 2);
+    bench::Case c;
+    c.bytes = 2 * count * sizeof(float);
+    c.items = count;
+    c.variants = {
+        {"plain loop", [a, b, count] {
+            const float* pa = a.get();
+            const float* pb = b.get();
+            bench::do_not_optimize(pa);
+            float sum = 0.0f;
+            for (size_t i = 0; i < count; ++i) sum += pa[i] * pb[i];
+            return sum;
+        }},
+        {"dot_product_sse", [a, b, count] {
+            return dot_product_sse(a.get(), b.get(), static_cast<int>(count));
+        }},
+        {"dot_product_sse2", [a, b, count] {
+            return dot_product_sse2(a.get(), b.get(), static_cast<int>(count));
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"dot_product_avx2", [a, b, count] {
+            return dot_product_avx2(a.get(), b.get(), static_cast<int>(count));
+        }});
+    }
+    return c;
+});
+
+BENCH_GROUP("add_vectors", 64, 0, [](size_t bytes) {
+    size_t count = (bytes / (3 * sizeof(float))) & ~size_t(3);
+    if (count == 0) count = 4;
+    auto a = make_floats(count, 1);
+    auto b = make_floats(count, 2);
+    auto out = bench::make_buffer<float>(count);
+    auto checksum = [out, count] {
+        double sum = 0.0;
+        for (size_t i = 0; i < count; i += 4096) sum += out.get()[i] * static_cast<double>(i + 1);
+        return sum + out.get()[count - 1];
+    };
+    bench::Case c;
+    c.bytes = 3 * count * sizeof(float);
+    c.items = count;
+    c.variants = {
+        {"plain loop", [a, b, out, count, checksum] {
+            const float* pa = a.get();
+            bench::do_not_optimize(pa);
+            for (size_t i = 0; i < count; ++i) out.get()[i] = pa[i] + b.get()[i];
+            return checksum();
+        }},
+        {"add_vectors_sse", [a, b, out, count, checksum] {
+            for (size_t i = 0; i < count; i += 4) {
+                add_vectors_sse(a.get() + i, b.get() + i, out.get() + i);
+            }
+            return checksum();
+        }},
+    };
+    return c;
+});
+
+} // namespace
@@ -0,0 +1,504 @@
+// bench_string.cpp - String kernel benchmarks (assm_string.c vs libc)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// bytes - 1 non-zero characters followed by the terminator
+std::shared_ptr<char> make_string(size_t bytes) {
+    auto buf = bench::make_buffer<char>(bytes);
+    bench::Rng rng;
+    for (size_t i = 0; i + 1 < bytes; ++i) {
+        buf.get()[i] = static_cast<char>('a' + rng.next() % 26);
+    }
+    return buf;
+}
+
+BENCH_GROUP("strlen", 2, 0, [](size_t bytes) {
+    auto str = make_string(bytes);
+    bench::Case c;
+    c.bytes = c.items = bytes;
+    c.variants = {
+        {"strlen (libc)", [str] {
+            const char* s = str.get();
+            bench::do_not_optimize(s);
+            return std::strlen(s);
+        }},
+        {"strlen_asm", [str] {
+            return strlen_asm(str.get());
+        }},
+        {"strlen_scasb", [str] {
+            return strlen_scasb(str.get());
+        }},
+        {"strlen_sse2", [str] {
+            return strlen_sse2(str.get());
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"strlen_avx2", [str] {
+            return strlen_avx2(str.get());
+        }});
+    }
+    return c;
+});
+
+// Bound at half the string: the scan stops at maxlen, not the terminator
+BENCH_GROUP("strnlen", 2, 0, [](size_t bytes) {
+    auto str = make_string(bytes);
+    size_t maxlen = bytes / 2;
+    bench::Case c;
+    c.bytes = c.items = maxlen;
+    c.variants = {
+        {"strnlen (libc)", [str, maxlen] {
+            const char* s = str.get();
+            bench::do_not_optimize(s);
+            return strnlen(s, maxlen);
+        }},
+        {"strnlen_asm", [str, maxlen] {
+            return strnlen_asm(str.get(), maxlen);
+        }},
+        {"strnlen_sse2", [str, maxlen] {
+            return strnlen_sse2(str.get(), maxlen);
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"strnlen_avx2", [str, maxlen] {
+            return strnlen_avx2(str.get(), maxlen);
+        }});
+    }
+    return c;
+});
+
+BENCH_GROUP("strcpy", 2, 0, [](size_t bytes) {
+    auto src = make_string(bytes);
+    auto dst = bench::make_buffer<char>(bytes);
+    auto checksum = [dst, bytes] {
+        const char* d = dst.get();
+        return d[0] + d[bytes / 2] * 3 + d[bytes - 2] * 7 + (d[bytes - 1] == '\0' ? 0 : 1000000000);
+    };
+    bench::Case c;
+    c.bytes = 2 * bytes;
+    c.items = bytes;
+    c.variants = {
+        {"strcpy (libc)", [src, dst, checksum] {
+            char* d = dst.get();
+            bench::do_not_optimize(d);
+            std::strcpy(d, src.get());
+            return checksum();
+        }},
+        {"strcpy_asm", [src, dst, checksum] {
+            strcpy_asm(dst.get(), src.get());
+            return checksum();
+        }},
+        {"strcpy_lodsb", [src, dst, checksum] {
+            strcpy_lodsb(dst.get(), src.get());
+            return checksum();
+        }},
+        {"strcpy_bounded_sse2", [src, dst, checksum] {
+            strcpy_bounded_sse2(dst.get(), src.get(), SIZE_MAX);
+            return checksum();
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"strcpy_bounded_avx2", [src, dst, checksum] {
+            strcpy_bounded_avx2(dst.get(), src.get(), SIZE_MAX);
+            return checksum();
+        }});
+    }
+    return c;
+});
+
+// stpcpy returns the end, so appending needs no rescan
+BENCH_GROUP("stpcpy", 2, 0, [](size_t bytes) {
+    auto src = make_string(bytes);
+    auto dst = bench::make_buffer<char>(bytes);
+    bench::Case c;
+    c.bytes = 2 * bytes;
+    c.items = bytes;
+    c.variants = {
+        {"stpcpy (libc)", [src, dst] {
+            char* d = dst.get();
+            bench::do_not_optimize(d);
+            return stpcpy(d, src.get()) - d;
+        }},
+        {"stpcpy_asm", [src, dst] {
+            char* d = dst.get();
+            return stpcpy_asm(d, src.get()) - d;
+        }},
+    };
+    return c;
+});
+
+// Copies a bytes-long string into a buffer half that size, so every call
+// truncates and strlcpy must still measure the whole source
+BENCH_GROUP("strlcpy", 4, 0, [](size_t bytes) {
+    auto src = make_string(bytes);
+    auto dst = bench::make_buffer<char>(bytes / 2);
+    size_t size = bytes / 2;
+    bench::Case c;
+    c.bytes = bytes + size;
+    c.items = bytes;
+    c.variants = {
+        {"strlen+memcpy (libc)", [src, dst, size] {
+            const char* s = src.get();
+            char* d = dst.get();
+            bench::do_not_optimize(s);
+            size_t len = std::strlen(s);
+            size_t n = std::min(len, size - 1);
+            std::memcpy(d, s, n);
+            d[n] = '\0';
+            return len + d[n / 2];
+        }},
+        {"strlcpy_asm", [src, dst, size] {
+            size_t len = strlcpy_asm(dst.get(), src.get(), size);
+            return len + dst.get()[(size - 1) / 2];
+        }},
+    };
+    return c;
+});
+
+// Struct filling: short names copied into char[16] fields, about a quarter
+// of them too long to fit. The sweep size is the total size of the records.
+BENCH_GROUP("strscpy_field16", 256, 64 << 20, [](size_t bytes) {
+    struct Record { int id; int flags; char name[16]; };
+    const size_t pool = 256;
+    size_t count = std::max<size_t>(1, bytes / sizeof(Record));
+    auto names = bench::make_buffer<char>(pool * 32);
+    auto records = bench::make_buffer<Record>(count);
+    bench::Rng rng;
+    for (size_t i = 0; i < pool; ++i) {
+        size_t len = rng.next() % 22;
+        char* name = names.get() + i * 32;
+        for (size_t j = 0; j < len; ++j) name[j] = static_cast<char>('a' + rng.next() % 26);
+    }
+    auto checksum = [records, count] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; i += count / 8 + 1) {
+            const char* name = records.get()[i].name;
+            const void* end = std::memchr(name, 0, sizeof(records.get()[i].name));
+            sum += name[0] + (end ? static_cast<const char*>(end) - name : 1000) * 256;
+        }
+        return sum;
+    };
+    bench::Case c;
+    c.bytes = count * sizeof(Record);
+    c.items = count;
+    c.variants = {
+        {"strncpy+terminate (libc)", [names, records, count, checksum] {
+            Record* r = records.get();
+            for (size_t i = 0; i < count; ++i) {
+                const char* name = names.get() + (i % pool) * 32;
+                bench::do_not_optimize(name);
+                std::strncpy(r[i].name, name, sizeof(r[i].name));
+                r[i].name[sizeof(r[i].name) - 1] = '\0';
+            }
+            return checksum();
+        }},
+        {"strscpy_asm", [names, records, count, checksum] {
+            Record* r = records.get();
+            for (size_t i = 0; i < count; ++i) {
+                strscpy_asm(r[i].name, names.get() + (i % pool) * 32, sizeof(r[i].name));
+            }
+            return checksum();
+        }},
+        {"strlcpy_asm", [names, records, count, checksum] {
+            Record* r = records.get();
+            for (size_t i = 0; i < count; ++i) {
+                strlcpy_asm(r[i].name, names.get() + (i % pool) * 32, sizeof(r[i].name));
+            }
+            return checksum();
+        }},
+    };
+    return c;
+});
+
+// Equal buffers except the final byte: every variant scans everything
+BENCH_GROUP("memcmp", 1, 0, [](size_t bytes) {
+    auto a = make_string(bytes);
+    auto b = bench::make_buffer<char>(bytes);
+    std::memcpy(b.get(), a.get(), bytes);
+    b.get()[bytes - 1] = 1;
+    auto sign = [](int v) { return (v > 0) - (v < 0); };
+    bench::Case c;
+    c.bytes = 2 * bytes;
+    c.items = bytes;
+    c.variants = {
+        {"memcmp (libc)", [a, b, bytes, sign] {
+            const char* p = a.get();
+            bench::do_not_optimize(p);
+            return sign(std::memcmp(p, b.get(), bytes));
+        }},
+        {"memcmp_asm", [a, b, bytes, sign] {
+            return sign(memcmp_asm(a.get(), b.get(), bytes));
+        }},
+        {"memcmp_cmpsb", [a, b, bytes, sign] {
+            return sign(memcmp_cmpsb(a.get(), b.get(), bytes));
+        }},
+    };
+    return c;
+});
+
+BENCH_GROUP("memcmp_mismatch", 1, 0, [](size_t bytes) {
+    auto a = make_string(bytes);
+    auto b = bench::make_buffer<char>(bytes);
+    std::memcpy(b.get(), a.get(), bytes);
+    b.get()[bytes - 1] = 1;
+    bench::Case c;
+    c.bytes = 2 * bytes;
+    c.items = bytes;
+    c.variants = {
+        {"std::mismatch", [a, b, bytes] {
+            const char* p = a.get();
+            bench::do_not_optimize(p);
+            return std::mismatch(p, p + bytes, b.get()).first - p;
+        }},
+        {"memcmp_mismatch_asm", [a, b, bytes] {
+            return memcmp_mismatch_asm(a.get(), b.get(), bytes);
+        }},
+        {"memcmp_mismatch_sse2", [a, b, bytes] {
+            return memcmp_mismatch_sse2(a.get(), b.get(), bytes);
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"memcmp_mismatch_avx2", [a, b, bytes] {
+            return memcmp_mismatch_avx2(a.get(), b.get(), bytes);
+        }});
+    }
+    return c;
+});
+
+// Many fixed-width key comparisons: half the pairs are equal, the rest
+// differ at a random position
+bench::Case make_key_case(size_t bytes, size_t width) {
+    size_t pairs = std::max<size_t>(1, bytes / (2 * width));
+    auto a = make_string(pairs * width + 1);
+    auto b = bench::make_buffer<char>(pairs * width + 1);
+    std::memcpy(b.get(), a.get(), pairs * width);
+    bench::Rng rng(width);
+    for (size_t i = 0; i < pairs; ++i) {
+        if (rng.next() & 1) b.get()[i * width + rng.next() % width] ^= 0x20;
+    }
+    auto sign = [](int v) { return (v > 0) - (v < 0); };
+    bench::Case c;
+    c.bytes = 2 * pairs * width;
+    c.items = pairs;
+    c.variants = {
+        {"memcmp (libc)", [=] {
+            const char* pa = a.get();
+            bench::do_not_optimize(pa);
+            long total = 0;
+            for (size_t i = 0; i < pairs; ++i) {
+                total += sign(std::memcmp(pa + i * width, b.get() + i * width, width)) * long(i + 1);
+            }
+            return total;
+        }},
+        {"memcmp_asm", [=] {
+            long total = 0;
+            for (size_t i = 0; i < pairs; ++i) {
+                total += sign(memcmp_asm(a.get() + i * width, b.get() + i * width, width)) * long(i + 1);
+            }
+            return total;
+        }},
+    };
+    return c;
+}
+
+BENCH_GROUP("memcmp_key16", 32, 0, [](size_t bytes) { return make_key_case(bytes, 16); });
+BENCH_GROUP("memcmp_key32", 64, 0, [](size_t bytes) { return make_key_case(bytes, 32); });
+BENCH_GROUP("memcmp_key64", 128, 0, [](size_t bytes) { return make_key_case(bytes, 64); });
+
+// Byte search. Hit-early texts put a needle after every 16-80 letters, like
+// line breaks, so the per-call overhead dominates; hit-late texts hold one
+// needle as the last letter (the first, for reverse scans) and measure
+// throughput. Every variant finds all hits, restarting after each one.
+using FindFn = const char* (*)(const char* s, size_t n);
+using FindList = std::vector<std::pair<const char*, FindFn>>;
+
+// bytes - 1 letters and a terminator
+std::shared_ptr<char> make_text(size_t bytes, const char* needles, bool early, bool reverse) {
+    auto text = make_string(bytes);
+    char* t = text.get();
+    size_t n = bytes - 1, count = std::strlen(needles);
+    bench::Rng rng(5);
+    if (!early) {
+        t[reverse ? 0 : n - 1] = needles[0];
+        return text;
+    }
+    for (size_t i = 16 + rng.next() % 65; i < n; i += 17 + rng.next() % 65) {
+        t[i] = needles[rng.next() % count];
+    }
+    return text;
+}
+
+uint64_t scan_all(const char* text, size_t n, FindFn find, bool reverse) {
+    uint64_t sum = 0;
+    const char* lo = text;
+    const char* hi = text + n;
+    while (lo < hi) {
+        const char* hit = find(lo, static_cast<size_t>(hi - lo));
+        if (!hit) break;
+        sum += static_cast<size_t>(hit - text) + 1;
+        if (reverse) hi = hit; else lo = hit + 1;
+    }
+    return sum;
+}
+
+bench::Case make_search_case(size_t bytes, const char* needles, bool early, bool reverse,
+                             const FindList& fns) {
+    auto text = make_text(bytes, needles, early, reverse);
+    size_t n = bytes - 1;
+    bench::Case c;
+    c.bytes = c.items = n;
+    for (const auto& fn : fns) {
+        FindFn find = fn.second;
+        c.variants.push_back({fn.first, [text, n, find, reverse] {
+            const char* t = text.get();
+            bench::do_not_optimize(t);
+            return scan_all(t, n, find, reverse);
+        }});
+    }
+    return c;
+}
+
+template<size_t (*Kernel)(const void*, int, size_t)>
+const char* find_newline(const char* s, size_t n) {
+    size_t i = Kernel(s, '\n', n);
+    return i < n ? s + i : nullptr;
+}
+
+FindList memchr_variants() {
+    FindList fns = {
+        {"memchr (libc)", [](const char* s, size_t n) {
+            return static_cast<const char*>(std::memchr(s, '\n', n));
+        }},
+        {"memchr_asm", [](const char* s, size_t n) {
+            return static_cast<const char*>(memchr_asm(s, '\n', n));
+        }},
+        {"memchr_index_sse2", find_newline<memchr_index_sse2>},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        fns.push_back({"memchr_index_avx2", find_newline<memchr_index_avx2>});
+    }
+    return fns;
+}
+
+FindList memrchr_variants() {
+    FindList fns = {
+        {"memrchr (libc)", [](const char* s, size_t n) {
+            return static_cast<const char*>(memrchr(s, '\n', n));
+        }},
+        {"memrchr_asm", [](const char* s, size_t n) {
+            return static_cast<const char*>(memrchr_asm(s, '\n', n));
+        }},
+        {"memrchr_index_sse2", find_newline<memrchr_index_sse2>},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        fns.push_back({"memrchr_index_avx2", find_newline<memrchr_index_avx2>});
+    }
+    return fns;
+}
+
+// The text is terminated right after n, so strchr needs no bound
+FindList strchr_variants() {
+    FindList fns = {
+        {"strchr (libc)", [](const char* s, size_t) {
+            return static_cast<const char*>(std::strchr(s, '\n'));
+        }},
+        {"strchr_asm", [](const char* s, size_t) {
+            return static_cast<const char*>(strchr_asm(s, '\n'));
+        }},
+        {"strchr_index_sse2", [](const char* s, size_t) {
+            const char* stop = s + strchr_index_sse2(s, '\n');
+            return *stop ? stop : nullptr;
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        fns.push_back({"strchr_index_avx2", [](const char* s, size_t) {
+            const char* stop = s + strchr_index_avx2(s, '\n');
+            return *stop ? stop : nullptr;
+        }});
+    }
+    return fns;
+}
+
+// libc has no memchr2/3; strpbrk over the terminated text is the nearest
+FindList memchr2_variants() {
+    FindList fns = {
+        {"strpbrk (libc)", [](const char* s, size_t) {
+            return static_cast<const char*>(std::strpbrk(s, "\n\r"));
+        }},
+        {"memchr2_asm", [](const char* s, size_t n) {
+            return static_cast<const char*>(memchr2_asm(s, '\n', '\r', n));
+        }},
+        {"memchr2_index_sse2", [](const char* s, size_t n) {
+            size_t i = memchr2_index_sse2(s, '\n', '\r', n);
+            return i < n ? s + i : nullptr;
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        fns.push_back({"memchr2_index_avx2", [](const char* s, size_t n) {
+            size_t i = memchr2_index_avx2(s, '\n', '\r', n);
+            return i < n ? s + i : nullptr;
+        }});
+    }
+    return fns;
+}
+
+FindList memchr3_variants() {
+    FindList fns = {
+        {"strpbrk (libc)", [](const char* s, size_t) {
+            return static_cast<const char*>(std::strpbrk(s, "\n\r\t"));
+        }},
+        {"memchr3_asm", [](const char* s, size_t n) {
+            return static_cast<const char*>(memchr3_asm(s, '\n', '\r', '\t', n));
+        }},
+        {"memchr3_index_sse2", [](const char* s, size_t n) {
+            size_t i = memchr3_index_sse2(s, '\n', '\r', '\t', n);
+            return i < n ? s + i : nullptr;
+        }},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        fns.push_back({"memchr3_index_avx2", [](const char* s, size_t n) {
+            size_t i = memchr3_index_avx2(s, '\n', '\r', '\t', n);
+            return i < n ? s + i : nullptr;
+        }});
+    }
+    return fns;
+}
+
+BENCH_GROUP("memchr_early", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n", true, false, memchr_variants());
+});
+BENCH_GROUP("memchr_late", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n", false, false, memchr_variants());
+});
+BENCH_GROUP("memrchr_early", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n", true, true, memrchr_variants());
+});
+BENCH_GROUP("memrchr_late", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n", false, true, memrchr_variants());
+});
+BENCH_GROUP("strchr_early", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n", true, false, strchr_variants());
+});
+BENCH_GROUP("strchr_late", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n", false, false, strchr_variants());
+});
+BENCH_GROUP("memchr2_early", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n\r", true, false, memchr2_variants());
+});
+BENCH_GROUP("memchr2_late", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n\r", false, false, memchr2_variants());
+});
+BENCH_GROUP("memchr3_early", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n\r\t", true, false, memchr3_variants());
+});
+BENCH_GROUP("memchr3_late", 2, 0, [](size_t bytes) {
+    return make_search_case(bytes, "\n\r\t", false, false, memchr3_variants());
+});
+
+} // namespace
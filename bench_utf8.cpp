@@ -0,0 +1,162 @@
+// bench_utf8.cpp - UTF-8 validation benchmarks (assm_utf8.c vs a scalar decoder)
+#include "assm_kernels.h"
+#include "assm_internal.h"
+#include "bench.h"
+
+#include <vector>
+
+namespace {
+
+// Encodes one code point; returns its length
+size_t encode(unsigned char* p, uint32_t cp) {
+    if (cp < 0x80) {
+        p[0] = static_cast<unsigned char>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        p[0] = static_cast<unsigned char>(0xC0 | cp >> 6);
+        p[1] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        p[0] = static_cast<unsigned char>(0xE0 | cp >> 12);
+        p[1] = static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3F));
+        p[2] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    p[0] = static_cast<unsigned char>(0xF0 | cp >> 18);
+    p[1] = static_cast<unsigned char>(0x80 | (cp >> 12 & 0x3F));
+    p[2] = static_cast<unsigned char>(0x80 | (cp >> 6 & 0x3F));
+    p[3] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Valid text of exactly `bytes` bytes: ASCII with the given percentages of
+// 2-byte (Latin/Cyrillic), 3-byte (CJK) and 4-byte (emoji) characters
+std::shared_ptr<unsigned char> make_text(size_t bytes, int two, int three, int four) {
+    auto buf = bench::make_buffer<unsigned char>(bytes);
+    unsigned char* p = buf.get();
+    bench::Rng rng(17);
+    size_t pos = 0;
+    while (pos < bytes) {
+        int r = static_cast<int>(rng.next() % 100);
+        uint32_t cp;
+        if (r < four) cp = 0x1F600 + rng.next() % 80;
+        else if (r < four + three) cp = 0x4E00 + rng.next() % 0x5000;
+        else if (r < four + three + two) cp = 0x410 + rng.next() % 64;
+        else cp = 'a' + rng.next() % 26;
+        unsigned char tmp[4];
+        size_t len = encode(tmp, cp);
+        if (len > bytes - pos) {
+            tmp[0] = 'z';
+            len = 1;
+        }
+        for (size_t i = 0; i < len; ++i) p[pos++] = tmp[i];
+    }
+    return buf;
+}
+
+// The byte-at-a-time decoder a separate validation pass usually is:
+// returns the valid prefix length and counts code points
+size_t scalar_validate(const unsigned char* p, size_t n, size_t* count) {
+    size_t i = 0, chars = 0;
+    while (i < n) {
+        unsigned b = p[i];
+        size_t len;
+        uint32_t cp, min;
+        if (b < 0x80) {
+            ++i;
+            ++chars;
+            continue;
+        }
+        if ((b & 0xE0) == 0xC0) { len = 2; cp = b & 0x1F; min = 0x80; }
+        else if ((b & 0xF0) == 0xE0) { len = 3; cp = b & 0x0F; min = 0x800; }
+        else if ((b & 0xF8) == 0xF0) { len = 4; cp = b & 0x07; min = 0x10000; }
+        else break;
+        if (len > n - i) break;
+        size_t k = 1;
+        for (; k < len && (p[i + k] & 0xC0) == 0x80; ++k) cp = cp << 6 | (p[i + k] & 0x3F);
+        if (k < len || cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) break;
+        i += len;
+        ++chars;
+    }
+    *count = chars;
+    return i;
+}
+
+bench::Case make_validate_case(size_t bytes, int two, int three, int four) {
+    auto text = make_text(bytes, two, three, four);
+    bench::Case c;
+    c.bytes = c.items = bytes;
+    auto with = [text, bytes](utf8_scan_fn scan) {
+        return [text, bytes, scan] {
+            const unsigned char* p = text.get();
+            bench::do_not_optimize(p);
+            return utf8_validate_with(scan, p, bytes, nullptr);
+        };
+    };
+    c.variants = {
+        {"scalar decoder", [text, bytes] {
+            const unsigned char* p = text.get();
+            bench::do_not_optimize(p);
+            size_t count;
+            return scalar_validate(p, bytes, &count);
+        }},
+        {"utf8_scan_sse2", with(utf8_scan_sse2)},
+    };
+    if (assm_cpu_detected_tier() >= ASSM_TIER_SSE42) {
+        c.variants.push_back({"utf8_scan_sse42", with(utf8_scan_sse42)});
+    }
+    if (assm_cpu_detected_tier() >= ASSM_TIER_AVX2) {
+        c.variants.push_back({"utf8_scan_avx2", with(utf8_scan_avx2)});
+    }
+    c.variants.push_back({"assm_utf8_validate", [text, bytes] {
+        const unsigned char* p = text.get();
+        bench::do_not_optimize(p);
+        return assm_utf8_validate(p, bytes);
+    }});
+    return c;
+}
+
+// All ASCII: the pmovmskb fast path
+BENCH_GROUP("utf8_ascii", 16, 0, [](size_t bytes) { return make_validate_case(bytes, 0, 0, 0); });
+
+// Mostly ASCII with some accented, CJK and emoji characters
+BENCH_GROUP("utf8_mixed", 16, 0, [](size_t bytes) { return make_validate_case(bytes, 10, 5, 1); });
+
+// Nearly all 3-byte characters: every block takes the full check
+BENCH_GROUP("utf8_cjk", 16, 0, [](size_t bytes) { return make_validate_case(bytes, 0, 95, 0); });
+
+// Validation plus code point count: one combined pass against validating
+// and then counting non-continuation bytes separately
+BENCH_GROUP("utf8_count", 16, 0, [](size_t bytes) {
+    auto text = make_text(bytes, 10, 5, 1);
+    bench::Case c;
+    c.bytes = c.items = bytes;
+    c.variants = {
+        {"scalar decoder", [text, bytes] {
+            const unsigned char* p = text.get();
+            bench::do_not_optimize(p);
+            size_t count;
+            scalar_validate(p, bytes, &count);
+            return count;
+        }},
+        {"validate, then count", [text, bytes] {
+            const unsigned char* p = text.get();
+            bench::do_not_optimize(p);
+            size_t valid = assm_utf8_validate(p, bytes), count = 0;
+            for (size_t i = 0; i < valid; ++i) count += (p[i] & 0xC0) != 0x80;
+            return count;
+        }},
+        {"assm_utf8_validate_count", [text, bytes] {
+            const unsigned char* p = text.get();
+            bench::do_not_optimize(p);
+            size_t count;
+            assm_utf8_validate_count(p, bytes, &count);
+            return count;
+        }},
+    };
+    return c;
+});
+
+} // namespace
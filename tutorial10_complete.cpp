@@ -1,21 +1,9 @@
 // tutorial10_complete.cpp - Mixed C++/Assembly programming
 #include <iostream>
 #include <string>
+#include "assm_kernels.h"
 
-extern "C" long multiply_add_asm(long a, long b, long c);
-
-// Assembly function: (a * b) + c
-__asm__(
-    ".globl multiply_add_asm\n"
-    "multiply_add_asm:\n"
-    "pushq %rbp\n\t"             // Save base pointer
-    "movq %rsp, %rbp\n\t"        // Set up frame
-    "movq %rdi, %rax\n\t"        // Load a into RAX
-    "mulq %rsi\n\t"              // Multiply RAX by b (RSI)
-    "addq %rdx, %rax\n\t"        // Add c (RDX) to result
-    "popq %rbp\n\t"              // Restore base pointer
-    "ret\n"
-);
+// multiply_add_asm: (a * b) + c, lives in assm_control.c (libassmkernels)
 
 class Calculator {
 private:
@@ -45,7 +45,8 @@ int conditional_sum(const std::vector<int>& data, bool always_true) {
     return sum;
 }
 
-// Function with loop that can be unrolled
+// Function with loop that can be unrolled (memcpy_asm in assm_memcpy.c is
+// the hand-written version: size classes, rep movsb, streaming stores)
 void copy_array(const int* src, int* dest, size_t count) {
     for (size_t i = 0; i < count; ++i) {
         dest[i] = src[i];
@@ -84,6 +85,8 @@ T max_value(T a, T b) {
     return (a > b) ? a : b;
 }
 
+// A single timing window around unrelated work: useful for comparing -O0
+// and -O2 builds, not for per-kernel numbers (see `make bench` for those)
 void benchmark_optimization_effects() {
     const size_t DATA_SIZE = 1000000;
     std::vector<int> large_data(DATA_SIZE, 1);
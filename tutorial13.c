@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "assm_kernels.h"
 
 // Obfuscated function names to make reverse engineering necessary
 int a1b2c3(int x) {
@@ -40,7 +41,7 @@ struct MysteryStruct {
 void g7h8i9(struct MysteryStruct* ms) {
     ms->field1 = a1b2c3(ms->field1);
     ms->field2 = ms->field1 ^ 0xDEADBEEF;
-    strcpy(ms->field3, "PROCESSED");
+    strscpy_asm(ms->field3, "PROCESSED", sizeof(ms->field3));
 }
 
 int main(int argc, char* argv[]) {
@@ -64,7 +65,7 @@ int main(int argc, char* argv[]) {
     struct MysteryStruct ms;
     ms.field1 = num;
     ms.field2 = 0;
-    strcpy(ms.field3, "INITIAL");
+    strscpy_asm(ms.field3, "INITIAL", sizeof(ms.field3));
     
     g7h8i9(&ms);
     printf("Structure: field1=%d, field2=%x, field3=%s\n", 
@@ -75,6 +76,6 @@ int main(int argc, char* argv[]) {
 }
 
 // Compile this with:
-// gcc -O2 -o mystery13 tutorial13.c
+// gcc -O2 -o mystery13 tutorial13.c -L. -l:libassmkernels.a
 // strip mystery13
 // Now debug the stripped binary!
\ No newline at end of file
@@ -1,65 +1,66 @@
 // tutorial6_complete.c - String operations and memory manipulation
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "assm_kernels.h"
 
-size_t strlen_asm(const char* str) {
-    size_t len;
+// strlen_asm, strnlen_asm, strcpy_asm and memcmp_asm live in assm_string.c (libassmkernels),
+// assm_crc32c and assm_hash64 in assm_hash.c
+
+// Avalanche: flipping one input bit should flip each output bit with
+// probability 1/2. Returns the mean number of output bits flipped (ideal 32)
+// and stores the largest deviation of any output bit's flip rate from 0.5.
+static double hash_avalanche(int keys, double* worst_bias) {
+    static long flips[64];
+    long trials = 0;
+    unsigned char key[16];
     
-    __asm__ volatile (
-        "movq %1, %%rdi\n\t"        // Load string pointer into RDI
-        "xorq %%rax, %%rax\n\t"     // Clear RAX (will be our counter)
-        "movq $-1, %%rcx\n\t"       // Set RCX to -1 (maximum count)
-        "cld\n\t"                   // Clear direction flag (forward)
-        "repne scasb\n\t"           // Scan for null byte (AL = 0)
-        "notq %%rcx\n\t"            // Invert RCX
-        "decq %%rcx\n\t"            // Subtract 1 (don't count null terminator)
-        "movq %%rcx, %0\n\t"        // Store result
-        : "=m" (len)
-        : "m" (str)
-        : "rax", "rcx", "rdi"
-    );
+    memset(flips, 0, sizeof(flips));
+    srand(1);
+    for (int k = 0; k < keys; k++) {
+        for (int i = 0; i < 16; i++) key[i] = (unsigned char)rand();
+        uint64_t base = assm_hash64(key, sizeof(key), 0);
+        for (int bit = 0; bit < 128; bit++) {
+            key[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+            uint64_t diff = base ^ assm_hash64(key, sizeof(key), 0);
+            key[bit / 8] ^= (unsigned char)(1u << (bit % 8));
+            for (int out = 0; out < 64; out++) flips[out] += (diff >> out) & 1;
+            trials++;
+        }
+    }
     
-    return len;
+    long total = 0;
+    *worst_bias = 0.0;
+    for (int out = 0; out < 64; out++) {
+        double bias = (double)flips[out] / trials - 0.5;
+        if (bias < 0) bias = -bias;
+        if (bias > *worst_bias) *worst_bias = bias;
+        total += flips[out];
+    }
+    return (double)total / trials;
 }
 
-void strcpy_asm(char* dest, const char* src) {
-    __asm__ volatile (
-        "movq %0, %%rdi\n\t"        // Load dest into RDI
-        "movq %1, %%rsi\n\t"        // Load src into RSI
-        "cld\n\t"                   // Clear direction flag
-        "1:\n\t"                    // loop_start
-        "lodsb\n\t"                 // Load byte from [RSI] into AL, increment RSI
-        "stosb\n\t"                 // Store AL into [RDI], increment RDI
-        "testb %%al, %%al\n\t"      // Test if AL is zero (null terminator)
-        "jnz 1b\n\t"                // If not zero, loop back
-        :
-        : "m" (dest), "m" (src)
-        : "rax", "rsi", "rdi"
-    );
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
 }
 
-int memcmp_asm(const void* ptr1, const void* ptr2, size_t num) {
-    int result;
-    
-    __asm__ volatile (
-        "movq %1, %%rsi\n\t"        // Load ptr1 into RSI
-        "movq %2, %%rdi\n\t"        // Load ptr2 into RDI  
-        "movq %3, %%rcx\n\t"        // Load num into RCX
-        "cld\n\t"                   // Clear direction flag
-        "repe cmpsb\n\t"            // Compare bytes while equal
-        "movl $0, %%eax\n\t"        // Default result = 0 (equal)
-        "je 2f\n\t"                 // If equal, skip to end
-        "movl $-1, %%eax\n\t"       // Assume ptr1 < ptr2
-        "jb 2f\n\t"                 // If below, result = -1
-        "movl $1, %%eax\n\t"        // Otherwise ptr1 > ptr2, result = 1
-        "2:\n\t"                    // end
-        "movl %%eax, %0\n\t"        // Store result
-        : "=m" (result)
-        : "m" (ptr1), "m" (ptr2), "m" (num)
-        : "rax", "rcx", "rsi", "rdi"
-    );
+// Full 64-bit collisions among similar keys ("key0", "key1", ...), or -1
+// when the hashes cannot be allocated
+static int hash_collisions(int keys) {
+    uint64_t* hashes = malloc((size_t)keys * sizeof(uint64_t));
+    if (!hashes) return -1;
+    char key[32];
+    int collisions = 0;
     
-    return result;
+    for (int k = 0; k < keys; k++) {
+        int len = snprintf(key, sizeof(key), "key%d", k);
+        hashes[k] = assm_hash64(key, len, 0);
+    }
+    qsort(hashes, keys, sizeof(uint64_t), compare_u64);
+    for (int k = 1; k < keys; k++) collisions += hashes[k] == hashes[k - 1];
+    free(hashes);
+    return collisions;
 }
 
 int main() {
@@ -69,11 +70,22 @@ int main() {
     char test2[] = "ABD";
     
     printf("String length of '%s': %zu\n", src, strlen_asm(src));           // Should print: 14
+    printf("Bounded length (max 5): %zu\n", strnlen_asm(src, 5));          // Should print: 5
     
     strcpy_asm(dest, src);
     printf("Copied string: '%s'\n", dest);                                  // Should print: Hello Assembly
     
     printf("Comparing '%s' and '%s': %d\n", test1, test2, memcmp_asm(test1, test2, 3));  // Should print: -1
     
+    printf("CRC32C of '123456789': 0x%08X\n", assm_crc32c("123456789", 9));  // Should print: 0xE3069283
+    printf("hash64 of 'abc': 0x%016llX\n",
+           (unsigned long long)assm_hash64("abc", 3, 0));                      // Should print: 0x44BC2CF5AD770999
+    
+    double worst_bias;
+    double flipped = hash_avalanche(1000, &worst_bias);
+    printf("hash64 avalanche: %.2f of 64 bits flip per input bit, worst bit bias %.3f\n",
+           flipped, worst_bias);                                               // Should be ~32 and < 0.02
+    printf("hash64 collisions among 200000 keys: %d\n", hash_collisions(200000));  // Should print: 0
+    
     return 0;
 }
\ No newline at end of file